@@ -0,0 +1,96 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Cache line aligned allocator for the arrays behind PIDBank, so
+// the arrays can be split into shards that never share a cache line.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_ALIGNED_ALLOCATOR_H
+#define PID_ALIGNED_ALLOCATOR_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <new>
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Size in bytes of a cache line on the targets this library is tuned for
+//
+#define PID_CACHE_LINE_SIZE    64
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+template <typename T, size_t Alignment = PID_CACHE_LINE_SIZE>
+class
+PIDAlignedAllocator
+{
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef PIDAlignedAllocator<U, Alignment> other;
+        };
+
+        PIDAlignedAllocator() noexcept {}
+
+        template <typename U>
+        PIDAlignedAllocator(const PIDAlignedAllocator<U, Alignment> &) noexcept {}
+
+        T *allocate(size_t count)
+        {
+            return static_cast<T *>(::operator new(count * sizeof(T),
+                                                   std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T *pointer, size_t)
+        {
+            ::operator delete(pointer, std::align_val_t(Alignment));
+        }
+
+        template <typename U>
+        bool operator==(const PIDAlignedAllocator<U, Alignment> &) const noexcept { return true; }
+
+        template <typename U>
+        bool operator!=(const PIDAlignedAllocator<U, Alignment> &) const noexcept { return false; }
+};
+
+#endif  // PID_ALIGNED_ALLOCATOR_H
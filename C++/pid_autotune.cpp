@@ -0,0 +1,359 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Automatic tuning of PID gains. PIDRelayTuner runs an Astrom-
+// Hagglund relay experiment on a live loop and turns the ultimate gain and
+// period into gains, and PIDTuneGridSearch scores a grid of gain sets against a
+// first order plus dead time plant model, thousands at a time, through PIDBank.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "pid_autotune.h"
+#include "pid_bank.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define PID_TUNE_PI             3.14159265358979323846
+
+//
+// Gain sets per bank handed to a search thread at a time. Small enough that
+// a bank and its plant models stay in the L2 cache.
+//
+#define PID_TUNE_BLOCK          2048
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static float
+GainAt(const PIDGainRange &range, unsigned step)
+{
+    if(range.steps <= 1)
+    {
+        return range.min;
+    }
+
+    return range.min + (range.max - range.min) * (float)step / (float)(range.steps - 1);
+}
+
+//
+// Runs the experiment for gain sets [first, last) of the grid
+//
+static void
+SearchBlock(const PIDPlantFOPDT &plant, const PIDGainRange &kp, const PIDGainRange &ki,
+            const PIDGainRange &kd, const PIDTuneOptions &options, size_t first,
+            size_t last, PIDTuneResult *results)
+{
+    size_t n = last - first;
+    float dt = options.sampleTime;
+    float setpoint = options.setpoint;
+    size_t steps = (size_t)ceil(options.duration / dt);
+    size_t delaySteps = (size_t)lround(plant.deadTime > 0.0f ? plant.deadTime / dt : 0.0);
+    size_t ring = delaySteps + 1;
+    float decay, drive;
+    PIDBank bank(n);
+
+    // Zero order hold discretization of the first order lag
+    decay = (plant.timeConstant > 0.0f) ? (float)exp(-(double)dt / plant.timeConstant) : 0.0f;
+    drive = (1.0f - decay) * plant.gain;
+
+    for(size_t c = first; c < last; c++)
+    {
+        PIDTuneResult &result = results[c - first];
+        size_t kiSteps = ki.steps ? ki.steps : 1;
+        size_t kdSteps = kd.steps ? kd.steps : 1;
+
+        result.kp = GainAt(kp, (unsigned)(c / (kiSteps * kdSteps)));
+        result.ki = GainAt(ki, (unsigned)(c / kdSteps % kiSteps));
+        result.kd = GainAt(kd, (unsigned)(c % kdSteps));
+
+        bank.PIDAdd(result.kp, result.ki, result.kd, dt, options.outMin, options.outMax,
+                    AUTOMATIC, DIRECT);
+        bank.PIDSetpointSet(c - first, setpoint);
+    }
+
+    // The plant output, the metrics and the dead time line of past controller
+    // outputs, one row per step of delay
+    std::vector<float> y(n, 0.0f), iae(n, 0.0f), ise(n, 0.0f), peak(n, 0.0f);
+    std::vector<float> delay(ring * n, 0.0f);
+    float *input = bank.InputData();
+    const float *u = bank.OutputData();
+
+    for(size_t step = 0; step < steps; step++)
+    {
+        float *write = &delay[(step % ring) * n];
+        const float *read = &delay[((step + 1) % ring) * n];
+
+        for(size_t i = 0; i < n; i++)
+        {
+            input[i] = y[i];
+        }
+
+        bank.ComputeAll();
+
+        // With no dead time read is write, so the plant sees this output
+        for(size_t i = 0; i < n; i++)
+        {
+            write[i] = u[i];
+        }
+
+        for(size_t i = 0; i < n; i++)
+        {
+            float error;
+
+            y[i] = decay * y[i] + drive * read[i];
+            error = setpoint - y[i];
+            iae[i] += fabsf(error);
+            ise[i] += error * error;
+            peak[i] = (y[i] > peak[i]) ? y[i] : peak[i];
+        }
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        PIDTuneResult &result = results[i];
+        float overshoot = (setpoint != 0.0f) ? (peak[i] - setpoint) / fabsf(setpoint) : 0.0f;
+
+        result.iae = iae[i] * dt;
+        result.ise = ise[i] * dt;
+        result.overshoot = (overshoot > 0.0f) ? overshoot : 0.0f;
+        result.score = options.iaeWeight * result.iae + options.iseWeight * result.ise +
+                       options.overshootWeight * result.overshoot;
+
+        // A loop that blew up sorts last
+        if(!(result.score == result.score))
+        {
+            result.score = INFINITY;
+        }
+    }
+}
+
+//*********************************************************************************
+// Public Functions
+//*********************************************************************************
+
+size_t
+PIDTuneGridSearch(const PIDPlantFOPDT &plant, const PIDGainRange &kp,
+                  const PIDGainRange &ki, const PIDGainRange &kd,
+                  const PIDTuneOptions &options, std::vector<PIDTuneResult> &results)
+{
+    size_t count = (size_t)(kp.steps ? kp.steps : 1) * (ki.steps ? ki.steps : 1) *
+                   (kd.steps ? kd.steps : 1);
+    size_t blocks = (count + PID_TUNE_BLOCK - 1) / PID_TUNE_BLOCK;
+    unsigned threadCount = options.threads;
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+
+    results.resize(count);
+
+    if(!(options.sampleTime > 0.0f))
+    {
+        results.clear();
+        return 0;
+    }
+
+    if(threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+        threadCount = threadCount ? threadCount : 1;
+    }
+    threadCount = (unsigned)std::min<size_t>(threadCount, blocks);
+
+    // Each thread takes the next block until they are all done
+    auto work = [&]()
+    {
+        for(size_t block = next++; block < blocks; block = next++)
+        {
+            size_t first = block * PID_TUNE_BLOCK;
+            size_t last = std::min(first + PID_TUNE_BLOCK, count);
+
+            SearchBlock(plant, kp, ki, kd, options, first, last, &results[first]);
+        }
+    };
+
+    for(unsigned t = 1; t < threadCount; t++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+
+    for(std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::stable_sort(results.begin(), results.end(),
+                     [](const PIDTuneResult &a, const PIDTuneResult &b)
+                     {
+                         return a.score < b.score;
+                     });
+
+    return count;
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDRelayTuner::
+PIDRelayTuner(float setpoint, float bias, float amplitude, float hysteresis,
+              float sampleTimeSeconds, unsigned cycles) :
+    setpoint(setpoint),
+    bias(bias),
+    amplitude(amplitude),
+    hysteresis(hysteresis),
+    sampleTime(sampleTimeSeconds > 0.0f ? sampleTimeSeconds : 1.0f),
+    cycles(cycles ? cycles : 1),
+    high(true),
+    samples(0),
+    lastSwitch(0),
+    switches(0),
+    measured(0),
+    inputMax(-INFINITY),
+    inputMin(INFINITY),
+    periodSum(0.0),
+    swingSum(0.0)
+{
+}
+
+float PIDRelayTuner::
+Step(float input)
+{
+    samples++;
+
+    inputMax = (input > inputMax) ? input : inputMax;
+    inputMin = (input < inputMin) ? input : inputMin;
+
+    if(high && input > setpoint + hysteresis)
+    {
+        high = false;
+
+        // A cycle ended. The first one is still settling.
+        if(switches >= 2 && measured < cycles)
+        {
+            periodSum += (double)(samples - lastSwitch) * sampleTime;
+            swingSum += 0.5 * ((double)inputMax - (double)inputMin);
+            measured++;
+        }
+
+        switches++;
+        lastSwitch = samples;
+        inputMax = input;
+        inputMin = input;
+    }
+    else if(!high && input < setpoint - hysteresis)
+    {
+        high = true;
+    }
+
+    return high ? bias + amplitude : bias - amplitude;
+}
+
+float PIDRelayTuner::
+UltimateGain() const
+{
+    double swing, squared;
+
+    if(!Done())
+    {
+        return 0.0f;
+    }
+
+    swing = swingSum / measured;
+    squared = swing * swing - (double)hysteresis * hysteresis;
+
+    if(squared <= 0.0)
+    {
+        return 0.0f;
+    }
+
+    return (float)(4.0 * amplitude / (PID_TUNE_PI * sqrt(squared)));
+}
+
+float PIDRelayTuner::
+UltimatePeriod() const
+{
+    return Done() ? (float)(periodSum / measured) : 0.0f;
+}
+
+bool PIDRelayTuner::
+Gains(PIDTuneRule rule, float &kp, float &ki, float &kd) const
+{
+    float ku = UltimateGain();
+    float tu = UltimatePeriod();
+    float gain, ti, td;
+
+    if(ku <= 0.0f || tu <= 0.0f)
+    {
+        return false;
+    }
+
+    switch(rule)
+    {
+        case PID_TUNE_ZN_PI:
+            gain = 0.45f * ku;
+            ti = tu / 1.2f;
+            td = 0.0f;
+            break;
+
+        case PID_TUNE_ZN_PID:
+            gain = 0.6f * ku;
+            ti = tu / 2.0f;
+            td = tu / 8.0f;
+            break;
+
+        case PID_TUNE_NO_OVERSHOOT:
+            gain = 0.2f * ku;
+            ti = tu / 2.0f;
+            td = tu / 3.0f;
+            break;
+
+        case PID_TUNE_TYREUS_LUYBEN:
+        default:
+            gain = ku / 2.2f;
+            ti = 2.2f * tu;
+            td = tu / 6.3f;
+            break;
+    }
+
+    kp = gain;
+    ki = gain / ti;
+    kd = gain * td;
+
+    return true;
+}
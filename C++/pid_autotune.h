@@ -0,0 +1,251 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Automatic tuning of PID gains. PIDRelayTuner runs an Astrom-
+// Hagglund relay experiment on a live loop and turns the ultimate gain and
+// period into gains, and PIDTuneGridSearch scores a grid of gain sets against a
+// first order plus dead time plant model, thousands at a time, through PIDBank.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_AUTOTUNE_H
+#define PID_AUTOTUNE_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Rules that turn an ultimate gain Ku and period Tu into gains
+// PID_TUNE_ZN_PI:          Ziegler-Nichols PI
+// PID_TUNE_ZN_PID:         Ziegler-Nichols classic PID
+// PID_TUNE_NO_OVERSHOOT:   Ziegler-Nichols variant with little overshoot
+// PID_TUNE_TYREUS_LUYBEN:  Tyreus-Luyben, more robust and slower
+//
+typedef enum
+{
+    PID_TUNE_ZN_PI,
+    PID_TUNE_ZN_PID,
+    PID_TUNE_NO_OVERSHOOT,
+    PID_TUNE_TYREUS_LUYBEN
+}
+PIDTuneRule;
+
+//
+// First order plus dead time plant, y' = (gain * u(t - deadTime) - y) / timeConstant
+//
+struct
+PIDPlantFOPDT
+{
+    float gain;
+    float timeConstant;
+    float deadTime;
+};
+
+//
+// steps evenly spaced values from min to max. One step is min alone.
+//
+struct
+PIDGainRange
+{
+    float min;
+    float max;
+    unsigned steps;
+};
+
+//
+// The closed loop experiment each gain set of a search is scored on: a step of
+// the setpoint from 0, with the plant at rest, simulated for duration seconds.
+// The score is the weighted sum of the integrated absolute error, the
+// integrated square error and the overshoot as a fraction of the step.
+//
+struct
+PIDTuneOptions
+{
+    float sampleTime = 0.01f;
+    float duration = 10.0f;
+    float setpoint = 1.0f;
+    float outMin = -10.0f;
+    float outMax = 10.0f;
+    float iaeWeight = 1.0f;
+    float iseWeight = 0.0f;
+    float overshootWeight = 1.0f;
+
+    // Threads to run the search on, including the caller. Zero uses one per
+    // hardware thread.
+    unsigned threads = 0;
+};
+
+struct
+PIDTuneResult
+{
+    float kp;
+    float ki;
+    float kd;
+    float iae;
+    float ise;
+    float overshoot;
+    float score;
+};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class
+PIDRelayTuner
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Sets up a relay experiment. While it runs, the relay replaces
+        //      the controller: its output is bias + amplitude while the input
+        //      is below the setpoint and bias - amplitude while above, which
+        //      makes a direct acting loop oscillate at its ultimate period.
+        // Parameters:
+        //      setpoint - Value the input oscillates around.
+        //      bias - Middle of the relay output.
+        //      amplitude - Half the swing of the relay output.
+        //      hysteresis - Band around the setpoint the input must leave
+        //          before the relay switches, to ride out noise.
+        //      sampleTimeSeconds - Interval between calls to Step.
+        //      cycles - Oscillation cycles to measure. The first, which is
+        //          still settling, is not counted.
+        // Returns:
+        //      Nothing.
+        //
+        PIDRelayTuner(float setpoint, float bias, float amplitude, float hysteresis,
+                      float sampleTimeSeconds, unsigned cycles = 4);
+
+        //
+        // Step
+        // Description:
+        //      Takes a sample of the input and gives the relay output to
+        //      apply until the next sample.
+        // Parameters:
+        //      input - The process value.
+        // Returns:
+        //      The output to drive the plant with.
+        //
+        float Step(float input);
+
+        //
+        // Done
+        // Description:
+        //      Tells whether the requested cycles have been measured.
+        //
+        inline bool Done() const { return measured >= cycles; }
+
+        //
+        // Ultimate Gain and Period
+        // Description:
+        //      Ku = 4 * amplitude / (pi * sqrt(a^2 - hysteresis^2)), with a
+        //      half the measured input swing, and Tu the mean period in
+        //      seconds. Zero until Done.
+        //
+        float UltimateGain() const;
+        float UltimatePeriod() const;
+
+        //
+        // Gains
+        // Description:
+        //      Turns Ku and Tu into gains for PIDTuningsSet.
+        // Parameters:
+        //      rule - The tuning rule.
+        //      kp, ki, kd - Receive the gains.
+        // Returns:
+        //      False, leaving the gains alone, if the experiment is not done.
+        //
+        bool Gains(PIDTuneRule rule, float &kp, float &ki, float &kd) const;
+
+    private:
+        float setpoint;
+        float bias;
+        float amplitude;
+        float hysteresis;
+        float sampleTime;
+        unsigned cycles;
+
+        //
+        // A cycle starts each time the relay switches low. switches counts
+        // those, measured the cycles after the first that have ended.
+        //
+        bool high;
+        uint64_t samples;
+        uint64_t lastSwitch;
+        unsigned switches;
+        unsigned measured;
+
+        //
+        // Extremes of the input in the current cycle, and the sums over the
+        // measured cycles
+        //
+        float inputMax;
+        float inputMin;
+        double periodSum;
+        double swingSum;
+};
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+//
+// PID Tune Grid Search
+// Description:
+//      Scores every gain set of the grid kp x ki x kd on the closed loop step
+//      experiment of options against the plant model. Blocks of gain sets are
+//      each run as one PIDBank, so the controllers go through the SIMD kernels
+//      and the plant models through vectorized loops, and the blocks are
+//      shared out to a pool of threads.
+// Parameters:
+//      plant - The plant model.
+//      kp, ki, kd - The ranges of gains to search.
+//      options - The experiment and the weights of the score.
+//      results - Receives every gain set with its metrics, best score first.
+// Returns:
+//      The number of gain sets scored.
+//
+size_t PIDTuneGridSearch(const PIDPlantFOPDT &plant, const PIDGainRange &kp,
+                         const PIDGainRange &ki, const PIDGainRange &kd,
+                         const PIDTuneOptions &options,
+                         std::vector<PIDTuneResult> &results);
+
+#endif  // PID_AUTOTUNE_H
@@ -0,0 +1,1084 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: A bank of PID controllers stored as a structure of arrays. Each
+// controller field lives in its own contiguous array so that a whole bank can
+// be stepped in a single branch free pass instead of one PIDControl object at
+// a time.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <string.h>
+#include "pid_bank.h"
+#include "pid_bank_simd.h"
+#include "pid_checkpoint.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Number of controllers a bound bank gathers and scatters at a time. The
+// chunk's inputs, setpoints and outputs stay in L1 between the copy and the
+// compute.
+//
+#define PID_BANK_CHUNK              512
+
+//
+// ComputeActive gathers a chunk into scratch arrays when fewer than one in
+// PID_BANK_SPARSE_RATIO of its controllers are awake. Above that, masking the
+// resting controllers out of the in place kernel is cheaper than the copies.
+//
+#define PID_BANK_SPARSE_RATIO       8
+
+//
+// Keep every multiply and add rounded on its own so that PIDCompute matches
+// the batched PIDBank kernels bit for bit, even when FMA is available.
+//
+#if defined(__clang__)
+    #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+    #pragma GCC optimize ("fp-contract=off")
+#endif
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// Copies elements [first, last) of a strided external array into a packed one
+//
+static void
+Gather(float *destination, const float *source, size_t stride, size_t first,
+       size_t last)
+{
+    const char *bytes = (const char *)source;
+
+    if(stride == 0 || stride == sizeof(float))
+    {
+        memcpy(destination + first, source + first, (last - first) * sizeof(float));
+        return;
+    }
+
+    for(size_t i = first; i < last; i++)
+    {
+        memcpy(&destination[i], bytes + i * stride, sizeof(float));
+    }
+}
+
+//
+// Moves the last element of an array into index and drops the last element
+//
+template <typename Array>
+static void
+SwapRemove(Array &array, size_t index)
+{
+    array[index] = array.back();
+    array.pop_back();
+}
+
+//
+// The kernel arrays moved along so that element 0 is controller offset
+//
+static PIDBankArrays
+ArraysOffset(const PIDBankArrays &arrays, size_t offset)
+{
+    PIDBankArrays moved;
+
+    moved.input = arrays.input + offset;
+    moved.setpoint = arrays.setpoint + offset;
+    moved.output = arrays.output + offset;
+    moved.lastInput = arrays.lastInput + offset;
+    moved.iTerm = arrays.iTerm + offset;
+    moved.alteredKp = arrays.alteredKp + offset;
+    moved.alteredKi = arrays.alteredKi + offset;
+    moved.alteredKd = arrays.alteredKd + offset;
+    moved.outMin = arrays.outMin + offset;
+    moved.outMax = arrays.outMax + offset;
+    moved.mode = arrays.mode + offset;
+    moved.alteredKt = arrays.alteredKt + offset;
+    moved.antiWindup = arrays.antiWindup ? arrays.antiWindup + offset : nullptr;
+    moved.setpointWeightB = arrays.setpointWeightB + offset;
+    moved.setpointWeightC = arrays.setpointWeightC + offset;
+    moved.filterAlpha = arrays.filterAlpha + offset;
+    moved.filterKd = arrays.filterKd + offset;
+    moved.weighted = arrays.weighted ? arrays.weighted + offset : nullptr;
+    moved.dTerm = arrays.dTerm + offset;
+    moved.lastSetpoint = arrays.lastSetpoint + offset;
+
+    return moved;
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDBank::
+PIDBank(size_t capacity) :
+    windupCount(0),
+    weightedCount(0),
+    activeCount(0),
+    binding(),
+    bound(false)
+{
+    input.reserve(capacity);
+    lastInput.reserve(capacity);
+    output.reserve(capacity);
+    dispKp.reserve(capacity);
+    dispKi.reserve(capacity);
+    dispKd.reserve(capacity);
+    alteredKp.reserve(capacity);
+    alteredKi.reserve(capacity);
+    alteredKd.reserve(capacity);
+    iTerm.reserve(capacity);
+    sampleTime.reserve(capacity);
+    outMin.reserve(capacity);
+    outMax.reserve(capacity);
+    setpoint.reserve(capacity);
+    controllerDirection.reserve(capacity);
+    mode.reserve(capacity);
+    deadband.reserve(capacity);
+    lastSetpoint.reserve(capacity);
+    outputChanged.reserve(capacity);
+    forceCompute.reserve(capacity);
+    antiWindup.reserve(capacity);
+    dispKt.reserve(capacity);
+    alteredKt.reserve(capacity);
+    setpointWeightB.reserve(capacity);
+    setpointWeightC.reserve(capacity);
+    filterN.reserve(capacity);
+    filterAlpha.reserve(capacity);
+    filterKd.reserve(capacity);
+    dTerm.reserve(capacity);
+    weighted.reserve(capacity);
+    active.reserve(capacity);
+}
+
+size_t PIDBank::
+PIDAdd(float kp, float ki, float kd, float sampleTimeSeconds, float minOutput,
+       float maxOutput, PIDMode mode, PIDDirection controllerDirection)
+{
+    size_t index = input.size();
+
+    this->controllerDirection.push_back(controllerDirection);
+    this->mode.push_back(mode);
+    iTerm.push_back(0.0f);
+    input.push_back(0.0f);
+    lastInput.push_back(0.0f);
+    output.push_back(0.0f);
+    setpoint.push_back(0.0f);
+
+    // Deadband mode starts out off
+    deadband.push_back(-1.0f);
+    lastSetpoint.push_back(0.0f);
+    outputChanged.push_back(0);
+    forceCompute.push_back(1);
+    active.push_back(0);
+
+    // Anti-windup starts out as plain clamping
+    antiWindup.push_back(CLAMPING);
+    dispKt.push_back(0.0f);
+    alteredKt.push_back(0.0f);
+
+    // So does the update law, with its filter coefficients filled in by
+    // PIDTuningsSet below
+    setpointWeightB.push_back(1.0f);
+    setpointWeightC.push_back(0.0f);
+    filterN.push_back(0.0f);
+    filterAlpha.push_back(0.0f);
+    filterKd.push_back(0.0f);
+    dTerm.push_back(0.0f);
+    weighted.push_back(0);
+
+    // If the passed parameter was incorrect, set to 1 second
+    sampleTime.push_back(sampleTimeSeconds > 0.0f ? sampleTimeSeconds : 1.0f);
+
+    // Placeholders that the setters below fill in. The limits start out invalid
+    // on purpose so that a bad min/max pair leaves them the way PIDControl
+    // would leave its uninitialized members.
+    outMin.push_back(0.0f);
+    outMax.push_back(0.0f);
+    dispKp.push_back(0.0f);
+    dispKi.push_back(0.0f);
+    dispKd.push_back(0.0f);
+    alteredKp.push_back(0.0f);
+    alteredKi.push_back(0.0f);
+    alteredKd.push_back(0.0f);
+
+    PIDOutputLimitsSet(index, minOutput, maxOutput);
+    PIDTuningsSet(index, kp, ki, kd);
+
+    return index;
+}
+
+size_t PIDBank::
+PIDRemove(size_t index)
+{
+    windupCount -= (antiWindup[index] != CLAMPING);
+    weightedCount -= (weighted[index] != 0);
+
+    SwapRemove(input, index);
+    SwapRemove(lastInput, index);
+    SwapRemove(output, index);
+    SwapRemove(dispKp, index);
+    SwapRemove(dispKi, index);
+    SwapRemove(dispKd, index);
+    SwapRemove(alteredKp, index);
+    SwapRemove(alteredKi, index);
+    SwapRemove(alteredKd, index);
+    SwapRemove(iTerm, index);
+    SwapRemove(sampleTime, index);
+    SwapRemove(outMin, index);
+    SwapRemove(outMax, index);
+    SwapRemove(setpoint, index);
+    SwapRemove(controllerDirection, index);
+    SwapRemove(mode, index);
+    SwapRemove(deadband, index);
+    SwapRemove(lastSetpoint, index);
+    SwapRemove(outputChanged, index);
+    SwapRemove(forceCompute, index);
+    SwapRemove(antiWindup, index);
+    SwapRemove(dispKt, index);
+    SwapRemove(alteredKt, index);
+    SwapRemove(setpointWeightB, index);
+    SwapRemove(setpointWeightC, index);
+    SwapRemove(filterN, index);
+    SwapRemove(filterAlpha, index);
+    SwapRemove(filterKd, index);
+    SwapRemove(dTerm, index);
+    SwapRemove(weighted, index);
+
+    // The active set may name the moved or removed controllers
+    active.pop_back();
+    activeCount = 0;
+
+    return input.size();
+}
+
+void PIDBank::
+ComputeAll()
+{
+    ComputeRange(0, input.size());
+}
+
+void PIDBank::
+ComputeRange(size_t first, size_t last)
+{
+    PIDBankArrays arrays;
+
+    arrays.input = input.data();
+    arrays.setpoint = setpoint.data();
+    arrays.output = output.data();
+    arrays.lastInput = lastInput.data();
+    arrays.iTerm = iTerm.data();
+    arrays.alteredKp = alteredKp.data();
+    arrays.alteredKi = alteredKi.data();
+    arrays.alteredKd = alteredKd.data();
+    arrays.outMin = outMin.data();
+    arrays.outMax = outMax.data();
+    arrays.mode = mode.data();
+    arrays.alteredKt = alteredKt.data();
+    arrays.antiWindup = windupCount ? antiWindup.data() : nullptr;
+    arrays.setpointWeightB = setpointWeightB.data();
+    arrays.setpointWeightC = setpointWeightC.data();
+    arrays.filterAlpha = filterAlpha.data();
+    arrays.filterKd = filterKd.data();
+    arrays.weighted = weightedCount ? weighted.data() : nullptr;
+    arrays.dTerm = dTerm.data();
+    arrays.lastSetpoint = lastSetpoint.data();
+
+#ifdef PID_INSTRUMENTATION
+    uint64_t start = PIDStatsNow();
+#endif
+
+    if(!bound)
+    {
+        PIDBankKernelRun(arrays, first, last);
+#ifdef PID_INSTRUMENTATION
+        StatsRecord(start, first, last);
+#endif
+        return;
+    }
+
+    for(size_t chunk = first; chunk < last; chunk += PID_BANK_CHUNK)
+    {
+        size_t chunkLast = (last - chunk > PID_BANK_CHUNK) ? chunk + PID_BANK_CHUNK : last;
+
+        // Pull the chunk's inputs and setpoints out of the external arrays
+        if(binding.input)
+        {
+            Gather(input.data(), binding.input, binding.inputStride, chunk, chunkLast);
+        }
+        if(binding.setpoint)
+        {
+            Gather(setpoint.data(), binding.setpoint, binding.setpointStride, chunk, chunkLast);
+        }
+
+        PIDBankKernelRun(arrays, chunk, chunkLast);
+
+        // Push the outputs of controllers in AUTOMATIC back out
+        if(binding.output)
+        {
+            char *bytes = (char *)binding.output;
+            size_t stride = binding.outputStride ? binding.outputStride : sizeof(float);
+
+            for(size_t i = chunk; i < chunkLast; i++)
+            {
+                if(mode[i] == AUTOMATIC)
+                {
+                    memcpy(bytes + i * stride, &output[i], sizeof(float));
+                }
+            }
+        }
+    }
+
+#ifdef PID_INSTRUMENTATION
+    StatsRecord(start, first, last);
+#endif
+}
+
+void PIDBank::
+ComputeIndices(const uint32_t *indices, size_t n)
+{
+    for(size_t k = 0; k < n; k += PID_BANK_CHUNK)
+    {
+        ComputeGathered(indices + k, (n - k > PID_BANK_CHUNK) ? PID_BANK_CHUNK : n - k);
+    }
+}
+
+size_t PIDBank::
+ComputeActive()
+{
+    activeCount = ComputeActiveRange(0, input.size());
+
+    return activeCount;
+}
+
+size_t PIDBank::
+ComputeActiveRange(size_t first, size_t last)
+{
+    alignas(PID_CACHE_LINE_SIZE) PIDMode chunkMode[PID_BANK_CHUNK];
+    PIDBankArrays arrays;
+    uint32_t *indices = active.data() + first;
+    size_t count = 0;
+
+    arrays.input = input.data();
+    arrays.setpoint = setpoint.data();
+    arrays.output = output.data();
+    arrays.lastInput = lastInput.data();
+    arrays.iTerm = iTerm.data();
+    arrays.alteredKp = alteredKp.data();
+    arrays.alteredKi = alteredKi.data();
+    arrays.alteredKd = alteredKd.data();
+    arrays.outMin = outMin.data();
+    arrays.outMax = outMax.data();
+    arrays.mode = mode.data();
+    arrays.alteredKt = alteredKt.data();
+    arrays.antiWindup = windupCount ? antiWindup.data() : nullptr;
+    arrays.setpointWeightB = setpointWeightB.data();
+    arrays.setpointWeightC = setpointWeightC.data();
+    arrays.filterAlpha = filterAlpha.data();
+    arrays.filterKd = filterKd.data();
+    arrays.weighted = weightedCount ? weighted.data() : nullptr;
+    arrays.dTerm = dTerm.data();
+    arrays.lastSetpoint = lastSetpoint.data();
+
+#ifdef PID_INSTRUMENTATION
+    uint64_t start = PIDStatsNow();
+#endif
+
+    for(size_t chunk = first; chunk < last; chunk += PID_BANK_CHUNK)
+    {
+        size_t chunkLast = (last - chunk > PID_BANK_CHUNK) ? chunk + PID_BANK_CHUNK : last;
+        size_t awake = 0;
+
+        if(bound && binding.input)
+        {
+            Gather(input.data(), binding.input, binding.inputStride, chunk, chunkLast);
+        }
+        if(bound && binding.setpoint)
+        {
+            Gather(setpoint.data(), binding.setpoint, binding.setpointStride, chunk, chunkLast);
+        }
+
+        // Collect the awake controllers. Every index is written and only the
+        // awake ones are kept, which avoids a branch per controller.
+        for(size_t i = chunk; i < chunkLast; i++)
+        {
+            bool on = (mode[i] == AUTOMATIC) && (forceCompute[i] || !PIDAtRest(i));
+
+            chunkMode[i - chunk] = on ? AUTOMATIC : MANUAL;
+            outputChanged[i] = (mode[i] == AUTOMATIC) ? on : outputChanged[i];
+            indices[count + awake] = (uint32_t)i;
+            awake += on;
+        }
+
+        if(awake * PID_BANK_SPARSE_RATIO < chunkLast - chunk)
+        {
+            ComputeGathered(indices + count, awake);
+        }
+        else
+        {
+            PIDBankArrays chunkArrays = ArraysOffset(arrays, chunk);
+
+            chunkArrays.mode = chunkMode;
+            PIDBankKernelRun(chunkArrays, 0, chunkLast - chunk);
+        }
+
+        // Remember what the outputs were computed from and push them out
+        for(size_t k = count; k < count + awake; k++)
+        {
+            size_t i = indices[k];
+
+            lastSetpoint[i] = setpoint[i];
+            forceCompute[i] = 0;
+
+            if(bound && binding.output)
+            {
+                size_t stride = binding.outputStride ? binding.outputStride : sizeof(float);
+
+                memcpy((char *)binding.output + i * stride, &output[i], sizeof(float));
+            }
+        }
+
+        count += awake;
+    }
+
+#ifdef PID_INSTRUMENTATION
+    StatsRecordActive(start, indices, count);
+#endif
+
+    return count;
+}
+
+void PIDBank::
+Bind(const PIDBankBinding &binding)
+{
+    this->binding = binding;
+    bound = (binding.input || binding.setpoint || binding.output);
+}
+
+void PIDBank::
+Unbind()
+{
+    binding = PIDBankBinding();
+    bound = false;
+}
+
+size_t PIDBank::
+MemoryBytes() const
+{
+    size_t floats = input.capacity() + lastInput.capacity() + output.capacity() +
+                    dispKp.capacity() + dispKi.capacity() + dispKd.capacity() +
+                    alteredKp.capacity() + alteredKi.capacity() + alteredKd.capacity() +
+                    iTerm.capacity() + sampleTime.capacity() + outMin.capacity() +
+                    outMax.capacity() + setpoint.capacity() + deadband.capacity() +
+                    lastSetpoint.capacity() + dispKt.capacity() + alteredKt.capacity() +
+                    setpointWeightB.capacity() + setpointWeightC.capacity() +
+                    filterN.capacity() + filterAlpha.capacity() + filterKd.capacity() +
+                    dTerm.capacity();
+
+    return floats * sizeof(float) +
+           controllerDirection.capacity() * sizeof(PIDDirection) +
+           mode.capacity() * sizeof(PIDMode) +
+           outputChanged.capacity() + forceCompute.capacity() +
+           antiWindup.capacity() * sizeof(PIDAntiWindup) +
+           weighted.capacity() * sizeof(uint32_t) + active.capacity() * sizeof(uint32_t);
+}
+
+size_t PIDBank::
+CheckpointSize() const
+{
+    return PIDCheckpointSize(input.size());
+}
+
+size_t PIDBank::
+CheckpointWrite(void *buffer, size_t size) const
+{
+    size_t count = input.size();
+    PIDCheckpointRecord *records;
+
+    if(size < PIDCheckpointSize(count) || count > UINT32_MAX)
+    {
+        return 0;
+    }
+
+    PIDCheckpointHeaderWrite(buffer, count);
+    records = (PIDCheckpointRecord *)((char *)buffer + sizeof(PIDCheckpointHeader));
+
+    for(size_t i = 0; i < count; i++)
+    {
+        PIDCheckpointRecord &record = records[i];
+
+        record.input = input[i];
+        record.lastInput = lastInput[i];
+        record.output = output[i];
+        record.iTerm = iTerm[i];
+        record.setpoint = setpoint[i];
+        record.dispKp = dispKp[i];
+        record.dispKi = dispKi[i];
+        record.dispKd = dispKd[i];
+        record.alteredKp = alteredKp[i];
+        record.alteredKi = alteredKi[i];
+        record.alteredKd = alteredKd[i];
+        record.sampleTime = sampleTime[i];
+        record.outMin = outMin[i];
+        record.outMax = outMax[i];
+        record.deadband = deadband[i];
+        record.mode = (uint8_t)mode[i];
+        record.controllerDirection = (uint8_t)controllerDirection[i];
+        record.antiWindup = (uint8_t)antiWindup[i];
+        record.reserved = 0;
+        record.dispKt = dispKt[i];
+        record.setpointWeightB = setpointWeightB[i];
+        record.setpointWeightC = setpointWeightC[i];
+        record.filterN = filterN[i];
+        record.dTerm = dTerm[i];
+        record.lastSetpoint = lastSetpoint[i];
+        memset(record.padding, 0, sizeof(record.padding));
+    }
+
+    return PIDCheckpointSize(count);
+}
+
+bool PIDBank::
+CheckpointRead(const void *buffer, size_t size)
+{
+    const PIDCheckpointRecord *records;
+    size_t count;
+
+    if(!PIDCheckpointHeaderCheck(buffer, size, count))
+    {
+        return false;
+    }
+
+    records = (const PIDCheckpointRecord *)((const char *)buffer + sizeof(PIDCheckpointHeader));
+
+    // Check everything before touching the bank
+    for(size_t i = 0; i < count; i++)
+    {
+        if(!PIDCheckpointRecordValid(records[i]))
+        {
+            return false;
+        }
+    }
+
+    input.resize(count);
+    lastInput.resize(count);
+    output.resize(count);
+    dispKp.resize(count);
+    dispKi.resize(count);
+    dispKd.resize(count);
+    alteredKp.resize(count);
+    alteredKi.resize(count);
+    alteredKd.resize(count);
+    iTerm.resize(count);
+    sampleTime.resize(count);
+    outMin.resize(count);
+    outMax.resize(count);
+    setpoint.resize(count);
+    controllerDirection.resize(count);
+    mode.resize(count);
+    deadband.resize(count);
+    lastSetpoint.resize(count);
+    outputChanged.assign(count, 0);
+    forceCompute.assign(count, 1);
+    antiWindup.resize(count);
+    dispKt.resize(count);
+    alteredKt.resize(count);
+    setpointWeightB.resize(count);
+    setpointWeightC.resize(count);
+    filterN.resize(count);
+    filterAlpha.resize(count);
+    filterKd.resize(count);
+    dTerm.resize(count);
+    weighted.resize(count);
+    active.resize(count);
+    activeCount = 0;
+    windupCount = 0;
+    weightedCount = 0;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        const PIDCheckpointRecord &record = records[i];
+
+        input[i] = record.input;
+        lastInput[i] = record.lastInput;
+        output[i] = record.output;
+        iTerm[i] = record.iTerm;
+        setpoint[i] = record.setpoint;
+        dispKp[i] = record.dispKp;
+        dispKi[i] = record.dispKi;
+        dispKd[i] = record.dispKd;
+        alteredKp[i] = record.alteredKp;
+        alteredKi[i] = record.alteredKi;
+        alteredKd[i] = record.alteredKd;
+        sampleTime[i] = record.sampleTime;
+        outMin[i] = record.outMin;
+        outMax[i] = record.outMax;
+        deadband[i] = record.deadband;
+        mode[i] = (PIDMode)record.mode;
+        controllerDirection[i] = (PIDDirection)record.controllerDirection;
+        antiWindup[i] = (PIDAntiWindup)record.antiWindup;
+        dispKt[i] = record.dispKt;
+        setpointWeightB[i] = record.setpointWeightB;
+        setpointWeightC[i] = record.setpointWeightC;
+        filterN[i] = record.filterN;
+        dTerm[i] = record.dTerm;
+        lastSetpoint[i] = record.lastSetpoint;
+
+        // The coefficients worked out from the settings are altered for the
+        // restored gains and sample time, and the weighted law is chosen as
+        // PIDWeightedUpdate does
+        alteredKt[i] = dispKt[i] * sampleTime[i];
+        PIDCoreFilter(alteredKd[i], filterN[i], sampleTime[i], &filterAlpha[i],
+                      &filterKd[i]);
+        weighted[i] = (setpointWeightB[i] != 1.0f || setpointWeightC[i] != 0.0f ||
+                       filterN[i] > 0.0f) ? ~0u : 0u;
+        windupCount += (antiWindup[i] != CLAMPING);
+        weightedCount += (weighted[i] != 0);
+    }
+
+    return true;
+}
+
+void PIDBank::
+StatsRead(PIDStats &stats) const
+{
+#ifdef PID_INSTRUMENTATION
+    this->stats.Read(stats);
+#else
+    stats.Reset();
+#endif
+}
+
+void PIDBank::
+StatsReset()
+{
+#ifdef PID_INSTRUMENTATION
+    stats.Reset();
+#endif
+}
+
+bool PIDBank::
+PIDCompute(size_t index)
+{
+    if(mode[index] == MANUAL)
+    {
+        return false;
+    }
+
+    // In deadband mode, leave the controller at rest while nothing moves
+    if(deadband[index] >= 0.0f && !forceCompute[index] && PIDAtRest(index))
+    {
+        outputChanged[index] = 0;
+        return true;
+    }
+
+    if(weighted[index])
+    {
+        PIDCoreUpdateWeighted(input[index], setpoint[index], &iTerm[index],
+                              &lastInput[index], &lastSetpoint[index], &dTerm[index],
+                              &output[index], alteredKp[index], alteredKi[index],
+                              alteredKt[index], setpointWeightB[index],
+                              setpointWeightC[index], filterAlpha[index],
+                              filterKd[index], outMin[index], outMax[index],
+                              antiWindup[index]);
+    }
+    else
+    {
+        PIDCoreUpdate(input[index], setpoint[index], &iTerm[index], &lastInput[index],
+                      &output[index], alteredKp[index], alteredKi[index],
+                      alteredKd[index], alteredKt[index], outMin[index], outMax[index],
+                      antiWindup[index]);
+    }
+
+    // Remember what the output was computed from for deadband mode
+    lastSetpoint[index] = setpoint[index];
+    outputChanged[index] = 1;
+    forceCompute[index] = 0;
+
+    return true;
+}
+
+void PIDBank::
+PIDModeSet(size_t index, PIDMode mode)
+{
+    // If the mode changed from MANUAL to AUTOMATIC
+    if(this->mode[index] != mode && mode == AUTOMATIC)
+    {
+        // Initialize a few PID parameters to new values
+        iTerm[index] = output[index];
+        lastInput[index] = input[index];
+        lastSetpoint[index] = setpoint[index];
+        dTerm[index] = 0.0f;
+
+        // Constrain the integrator to make sure it does not exceed output bounds
+        iTerm[index] = PIDCoreConstrain(iTerm[index], outMin[index], outMax[index]);
+        forceCompute[index] = 1;
+    }
+
+    this->mode[index] = mode;
+}
+
+void PIDBank::
+PIDOutputLimitsSet(size_t index, float min, float max)
+{
+    // Check if the parameters are valid
+    if(min >= max)
+    {
+        return;
+    }
+
+    // Save the parameters
+    outMin[index] = min;
+    outMax[index] = max;
+    forceCompute[index] = 1;
+
+    // If in automatic, apply the new constraints
+    if(mode[index] == AUTOMATIC)
+    {
+        output[index] = PIDCoreConstrain(output[index], min, max);
+        iTerm[index]  = PIDCoreConstrain(iTerm[index],  min, max);
+    }
+}
+
+void PIDBank::
+PIDTuningsSet(size_t index, float kp, float ki, float kd)
+{
+    // Check if the parameters are valid
+    if(kp < 0.0f || ki < 0.0f || kd < 0.0f)
+    {
+        return;
+    }
+
+    // Save the parameters for displaying purposes
+    dispKp[index] = kp;
+    dispKi[index] = ki;
+    dispKd[index] = kd;
+
+    // Alter the parameters for PID, reversed if necessary
+    PIDCoreGains(kp, ki, kd, sampleTime[index], controllerDirection[index] == REVERSE,
+                 &alteredKp[index], &alteredKi[index], &alteredKd[index]);
+    PIDCoreFilter(alteredKd[index], filterN[index], sampleTime[index],
+                  &filterAlpha[index], &filterKd[index]);
+    forceCompute[index] = 1;
+}
+
+void PIDBank::
+PIDTuningKpSet(size_t index, float kp)
+{
+    PIDTuningsSet(index, kp, dispKi[index], dispKd[index]);
+}
+
+void PIDBank::
+PIDTuningKiSet(size_t index, float ki)
+{
+    PIDTuningsSet(index, dispKp[index], ki, dispKd[index]);
+}
+
+void PIDBank::
+PIDTuningKdSet(size_t index, float kd)
+{
+    PIDTuningsSet(index, dispKp[index], dispKi[index], kd);
+}
+
+void PIDBank::
+PIDControllerDirectionSet(size_t index, PIDDirection controllerDirection)
+{
+    // If in automatic mode and the controller's sense of direction is reversed
+    if(mode[index] == AUTOMATIC && controllerDirection == REVERSE)
+    {
+        // Reverse sense of direction of PID gain constants
+        PIDCoreGainsReverse(&alteredKp[index], &alteredKi[index], &alteredKd[index]);
+        filterKd[index] = -filterKd[index];
+    }
+
+    this->controllerDirection[index] = controllerDirection;
+    forceCompute[index] = 1;
+}
+
+void PIDBank::
+PIDSampleTimeSet(size_t index, float sampleTimeSeconds)
+{
+    float ratio;
+
+    if(sampleTimeSeconds > 0.0f)
+    {
+        // Find the ratio of change and apply to the altered values
+        ratio = sampleTimeSeconds / sampleTime[index];
+        PIDCoreSampleTimeScale(ratio, &alteredKi[index], &alteredKd[index]);
+        alteredKt[index] *= ratio;
+
+        // Save the new sampling time
+        sampleTime[index] = sampleTimeSeconds;
+        PIDCoreFilter(alteredKd[index], filterN[index], sampleTimeSeconds,
+                      &filterAlpha[index], &filterKd[index]);
+        forceCompute[index] = 1;
+    }
+}
+
+void PIDBank::
+PIDDeadbandSet(size_t index, float deadband)
+{
+    this->deadband[index] = deadband;
+    forceCompute[index] = 1;
+}
+
+void PIDBank::
+PIDAntiWindupSet(size_t index, PIDAntiWindup antiWindup, float kt)
+{
+    // Check if the parameters are valid
+    if(kt < 0.0f)
+    {
+        return;
+    }
+
+    windupCount += (antiWindup != CLAMPING);
+    windupCount -= (this->antiWindup[index] != CLAMPING);
+
+    this->antiWindup[index] = antiWindup;
+    dispKt[index] = kt;
+    alteredKt[index] = kt * sampleTime[index];
+    forceCompute[index] = 1;
+}
+
+void PIDBank::
+PIDSetpointWeightsSet(size_t index, float b, float c)
+{
+    // Check if the parameters are valid
+    if(b < 0.0f || c < 0.0f)
+    {
+        return;
+    }
+
+    setpointWeightB[index] = b;
+    setpointWeightC[index] = c;
+    PIDWeightedUpdate(index);
+}
+
+void PIDBank::
+PIDDerivativeFilterSet(size_t index, float n)
+{
+    // Check if the parameters are valid
+    if(n < 0.0f)
+    {
+        return;
+    }
+
+    filterN[index] = n;
+    PIDCoreFilter(alteredKd[index], n, sampleTime[index], &filterAlpha[index],
+                  &filterKd[index]);
+    PIDWeightedUpdate(index);
+}
+
+//*********************************************************************************
+// Private Class Functions
+//*********************************************************************************
+
+bool PIDBank::
+PIDAtRest(size_t index) const
+{
+    // A negative deadband, like a NaN, wakes the controller up
+    bool twoDegree = weighted[index] != 0;
+
+    return PIDCoreAtRest(input[index], lastInput[index], setpoint[index],
+                         lastSetpoint[index], iTerm[index], output[index],
+                         alteredKp[index], alteredKi[index],
+                         twoDegree ? setpointWeightB[index] : 1.0f,
+                         twoDegree ? filterAlpha[index] * dTerm[index] : 0.0f,
+                         outMin[index], outMax[index], deadband[index]);
+}
+
+void PIDBank::
+PIDWeightedUpdate(size_t index)
+{
+    bool twoDegree = (setpointWeightB[index] != 1.0f || setpointWeightC[index] != 0.0f ||
+                      filterN[index] > 0.0f);
+
+    // The plain law does not keep the weighted law's state up to date
+    if(twoDegree && !weighted[index])
+    {
+        lastSetpoint[index] = setpoint[index];
+        dTerm[index] = 0.0f;
+    }
+
+    weightedCount += twoDegree;
+    weightedCount -= (weighted[index] != 0);
+    weighted[index] = twoDegree ? ~0u : 0u;
+    forceCompute[index] = 1;
+}
+
+void PIDBank::
+ComputeGathered(const uint32_t *indices, size_t n)
+{
+    alignas(PID_CACHE_LINE_SIZE) float packedInput[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedSetpoint[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedOutput[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedLastInput[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedITerm[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedKp[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedKi[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedKd[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedMin[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedMax[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) PIDMode packedMode[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedKt[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) PIDAntiWindup packedAntiWindup[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedWeightB[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedWeightC[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedAlpha[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedFilterKd[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) uint32_t packedWeighted[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedDTerm[PID_BANK_CHUNK];
+    alignas(PID_CACHE_LINE_SIZE) float packedLastSetpoint[PID_BANK_CHUNK];
+    PIDBankArrays arrays;
+
+    for(size_t k = 0; k < n; k++)
+    {
+        size_t i = indices[k];
+
+        packedInput[k] = input[i];
+        packedSetpoint[k] = setpoint[i];
+        packedOutput[k] = output[i];
+        packedLastInput[k] = lastInput[i];
+        packedITerm[k] = iTerm[i];
+        packedKp[k] = alteredKp[i];
+        packedKi[k] = alteredKi[i];
+        packedKd[k] = alteredKd[i];
+        packedMin[k] = outMin[i];
+        packedMax[k] = outMax[i];
+        packedMode[k] = mode[i];
+    }
+
+    // The anti-windup arrays are only needed when some controller uses them
+    for(size_t k = 0; k < n && windupCount; k++)
+    {
+        size_t i = indices[k];
+
+        packedKt[k] = alteredKt[i];
+        packedAntiWindup[k] = antiWindup[i];
+    }
+
+    // And so are the weighted law's
+    for(size_t k = 0; k < n && weightedCount; k++)
+    {
+        size_t i = indices[k];
+
+        packedWeightB[k] = setpointWeightB[i];
+        packedWeightC[k] = setpointWeightC[i];
+        packedAlpha[k] = filterAlpha[i];
+        packedFilterKd[k] = filterKd[i];
+        packedWeighted[k] = weighted[i];
+        packedDTerm[k] = dTerm[i];
+        packedLastSetpoint[k] = lastSetpoint[i];
+    }
+
+    arrays.input = packedInput;
+    arrays.setpoint = packedSetpoint;
+    arrays.output = packedOutput;
+    arrays.lastInput = packedLastInput;
+    arrays.iTerm = packedITerm;
+    arrays.alteredKp = packedKp;
+    arrays.alteredKi = packedKi;
+    arrays.alteredKd = packedKd;
+    arrays.outMin = packedMin;
+    arrays.outMax = packedMax;
+    arrays.mode = packedMode;
+    arrays.alteredKt = packedKt;
+    arrays.antiWindup = windupCount ? packedAntiWindup : nullptr;
+    arrays.setpointWeightB = packedWeightB;
+    arrays.setpointWeightC = packedWeightC;
+    arrays.filterAlpha = packedAlpha;
+    arrays.filterKd = packedFilterKd;
+    arrays.weighted = weightedCount ? packedWeighted : nullptr;
+    arrays.dTerm = packedDTerm;
+    arrays.lastSetpoint = packedLastSetpoint;
+
+    PIDBankKernelRun(arrays, 0, n);
+
+    for(size_t k = 0; k < n; k++)
+    {
+        size_t i = indices[k];
+
+        output[i] = packedOutput[k];
+        lastInput[i] = packedLastInput[k];
+        iTerm[i] = packedITerm[k];
+    }
+
+    for(size_t k = 0; k < n && weightedCount; k++)
+    {
+        size_t i = indices[k];
+
+        dTerm[i] = packedDTerm[k];
+        lastSetpoint[i] = packedLastSetpoint[k];
+    }
+}
+
+#ifdef PID_INSTRUMENTATION
+void PIDBank::
+StatsRecord(uint64_t start, size_t first, size_t last)
+{
+    uint64_t end = PIDStatsNow();
+    uint64_t computes = 0, saturated = 0, clamped = 0;
+
+    // The kernels only leave the clamped values behind, so a controller at a
+    // limit is counted as clamped
+    for(size_t i = first; i < last; i++)
+    {
+        uint64_t active = (mode[i] == AUTOMATIC);
+
+        computes += active;
+        saturated += active & (output[i] <= outMin[i] || output[i] >= outMax[i]);
+        clamped += active & (iTerm[i] <= outMin[i] || iTerm[i] >= outMax[i]);
+    }
+
+    stats.Record(start, end, computes, saturated, clamped);
+}
+
+void PIDBank::
+StatsRecordActive(uint64_t start, const uint32_t *indices, size_t n)
+{
+    uint64_t end = PIDStatsNow();
+    uint64_t saturated = 0, clamped = 0;
+
+    for(size_t k = 0; k < n; k++)
+    {
+        size_t i = indices[k];
+
+        saturated += (output[i] <= outMin[i] || output[i] >= outMax[i]);
+        clamped += (iTerm[i] <= outMin[i] || iTerm[i] >= outMax[i]);
+    }
+
+    stats.Record(start, end, n, saturated, clamped);
+}
+#endif
@@ -0,0 +1,583 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: A bank of PID controllers stored as a structure of arrays. Each
+// controller field lives in its own contiguous array so that a whole bank can
+// be stepped in a single branch free pass instead of one PIDControl object at
+// a time.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_BANK_H
+#define PID_BANK_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "pid_controller.h"
+#include "pid_aligned_allocator.h"
+#include "pid_instrumentation.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Arrays outside of the bank, such as a shared memory process image, that a
+// bound bank reads its inputs and setpoints from and writes its outputs to.
+// Element i is found at (char *)base + i * stride. A null base leaves the
+// bank's own array in use and a stride of 0 means the elements are packed.
+//
+struct
+PIDBankBinding
+{
+    const float *input;
+    size_t inputStride;
+    const float *setpoint;
+    size_t setpointStride;
+    float *output;
+    size_t outputStride;
+};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class PIDBankView;
+
+class
+PIDBank
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates an empty bank of PID controllers.
+        // Parameters:
+        //      capacity - Number of controllers to reserve storage for up front.
+        // Returns:
+        //      Nothing.
+        //
+        explicit PIDBank(size_t capacity = 0);
+
+        //
+        // PID Add
+        // Description:
+        //      Appends a new controller to the bank. The controller is initialized
+        //      exactly as the PIDControl constructor would initialize it.
+        // Parameters:
+        //      Same as the PIDControl constructor.
+        // Returns:
+        //      The index of the new controller within the bank.
+        //
+        size_t PIDAdd(float kp, float ki, float kd, float sampleTimeSeconds,
+                      float minOutput, float maxOutput, PIDMode mode,
+                      PIDDirection controllerDirection);
+
+        //
+        // PID Remove
+        // Description:
+        //      Removes a controller from the bank in constant time by moving
+        //      the last controller of the bank into its place, so the bank
+        //      stays dense. The external arrays of a bound bank are left to the
+        //      caller, who moves their last element the same way. The active
+        //      set of ComputeActive is cleared.
+        // Parameters:
+        //      index - Index of the controller to remove.
+        // Returns:
+        //      The former index of the controller now at index. This is the
+        //      new Size(), and equals index when the last controller was the
+        //      one removed.
+        //
+        size_t PIDRemove(size_t index);
+
+        //
+        // Compute All
+        // Description:
+        //      Runs PIDCompute on every controller in the bank in one pass. The
+        //      math is identical to PIDControl::PIDCompute. Controllers in MANUAL
+        //      are masked out instead of branched around, so their state is left
+        //      untouched.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      Nothing.
+        //
+        void ComputeAll();
+
+        //
+        // Compute Range
+        // Description:
+        //      Same as ComputeAll but only for the controllers in [first, last).
+        // Parameters:
+        //      first - Index of the first controller to compute.
+        //      last - One past the index of the last controller to compute.
+        // Returns:
+        //      Nothing.
+        //
+        void ComputeRange(size_t first, size_t last);
+
+        //
+        // Compute Indices
+        // Description:
+        //      Same as ComputeAll but only for the n controllers listed in
+        //      indices, which need not be contiguous. They are gathered into
+        //      scratch arrays a chunk at a time, run through the kernel and
+        //      scattered back. Disjoint lists may be computed from different
+        //      threads at the same time. The bank's binding is not used.
+        // Parameters:
+        //      indices - The controllers to compute, each at most once.
+        //      n - Number of indices.
+        // Returns:
+        //      Nothing.
+        //
+        void ComputeIndices(const uint32_t *indices, size_t n);
+
+        //
+        // Compute Active
+        // Description:
+        //      Same as ComputeAll, but honours each controller's deadband the
+        //      way PIDCompute does. A first pass collects the controllers that
+        //      are awake, the ones in AUTOMATIC that PIDCompute would not leave
+        //      at rest, into a compact active set index. The kernels then only
+        //      update those: a chunk with few awake controllers is gathered
+        //      into scratch arrays and scattered back, a busier chunk is run in
+        //      place with the resting controllers masked out. ComputeAll and
+        //      ComputeRange ignore the deadband.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of controllers that were updated.
+        //
+        size_t ComputeActive();
+
+        //
+        // Compute Active Range
+        // Description:
+        //      Same as ComputeActive but only for the controllers in
+        //      [first, last). Disjoint ranges may be computed from different
+        //      threads at the same time.
+        // Parameters:
+        //      first - Index of the first controller to compute.
+        //      last - One past the index of the last controller to compute.
+        // Returns:
+        //      The number of controllers that were updated. Their indices are
+        //      at ActiveData() + first.
+        //
+        size_t ComputeActiveRange(size_t first, size_t last);
+
+        //
+        // Active Data and Count
+        // Description:
+        //      The active set of the last ComputeActive: the indices of the
+        //      controllers it updated, in increasing order.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      A pointer to the first index, and the number of indices.
+        //
+        inline const uint32_t *ActiveData() const { return active.data(); }
+        inline size_t ActiveCount() const { return activeCount; }
+
+        //
+        // Bind
+        // Description:
+        //      Binds the bank to external input, setpoint and output arrays.
+        //      ComputeAll and ComputeRange then read and write those arrays as
+        //      part of the compute pass, a cache sized chunk at a time, so the
+        //      caller no longer copies values in and out of the bank. Outputs of
+        //      controllers in MANUAL are not written, so the external value is
+        //      left to the user. The arrays must hold at least Size() elements.
+        // Parameters:
+        //      binding - The external arrays.
+        // Returns:
+        //      Nothing.
+        //
+        void Bind(const PIDBankBinding &binding);
+
+        //
+        // Unbind
+        // Description:
+        //      Goes back to computing from the bank's own arrays only.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      Nothing.
+        //
+        void Unbind();
+
+        //
+        // Checkpoint Size, Write and Read
+        // Description:
+        //      Save and restore the whole bank in the checkpoint format of
+        //      pid_checkpoint.h, which PIDControl and the C library share.
+        //      CheckpointRead replaces the controllers of the bank with those
+        //      of the checkpoint in one pass per array, and each controller
+        //      carries on exactly as PIDCheckpointRestore describes. An
+        //      executor must not be attached while the bank is read into.
+        // Parameters:
+        //      buffer - The checkpoint, such as a memory mapped file. It must
+        //          be aligned to 4 bytes.
+        //      size - Size of the buffer in bytes.
+        // Returns:
+        //      CheckpointSize returns the bytes a checkpoint of the bank takes.
+        //      CheckpointWrite returns the bytes written, or 0 if the buffer is
+        //      too small. CheckpointRead returns false, leaving the bank
+        //      untouched, if the checkpoint is truncated, has the wrong magic
+        //      number, an unknown version, a record size that does not match
+        //      its version, or holds an invalid record.
+        //
+        size_t CheckpointSize() const;
+        size_t CheckpointWrite(void *buffer, size_t size) const;
+        bool CheckpointRead(const void *buffer, size_t size);
+
+        //
+        // View
+        // Description:
+        //      Returns a handle to a single controller in the bank that exposes
+        //      the same interface as PIDControl. The handle refers to index, so
+        //      it follows the controller PIDRemove moves there.
+        // Parameters:
+        //      index - Index of the controller within the bank.
+        // Returns:
+        //      A PIDBankView for the controller.
+        //
+        PIDBankView View(size_t index);
+        PIDBankView operator[](size_t index);
+
+        //
+        // Size
+        // Description:
+        //      Returns the number of controllers in the bank.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of controllers.
+        //
+        inline size_t Size() const { return input.size(); }
+
+        //
+        // Memory Bytes
+        // Description:
+        //      Returns the memory the bank's arrays have allocated, including
+        //      the space reserved for controllers not yet added.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of bytes.
+        //
+        size_t MemoryBytes() const;
+
+        //
+        // Stats Read
+        // Description:
+        //      Returns the counters recorded for the bank when it is built with
+        //      PID_INSTRUMENTATION: one call per ComputeAll or ComputeRange,
+        //      the number of controllers updated, and how many of those were
+        //      left with their output or integrator at outMin or outMax. The
+        //      counters of every thread that computed the bank are added up,
+        //      so a bank run by a PIDBankExecutor reports the whole bank.
+        //      Without PID_INSTRUMENTATION every counter reads 0.
+        // Parameters:
+        //      stats - Receives the counters.
+        // Returns:
+        //      Nothing.
+        //
+        void StatsRead(PIDStats &stats) const;
+
+        //
+        // Stats Reset
+        // Description:
+        //      Zeroes the counters of every thread.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      Nothing.
+        //
+        void StatsReset();
+
+        //
+        // Per Controller Functions
+        // Description:
+        //      These behave exactly like the PIDControl member functions of the
+        //      same name, applied to the controller at index.
+        //
+        bool PIDCompute(size_t index);
+        void PIDModeSet(size_t index, PIDMode mode);
+        void PIDOutputLimitsSet(size_t index, float min, float max);
+        void PIDTuningsSet(size_t index, float kp, float ki, float kd);
+        void PIDTuningKpSet(size_t index, float kp);
+        void PIDTuningKiSet(size_t index, float ki);
+        void PIDTuningKdSet(size_t index, float kd);
+        void PIDControllerDirectionSet(size_t index,
+                                       PIDDirection controllerDirection);
+        void PIDSampleTimeSet(size_t index, float sampleTimeSeconds);
+        void PIDDeadbandSet(size_t index, float deadband);
+        void PIDAntiWindupSet(size_t index, PIDAntiWindup antiWindup, float kt);
+        void PIDSetpointWeightsSet(size_t index, float b, float c);
+        void PIDDerivativeFilterSet(size_t index, float n);
+
+        inline void PIDScheduledGainsSet(size_t index, float kp, float ki, float kd)
+        {
+            forceCompute[index] |= (kp != alteredKp[index] || ki != alteredKi[index] ||
+                                    kd != alteredKd[index]) ? 1 : 0;
+            alteredKp[index] = kp;
+            alteredKi[index] = ki;
+            alteredKd[index] = kd;
+            filterKd[index] = kd * (1.0f - filterAlpha[index]);
+        }
+
+        inline void PIDSetpointSet(size_t index, float value) { setpoint[index] = value; }
+        inline void PIDInputSet(size_t index, float value) { input[index] = value; }
+        inline float PIDOutputGet(size_t index) const { return output[index]; }
+        inline float PIDInputGet(size_t index) const { return input[index]; }
+        inline float PIDSetpointGet(size_t index) const { return setpoint[index]; }
+        inline float PIDIntegralGet(size_t index) const { return iTerm[index]; }
+        inline float PIDKpGet(size_t index) const { return dispKp[index]; }
+        inline float PIDKiGet(size_t index) const { return dispKi[index]; }
+        inline float PIDKdGet(size_t index) const { return dispKd[index]; }
+        inline float PIDSampleTimeGet(size_t index) const { return sampleTime[index]; }
+        inline PIDMode PIDModeGet(size_t index) const { return mode[index]; }
+        inline PIDDirection PIDDirectionGet(size_t index) const
+        {
+            return controllerDirection[index];
+        }
+        inline bool PIDOutputChangedGet(size_t index) const { return outputChanged[index] != 0; }
+        inline PIDAntiWindup PIDAntiWindupGet(size_t index) const { return antiWindup[index]; }
+        inline float PIDKtGet(size_t index) const { return dispKt[index]; }
+        inline float PIDSetpointWeightBGet(size_t index) const
+        {
+            return setpointWeightB[index];
+        }
+        inline float PIDSetpointWeightCGet(size_t index) const
+        {
+            return setpointWeightC[index];
+        }
+        inline float PIDDerivativeFilterGet(size_t index) const { return filterN[index]; }
+
+        //
+        // Array Access
+        // Description:
+        //      Direct access to the contiguous input, setpoint and output arrays
+        //      so that callers can fill and drain a whole bank without going
+        //      through the per controller functions.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      A pointer to the first element of the array.
+        //
+        inline float *InputData() { return input.data(); }
+        inline float *SetpointData() { return setpoint.data(); }
+        inline const float *OutputData() const { return output.data(); }
+
+    private:
+        //
+        // Mirrors the arrays to and from GPU memory
+        //
+        friend class PIDBankDevice;
+
+        //
+        // One array per PIDControl field. See pid_controller.h for the
+        // meaning of each field. Every array starts on a cache line.
+        //
+        typedef std::vector<float, PIDAlignedAllocator<float> > FloatArray;
+
+        FloatArray input;
+        FloatArray lastInput;
+        FloatArray output;
+        FloatArray dispKp;
+        FloatArray dispKi;
+        FloatArray dispKd;
+        FloatArray alteredKp;
+        FloatArray alteredKi;
+        FloatArray alteredKd;
+        FloatArray iTerm;
+        FloatArray sampleTime;
+        FloatArray outMin;
+        FloatArray outMax;
+        FloatArray setpoint;
+        std::vector<PIDDirection, PIDAlignedAllocator<PIDDirection> > controllerDirection;
+        std::vector<PIDMode, PIDAlignedAllocator<PIDMode> > mode;
+        FloatArray deadband;
+        FloatArray lastSetpoint;
+        std::vector<uint8_t, PIDAlignedAllocator<uint8_t> > outputChanged;
+        std::vector<uint8_t, PIDAlignedAllocator<uint8_t> > forceCompute;
+        std::vector<PIDAntiWindup, PIDAlignedAllocator<PIDAntiWindup> > antiWindup;
+        FloatArray dispKt;
+        FloatArray alteredKt;
+        FloatArray setpointWeightB;
+        FloatArray setpointWeightC;
+        FloatArray filterN;
+        FloatArray filterAlpha;
+        FloatArray filterKd;
+        FloatArray dTerm;
+
+        //
+        // All ones for the controllers on the weighted law, as the kernels
+        // take it
+        //
+        std::vector<uint32_t, PIDAlignedAllocator<uint32_t> > weighted;
+
+        //
+        // Number of controllers that do not use CLAMPING. While it is 0 the
+        // compute passes run the kernels without the other strategies.
+        //
+        size_t windupCount;
+
+        //
+        // Number of controllers on the weighted law. While it is 0 the
+        // compute passes run the kernels without it.
+        //
+        size_t weightedCount;
+
+        //
+        // Active set filled in by ComputeActive, and its size
+        //
+        std::vector<uint32_t, PIDAlignedAllocator<uint32_t> > active;
+        size_t activeCount;
+
+        //
+        // External arrays set by Bind
+        //
+        PIDBankBinding binding;
+        bool bound;
+
+        //
+        // Tells whether a controller in deadband mode can be left at rest
+        //
+        bool PIDAtRest(size_t index) const;
+
+        //
+        // Works out whether a controller leaves the plain update law, and
+        // starts the weighted law's own state over when it is turned on
+        //
+        void PIDWeightedUpdate(size_t index);
+
+        //
+        // Runs the kernel over the n controllers listed in indices, at most
+        // one chunk, through packed scratch copies of their state. Lanes in
+        // MANUAL keep their state.
+        //
+        void ComputeGathered(const uint32_t *indices, size_t n);
+
+#ifdef PID_INSTRUMENTATION
+        //
+        // Counts the controllers of [first, last) left at a limit by a
+        // compute pass and records the pass
+        //
+        void StatsRecord(uint64_t start, size_t first, size_t last);
+        void StatsRecordActive(uint64_t start, const uint32_t *indices, size_t n);
+
+        PIDStatsCollector stats;
+#endif
+};
+
+//
+// A handle to a single controller inside a PIDBank. It has the same interface
+// as PIDControl so existing per object code can be pointed at a bank.
+//
+class
+PIDBankView
+{
+    public:
+        PIDBankView(PIDBank *bank, size_t index) : bank(bank), index(index) {}
+
+        inline bool PIDCompute() { return bank->PIDCompute(index); }
+        inline void PIDModeSet(PIDMode mode) { bank->PIDModeSet(index, mode); }
+        inline void PIDOutputLimitsSet(float min, float max)
+        {
+            bank->PIDOutputLimitsSet(index, min, max);
+        }
+        inline void PIDTuningsSet(float kp, float ki, float kd)
+        {
+            bank->PIDTuningsSet(index, kp, ki, kd);
+        }
+        inline void PIDTuningKpSet(float kp) { bank->PIDTuningKpSet(index, kp); }
+        inline void PIDTuningKiSet(float ki) { bank->PIDTuningKiSet(index, ki); }
+        inline void PIDTuningKdSet(float kd) { bank->PIDTuningKdSet(index, kd); }
+        inline void PIDControllerDirectionSet(PIDDirection controllerDirection)
+        {
+            bank->PIDControllerDirectionSet(index, controllerDirection);
+        }
+        inline void PIDSampleTimeSet(float sampleTimeSeconds)
+        {
+            bank->PIDSampleTimeSet(index, sampleTimeSeconds);
+        }
+        inline void PIDDeadbandSet(float deadband) { bank->PIDDeadbandSet(index, deadband); }
+        inline void PIDAntiWindupSet(PIDAntiWindup antiWindup, float kt)
+        {
+            bank->PIDAntiWindupSet(index, antiWindup, kt);
+        }
+        inline void PIDSetpointWeightsSet(float b, float c)
+        {
+            bank->PIDSetpointWeightsSet(index, b, c);
+        }
+        inline void PIDDerivativeFilterSet(float n) { bank->PIDDerivativeFilterSet(index, n); }
+        inline void PIDScheduledGainsSet(float kp, float ki, float kd)
+        {
+            bank->PIDScheduledGainsSet(index, kp, ki, kd);
+        }
+        inline void PIDSetpointSet(float setpoint) { bank->PIDSetpointSet(index, setpoint); }
+        inline void PIDInputSet(float input) { bank->PIDInputSet(index, input); }
+        inline float PIDOutputGet() { return bank->PIDOutputGet(index); }
+        inline float PIDInputGet() { return bank->PIDInputGet(index); }
+        inline float PIDSetpointGet() { return bank->PIDSetpointGet(index); }
+        inline float PIDIntegralGet() { return bank->PIDIntegralGet(index); }
+        inline float PIDKpGet() { return bank->PIDKpGet(index); }
+        inline float PIDKiGet() { return bank->PIDKiGet(index); }
+        inline float PIDKdGet() { return bank->PIDKdGet(index); }
+        inline PIDMode PIDModeGet() { return bank->PIDModeGet(index); }
+        inline PIDDirection PIDDirectionGet() { return bank->PIDDirectionGet(index); }
+        inline bool PIDOutputChangedGet() { return bank->PIDOutputChangedGet(index); }
+        inline PIDAntiWindup PIDAntiWindupGet() { return bank->PIDAntiWindupGet(index); }
+        inline float PIDKtGet() { return bank->PIDKtGet(index); }
+        inline float PIDSetpointWeightBGet() { return bank->PIDSetpointWeightBGet(index); }
+        inline float PIDSetpointWeightCGet() { return bank->PIDSetpointWeightCGet(index); }
+        inline float PIDDerivativeFilterGet() { return bank->PIDDerivativeFilterGet(index); }
+
+        //
+        // Index of the controller within its bank
+        //
+        inline size_t Index() const { return index; }
+
+    private:
+        PIDBank *bank;
+        size_t index;
+};
+
+inline PIDBankView PIDBank::View(size_t index) { return PIDBankView(this, index); }
+inline PIDBankView PIDBank::operator[](size_t index) { return PIDBankView(this, index); }
+
+#endif  // PID_BANK_H
@@ -0,0 +1,349 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: CUDA offload of a PIDBank. The compute state of the bank is kept
+// in GPU memory, and each launch runs the PIDCompute update law for a batch of
+// many ticks, so only the inputs and outputs of the batch cross the bus. Built
+// when the CMake option PID_CUDA is on.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <vector>
+#include <cuda_runtime.h>
+#include "pid_bank_cuda.h"
+#include "pid_core.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// GPU threads per block
+//
+#define PID_CUDA_BLOCK_SIZE     256
+
+//
+// Every array of the shared allocation starts on a multiple of this many
+// elements, which is 128 bytes
+//
+#define PID_CUDA_ARRAY_ALIGN    32
+
+//
+// Number of arrays in the shared allocation
+//
+#define PID_CUDA_ARRAY_COUNT    20
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// One thread per controller, looping over the ticks of the batch. Row t of
+// the inputs and outputs is read and written by consecutive threads, so the
+// accesses coalesce. The law is PIDCoreUpdate or PIDCoreUpdateWeighted, as in
+// PIDBank::ComputeRange, built with --fmad=false so that it rounds as the CPU
+// kernels do.
+//
+__global__ void
+PIDBankDeviceKernel(PIDBankDeviceArrays arrays, const float *inputs, float *outputs,
+                    size_t count, size_t ticks)
+{
+    size_t i = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    float input, setpoint, output, lastInput, iTerm, lastSetpoint, dTerm;
+    float kp, ki, kd, kt, outMin, outMax, b, c, alpha, kdFiltered;
+    int antiWindup;
+    bool weighted;
+
+    if(i >= count)
+    {
+        return;
+    }
+
+    // Controllers in MANUAL only take the inputs and hold their output
+    if(arrays.mode[i] != AUTOMATIC)
+    {
+        output = arrays.output[i];
+
+        for(size_t t = 0; t < ticks && outputs; t++)
+        {
+            outputs[t * count + i] = output;
+        }
+
+        arrays.input[i] = inputs[(ticks - 1) * count + i];
+        return;
+    }
+
+    setpoint = arrays.setpoint[i];
+    output = arrays.output[i];
+    lastInput = arrays.lastInput[i];
+    iTerm = arrays.iTerm[i];
+    kp = arrays.alteredKp[i];
+    ki = arrays.alteredKi[i];
+    kd = arrays.alteredKd[i];
+    kt = arrays.alteredKt[i];
+    antiWindup = arrays.antiWindup[i];
+    lastSetpoint = arrays.lastSetpoint[i];
+    dTerm = arrays.dTerm[i];
+    b = arrays.setpointWeightB[i];
+    c = arrays.setpointWeightC[i];
+    alpha = arrays.filterAlpha[i];
+    kdFiltered = arrays.filterKd[i];
+    weighted = (arrays.weighted[i] != 0);
+    outMin = arrays.outMin[i];
+    outMax = arrays.outMax[i];
+    input = lastInput;
+
+    for(size_t t = 0; t < ticks; t++)
+    {
+        input = inputs[t * count + i];
+
+        // The branch is the same on every tick of a thread
+        if(weighted)
+        {
+            PIDCoreUpdateWeighted(input, setpoint, &iTerm, &lastInput, &lastSetpoint, 
+                                  &dTerm, &output, kp, ki, kt, b, c, alpha, kdFiltered, 
+                                  outMin, outMax, antiWindup);
+        }
+        else
+        {
+            PIDCoreUpdate(input, setpoint, &iTerm, &lastInput, &output, kp, ki, kd, kt, 
+                          outMin, outMax, antiWindup);
+        }
+
+        if(outputs)
+        {
+            outputs[t * count + i] = output;
+        }
+    }
+
+    arrays.input[i] = input;
+    arrays.output[i] = output;
+    arrays.lastInput[i] = lastInput;
+    arrays.iTerm[i] = iTerm;
+    arrays.lastSetpoint[i] = lastSetpoint;
+    arrays.dTerm[i] = dTerm;
+}
+
+static bool
+CopyToDevice(void *device, const void *host, size_t bytes)
+{
+    return bytes == 0 || cudaMemcpy(device, host, bytes, cudaMemcpyHostToDevice) == cudaSuccess;
+}
+
+static bool
+CopyToHost(void *host, const void *device, size_t bytes)
+{
+    return bytes == 0 || cudaMemcpy(host, device, bytes, cudaMemcpyDeviceToHost) == cudaSuccess;
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDBankDevice::
+PIDBankDevice(PIDBank &bank) :
+    bank(bank),
+    count(bank.Size()),
+    valid(false),
+    block(nullptr),
+    device(),
+    inputRows(nullptr),
+    outputRows(nullptr),
+    rowCapacity(0)
+{
+    size_t stride = (count + PID_CUDA_ARRAY_ALIGN - 1) / PID_CUDA_ARRAY_ALIGN *
+                    PID_CUDA_ARRAY_ALIGN;
+    float *base;
+
+    // At least one element per array so an empty bank still allocates
+    stride = stride ? stride : PID_CUDA_ARRAY_ALIGN;
+
+    if(cudaMalloc(&block, PID_CUDA_ARRAY_COUNT * stride * sizeof(float)) != cudaSuccess)
+    {
+        block = nullptr;
+        return;
+    }
+
+    // int32_t and float are the same size, so mode, antiWindup and weighted
+    // take one stride too
+    base = (float *)block;
+    device.input = base + 0 * stride;
+    device.setpoint = base + 1 * stride;
+    device.output = base + 2 * stride;
+    device.lastInput = base + 3 * stride;
+    device.iTerm = base + 4 * stride;
+    device.alteredKp = base + 5 * stride;
+    device.alteredKi = base + 6 * stride;
+    device.alteredKd = base + 7 * stride;
+    device.outMin = base + 8 * stride;
+    device.outMax = base + 9 * stride;
+    device.mode = (int32_t *)(base + 10 * stride);
+    device.alteredKt = base + 11 * stride;
+    device.antiWindup = (int32_t *)(base + 12 * stride);
+    device.setpointWeightB = base + 13 * stride;
+    device.setpointWeightC = base + 14 * stride;
+    device.filterAlpha = base + 15 * stride;
+    device.filterKd = base + 16 * stride;
+    device.weighted = (uint32_t *)(base + 17 * stride);
+    device.dTerm = base + 18 * stride;
+    device.lastSetpoint = base + 19 * stride;
+
+    valid = Upload();
+}
+
+PIDBankDevice::
+~PIDBankDevice()
+{
+    cudaFree(inputRows);
+    cudaFree(outputRows);
+    cudaFree(block);
+}
+
+bool PIDBankDevice::
+Upload()
+{
+    size_t bytes = count * sizeof(float);
+    std::vector<int32_t> mode(count), antiWindup(count);
+
+    if(block == nullptr || bank.Size() != count)
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+        mode[i] = (int32_t)bank.mode[i];
+        antiWindup[i] = (int32_t)bank.antiWindup[i];
+    }
+
+    return CopyToDevice(device.input, bank.input.data(), bytes) &&
+           CopyToDevice(device.setpoint, bank.setpoint.data(), bytes) &&
+           CopyToDevice(device.output, bank.output.data(), bytes) &&
+           CopyToDevice(device.lastInput, bank.lastInput.data(), bytes) &&
+           CopyToDevice(device.iTerm, bank.iTerm.data(), bytes) &&
+           CopyToDevice(device.alteredKp, bank.alteredKp.data(), bytes) &&
+           CopyToDevice(device.alteredKi, bank.alteredKi.data(), bytes) &&
+           CopyToDevice(device.alteredKd, bank.alteredKd.data(), bytes) &&
+           CopyToDevice(device.outMin, bank.outMin.data(), bytes) &&
+           CopyToDevice(device.outMax, bank.outMax.data(), bytes) &&
+           CopyToDevice(device.mode, mode.data(), count * sizeof(int32_t)) &&
+           CopyToDevice(device.alteredKt, bank.alteredKt.data(), bytes) &&
+           CopyToDevice(device.antiWindup, antiWindup.data(), count * sizeof(int32_t)) &&
+           CopyToDevice(device.setpointWeightB, bank.setpointWeightB.data(), bytes) &&
+           CopyToDevice(device.setpointWeightC, bank.setpointWeightC.data(), bytes) &&
+           CopyToDevice(device.filterAlpha, bank.filterAlpha.data(), bytes) &&
+           CopyToDevice(device.filterKd, bank.filterKd.data(), bytes) &&
+           CopyToDevice(device.weighted, bank.weighted.data(), count * sizeof(uint32_t)) &&
+           CopyToDevice(device.dTerm, bank.dTerm.data(), bytes) &&
+           CopyToDevice(device.lastSetpoint, bank.lastSetpoint.data(), bytes);
+}
+
+bool PIDBankDevice::
+Download()
+{
+    size_t bytes = count * sizeof(float);
+
+    if(!valid || bank.Size() != count)
+    {
+        return false;
+    }
+
+    return CopyToHost(bank.input.data(), device.input, bytes) &&
+           CopyToHost(bank.output.data(), device.output, bytes) &&
+           CopyToHost(bank.lastInput.data(), device.lastInput, bytes) &&
+           CopyToHost(bank.iTerm.data(), device.iTerm, bytes) &&
+           CopyToHost(bank.dTerm.data(), device.dTerm, bytes) &&
+           CopyToHost(bank.lastSetpoint.data(), device.lastSetpoint, bytes);
+}
+
+bool PIDBankDevice::
+SetpointsUpload(const float *setpoints)
+{
+    return valid && CopyToDevice(device.setpoint, setpoints, count * sizeof(float));
+}
+
+bool PIDBankDevice::
+Run(const float *inputs, size_t ticks, float *outputs)
+{
+    size_t values = ticks * count;
+    unsigned blocks;
+
+    if(!valid)
+    {
+        return false;
+    }
+
+    if(values == 0)
+    {
+        return true;
+    }
+
+    // Grow the batch rows, keeping the larger allocation for later batches
+    if(values > rowCapacity)
+    {
+        cudaFree(inputRows);
+        cudaFree(outputRows);
+        inputRows = nullptr;
+        outputRows = nullptr;
+        rowCapacity = 0;
+
+        if(cudaMalloc((void **)&inputRows, values * sizeof(float)) != cudaSuccess ||
+           cudaMalloc((void **)&outputRows, values * sizeof(float)) != cudaSuccess)
+        {
+            return false;
+        }
+        rowCapacity = values;
+    }
+
+    if(!CopyToDevice(inputRows, inputs, values * sizeof(float)))
+    {
+        return false;
+    }
+
+    blocks = (unsigned)((count + PID_CUDA_BLOCK_SIZE - 1) / PID_CUDA_BLOCK_SIZE);
+    PIDBankDeviceKernel<<<blocks, PID_CUDA_BLOCK_SIZE>>>(device, inputRows,
+                                                         outputs ? outputRows : nullptr,
+                                                         count, ticks);
+
+    if(cudaGetLastError() != cudaSuccess)
+    {
+        return false;
+    }
+
+    // The copy back waits for the kernel
+    if(outputs)
+    {
+        return CopyToHost(outputs, outputRows, values * sizeof(float));
+    }
+
+    return cudaDeviceSynchronize() == cudaSuccess;
+}
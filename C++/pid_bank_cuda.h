@@ -0,0 +1,205 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: CUDA offload of a PIDBank. The compute state of the bank is kept
+// in GPU memory, and each launch runs the PIDCompute update law for a batch of
+// many ticks, so only the inputs and outputs of the batch cross the bus. Built
+// when the CMake option PID_CUDA is on.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_BANK_CUDA_H
+#define PID_BANK_CUDA_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include "pid_bank.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// The bank arrays in GPU memory. Element i of every array belongs to
+// controller i of the bank. Device kernels that model the plants can read and
+// write these directly between calls to Run.
+//
+struct
+PIDBankDeviceArrays
+{
+    float *input;
+    float *setpoint;
+    float *output;
+    float *lastInput;
+    float *iTerm;
+    float *alteredKp;
+    float *alteredKi;
+    float *alteredKd;
+    float *outMin;
+    float *outMax;
+    int32_t *mode;
+    float *alteredKt;
+    int32_t *antiWindup;
+    float *setpointWeightB;
+    float *setpointWeightC;
+    float *filterAlpha;
+    float *filterKd;
+    uint32_t *weighted;
+    float *dTerm;
+    float *lastSetpoint;
+};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class
+PIDBankDevice
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Allocates GPU memory for the controllers of a bank and uploads
+        //      them. The bank must not gain or lose controllers while the
+        //      device copy is in use.
+        // Parameters:
+        //      bank - The bank to mirror.
+        // Returns:
+        //      Nothing. Valid tells whether the allocation and upload worked.
+        //
+        explicit PIDBankDevice(PIDBank &bank);
+
+        //
+        // Destructor
+        // Description:
+        //      Frees the GPU memory. The bank keeps whatever was downloaded
+        //      last.
+        //
+        ~PIDBankDevice();
+
+        PIDBankDevice(const PIDBankDevice &) = delete;
+        PIDBankDevice &operator=(const PIDBankDevice &) = delete;
+
+        //
+        // Upload
+        // Description:
+        //      Copies the whole bank to the GPU, replacing the device state.
+        //      Needed after settings are changed on the host. The bank's own
+        //      arrays are used even if it is bound.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      True if the copy worked.
+        //
+        bool Upload();
+
+        //
+        // Download
+        // Description:
+        //      Copies the state Run changes (input, output, lastInput, iTerm
+        //      and the weighted law's dTerm and lastSetpoint) back into the
+        //      bank, so it carries on from the last tick run on the GPU.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      True if the copy worked.
+        //
+        bool Download();
+
+        //
+        // Setpoints Upload
+        // Description:
+        //      Replaces the setpoints of every controller on the GPU.
+        // Parameters:
+        //      setpoints - Size() setpoints in host memory.
+        // Returns:
+        //      True if the copy worked.
+        //
+        bool SetpointsUpload(const float *setpoints);
+
+        //
+        // Run
+        // Description:
+        //      Runs ticks ticks of ComputeAll on the GPU in one launch. Each
+        //      controller is one GPU thread that keeps its state in registers
+        //      across the ticks of the batch. The math is rounded exactly as
+        //      PIDBank::ComputeRange rounds it, with no fused multiply-add, so
+        //      the outputs match the CPU bit for bit. The deadband is ignored
+        //      as in ComputeRange and controllers in MANUAL keep their state.
+        // Parameters:
+        //      inputs - ticks rows of Size() inputs in host memory, row t
+        //          being the inputs of tick t.
+        //      ticks - Number of ticks to run.
+        //      outputs - ticks rows of Size() outputs in host memory that
+        //          receive the output of every tick, or null to only keep
+        //          the state on the GPU.
+        // Returns:
+        //      True if the launch and the copies worked.
+        //
+        bool Run(const float *inputs, size_t ticks, float *outputs);
+
+        //
+        // Device Arrays
+        // Description:
+        //      The GPU copies of the bank arrays, for plant models written as
+        //      device kernels that feed the inputs without a round trip.
+        //
+        inline const PIDBankDeviceArrays &DeviceArrays() const { return device; }
+
+        inline bool Valid() const { return valid; }
+        inline size_t Size() const { return count; }
+
+    private:
+        PIDBank &bank;
+        size_t count;
+        bool valid;
+
+        //
+        // All the arrays share one allocation, each starting on a 128 byte
+        // boundary for coalesced access
+        //
+        void *block;
+        PIDBankDeviceArrays device;
+
+        //
+        // Per batch input and output rows, grown as needed
+        //
+        float *inputRows;
+        float *outputRows;
+        size_t rowCapacity;
+};
+
+#endif  // PID_BANK_CUDA_H
@@ -0,0 +1,871 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Batched PIDCompute kernels for PIDBank. Explicit SSE2, AVX2,
+// AVX-512 and NEON versions of the update law are provided next to a scalar
+// fallback, and the widest one the CPU supports is picked at run time. Every
+// kernel gives bit identical results to PIDControl::PIDCompute.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <string.h>
+#include <atomic>
+#include "pid_bank_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define PID_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define PID_SIMD_ARM 1
+    #include <arm_neon.h>
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Lets a single function use a wider instruction set than the rest of the
+// build so that it can be picked at run time.
+//
+#if defined(__GNUC__) || defined(__clang__)
+    #define PID_TARGET(isa)    __attribute__((target(isa)))
+#else
+    #define PID_TARGET(isa)
+#endif
+
+//
+// Bit identical results rely on every multiply and add being rounded on its
+// own, exactly like the scalar PIDCompute. Keep the compiler from fusing them
+// into FMA instructions.
+//
+#if defined(__clang__)
+    #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+    #pragma GCC optimize ("fp-contract=off")
+#endif
+
+//
+// The kernels compare the mode and anti-windup arrays as 32 bit integers
+//
+static_assert(sizeof(PIDMode) == sizeof(int32_t), "PIDMode must be 32 bits wide");
+static_assert(sizeof(PIDAntiWindup) == sizeof(int32_t), "PIDAntiWindup must be 32 bits wide");
+
+typedef void (*PIDBankKernel)(const PIDBankArrays &arrays, size_t first, size_t last);
+
+//*********************************************************************************
+// Scalar Kernel
+//*********************************************************************************
+
+//
+// Same result as PIDCoreConstrain, written as two independent selects so the
+// compiler can turn it into compare and blend instructions inside a 
+// vectorized loop.
+//
+static inline float
+ConstrainSelect(float x, float lower, float upper)
+{
+    float bounded = (x > upper) ? upper : x;
+    return (x < lower) ? lower : bounded;
+}
+
+//
+// Picks a when mask is all ones and b when mask is all zeros. It works on the
+// bit patterns so that the compiler cannot turn it back into a conditional
+// store, which would stop the loop from vectorizing.
+//
+static inline float
+MaskSelect(uint32_t mask, float a, float b)
+{
+    uint32_t bitsA, bitsB;
+    float result;
+
+    memcpy(&bitsA, &a, sizeof(bitsA));
+    memcpy(&bitsB, &b, sizeof(bitsB));
+    bitsA = (bitsA & mask) | (bitsB & ~mask);
+    memcpy(&result, &bitsA, sizeof(result));
+
+    return result;
+}
+
+//
+// The PIDCompute update law over arrays. The arrays are declared restrict so
+// the compiler does not need a run time overlap check for each of them. Every
+// kernel comes in four versions. Windup false is the clamping law alone, and
+// Windup true also evaluates conditional integration and back-calculation for
+// every lane and picks each lane's strategy with masks. Weighted true also
+// evaluates the weighted law of PIDCoreUpdateWeighted for every lane and
+// picks each lane's proportional and derivative terms with a mask, so that
+// the lanes on the plain law get exactly the plain law's results.
+//
+template <bool Windup, bool Weighted>
+static void
+ScalarLanes(const float *__restrict in, const float *__restrict sp,
+            float *__restrict out, float *__restrict li,
+            float *__restrict it, const float *__restrict kp,
+            const float *__restrict ki, const float *__restrict kd,
+            const float *__restrict lo, const float *__restrict hi,
+            const PIDMode *__restrict md, const float *__restrict kt,
+            const PIDAntiWindup *__restrict aw, const float *__restrict wb,
+            const float *__restrict wc, const float *__restrict fa,
+            const float *__restrict fk, const uint32_t *__restrict wt,
+            float *__restrict dt, float *__restrict ls, size_t first, size_t last)
+{
+    for(size_t i = first; i < last; i++)
+    {
+        float error, dInput, proportional, derivative, step, newITerm, rawOutput;
+        float newOutput;
+
+        // All ones for AUTOMATIC, all zeros for MANUAL
+        uint32_t automatic = 0u - (uint32_t)(md[i] == AUTOMATIC);
+
+        // The classic PID error term
+        error = sp[i] - in[i];
+
+        // Take the "derivative on measurement" instead of "derivative on error"
+        dInput = in[i] - li[i];
+        proportional = kp[i] * error;
+        derivative = kd[i] * dInput;
+
+        // The weighted law's terms, see PIDCoreUpdateWeighted
+        if constexpr(Weighted)
+        {
+            float weightedInput = dInput - wc[i] * (sp[i] - ls[i]);
+            float filtered = fa[i] * dt[i] + fk[i] * weightedInput;
+
+            proportional = MaskSelect(wt[i], kp[i] * (wb[i] * sp[i] - in[i]), proportional);
+            derivative = MaskSelect(wt[i], filtered, derivative);
+        }
+
+        // Compute and constrain the integral term separately ahead of time
+        step = ki[i] * error;
+        if constexpr(Windup)
+        {
+            uint32_t conditional = 0u - (uint32_t)(aw[i] == CONDITIONAL_INTEGRATION);
+            float held = PIDCoreHold(proportional + it[i] - derivative, step, lo[i], hi[i]);
+
+            step = MaskSelect(conditional, held, step);
+        }
+        newITerm = ConstrainSelect(it[i] + step, lo[i], hi[i]);
+
+        // Run all the terms together to get the overall output and bound it
+        rawOutput = proportional + newITerm - derivative;
+        newOutput = ConstrainSelect(rawOutput, lo[i], hi[i]);
+
+        // Back-calculation feeds the cut off part of the output back
+        if constexpr(Windup)
+        {
+            uint32_t back = 0u - (uint32_t)(aw[i] == BACK_CALCULATION);
+            float tracked = ConstrainSelect(newITerm + kt[i] * (newOutput - rawOutput),
+                                            lo[i], hi[i]);
+
+            newITerm = MaskSelect(back, tracked, newITerm);
+        }
+
+        // Only the lanes on the weighted law keep its state
+        if constexpr(Weighted)
+        {
+            dt[i] = MaskSelect(automatic & wt[i], derivative, dt[i]);
+            ls[i] = MaskSelect(automatic & wt[i], sp[i], ls[i]);
+        }
+
+        // Controllers in MANUAL keep their state
+        it[i] = MaskSelect(automatic, newITerm, it[i]);
+        out[i] = MaskSelect(automatic, newOutput, out[i]);
+        li[i] = MaskSelect(automatic, in[i], li[i]);
+    }
+}
+
+template <bool Windup, bool Weighted>
+static void
+KernelScalar(const PIDBankArrays &a, size_t first, size_t last)
+{
+    ScalarLanes<Windup, Weighted>(a.input, a.setpoint, a.output, a.lastInput, a.iTerm,
+                                  a.alteredKp, a.alteredKi, a.alteredKd, a.outMin,
+                                  a.outMax, a.mode, a.alteredKt, a.antiWindup,
+                                  a.setpointWeightB, a.setpointWeightC, a.filterAlpha,
+                                  a.filterKd, a.weighted, a.dTerm, a.lastSetpoint,
+                                  first, last);
+}
+
+//*********************************************************************************
+// x86 Kernels
+//*********************************************************************************
+#if PID_SIMD_X86
+
+//
+// SSE2 is part of every x86-64 CPU, so this is the baseline x86 kernel. SSE2
+// has no blend instruction, so selects are done with and/andnot/or.
+//
+static inline __m128
+Sse2Select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//
+// ConstrainSelect in two instructions. minps and maxps return their second
+// operand when the comparison fails, so min(upper, x) is exactly x > upper ?
+// upper : x, NaN and signed zeros included. Taking the max against that
+// rather than against x only differs when upper is below lower, which the
+// limit setters never allow.
+//
+static inline __m128
+Sse2Constrain(__m128 x, __m128 lower, __m128 upper)
+{
+    return _mm_max_ps(lower, _mm_min_ps(upper, x));
+}
+
+//
+// PIDCoreHold. minps and maxps return their second operand when the first is
+// NaN, the same as the selects of the scalar version.
+//
+static inline __m128
+Sse2Hold(__m128 x, __m128 step, __m128 lower, __m128 upper)
+{
+    __m128 zero = _mm_setzero_ps();
+    __m128 held = Sse2Select(_mm_cmpgt_ps(x, upper), _mm_min_ps(step, zero), step);
+    return Sse2Select(_mm_cmplt_ps(x, lower), _mm_max_ps(step, zero), held);
+}
+
+template <bool Windup, bool Weighted>
+PID_TARGET("sse2") static void
+KernelSse2(const PIDBankArrays &arrays, size_t first, size_t last)
+{
+    const PIDBankArrays a = arrays;
+    const __m128i automatic = _mm_set1_epi32(AUTOMATIC);
+    const __m128i conditional = _mm_set1_epi32(CONDITIONAL_INTEGRATION);
+    const __m128i back = _mm_set1_epi32(BACK_CALCULATION);
+    size_t i = first;
+
+    for(; i + 4 <= last; i += 4)
+    {
+        __m128 in = _mm_loadu_ps(a.input + i);
+        __m128 sp = _mm_loadu_ps(a.setpoint + i);
+        __m128 li = _mm_loadu_ps(a.lastInput + i);
+        __m128 it = _mm_loadu_ps(a.iTerm + i);
+        __m128 out = _mm_loadu_ps(a.output + i);
+        __m128 kp = _mm_loadu_ps(a.alteredKp + i);
+        __m128 kd = _mm_loadu_ps(a.alteredKd + i);
+        __m128 lo = _mm_loadu_ps(a.outMin + i);
+        __m128 hi = _mm_loadu_ps(a.outMax + i);
+        __m128 on = _mm_castsi128_ps(_mm_cmpeq_epi32(
+                        _mm_loadu_si128((const __m128i *)(a.mode + i)), automatic));
+
+        __m128 error = _mm_sub_ps(sp, in);
+        __m128 dInput = _mm_sub_ps(in, li);
+        __m128 proportional = _mm_mul_ps(kp, error);
+        __m128 derivative = _mm_mul_ps(kd, dInput);
+        __m128 step = _mm_mul_ps(_mm_loadu_ps(a.alteredKi + i), error);
+        __m128i strategy = _mm_setzero_si128();
+        __m128 weighted = _mm_setzero_ps();
+        __m128 dt = _mm_setzero_ps();
+        __m128 ls = _mm_setzero_ps();
+
+        if constexpr(Weighted)
+        {
+            weighted = _mm_loadu_ps((const float *)(a.weighted + i));
+            dt = _mm_loadu_ps(a.dTerm + i);
+            ls = _mm_loadu_ps(a.lastSetpoint + i);
+
+            __m128 weightedInput = _mm_sub_ps(dInput, _mm_mul_ps(_mm_loadu_ps(a.setpointWeightC + i),
+                                                                 _mm_sub_ps(sp, ls)));
+            __m128 filtered = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a.filterAlpha + i), dt),
+                                         _mm_mul_ps(_mm_loadu_ps(a.filterKd + i), weightedInput));
+            __m128 weightedError = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(a.setpointWeightB + i), sp),
+                                              in);
+
+            proportional = Sse2Select(weighted, _mm_mul_ps(kp, weightedError), proportional);
+            derivative = Sse2Select(weighted, filtered, derivative);
+        }
+
+        if constexpr(Windup)
+        {
+            strategy = _mm_loadu_si128((const __m128i *)(a.antiWindup + i));
+            step = Sse2Select(_mm_castsi128_ps(_mm_cmpeq_epi32(strategy, conditional)),
+                              Sse2Hold(_mm_sub_ps(_mm_add_ps(proportional, it), derivative),
+                                       step, lo, hi),
+                              step);
+        }
+        __m128 newITerm = Sse2Constrain(_mm_add_ps(it, step), lo, hi);
+
+        __m128 rawOutput = _mm_sub_ps(_mm_add_ps(proportional, newITerm), derivative);
+        __m128 newOutput = Sse2Constrain(rawOutput, lo, hi);
+
+        if constexpr(Windup)
+        {
+            __m128 tracked = _mm_add_ps(newITerm, _mm_mul_ps(_mm_loadu_ps(a.alteredKt + i),
+                                                             _mm_sub_ps(newOutput, rawOutput)));
+
+            newITerm = Sse2Select(_mm_castsi128_ps(_mm_cmpeq_epi32(strategy, back)),
+                                  Sse2Constrain(tracked, lo, hi), newITerm);
+        }
+
+        if constexpr(Weighted)
+        {
+            __m128 keep = _mm_and_ps(on, weighted);
+
+            _mm_storeu_ps(a.dTerm + i, Sse2Select(keep, derivative, dt));
+            _mm_storeu_ps(a.lastSetpoint + i, Sse2Select(keep, sp, ls));
+        }
+
+        _mm_storeu_ps(a.iTerm + i, Sse2Select(on, newITerm, it));
+        _mm_storeu_ps(a.output + i, Sse2Select(on, newOutput, out));
+        _mm_storeu_ps(a.lastInput + i, Sse2Select(on, in, li));
+    }
+
+    KernelScalar<Windup, Weighted>(arrays, i, last);
+}
+
+//
+// Same as Sse2Constrain, which saves a compare and a blend each
+//
+PID_TARGET("avx2") static inline __m256
+Avx2Constrain(__m256 x, __m256 lower, __m256 upper)
+{
+    return _mm256_max_ps(lower, _mm256_min_ps(upper, x));
+}
+
+PID_TARGET("avx2") static inline __m256
+Avx2Hold(__m256 x, __m256 step, __m256 lower, __m256 upper)
+{
+    __m256 zero = _mm256_setzero_ps();
+    __m256 held = _mm256_blendv_ps(step, _mm256_min_ps(step, zero),
+                                   _mm256_cmp_ps(x, upper, _CMP_GT_OQ));
+    return _mm256_blendv_ps(held, _mm256_max_ps(step, zero),
+                            _mm256_cmp_ps(x, lower, _CMP_LT_OQ));
+}
+
+template <bool Windup, bool Weighted>
+PID_TARGET("avx2") static void
+KernelAvx2(const PIDBankArrays &arrays, size_t first, size_t last)
+{
+    const PIDBankArrays a = arrays;
+    const __m256i automatic = _mm256_set1_epi32(AUTOMATIC);
+    const __m256i conditional = _mm256_set1_epi32(CONDITIONAL_INTEGRATION);
+    const __m256i back = _mm256_set1_epi32(BACK_CALCULATION);
+    size_t i = first;
+
+    for(; i + 8 <= last; i += 8)
+    {
+        __m256 in = _mm256_loadu_ps(a.input + i);
+        __m256 sp = _mm256_loadu_ps(a.setpoint + i);
+        __m256 li = _mm256_loadu_ps(a.lastInput + i);
+        __m256 it = _mm256_loadu_ps(a.iTerm + i);
+        __m256 out = _mm256_loadu_ps(a.output + i);
+        __m256 kp = _mm256_loadu_ps(a.alteredKp + i);
+        __m256 kd = _mm256_loadu_ps(a.alteredKd + i);
+        __m256 lo = _mm256_loadu_ps(a.outMin + i);
+        __m256 hi = _mm256_loadu_ps(a.outMax + i);
+        __m256 on = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+                        _mm256_loadu_si256((const __m256i *)(a.mode + i)), automatic));
+
+        __m256 error = _mm256_sub_ps(sp, in);
+        __m256 dInput = _mm256_sub_ps(in, li);
+        __m256 proportional = _mm256_mul_ps(kp, error);
+        __m256 derivative = _mm256_mul_ps(kd, dInput);
+        __m256 step = _mm256_mul_ps(_mm256_loadu_ps(a.alteredKi + i), error);
+        __m256i strategy = _mm256_setzero_si256();
+        __m256 weighted = _mm256_setzero_ps();
+        __m256 dt = _mm256_setzero_ps();
+        __m256 ls = _mm256_setzero_ps();
+
+        if constexpr(Weighted)
+        {
+            weighted = _mm256_loadu_ps((const float *)(a.weighted + i));
+            dt = _mm256_loadu_ps(a.dTerm + i);
+            ls = _mm256_loadu_ps(a.lastSetpoint + i);
+
+            __m256 weightedInput = _mm256_sub_ps(dInput,
+                                                 _mm256_mul_ps(_mm256_loadu_ps(a.setpointWeightC + i),
+                                                               _mm256_sub_ps(sp, ls)));
+            __m256 filtered = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(a.filterAlpha + i), dt),
+                                            _mm256_mul_ps(_mm256_loadu_ps(a.filterKd + i),
+                                                          weightedInput));
+            __m256 weightedError = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(a.setpointWeightB + i),
+                                                               sp),
+                                                 in);
+
+            proportional = _mm256_blendv_ps(proportional, _mm256_mul_ps(kp, weightedError),
+                                            weighted);
+            derivative = _mm256_blendv_ps(derivative, filtered, weighted);
+        }
+
+        if constexpr(Windup)
+        {
+            strategy = _mm256_loadu_si256((const __m256i *)(a.antiWindup + i));
+            step = _mm256_blendv_ps(step,
+                                    Avx2Hold(_mm256_sub_ps(_mm256_add_ps(proportional, it),
+                                                           derivative),
+                                             step, lo, hi),
+                                    _mm256_castsi256_ps(_mm256_cmpeq_epi32(strategy, conditional)));
+        }
+        __m256 newITerm = Avx2Constrain(_mm256_add_ps(it, step), lo, hi);
+
+        __m256 rawOutput = _mm256_sub_ps(_mm256_add_ps(proportional, newITerm), derivative);
+        __m256 newOutput = Avx2Constrain(rawOutput, lo, hi);
+
+        if constexpr(Windup)
+        {
+            __m256 tracked = _mm256_add_ps(newITerm,
+                                           _mm256_mul_ps(_mm256_loadu_ps(a.alteredKt + i),
+                                                         _mm256_sub_ps(newOutput, rawOutput)));
+
+            newITerm = _mm256_blendv_ps(newITerm, Avx2Constrain(tracked, lo, hi),
+                                        _mm256_castsi256_ps(_mm256_cmpeq_epi32(strategy, back)));
+        }
+
+        if constexpr(Weighted)
+        {
+            __m256 keep = _mm256_and_ps(on, weighted);
+
+            _mm256_storeu_ps(a.dTerm + i, _mm256_blendv_ps(dt, derivative, keep));
+            _mm256_storeu_ps(a.lastSetpoint + i, _mm256_blendv_ps(ls, sp, keep));
+        }
+
+        _mm256_storeu_ps(a.iTerm + i, _mm256_blendv_ps(it, newITerm, on));
+        _mm256_storeu_ps(a.output + i, _mm256_blendv_ps(out, newOutput, on));
+        _mm256_storeu_ps(a.lastInput + i, _mm256_blendv_ps(li, in, on));
+    }
+
+    // The scalar kernel is built without VEX, so clear the upper halves 
+    // first or every one of its SSE instructions pays for the mixed state
+    _mm256_zeroupper();
+    KernelScalar<Windup, Weighted>(arrays, i, last);
+}
+
+PID_TARGET("avx512f") static inline __m512
+Avx512Constrain(__m512 x, __m512 lower, __m512 upper)
+{
+    __m512 bounded = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, upper, _CMP_GT_OQ), x, upper);
+    return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, lower, _CMP_LT_OQ), bounded, lower);
+}
+
+PID_TARGET("avx512f") static inline __m512
+Avx512Hold(__m512 x, __m512 step, __m512 lower, __m512 upper)
+{
+    __m512 zero = _mm512_setzero_ps();
+    __m512 down = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(step, zero, _CMP_LT_OQ), zero, step);
+    __m512 up = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(step, zero, _CMP_GT_OQ), zero, step);
+    __m512 held = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, upper, _CMP_GT_OQ), step, down);
+    return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, lower, _CMP_LT_OQ), held, up);
+}
+
+//
+// AVX-512 has per lane mask registers, so the tail is handled with masked
+// loads and stores instead of falling back to the scalar kernel.
+//
+template <bool Windup, bool Weighted>
+PID_TARGET("avx512f") static void
+KernelAvx512(const PIDBankArrays &arrays, size_t first, size_t last)
+{
+    const PIDBankArrays a = arrays;
+    const __m512i automatic = _mm512_set1_epi32(AUTOMATIC);
+    const __m512i conditional = _mm512_set1_epi32(CONDITIONAL_INTEGRATION);
+    const __m512i back = _mm512_set1_epi32(BACK_CALCULATION);
+    size_t i = first;
+
+    while(i < last)
+    {
+        size_t count = last - i;
+        __mmask16 lanes = (count >= 16) ? (__mmask16)0xFFFF
+                                        : (__mmask16)((1u << count) - 1u);
+
+        __m512 in = _mm512_maskz_loadu_ps(lanes, a.input + i);
+        __m512 sp = _mm512_maskz_loadu_ps(lanes, a.setpoint + i);
+        __m512 li = _mm512_maskz_loadu_ps(lanes, a.lastInput + i);
+        __m512 it = _mm512_maskz_loadu_ps(lanes, a.iTerm + i);
+        __m512 kp = _mm512_maskz_loadu_ps(lanes, a.alteredKp + i);
+        __m512 kd = _mm512_maskz_loadu_ps(lanes, a.alteredKd + i);
+        __m512 lo = _mm512_maskz_loadu_ps(lanes, a.outMin + i);
+        __m512 hi = _mm512_maskz_loadu_ps(lanes, a.outMax + i);
+        __mmask16 on = _mm512_mask_cmpeq_epi32_mask(
+                           lanes, _mm512_maskz_loadu_epi32(lanes, a.mode + i), automatic);
+
+        __m512 error = _mm512_sub_ps(sp, in);
+        __m512 dInput = _mm512_sub_ps(in, li);
+        __m512 proportional = _mm512_mul_ps(kp, error);
+        __m512 derivative = _mm512_mul_ps(kd, dInput);
+        __m512 step = _mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, a.alteredKi + i), error);
+        __m512i strategy = _mm512_setzero_si512();
+        __mmask16 weighted = 0;
+
+        if constexpr(Weighted)
+        {
+            __m512i flags = _mm512_maskz_loadu_epi32(lanes, a.weighted + i);
+            __m512 dt = _mm512_maskz_loadu_ps(lanes, a.dTerm + i);
+            __m512 ls = _mm512_maskz_loadu_ps(lanes, a.lastSetpoint + i);
+            __m512 weightedInput = _mm512_sub_ps(dInput,
+                                                 _mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, a.setpointWeightC + i),
+                                                               _mm512_sub_ps(sp, ls)));
+            __m512 filtered = _mm512_add_ps(_mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, a.filterAlpha + i),
+                                                          dt),
+                                            _mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, a.filterKd + i),
+                                                          weightedInput));
+            __m512 weightedError = _mm512_sub_ps(_mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, a.setpointWeightB + i),
+                                                               sp),
+                                                 in);
+
+            weighted = _mm512_test_epi32_mask(flags, flags);
+            proportional = _mm512_mask_blend_ps(weighted, proportional,
+                                                _mm512_mul_ps(kp, weightedError));
+            derivative = _mm512_mask_blend_ps(weighted, derivative, filtered);
+        }
+
+        if constexpr(Windup)
+        {
+            strategy = _mm512_maskz_loadu_epi32(lanes, a.antiWindup + i);
+            step = _mm512_mask_blend_ps(_mm512_cmpeq_epi32_mask(strategy, conditional), step,
+                                        Avx512Hold(_mm512_sub_ps(_mm512_add_ps(proportional, it),
+                                                                 derivative),
+                                                   step, lo, hi));
+        }
+        __m512 newITerm = Avx512Constrain(_mm512_add_ps(it, step), lo, hi);
+
+        __m512 rawOutput = _mm512_sub_ps(_mm512_add_ps(proportional, newITerm), derivative);
+        __m512 newOutput = Avx512Constrain(rawOutput, lo, hi);
+
+        if constexpr(Windup)
+        {
+            __m512 tracked = _mm512_add_ps(newITerm,
+                                           _mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, a.alteredKt + i),
+                                                         _mm512_sub_ps(newOutput, rawOutput)));
+
+            newITerm = _mm512_mask_blend_ps(_mm512_cmpeq_epi32_mask(strategy, back), newITerm,
+                                            Avx512Constrain(tracked, lo, hi));
+        }
+
+        // Only lanes that are both in range and in AUTOMATIC are written
+        if constexpr(Weighted)
+        {
+            _mm512_mask_storeu_ps(a.dTerm + i, on & weighted, derivative);
+            _mm512_mask_storeu_ps(a.lastSetpoint + i, on & weighted, sp);
+        }
+
+        _mm512_mask_storeu_ps(a.iTerm + i, on, newITerm);
+        _mm512_mask_storeu_ps(a.output + i, on, newOutput);
+        _mm512_mask_storeu_ps(a.lastInput + i, on, in);
+
+        i += 16;
+    }
+}
+
+#endif  // PID_SIMD_X86
+
+//*********************************************************************************
+// ARM Kernels
+//*********************************************************************************
+#if PID_SIMD_ARM
+
+static inline float32x4_t
+NeonConstrain(float32x4_t x, float32x4_t lower, float32x4_t upper)
+{
+    float32x4_t bounded = vbslq_f32(vcgtq_f32(x, upper), upper, x);
+    return vbslq_f32(vcltq_f32(x, lower), lower, bounded);
+}
+
+//
+// PIDCoreHold. vminq and vmaxq return NaN for a NaN step, so the min and max
+// against zero are selects here.
+//
+static inline float32x4_t
+NeonHold(float32x4_t x, float32x4_t step, float32x4_t lower, float32x4_t upper)
+{
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t down = vbslq_f32(vcltq_f32(step, zero), step, zero);
+    float32x4_t up = vbslq_f32(vcgtq_f32(step, zero), step, zero);
+    float32x4_t held = vbslq_f32(vcgtq_f32(x, upper), down, step);
+    return vbslq_f32(vcltq_f32(x, lower), up, held);
+}
+
+template <bool Windup, bool Weighted>
+static void
+KernelNeon(const PIDBankArrays &arrays, size_t first, size_t last)
+{
+    const PIDBankArrays a = arrays;
+    const int32x4_t automatic = vdupq_n_s32(AUTOMATIC);
+    const int32x4_t conditional = vdupq_n_s32(CONDITIONAL_INTEGRATION);
+    const int32x4_t back = vdupq_n_s32(BACK_CALCULATION);
+    size_t i = first;
+
+    for(; i + 4 <= last; i += 4)
+    {
+        float32x4_t in = vld1q_f32(a.input + i);
+        float32x4_t sp = vld1q_f32(a.setpoint + i);
+        float32x4_t li = vld1q_f32(a.lastInput + i);
+        float32x4_t it = vld1q_f32(a.iTerm + i);
+        float32x4_t out = vld1q_f32(a.output + i);
+        float32x4_t kp = vld1q_f32(a.alteredKp + i);
+        float32x4_t kd = vld1q_f32(a.alteredKd + i);
+        float32x4_t lo = vld1q_f32(a.outMin + i);
+        float32x4_t hi = vld1q_f32(a.outMax + i);
+        uint32x4_t on = vceqq_s32(vld1q_s32((const int32_t *)(a.mode + i)), automatic);
+
+        // vmulq/vaddq rather than vfmaq/vmlaq to keep the separate roundings
+        float32x4_t error = vsubq_f32(sp, in);
+        float32x4_t dInput = vsubq_f32(in, li);
+        float32x4_t proportional = vmulq_f32(kp, error);
+        float32x4_t derivative = vmulq_f32(kd, dInput);
+        float32x4_t step = vmulq_f32(vld1q_f32(a.alteredKi + i), error);
+        int32x4_t strategy = vdupq_n_s32(0);
+        uint32x4_t weighted = vdupq_n_u32(0);
+        float32x4_t dt = vdupq_n_f32(0.0f);
+        float32x4_t ls = vdupq_n_f32(0.0f);
+
+        if constexpr(Weighted)
+        {
+            weighted = vld1q_u32(a.weighted + i);
+            dt = vld1q_f32(a.dTerm + i);
+            ls = vld1q_f32(a.lastSetpoint + i);
+
+            float32x4_t weightedInput = vsubq_f32(dInput, vmulq_f32(vld1q_f32(a.setpointWeightC + i),
+                                                                    vsubq_f32(sp, ls)));
+            float32x4_t filtered = vaddq_f32(vmulq_f32(vld1q_f32(a.filterAlpha + i), dt),
+                                             vmulq_f32(vld1q_f32(a.filterKd + i), weightedInput));
+            float32x4_t weightedError = vsubq_f32(vmulq_f32(vld1q_f32(a.setpointWeightB + i), sp),
+                                                  in);
+
+            proportional = vbslq_f32(weighted, vmulq_f32(kp, weightedError), proportional);
+            derivative = vbslq_f32(weighted, filtered, derivative);
+        }
+
+        if constexpr(Windup)
+        {
+            strategy = vld1q_s32((const int32_t *)(a.antiWindup + i));
+            step = vbslq_f32(vceqq_s32(strategy, conditional),
+                             NeonHold(vsubq_f32(vaddq_f32(proportional, it), derivative),
+                                      step, lo, hi),
+                             step);
+        }
+        float32x4_t newITerm = NeonConstrain(vaddq_f32(it, step), lo, hi);
+
+        float32x4_t rawOutput = vsubq_f32(vaddq_f32(proportional, newITerm), derivative);
+        float32x4_t newOutput = NeonConstrain(rawOutput, lo, hi);
+
+        if constexpr(Windup)
+        {
+            float32x4_t tracked = vaddq_f32(newITerm, vmulq_f32(vld1q_f32(a.alteredKt + i),
+                                                                vsubq_f32(newOutput, rawOutput)));
+
+            newITerm = vbslq_f32(vceqq_s32(strategy, back), NeonConstrain(tracked, lo, hi),
+                                 newITerm);
+        }
+
+        if constexpr(Weighted)
+        {
+            uint32x4_t keep = vandq_u32(on, weighted);
+
+            vst1q_f32(a.dTerm + i, vbslq_f32(keep, derivative, dt));
+            vst1q_f32(a.lastSetpoint + i, vbslq_f32(keep, sp, ls));
+        }
+
+        vst1q_f32(a.iTerm + i, vbslq_f32(on, newITerm, it));
+        vst1q_f32(a.output + i, vbslq_f32(on, newOutput, out));
+        vst1q_f32(a.lastInput + i, vbslq_f32(on, in, li));
+    }
+
+    KernelScalar<Windup, Weighted>(arrays, i, last);
+}
+
+#endif  // PID_SIMD_ARM
+
+//*********************************************************************************
+// Dispatch
+//*********************************************************************************
+
+//
+// Returns true if the CPU running this code can execute the kernel
+//
+static bool
+CpuSupports(PIDSimdLevel level)
+{
+    switch(level)
+    {
+        case PID_SIMD_SCALAR:
+            return true;
+
+#if PID_SIMD_X86
+    #if defined(_MSC_VER) && !defined(__clang__)
+        case PID_SIMD_SSE2:
+        case PID_SIMD_AVX2:
+        case PID_SIMD_AVX512:
+        {
+            int info[4];
+            unsigned long long xcr0;
+
+            __cpuid(info, 1);
+            if(level == PID_SIMD_SSE2)
+            {
+                return (info[3] & (1 << 26)) != 0;
+            }
+
+            // The OS has to save the wider registers on a context switch
+            if((info[2] & (1 << 27)) == 0)
+            {
+                return false;
+            }
+            xcr0 = _xgetbv(0);
+
+            __cpuidex(info, 7, 0);
+            if(level == PID_SIMD_AVX2)
+            {
+                return (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+            }
+            return (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0;
+        }
+    #else
+        case PID_SIMD_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case PID_SIMD_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case PID_SIMD_AVX512:
+            return __builtin_cpu_supports("avx512f");
+    #endif
+#endif
+
+#if PID_SIMD_ARM
+        case PID_SIMD_NEON:
+            return true;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+template <bool Windup, bool Weighted>
+static PIDBankKernel
+KernelFor(PIDSimdLevel level)
+{
+    switch(level)
+    {
+#if PID_SIMD_X86
+        case PID_SIMD_SSE2:   return KernelSse2<Windup, Weighted>;
+        case PID_SIMD_AVX2:   return KernelAvx2<Windup, Weighted>;
+        case PID_SIMD_AVX512: return KernelAvx512<Windup, Weighted>;
+#endif
+#if PID_SIMD_ARM
+        case PID_SIMD_NEON:   return KernelNeon<Windup, Weighted>;
+#endif
+        default:              return KernelScalar<Windup, Weighted>;
+    }
+}
+
+//
+// The active kernels, indexed by the PID_KERNEL_WINDUP and PID_KERNEL_WEIGHTED
+// versions they run, and their level. They are only ever swapped together by
+// PIDSimdLevelSet, and a reader that sees a stale mix still runs correct
+// kernels.
+//
+#define PID_KERNEL_WINDUP       0x1
+#define PID_KERNEL_WEIGHTED     0x2
+
+static std::atomic<PIDBankKernel> activeKernels[4];
+static std::atomic<int> activeLevel(PID_SIMD_SCALAR);
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+void
+PIDBankKernelRun(const PIDBankArrays &arrays, size_t first, size_t last)
+{
+    int version = (arrays.antiWindup ? PID_KERNEL_WINDUP : 0) |
+                  (arrays.weighted ? PID_KERNEL_WEIGHTED : 0);
+    PIDBankKernel kernel = activeKernels[version].load(std::memory_order_relaxed);
+
+    if(kernel == nullptr)
+    {
+        PIDSimdLevelSet(PIDSimdLevelBest());
+        kernel = activeKernels[version].load(std::memory_order_relaxed);
+    }
+
+    if(first < last)
+    {
+        kernel(arrays, first, last);
+    }
+}
+
+PIDSimdLevel
+PIDSimdLevelBest()
+{
+    static const PIDSimdLevel order[] =
+    {
+        PID_SIMD_AVX512, PID_SIMD_AVX2, PID_SIMD_SSE2, PID_SIMD_NEON
+    };
+
+    for(size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        if(CpuSupports(order[i]))
+        {
+            return order[i];
+        }
+    }
+
+    return PID_SIMD_SCALAR;
+}
+
+PIDSimdLevel
+PIDSimdLevelGet()
+{
+    if(activeKernels[0].load(std::memory_order_relaxed) == nullptr)
+    {
+        return PIDSimdLevelBest();
+    }
+
+    return (PIDSimdLevel)activeLevel.load(std::memory_order_relaxed);
+}
+
+bool
+PIDSimdLevelSet(PIDSimdLevel level)
+{
+    if(!CpuSupports(level))
+    {
+        return false;
+    }
+
+    activeLevel.store(level, std::memory_order_relaxed);
+    activeKernels[PID_KERNEL_WINDUP | PID_KERNEL_WEIGHTED].store(KernelFor<true, true>(level),
+                                                                 std::memory_order_relaxed);
+    activeKernels[PID_KERNEL_WEIGHTED].store(KernelFor<false, true>(level),
+                                             std::memory_order_relaxed);
+    activeKernels[PID_KERNEL_WINDUP].store(KernelFor<true, false>(level),
+                                           std::memory_order_relaxed);
+    activeKernels[0].store(KernelFor<false, false>(level), std::memory_order_relaxed);
+
+    return true;
+}
@@ -0,0 +1,162 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Batched PIDCompute kernels for PIDBank. Explicit SSE2, AVX2,
+// AVX-512 and NEON versions of the update law are provided next to a scalar
+// fallback, and the widest one the CPU supports is picked at run time. Every
+// kernel gives bit identical results to PIDControl::PIDCompute.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_BANK_SIMD_H
+#define PID_BANK_SIMD_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include "pid_controller.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+typedef enum
+{
+    PID_SIMD_SCALAR,
+    PID_SIMD_SSE2,
+    PID_SIMD_AVX2,
+    PID_SIMD_AVX512,
+    PID_SIMD_NEON
+}
+PIDSimdLevel;
+
+//
+// The arrays of a PIDBank that the compute kernels read and write. Element i
+// of every array belongs to controller i.
+//
+struct
+PIDBankArrays
+{
+    const float *input;
+    const float *setpoint;
+    float *output;
+    float *lastInput;
+    float *iTerm;
+    const float *alteredKp;
+    const float *alteredKi;
+    const float *alteredKd;
+    const float *outMin;
+    const float *outMax;
+    const PIDMode *mode;
+
+    //
+    // Per controller anti-windup, see PIDAntiWindupSet. When antiWindup is
+    // null every controller clamps and a kernel without the other strategies
+    // runs.
+    //
+    const float *alteredKt;
+    const PIDAntiWindup *antiWindup;
+
+    //
+    // Per controller setpoint weighting and derivative filter, see
+    // PIDSetpointWeightsSet. weighted is all ones for the controllers on the
+    // weighted law and zero for the rest, whose dTerm and lastSetpoint are
+    // left alone. When weighted is null every controller is on the plain law
+    // and a kernel without the weighted law runs.
+    //
+    const float *setpointWeightB;
+    const float *setpointWeightC;
+    const float *filterAlpha;
+    const float *filterKd;
+    const uint32_t *weighted;
+    float *dTerm;
+    float *lastSetpoint;
+};
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+//
+// PID Bank Kernel Run
+// Description:
+//      Runs the PIDCompute update law over controllers [first, last) of the
+//      arrays using the currently selected kernel. Controllers in MANUAL are
+//      masked out per lane and keep their state, and each lane's anti-windup
+//      strategy and update law are picked with masks as well.
+// Parameters:
+//      arrays - The bank arrays to work on.
+//      first - Index of the first controller to compute.
+//      last - One past the index of the last controller to compute.
+// Returns:
+//      Nothing.
+//
+void PIDBankKernelRun(const PIDBankArrays &arrays, size_t first, size_t last);
+
+//
+// PID SIMD Level Best
+// Description:
+//      Returns the widest kernel that both the build and the CPU support.
+// Parameters:
+//      None.
+// Returns:
+//      The best supported PIDSimdLevel.
+//
+PIDSimdLevel PIDSimdLevelBest();
+
+//
+// PID SIMD Level Get
+// Description:
+//      Returns the kernel PIDBankKernelRun is currently using. Until
+//      PIDSimdLevelSet is called this is PIDSimdLevelBest.
+// Parameters:
+//      None.
+// Returns:
+//      The active PIDSimdLevel.
+//
+PIDSimdLevel PIDSimdLevelGet();
+
+//
+// PID SIMD Level Set
+// Description:
+//      Forces PIDBankKernelRun to use a particular kernel, for example to
+//      compare results or timings between kernels.
+// Parameters:
+//      level - The kernel to use.
+// Returns:
+//      True if the kernel is supported and was selected. False otherwise.
+//
+bool PIDSimdLevelSet(PIDSimdLevel level);
+
+#endif  // PID_BANK_SIMD_H
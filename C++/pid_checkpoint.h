@@ -0,0 +1,315 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checkpoint and restore of controller state in a versioned, fixed
+// layout binary format, so a restarted process can pick its controllers up where
+// they left off instead of re-converging from a zero integrator.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_CHECKPOINT_H
+#define PID_CHECKPOINT_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "pid_controller.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Checkpoint format, version 1
+//
+// A checkpoint is a 64 byte PIDCheckpointHeader followed by count 128 byte
+// PIDCheckpointRecords, one per controller, so records start on a cache line
+// when the checkpoint does. All values are in the native byte order and float
+// format of the machine that wrote them; a checkpoint from a machine of the
+// other byte order is rejected by its magic number. The C library writes the
+// same format, so a checkpoint can move between the two. Controllers over
+// double or _Float16 are saved as float.
+//
+#define PID_CHECKPOINT_MAGIC        0x43444950u
+#define PID_CHECKPOINT_VERSION      1
+
+struct
+PIDCheckpointHeader
+{
+    //
+    // PID_CHECKPOINT_MAGIC, PID_CHECKPOINT_VERSION, sizeof(PIDCheckpointRecord)
+    // and the number of records that follow
+    //
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t count;
+
+    //
+    // Zero, for future versions
+    //
+    uint32_t reserved[13];
+};
+
+struct
+PIDCheckpointRecord
+{
+    //
+    // The state and settings of one controller, see BasicPIDControl for the
+    // meaning of each field
+    //
+    float input;
+    float lastInput;
+    float output;
+    float iTerm;
+    float setpoint;
+    float dispKp;
+    float dispKi;
+    float dispKd;
+    float alteredKp;
+    float alteredKi;
+    float alteredKd;
+    float sampleTime;
+    float outMin;
+    float outMax;
+    float deadband;
+
+    //
+    // PIDMode, PIDDirection and PIDAntiWindup values
+    //
+    uint8_t mode;
+    uint8_t controllerDirection;
+    uint8_t antiWindup;
+
+    //
+    // Zero, for future versions
+    //
+    uint8_t reserved;
+
+    //
+    // The tracking gain, the setpoint weights, the derivative filter
+    // coefficient and the state the weighted law keeps
+    //
+    float dispKt;
+    float setpointWeightB;
+    float setpointWeightC;
+    float filterN;
+    float dTerm;
+    float lastSetpoint;
+
+    //
+    // Zero, for future versions
+    //
+    uint32_t padding[10];
+};
+
+static_assert(sizeof(PIDCheckpointHeader) == 64, "checkpoint header layout is fixed");
+static_assert(sizeof(PIDCheckpointRecord) == 128, "checkpoint record layout is fixed");
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+//
+// PID Checkpoint Size
+// Description:
+//      Returns the number of bytes a checkpoint of count controllers takes.
+// Parameters:
+//      count - Number of controllers.
+// Returns:
+//      The size in bytes.
+//
+inline size_t
+PIDCheckpointSize(size_t count)
+{
+    return sizeof(PIDCheckpointHeader) + count * sizeof(PIDCheckpointRecord);
+}
+
+//
+// PID Checkpoint Header Check
+// Description:
+//      Checks that a buffer starts with a header this library can read and is
+//      large enough for the records the header announces.
+// Parameters:
+//      buffer - The checkpoint.
+//      size - Size of the checkpoint in bytes.
+//      count - Receives the number of records.
+// Returns:
+//      True if the checkpoint can be read. False otherwise.
+//
+inline bool
+PIDCheckpointHeaderCheck(const void *buffer, size_t size, size_t &count)
+{
+    PIDCheckpointHeader header;
+
+    if(size < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, buffer, sizeof(header));
+    count = header.count;
+
+    return header.magic == PID_CHECKPOINT_MAGIC &&
+           header.version == PID_CHECKPOINT_VERSION &&
+           header.recordSize == sizeof(PIDCheckpointRecord) &&
+           (size - sizeof(header)) / sizeof(PIDCheckpointRecord) >= count;
+}
+
+//
+// PID Checkpoint Record Valid
+// Description:
+//      Checks that a record holds a valid mode, direction, anti-windup
+//      strategy, sample time and pair of limits, and no negative tracking
+//      gain, setpoint weight or filter coefficient. The comparisons are
+//      written so that NaN fails them.
+// Parameters:
+//      record - The record to check.
+// Returns:
+//      True if the record can be restored. False otherwise.
+//
+inline bool
+PIDCheckpointRecordValid(const PIDCheckpointRecord &record)
+{
+    return (record.mode == MANUAL || record.mode == AUTOMATIC) &&
+           (record.controllerDirection == DIRECT || record.controllerDirection == REVERSE) &&
+           (record.antiWindup == CLAMPING || record.antiWindup == CONDITIONAL_INTEGRATION ||
+            record.antiWindup == BACK_CALCULATION) &&
+           record.sampleTime > 0.0f && record.outMin < record.outMax &&
+           record.dispKt >= 0.0f && record.setpointWeightB >= 0.0f &&
+           record.setpointWeightC >= 0.0f && record.filterN >= 0.0f;
+}
+
+//
+// PID Checkpoint Header Write
+// Description:
+//      Writes the header of a checkpoint of count records.
+// Parameters:
+//      buffer - Receives the header.
+//      count - Number of records that will follow.
+// Returns:
+//      Nothing.
+//
+inline void
+PIDCheckpointHeaderWrite(void *buffer, size_t count)
+{
+    PIDCheckpointHeader header;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = PID_CHECKPOINT_MAGIC;
+    header.version = PID_CHECKPOINT_VERSION;
+    header.recordSize = (uint16_t)sizeof(PIDCheckpointRecord);
+    header.count = (uint32_t)count;
+    memcpy(buffer, &header, sizeof(header));
+}
+
+//
+// PID Checkpoint Write
+// Description:
+//      Writes a checkpoint of an array of controllers into a buffer, such as a
+//      memory mapped file.
+// Parameters:
+//      pids - Array of count controllers, such as PIDControl objects.
+//      count - Number of controllers.
+//      buffer - Receives the checkpoint. It must be aligned to 4 bytes.
+//      size - Size of the buffer in bytes.
+// Returns:
+//      The number of bytes written, or 0 if the buffer is too small.
+//
+template <typename Controller>
+size_t
+PIDCheckpointWrite(const Controller *pids, size_t count, void *buffer, size_t size)
+{
+    PIDCheckpointRecord *records;
+
+    if(size < PIDCheckpointSize(count) || count > UINT32_MAX)
+    {
+        return 0;
+    }
+
+    PIDCheckpointHeaderWrite(buffer, count);
+    records = (PIDCheckpointRecord *)((char *)buffer + sizeof(PIDCheckpointHeader));
+
+    for(size_t i = 0; i < count; i++)
+    {
+        pids[i].PIDCheckpointSave(records[i]);
+    }
+
+    return PIDCheckpointSize(count);
+}
+
+//
+// PID Checkpoint Read
+// Description:
+//      Restores an array of controllers from a checkpoint, such as a memory
+//      mapped file, in one pass over the records.
+// Parameters:
+//      pids - Array of count controllers.
+//      count - Number of controllers in the array.
+//      buffer - The checkpoint. It must be aligned to 4 bytes.
+//      size - Size of the checkpoint in bytes.
+// Returns:
+//      The number of controllers restored, which is the smaller of count and
+//      the number of records. 0 if the checkpoint is truncated, has the wrong
+//      magic number, version or record size, or holds an invalid record, in
+//      which case the records before the invalid one have been restored.
+//
+template <typename Controller>
+size_t
+PIDCheckpointRead(Controller *pids, size_t count, const void *buffer, size_t size)
+{
+    const PIDCheckpointRecord *records;
+    size_t recordCount;
+
+    if(!PIDCheckpointHeaderCheck(buffer, size, recordCount))
+    {
+        return 0;
+    }
+
+    count = (count < recordCount) ? count : recordCount;
+    records = (const PIDCheckpointRecord *)((const char *)buffer + sizeof(PIDCheckpointHeader));
+
+    for(size_t i = 0; i < count; i++)
+    {
+        if(!pids[i].PIDCheckpointRestore(records[i]))
+        {
+            return 0;
+        }
+    }
+
+    return count;
+}
+
+#endif  // PID_CHECKPOINT_H
@@ -0,0 +1,637 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Runs one controller graph across several machines. See
+// pid_cluster.h.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include "pid_cluster.h"
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static size_t
+ComponentFind(std::vector<size_t> &parent, size_t node)
+{
+    while(parent[node] != node)
+    {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+
+    return node;
+}
+
+static uint32_t
+HashAdd(uint32_t hash, const void *data, size_t bytes)
+{
+    const uint8_t *byte = (const uint8_t *)data;
+
+    for(size_t i = 0; i < bytes; i++)
+    {
+        hash = (hash ^ byte[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDClusterPlan::
+PIDClusterPlan(size_t controllers) :
+    nodes(controllers, 0),
+    nodeCount(1)
+{
+}
+
+bool PIDClusterPlan::
+Connect(size_t from, size_t to, PIDGraphPort port, float gain, float offset)
+{
+    Edge edge;
+
+    if(from >= nodes.size() || to >= nodes.size() || from == to)
+    {
+        return false;
+    }
+
+    edge.from = (uint32_t)from;
+    edge.to = (uint32_t)to;
+    edge.port = port;
+    edge.gain = gain;
+    edge.offset = offset;
+    edges.push_back(edge);
+
+    return true;
+}
+
+bool PIDClusterPlan::
+Assign(size_t controller, unsigned node)
+{
+    if(controller >= nodes.size() || node >= PID_CLUSTER_MAX_NODES)
+    {
+        return false;
+    }
+
+    nodes[controller] = node;
+    nodeCount = std::max(nodeCount, node + 1);
+
+    return true;
+}
+
+bool PIDClusterPlan::
+Balance(unsigned nodeTotal)
+{
+    size_t n = nodes.size();
+    std::vector<size_t> parent(n);
+    std::vector<std::vector<uint32_t> > adjacent(n);
+
+    nodeTotal = std::min<unsigned>(std::max(nodeTotal, 1u), PID_CLUSTER_MAX_NODES);
+    nodeCount = nodeTotal;
+
+    size_t share = std::max<size_t>(1, (n + nodeTotal - 1) / nodeTotal);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        parent[i] = i;
+    }
+    for(const Edge &edge : edges)
+    {
+        parent[ComponentFind(parent, edge.from)] = ComponentFind(parent, edge.to);
+        adjacent[edge.from].push_back(edge.to);
+        adjacent[edge.to].push_back(edge.from);
+    }
+
+    std::vector<std::vector<uint32_t> > components(n);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        components[ComponentFind(parent, i)].push_back((uint32_t)i);
+    }
+
+    // Cut the components larger than a share, walking breadth first from 
+    // their first controller so that each piece keeps its neighbours
+    std::vector<std::vector<uint32_t> > pieces;
+    std::vector<bool> visited(n, false);
+
+    for(const std::vector<uint32_t> &component : components)
+    {
+        if(component.size() <= share)
+        {
+            if(!component.empty())
+            {
+                pieces.push_back(component);
+            }
+            continue;
+        }
+
+        std::vector<uint32_t> order;
+
+        order.reserve(component.size());
+        order.push_back(component.front());
+        visited[component.front()] = true;
+        for(size_t next = 0; next < order.size(); next++)
+        {
+            for(uint32_t neighbour : adjacent[order[next]])
+            {
+                if(!visited[neighbour])
+                {
+                    visited[neighbour] = true;
+                    order.push_back(neighbour);
+                }
+            }
+        }
+
+        for(size_t first = 0; first < order.size(); first += share)
+        {
+            size_t last = std::min(order.size(), first + share);
+
+            pieces.push_back(std::vector<uint32_t>(order.begin() + first, order.begin() + last));
+        }
+    }
+
+    // Largest first onto the least loaded node
+    std::stable_sort(pieces.begin(), pieces.end(),
+                     [](const std::vector<uint32_t> &a, const std::vector<uint32_t> &b)
+                     {
+                         return a.size() > b.size();
+                     });
+
+    std::vector<size_t> load(nodeTotal, 0);
+
+    for(const std::vector<uint32_t> &piece : pieces)
+    {
+        unsigned lightest = 0;
+
+        for(unsigned node = 1; node < nodeTotal; node++)
+        {
+            lightest = (load[node] < load[lightest]) ? node : lightest;
+        }
+        for(uint32_t controller : piece)
+        {
+            nodes[controller] = lightest;
+        }
+        load[lightest] += piece.size();
+    }
+
+    // Number the controllers in reverse postorder of a depth first walk 
+    // along the edges. The edges that go back in it close every cycle, so a
+    // node all of whose edges go forward has none.
+    std::vector<std::vector<uint32_t> > outgoing(n);
+    std::vector<std::pair<uint32_t, size_t> > stack;
+    std::vector<size_t> position(n);
+    size_t next = n;
+
+    for(const Edge &edge : edges)
+    {
+        outgoing[edge.from].push_back(edge.to);
+    }
+
+    std::fill(visited.begin(), visited.end(), false);
+    for(size_t root = 0; root < n; root++)
+    {
+        if(visited[root])
+        {
+            continue;
+        }
+
+        visited[root] = true;
+        stack.push_back(std::make_pair((uint32_t)root, (size_t)0));
+        while(!stack.empty())
+        {
+            uint32_t controller = stack.back().first;
+            size_t &child = stack.back().second;
+
+            if(child == outgoing[controller].size())
+            {
+                position[controller] = --next;
+                stack.pop_back();
+                continue;
+            }
+
+            uint32_t to = outgoing[controller][child++];
+
+            if(!visited[to])
+            {
+                visited[to] = true;
+                stack.push_back(std::make_pair(to, (size_t)0));
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t> > closing(n);
+
+    for(const Edge &edge : edges)
+    {
+        if(position[edge.to] < position[edge.from])
+        {
+            closing[edge.from].push_back(edge.to);
+            closing[edge.to].push_back(edge.from);
+        }
+    }
+
+    // Move one end of every edge closing a cycle within a node, to a node
+    // none of its other such edges lead to
+    bool crossing = true;
+    std::vector<bool> taken(nodeTotal);
+
+    for(const Edge &edge : edges)
+    {
+        if(position[edge.to] >= position[edge.from] || nodes[edge.from] != nodes[edge.to])
+        {
+            continue;
+        }
+
+        bool moved = false;
+
+        for(uint32_t controller : { edge.from, edge.to })
+        {
+            unsigned lightest = nodeTotal;
+
+            std::fill(taken.begin(), taken.end(), false);
+            for(uint32_t other : closing[controller])
+            {
+                taken[nodes[other]] = true;
+            }
+            for(unsigned node = 0; node < nodeTotal; node++)
+            {
+                if(!taken[node] && (lightest == nodeTotal || load[node] < load[lightest]))
+                {
+                    lightest = node;
+                }
+            }
+
+            if(lightest != nodeTotal)
+            {
+                load[nodes[controller]]--;
+                load[lightest]++;
+                nodes[controller] = lightest;
+                moved = true;
+                break;
+            }
+        }
+
+        crossing = crossing && moved;
+    }
+
+    return crossing;
+}
+
+std::vector<size_t> PIDClusterPlan::
+Members(unsigned node) const
+{
+    std::vector<size_t> members;
+
+    for(size_t i = 0; i < nodes.size(); i++)
+    {
+        if(nodes[i] == node)
+        {
+            members.push_back(i);
+        }
+    }
+
+    return members;
+}
+
+uint32_t PIDClusterPlan::
+Hash() const
+{
+    uint32_t hash = 2166136261u;
+    uint64_t count = nodes.size();
+
+    hash = HashAdd(hash, &count, sizeof(count));
+    hash = HashAdd(hash, &nodeCount, sizeof(nodeCount));
+    for(unsigned node : nodes)
+    {
+        hash = HashAdd(hash, &node, sizeof(node));
+    }
+    for(const Edge &edge : edges)
+    {
+        uint32_t port = (uint32_t)edge.port;
+
+        hash = HashAdd(hash, &edge.from, sizeof(edge.from));
+        hash = HashAdd(hash, &edge.to, sizeof(edge.to));
+        hash = HashAdd(hash, &port, sizeof(port));
+        hash = HashAdd(hash, &edge.gain, sizeof(edge.gain));
+        hash = HashAdd(hash, &edge.offset, sizeof(edge.offset));
+    }
+
+    return hash;
+}
+
+size_t PIDClusterPlan::
+CutCount() const
+{
+    size_t cut = 0;
+
+    for(const Edge &edge : edges)
+    {
+        cut += (nodes[edge.from] != nodes[edge.to]);
+    }
+
+    return cut;
+}
+
+PIDClusterNode::
+PIDClusterNode(const PIDClusterPlan &plan, unsigned node, PIDBank &bank) :
+    plan(plan),
+    node(node),
+    bank(bank),
+    graph(bank),
+    connected(true),
+    planHash(plan.Hash()),
+    compensation(PID_CLUSTER_HOLD),
+    maxTicks(4),
+    tickCount(0),
+    rejected(0)
+{
+    std::vector<size_t> members = plan.Members(node);
+    std::vector<uint32_t> local(plan.ControllerCount(), 0);
+
+    for(size_t i = 0; i < members.size(); i++)
+    {
+        local[members[i]] = (uint32_t)i;
+    }
+
+    // The edges within the node are the node's graph, connected once since
+    // the plan cannot change
+    for(const PIDClusterPlan::Edge &edge : plan.edges)
+    {
+        if(plan.nodes[edge.from] == node && plan.nodes[edge.to] == node)
+        {
+            connected = graph.Connect(local[edge.from], local[edge.to], edge.port, 
+                                      edge.gain, edge.offset) && connected;
+        }
+    }
+}
+
+void PIDClusterNode::
+CompensationSet(PIDClusterCompensation compensation, unsigned maxTicks)
+{
+    this->compensation = compensation;
+    this->maxTicks = maxTicks;
+}
+
+bool PIDClusterNode::
+Build(unsigned threads, bool pinThreads, unsigned firstCpu)
+{
+    std::vector<size_t> members = plan.Members(node);
+    std::vector<uint32_t> local(plan.ControllerCount(), 0);
+    std::vector<std::vector<uint32_t> > sent(plan.NodeCount());
+    std::vector<std::vector<const PIDClusterPlan::Edge *> > received(plan.NodeCount());
+
+    if(!connected || bank.Size() != members.size() || !graph.Build(threads, pinThreads, firstCpu))
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i < members.size(); i++)
+    {
+        local[members[i]] = (uint32_t)i;
+    }
+
+    for(const PIDClusterPlan::Edge &edge : plan.edges)
+    {
+        unsigned from = plan.nodes[edge.from];
+        unsigned to = plan.nodes[edge.to];
+
+        if(from == node && to != node)
+        {
+            sent[to].push_back(edge.from);
+        }
+        else if(to == node && from != node)
+        {
+            received[from].push_back(&edge);
+        }
+    }
+
+    // One message to every node fed by this one, carrying each source once
+    outboxes.clear();
+    for(unsigned peer = 0; peer < plan.NodeCount(); peer++)
+    {
+        std::vector<uint32_t> &sources = sent[peer];
+
+        if(sources.empty())
+        {
+            continue;
+        }
+
+        std::sort(sources.begin(), sources.end());
+        sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+        Outbox outbox;
+        PIDClusterHeader header;
+
+        header.magic = PID_CLUSTER_MAGIC;
+        header.planHash = planHash;
+        header.from = (uint16_t)node;
+        header.to = (uint16_t)peer;
+        header.count = (uint32_t)sources.size();
+        header.tick = 0;
+
+        outbox.sources.resize(sources.size());
+        for(size_t i = 0; i < sources.size(); i++)
+        {
+            outbox.sources[i] = local[sources[i]];
+        }
+        outbox.buffer.resize(sizeof(header) + sources.size() * sizeof(float));
+        memcpy(outbox.buffer.data(), &header, sizeof(header));
+        outboxes.push_back(outbox);
+    }
+
+    for(Outbox &outbox : outboxes)
+    {
+        outbox.message.peer = ((const PIDClusterHeader *)outbox.buffer.data())->to;
+        outbox.message.data = outbox.buffer.data();
+        outbox.message.bytes = outbox.buffer.size();
+    }
+
+    // And the same layout, seen from the other end, for every node feeding
+    // this one
+    inboxes.clear();
+    inboxOf.assign(plan.NodeCount(), -1);
+    for(unsigned peer = 0; peer < plan.NodeCount(); peer++)
+    {
+        if(received[peer].empty())
+        {
+            continue;
+        }
+
+        std::vector<uint32_t> sources;
+        Inbox inbox;
+
+        for(const PIDClusterPlan::Edge *edge : received[peer])
+        {
+            sources.push_back(edge->from);
+        }
+        std::sort(sources.begin(), sources.end());
+        sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+        inbox.peer = peer;
+        inbox.tick = 0;
+        inbox.previousTick = 0;
+        inbox.value.assign(sources.size(), 0.0f);
+        inbox.previous.assign(sources.size(), 0.0f);
+        for(const PIDClusterPlan::Edge *edge : received[peer])
+        {
+            Target target;
+
+            target.slot = (uint32_t)(std::lower_bound(sources.begin(), sources.end(), 
+                                                      edge->from) - sources.begin());
+            target.target = (edge->port == PID_GRAPH_SETPOINT) ? 
+                            bank.SetpointData() + local[edge->to] : 
+                            bank.InputData() + local[edge->to];
+            target.gain = edge->gain;
+            target.offset = edge->offset;
+            inbox.targets.push_back(target);
+        }
+
+        inboxOf[peer] = (int32_t)inboxes.size();
+        inboxes.push_back(inbox);
+    }
+
+    return true;
+}
+
+uint64_t PIDClusterNode::
+Tick()
+{
+    uint64_t tick = tickCount + 1;
+    const float *output = bank.OutputData();
+
+    for(Inbox &inbox : inboxes)
+    {
+        float scale = 0.0f;
+
+        // Nothing has arrived yet, so the targets keep their own values
+        if(inbox.tick == 0)
+        {
+            continue;
+        }
+
+        if(compensation == PID_CLUSTER_EXTRAPOLATE && inbox.previousTick != 0 && 
+           tick > inbox.tick)
+        {
+            uint64_t age = std::min<uint64_t>(tick - inbox.tick, maxTicks);
+
+            scale = (float)age / (float)(inbox.tick - inbox.previousTick);
+        }
+
+        for(const Target &target : inbox.targets)
+        {
+            float value = inbox.value[target.slot];
+
+            if(scale != 0.0f)
+            {
+                value += scale * (value - inbox.previous[target.slot]);
+            }
+            *target.target = target.gain * value + target.offset;
+        }
+    }
+
+    graph.Tick();
+    tickCount = tick;
+
+    for(Outbox &outbox : outboxes)
+    {
+        uint8_t *payload = outbox.buffer.data() + sizeof(PIDClusterHeader);
+
+        memcpy(outbox.buffer.data() + offsetof(PIDClusterHeader, tick), &tick, sizeof(tick));
+        for(size_t i = 0; i < outbox.sources.size(); i++)
+        {
+            memcpy(payload + i * sizeof(float), &output[outbox.sources[i]], sizeof(float));
+        }
+    }
+
+    return tick;
+}
+
+const PIDClusterMessage &PIDClusterNode::
+MessageGet(size_t message) const
+{
+    return outboxes[message].message;
+}
+
+bool PIDClusterNode::
+Receive(const void *data, size_t bytes)
+{
+    PIDClusterHeader header;
+    Inbox *inbox;
+
+    if(bytes < sizeof(header))
+    {
+        rejected++;
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != PID_CLUSTER_MAGIC || header.planHash != planHash || 
+       header.to != node || header.from >= inboxOf.size() || inboxOf[header.from] < 0)
+    {
+        rejected++;
+        return false;
+    }
+
+    inbox = &inboxes[inboxOf[header.from]];
+    if(header.count != inbox->value.size() || 
+       bytes != sizeof(header) + (size_t)header.count * sizeof(float) || 
+       header.tick <= inbox->tick)
+    {
+        rejected++;
+        return false;
+    }
+
+    inbox->previous.swap(inbox->value);
+    inbox->previousTick = inbox->tick;
+    memcpy(inbox->value.data(), (const uint8_t *)data + sizeof(header), 
+           (size_t)header.count * sizeof(float));
+    inbox->tick = header.tick;
+
+    return true;
+}
+
+uint64_t PIDClusterNode::
+PeerTickGet(unsigned peer) const
+{
+    if(peer >= inboxOf.size() || inboxOf[peer] < 0)
+    {
+        return 0;
+    }
+
+    return inboxes[inboxOf[peer]].tick;
+}
@@ -0,0 +1,403 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Runs one controller graph across several machines. A
+// PIDClusterPlan assigns every controller of the graph to a node, by hand or
+// balanced, and each node runs its share as a PIDGraph over its own PIDBank. The
+// edges that cross nodes, such as an outer loop on one machine feeding the
+// setpoint of an inner loop on another, are carried once per tick per pair of
+// nodes in one message of bare floats in an order both sides derive from the
+// plan, so nothing is serialized value by value. The receiver can extrapolate
+// over the ticks a message spent in flight.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_CLUSTER_H
+#define PID_CLUSTER_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_graph.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// "PIDC" in the byte order of the sender. A receiver of the other byte order
+// rejects the messages.
+#define PID_CLUSTER_MAGIC           0x43444950u
+
+// Nodes are numbered 0 to PID_CLUSTER_MAX_NODES - 1
+#define PID_CLUSTER_MAX_NODES       65536
+
+//
+// What a node does with a value from another node, which is at least a tick
+// old when it is used
+//
+// PID_CLUSTER_HOLD:        use the newest value as it is
+// PID_CLUSTER_EXTRAPOLATE: extrapolate the newest two values in a straight
+//                          line to the tick being run
+//
+typedef enum
+{
+    PID_CLUSTER_HOLD,
+    PID_CLUSTER_EXTRAPOLATE
+}
+PIDClusterCompensation;
+
+//
+// The header every message starts with. It is followed by count floats, the
+// outputs in the order both nodes derive from the plan: the source 
+// controllers of the edges from the sending node to the receiving node, in 
+// the order of their index in the graph, each once however many edges leave
+// it. Gains and offsets are applied by the receiver.
+//
+struct
+PIDClusterHeader
+{
+    uint32_t magic;
+    uint32_t planHash;
+    uint16_t from;
+    uint16_t to;
+    uint32_t count;
+    uint64_t tick;
+};
+
+//
+// A message to send to another node, valid until the next Tick
+//
+struct
+PIDClusterMessage
+{
+    unsigned peer;
+    const void *data;
+    size_t bytes;
+};
+
+//*********************************************************************************
+// Classes
+//*********************************************************************************
+
+//
+// The controller graph of the whole plant and which node runs each controller.
+// Every node builds the same plan; the hash of the plan in every message makes
+// sure they did.
+//
+class
+PIDClusterPlan
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates a plan of controllers 0 to controllers - 1, all on node
+        //      0, with no edges.
+        // Parameters:
+        //      controllers - Number of controllers in the whole graph.
+        // Returns:
+        //      Nothing.
+        //
+        explicit PIDClusterPlan(size_t controllers);
+
+        //
+        // Connect
+        // Description:
+        //      Adds an edge as PIDGraph::Connect does, from and to being
+        //      indices in the whole graph. An edge between two nodes delays
+        //      the value by at least a tick, so unlike on one node, edges may
+        //      form a cycle as long as it crosses nodes.
+        // Parameters:
+        //      As for PIDGraph::Connect.
+        // Returns:
+        //      False if either index is not in the graph or they are the same.
+        //      True otherwise.
+        //
+        bool Connect(size_t from, size_t to, PIDGraphPort port = PID_GRAPH_SETPOINT,
+                     float gain = 1.0f, float offset = 0.0f);
+
+        //
+        // Assign
+        // Description:
+        //      Runs a controller on a node.
+        // Parameters:
+        //      controller - Index of the controller in the graph.
+        //      node - Number of the node.
+        // Returns:
+        //      False if the controller is not in the graph or the node is not
+        //      below PID_CLUSTER_MAX_NODES. True otherwise.
+        //
+        bool Assign(size_t controller, unsigned node);
+
+        //
+        // Balance
+        // Description:
+        //      Assigns every controller so that each node runs about the same
+        //      number and few edges cross nodes. Controllers joined by edges
+        //      are kept on one node unless together they are more than an even
+        //      share, in which case they are cut into shares in breadth first
+        //      order along the edges. The pieces go largest first onto the 
+        //      least loaded node. Then every cycle is made to cross nodes: the
+        //      edges that close a cycle in depth first order must join two
+        //      nodes, and a controller on the same node as the other end of one
+        //      is moved to the least loaded node that keeps all its such edges
+        //      crossing. This can leave the nodes less even than a share.
+        // Parameters:
+        //      nodes - Number of nodes. 0 is taken as 1.
+        // Returns:
+        //      False if some cycle could not be made to cross nodes, as with
+        //      any cycle and one node, or a controller closing cycles with 
+        //      controllers on every node. Those nodes' Build then fails. True
+        //      otherwise.
+        //
+        bool Balance(unsigned nodes);
+
+        //
+        // Members
+        // Description:
+        //      The controllers a node runs, in the order of their index in the
+        //      graph. The node's PIDBank holds them in this order.
+        // Parameters:
+        //      node - Number of the node.
+        // Returns:
+        //      The indices in the graph of the node's controllers.
+        //
+        std::vector<size_t> Members(unsigned node) const;
+
+        //
+        // Hash
+        // Description:
+        //      FNV-1a over the assignment and the edges.
+        //
+        uint32_t Hash() const;
+
+        //
+        // Plan Information
+        //
+        inline size_t ControllerCount() const { return nodes.size(); }
+        inline unsigned NodeCount() const { return nodeCount; }
+        inline unsigned NodeGet(size_t controller) const { return nodes[controller]; }
+        size_t CutCount() const;
+
+    private:
+        friend class PIDClusterNode;
+
+        struct
+        Edge
+        {
+            uint32_t from;
+            uint32_t to;
+            PIDGraphPort port;
+            float gain;
+            float offset;
+        };
+
+        std::vector<unsigned> nodes;
+        std::vector<Edge> edges;
+        unsigned nodeCount;
+};
+
+//
+// The part of the graph one node runs. Every tick the node applies the
+// newest values received from other nodes, runs its PIDGraph and packs one
+// message per node its controllers feed. Carrying the messages is up to the
+// caller, over whatever transport the plant uses: each is a single buffer
+// that can be handed to send as it is, and Receive reads a message straight
+// out of the buffer it arrived in. Nodes are assumed to tick with the same 
+// period, counting ticks from the same start.
+//
+class
+PIDClusterNode
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates a node of a plan. The bank must already hold the
+        //      node's controllers, in the order of plan.Members(node), and 
+        //      must not have controllers added or removed afterwards. The 
+        //      plan is copied.
+        // Parameters:
+        //      plan - The plan every node was built from.
+        //      node - Number of this node.
+        //      bank - The node's controllers.
+        // Returns:
+        //      Nothing.
+        //
+        PIDClusterNode(const PIDClusterPlan &plan, unsigned node, PIDBank &bank);
+
+        PIDClusterNode(const PIDClusterNode &) = delete;
+        PIDClusterNode &operator=(const PIDClusterNode &) = delete;
+
+        //
+        // Rate Set
+        // Description:
+        //      As PIDGraph::RateSet, with index the controller's index in the
+        //      node's bank. Takes effect on the next Build.
+        //
+        inline void RateSet(size_t index, unsigned divider) { graph.RateSet(index, divider); }
+
+        //
+        // Compensation Set
+        // Description:
+        //      Chooses what is done with values that are one or more ticks
+        //      old. Values older than maxTicks are extrapolated as if they 
+        //      were maxTicks old, so that a node that has stopped sending does
+        //      not drive the values it fed off to infinity. The default is
+        //      PID_CLUSTER_HOLD.
+        // Parameters:
+        //      compensation - PID_CLUSTER_HOLD or PID_CLUSTER_EXTRAPOLATE.
+        //      maxTicks - Age past which the extrapolation stops.
+        // Returns:
+        //      Nothing.
+        //
+        void CompensationSet(PIDClusterCompensation compensation, unsigned maxTicks = 4);
+
+        //
+        // Build
+        // Description:
+        //      Builds the node's PIDGraph from the edges within the node and
+        //      the message layouts from the edges that cross nodes.
+        // Parameters:
+        //      As for PIDGraph::Build.
+        // Returns:
+        //      False if the bank does not hold the node's controllers or the
+        //      edges within the node form a cycle. True otherwise.
+        //
+        bool Build(unsigned threads = 1, bool pinThreads = false, unsigned firstCpu = 0);
+
+        //
+        // Tick
+        // Description:
+        //      Writes the values received from other nodes into the setpoints
+        //      and inputs they feed, runs the node's graph and packs the 
+        //      outputs for the other nodes into the messages.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of the tick that was just run, starting at 1.
+        //
+        uint64_t Tick();
+
+        //
+        // Messages
+        // Description:
+        //      The messages the last Tick packed, one for every node fed by
+        //      this one, sent with the number of the tick they were packed 
+        //      on. The buffers are reused by the next Tick.
+        //
+        inline size_t MessageCount() const { return outboxes.size(); }
+        const PIDClusterMessage &MessageGet(size_t message) const;
+
+        //
+        // Receive
+        // Description:
+        //      Takes in a message from another node. The values are used from
+        //      the next Tick on. The buffer can be reused once this returns.
+        // Parameters:
+        //      data - The message as it was sent.
+        //      bytes - Its length.
+        // Returns:
+        //      False, ignoring the message, if it is not for this node or this
+        //      plan, is malformed, or is no newer than the last one from its
+        //      sender, as when the transport reorders or duplicates messages.
+        //      True otherwise.
+        //
+        bool Receive(const void *data, size_t bytes);
+
+        //
+        // Node Information
+        //
+        inline unsigned NodeGet() const { return node; }
+        inline uint64_t TickCount() const { return tickCount; }
+        inline uint64_t RejectedCount() const { return rejected; }
+        uint64_t PeerTickGet(unsigned peer) const;
+
+    private:
+        //
+        // Where a received value is written
+        //
+        struct
+        Target
+        {
+            uint32_t slot;
+            float *target;
+            float gain;
+            float offset;
+        };
+
+        //
+        // The values from one other node, the newest and the one before
+        //
+        struct
+        Inbox
+        {
+            unsigned peer;
+            uint64_t tick;
+            uint64_t previousTick;
+            std::vector<float> value;
+            std::vector<float> previous;
+            std::vector<Target> targets;
+        };
+
+        //
+        // The message to one other node and the controllers it carries, by
+        // index in the node's bank
+        //
+        struct
+        Outbox
+        {
+            PIDClusterMessage message;
+            std::vector<uint32_t> sources;
+            std::vector<uint8_t> buffer;
+        };
+
+        PIDClusterPlan plan;
+        unsigned node;
+        PIDBank &bank;
+        PIDGraph graph;
+        bool connected;
+        uint32_t planHash;
+        std::vector<Inbox> inboxes;
+        std::vector<int32_t> inboxOf;
+        std::vector<Outbox> outboxes;
+        PIDClusterCompensation compensation;
+        unsigned maxTicks;
+        uint64_t tickCount;
+        uint64_t rejected;
+};
+
+#endif  // PID_CLUSTER_H
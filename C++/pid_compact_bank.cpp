@@ -0,0 +1,276 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: A bank of controllers laid out for the smallest compute
+// footprint. Each controller's compute state is one 32 byte record, two to a
+// cache line, and the gains as the user set them, the direction and the sample
+// time live in a separate cold table that PIDCompute never reads.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include "pid_compact_bank.h"
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// PIDControl::PIDCompute on one hot record and its stream values
+//
+static inline void
+ComputeRecord(PIDHotRecord &record, float input, float setpoint, float &output)
+{
+    if(record.mode == MANUAL)
+    {
+        return;
+    }
+
+    PIDCoreUpdate(input, setpoint, &record.iTerm, &record.lastInput, &output,
+                  record.alteredKp, record.alteredKi, record.alteredKd, 0.0f,
+                  record.outMin, record.outMax, PID_CORE_CLAMPING);
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDCompactBank::
+PIDCompactBank(size_t capacity)
+{
+    hot.reserve(capacity);
+    input.reserve(capacity);
+    setpoint.reserve(capacity);
+    output.reserve(capacity);
+    cold.reserve(capacity);
+}
+
+size_t PIDCompactBank::
+PIDAdd(float kp, float ki, float kd, float sampleTimeSeconds, float minOutput,
+       float maxOutput, PIDMode mode, PIDDirection controllerDirection)
+{
+    size_t index = hot.size();
+    PIDHotRecord record;
+    PIDColdRecord coldRecord;
+
+    // The limits start out invalid on purpose so that a bad min/max pair
+    // leaves them the way PIDControl would leave its uninitialized members
+    record.alteredKp = 0.0f;
+    record.alteredKi = 0.0f;
+    record.alteredKd = 0.0f;
+    record.iTerm = 0.0f;
+    record.lastInput = 0.0f;
+    record.outMin = 0.0f;
+    record.outMax = 0.0f;
+    record.mode = (uint32_t)mode;
+
+    coldRecord.dispKp = 0.0f;
+    coldRecord.dispKi = 0.0f;
+    coldRecord.dispKd = 0.0f;
+
+    // If the passed parameter was incorrect, set to 1 second
+    coldRecord.sampleTime = (sampleTimeSeconds > 0.0f) ? sampleTimeSeconds : 1.0f;
+    coldRecord.controllerDirection = controllerDirection;
+
+    hot.push_back(record);
+    cold.push_back(coldRecord);
+    input.push_back(0.0f);
+    setpoint.push_back(0.0f);
+    output.push_back(0.0f);
+
+    PIDOutputLimitsSet(index, minOutput, maxOutput);
+    PIDTuningsSet(index, kp, ki, kd);
+
+    return index;
+}
+
+size_t PIDCompactBank::
+PIDRemove(size_t index)
+{
+    hot[index] = hot.back();
+    hot.pop_back();
+    cold[index] = cold.back();
+    cold.pop_back();
+    input[index] = input.back();
+    input.pop_back();
+    setpoint[index] = setpoint.back();
+    setpoint.pop_back();
+    output[index] = output.back();
+    output.pop_back();
+
+    return hot.size();
+}
+
+void PIDCompactBank::
+ComputeAll()
+{
+    ComputeRange(0, hot.size());
+}
+
+void PIDCompactBank::
+ComputeRange(size_t first, size_t last)
+{
+    PIDHotRecord *records = hot.data();
+    const float *in = input.data();
+    const float *target = setpoint.data();
+    float *out = output.data();
+
+    for(size_t i = first; i < last; i++)
+    {
+        ComputeRecord(records[i], in[i], target[i], out[i]);
+    }
+}
+
+bool PIDCompactBank::
+PIDCompute(size_t index)
+{
+    if(hot[index].mode == MANUAL)
+    {
+        return false;
+    }
+
+    ComputeRecord(hot[index], input[index], setpoint[index], output[index]);
+
+    return true;
+}
+
+void PIDCompactBank::
+PIDModeSet(size_t index, PIDMode mode)
+{
+    PIDHotRecord &record = hot[index];
+
+    // If the mode changed from MANUAL to AUTOMATIC
+    if(record.mode != (uint32_t)mode && mode == AUTOMATIC)
+    {
+        // Initialize a few PID parameters to new values
+        record.iTerm = output[index];
+        record.lastInput = input[index];
+
+        // Constrain the integrator to make sure it does not exceed output bounds
+        record.iTerm = PIDCoreConstrain(record.iTerm, record.outMin, record.outMax);
+    }
+
+    record.mode = (uint32_t)mode;
+}
+
+void PIDCompactBank::
+PIDOutputLimitsSet(size_t index, float min, float max)
+{
+    PIDHotRecord &record = hot[index];
+
+    // Check if the parameters are valid
+    if(min >= max)
+    {
+        return;
+    }
+
+    // Save the parameters
+    record.outMin = min;
+    record.outMax = max;
+
+    // If in automatic, apply the new constraints
+    if(record.mode == AUTOMATIC)
+    {
+        output[index] = PIDCoreConstrain(output[index], min, max);
+        record.iTerm  = PIDCoreConstrain(record.iTerm,  min, max);
+    }
+}
+
+void PIDCompactBank::
+PIDTuningsSet(size_t index, float kp, float ki, float kd)
+{
+    PIDHotRecord &record = hot[index];
+    PIDColdRecord &coldRecord = cold[index];
+
+    // Check if the parameters are valid
+    if(kp < 0.0f || ki < 0.0f || kd < 0.0f)
+    {
+        return;
+    }
+
+    // Save the parameters for displaying purposes
+    coldRecord.dispKp = kp;
+    coldRecord.dispKi = ki;
+    coldRecord.dispKd = kd;
+
+    // Alter the parameters for PID, reversed if necessary
+    PIDCoreGains(kp, ki, kd, coldRecord.sampleTime, coldRecord.controllerDirection == REVERSE,
+                 &record.alteredKp, &record.alteredKi, &record.alteredKd);
+}
+
+void PIDCompactBank::
+PIDTuningKpSet(size_t index, float kp)
+{
+    PIDTuningsSet(index, kp, cold[index].dispKi, cold[index].dispKd);
+}
+
+void PIDCompactBank::
+PIDTuningKiSet(size_t index, float ki)
+{
+    PIDTuningsSet(index, cold[index].dispKp, ki, cold[index].dispKd);
+}
+
+void PIDCompactBank::
+PIDTuningKdSet(size_t index, float kd)
+{
+    PIDTuningsSet(index, cold[index].dispKp, cold[index].dispKi, kd);
+}
+
+void PIDCompactBank::
+PIDControllerDirectionSet(size_t index, PIDDirection controllerDirection)
+{
+    PIDHotRecord &record = hot[index];
+
+    // If in automatic mode and the controller's sense of direction is reversed
+    if(record.mode == AUTOMATIC && controllerDirection == REVERSE)
+    {
+        // Reverse sense of direction of PID gain constants
+        PIDCoreGainsReverse(&record.alteredKp, &record.alteredKi, &record.alteredKd);
+    }
+
+    cold[index].controllerDirection = controllerDirection;
+}
+
+void PIDCompactBank::
+PIDSampleTimeSet(size_t index, float sampleTimeSeconds)
+{
+    float ratio;
+
+    if(sampleTimeSeconds > 0.0f)
+    {
+        // Find the ratio of change and apply to the altered values
+        ratio = sampleTimeSeconds / cold[index].sampleTime;
+        PIDCoreSampleTimeScale(ratio, &hot[index].alteredKi, &hot[index].alteredKd);
+
+        // Save the new sampling time
+        cold[index].sampleTime = sampleTimeSeconds;
+    }
+}
@@ -0,0 +1,200 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: A bank of controllers laid out for the smallest compute
+// footprint. Each controller's compute state is one 32 byte record, two to a
+// cache line, and the gains as the user set them, the direction and the sample
+// time live in a separate cold table that PIDCompute never reads.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_COMPACT_BANK_H
+#define PID_COMPACT_BANK_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "pid_controller.h"
+#include "pid_aligned_allocator.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Everything PIDCompute reads and writes besides the input, setpoint and
+// output streams. mode holds a PIDMode.
+//
+struct alignas(32)
+PIDHotRecord
+{
+    float alteredKp;
+    float alteredKi;
+    float alteredKd;
+    float iTerm;
+    float lastInput;
+    float outMin;
+    float outMax;
+    uint32_t mode;
+};
+
+static_assert(sizeof(PIDHotRecord) == 32, "hot record is half a cache line");
+
+//
+// Only read by the getters and the tuning setters
+//
+struct
+PIDColdRecord
+{
+    float dispKp;
+    float dispKi;
+    float dispKd;
+    float sampleTime;
+    PIDDirection controllerDirection;
+};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class
+PIDCompactBank
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates an empty bank with room for capacity controllers.
+        // Parameters:
+        //      capacity - Number of controllers to reserve storage for.
+        // Returns:
+        //      Nothing.
+        //
+        explicit PIDCompactBank(size_t capacity = 0);
+
+        //
+        // PID Add
+        // Description:
+        //      Appends a new controller to the bank. The controller is initialized
+        //      exactly as the PIDControl constructor would initialize it.
+        // Parameters:
+        //      Same as the PIDControl constructor.
+        // Returns:
+        //      The index of the new controller within the bank.
+        //
+        size_t PIDAdd(float kp, float ki, float kd, float sampleTimeSeconds,
+                      float minOutput, float maxOutput, PIDMode mode,
+                      PIDDirection controllerDirection);
+
+        //
+        // PID Remove
+        // Description:
+        //      Same as PIDBank::PIDRemove.
+        //
+        size_t PIDRemove(size_t index);
+
+        //
+        // Compute All and Compute Range
+        // Description:
+        //      Runs PIDCompute on every controller in the bank, or on those in
+        //      [first, last). The math is identical to PIDControl::PIDCompute,
+        //      and each controller touches its 32 byte record plus one float
+        //      of each of the input, setpoint and output streams. The compact
+        //      layout has no deadband, timed compute, setpoint weighting,
+        //      derivative filter or anti-windup strategy other than CLAMPING;
+        //      use PIDBank for those.
+        // Parameters:
+        //      first - Index of the first controller to compute.
+        //      last - One past the index of the last controller to compute.
+        // Returns:
+        //      Nothing.
+        //
+        void ComputeAll();
+        void ComputeRange(size_t first, size_t last);
+
+        //
+        // Per Controller Functions
+        // Description:
+        //      These behave exactly like the PIDControl member functions of the
+        //      same name, applied to the controller at index.
+        //
+        bool PIDCompute(size_t index);
+        void PIDModeSet(size_t index, PIDMode mode);
+        void PIDOutputLimitsSet(size_t index, float min, float max);
+        void PIDTuningsSet(size_t index, float kp, float ki, float kd);
+        void PIDTuningKpSet(size_t index, float kp);
+        void PIDTuningKiSet(size_t index, float ki);
+        void PIDTuningKdSet(size_t index, float kd);
+        void PIDControllerDirectionSet(size_t index,
+                                       PIDDirection controllerDirection);
+        void PIDSampleTimeSet(size_t index, float sampleTimeSeconds);
+
+        inline void PIDSetpointSet(size_t index, float value) { setpoint[index] = value; }
+        inline void PIDInputSet(size_t index, float value) { input[index] = value; }
+        inline float PIDOutputGet(size_t index) const { return output[index]; }
+        inline float PIDKpGet(size_t index) const { return cold[index].dispKp; }
+        inline float PIDKiGet(size_t index) const { return cold[index].dispKi; }
+        inline float PIDKdGet(size_t index) const { return cold[index].dispKd; }
+        inline float PIDSampleTimeGet(size_t index) const { return cold[index].sampleTime; }
+        inline PIDMode PIDModeGet(size_t index) const { return (PIDMode)hot[index].mode; }
+        inline PIDDirection PIDDirectionGet(size_t index) const
+        {
+            return cold[index].controllerDirection;
+        }
+
+        //
+        // Array Access
+        // Description:
+        //      Direct access to the contiguous input, setpoint and output
+        //      streams and to the hot records.
+        //
+        inline float *InputData() { return input.data(); }
+        inline float *SetpointData() { return setpoint.data(); }
+        inline const float *OutputData() const { return output.data(); }
+        inline const PIDHotRecord *HotData() const { return hot.data(); }
+
+        inline size_t Size() const { return hot.size(); }
+
+    private:
+        typedef std::vector<float, PIDAlignedAllocator<float> > FloatArray;
+
+        std::vector<PIDHotRecord, PIDAlignedAllocator<PIDHotRecord> > hot;
+        FloatArray input;
+        FloatArray setpoint;
+        FloatArray output;
+        std::vector<PIDColdRecord> cold;
+};
+
+#endif  // PID_COMPACT_BANK_H
@@ -37,95 +37,306 @@
 // Headers
 //*********************************************************************************
 #include "pid_controller.h"
+#include "pid_checkpoint.h"
+#include <type_traits>
 
 //*********************************************************************************
 // Macros and Globals
 //*********************************************************************************
-#define CONSTRAIN(x,lower,upper)    ((x)<(lower)?(lower):((x)>(upper)?(upper):(x)))
+// 
+// Keep every multiply and add rounded on its own so that PIDCompute matches
+// the batched PIDBank kernels bit for bit, even when FMA is available.
+// 
+#if defined(__clang__)
+    #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+    #pragma GCC optimize ("fp-contract=off")
+#endif
 
 //*********************************************************************************
 // Public Class Functions
 //*********************************************************************************
 
-PIDControl::
-PIDControl (float kp, float ki, float kd, float sampleTimeSeconds, float minOutput, 
-            float maxOutput, PIDMode mode, PIDDirection controllerDirection)     	
+template <typename T, typename Instrumentation>
+BasicPIDControl<T, Instrumentation>::
+BasicPIDControl(T kp, T ki, T kd, T sampleTimeSeconds, T minOutput, T maxOutput, 
+                PIDMode mode, PIDDirection controllerDirection)     	
 {
-    controllerDirection = controllerDirection;
-    mode = mode;
-    iTerm = 0.0f;
-    input = 0.0f;
-    lastInput = 0.0f;
-    output = 0.0f;
-    setpoint = 0.0f;
+    this->controllerDirection = controllerDirection;
+    this->mode = mode;
+    iTerm = T(0);
+    input = T(0);
+    lastInput = T(0);
+    output = T(0);
+    setpoint = T(0);
     
-    if(sampleTimeSeconds > 0.0f)
+    if(sampleTimeSeconds > T(0))
     {
         sampleTime = sampleTimeSeconds;
     }
     else
     {
         // If the passed parameter was incorrect, set to 1 second
-        sampleTime = 1.0f;
+        sampleTime = T(1);
     }
     
+    sampleRate = T(1) / sampleTime;
+    lastTime = 0;
+    timeValid = false;
+    deadband = T(-1);
+    lastSetpoint = T(0);
+    outputChanged = false;
+    forceCompute = true;
+    antiWindup = CLAMPING;
+    dispKt = T(0);
+    alteredKt = T(0);
+    setpointWeightB = T(1);
+    setpointWeightC = T(0);
+    filterN = T(0);
+    dTerm = T(0);
+    weighted = false;
+    
     PIDOutputLimitsSet(minOutput, maxOutput);
     PIDTuningsSet(kp, ki, kd);
 }
         
-bool PIDControl::
-PIDCompute() 
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDDeadbandSet(T deadband) 
 {
-    float error, dInput;
+    this->deadband = deadband;
+    forceCompute = true;
+}
+
+template <typename T, typename Instrumentation>
+bool BasicPIDControl<T, Instrumentation>::
+PIDCompute(uint32_t timestampMicros) 
+{
+    // The interval ratio is formed in at least float, as a _Float16 cannot 
+    // hold an interval above 65 ms in microseconds
+    typedef decltype(T(0) + 0.0f) Wide;
+    
+    T iScale, dScale, alpha, kdFiltered;
+    Wide ratio;
+    uint64_t start;
+    unsigned flags;
 
     if(mode == MANUAL)
     {
         return false;
     }
     
-    // The classic PID error term
-    error = setpoint - input;
+    if(timeValid)
+    {
+        // Unsigned subtraction gives the right interval across a wrap
+        ratio = Wide(timestampMicros - lastTime) * Wide(1e-6f) * Wide(sampleRate);
+        
+        // The caller is polling faster than the sample time
+        if(ratio < Wide(0.5f))
+        {
+            return false;
+        }
+        
+        // A gap of more than a few sample times is a restart, and the 
+        // derivative is not taken across it
+        if(ratio > Wide(PID_CORE_INTERVAL_MAX))
+        {
+            lastInput = input;
+            lastSetpoint = setpoint;
+            dTerm = T(0);
+            timeValid = false;
+        }
+        
+        iScale = T(ratio);
+        dScale = T(Wide(1) / ratio);
+    }
+    
+    // The first interval, and the first after a restart, is taken to be the 
+    // nominal sample time
+    if(!timeValid)
+    {
+        iScale = T(1);
+        dScale = T(1);
+        timeValid = true;
+    }
+    
+    lastTime = timestampMicros;
+    start = this->StatsBegin();
+    
+    // The same steps as PIDCompute with the gains scaled to the interval.
+    // The filter coefficients do not scale linearly, so they are worked out
+    // again for it.
+    if(weighted)
+    {
+        PIDCoreFilter(T(alteredKd * dScale), filterN, T(sampleTime * iScale), 
+                      &alpha, &kdFiltered);
+        flags = PIDCoreUpdateWeighted(input, setpoint, &iTerm, &lastInput, 
+                                      &lastSetpoint, &dTerm, &output, alteredKp, 
+                                      T(alteredKi * iScale), T(alteredKt * iScale), 
+                                      setpointWeightB, setpointWeightC, alpha, 
+                                      kdFiltered, outMin, outMax, antiWindup);
+    }
+    else
+    {
+        flags = PIDCoreUpdate(input, setpoint, &iTerm, &lastInput, &output, 
+                              alteredKp, T(alteredKi * iScale), 
+                              T(alteredKd * dScale), T(alteredKt * iScale), 
+                              outMin, outMax, antiWindup);
+    }
+    
+    this->StatsEnd(start, 1, (flags & PID_CORE_SATURATED) != 0, 
+                   (flags & PID_CORE_CLAMPED) != 0);
+    
+    return true;
+}
+     
+template <typename T, typename Instrumentation>
+bool BasicPIDControl<T, Instrumentation>::
+PIDComputeBlock(const T *inputs, const T *setpoints, T *outputs, size_t n)
+{
+    T in, out;
+    T sp = setpoint;
+    T integral = iTerm;
+    T previous = lastInput;
+    T kp = alteredKp;
+    T ki = alteredKi;
+    T kd = alteredKd;
+    T kt = alteredKt;
+    PIDAntiWindup strategy = antiWindup;
+    T previousSetpoint = lastSetpoint;
+    T derivative = dTerm;
+    T b = setpointWeightB;
+    T c = setpointWeightC;
+    T alpha = filterAlpha;
+    T kdFiltered = filterKd;
+    bool twoDegree = weighted;
+    T lower = outMin;
+    T upper = outMax;
+    uint64_t start, clamped = 0, saturated = 0;
+    unsigned flags;
+    
+    if(n == 0)
+    {
+        return mode == AUTOMATIC;
+    }
+    
+    if(mode == MANUAL)
+    {
+        // Nothing is computed, but the last input and setpoint are kept just
+        // like PIDInputSet and PIDSetpointSet would have
+        for(size_t i = 0; i < n; i++)
+        {
+            outputs[i] = output;
+        }
+        input = inputs[n - 1];
+        if(setpoints)
+        {
+            setpoint = setpoints[n - 1];
+        }
+        return false;
+    }
+    
+    start = this->StatsBegin();
     
-    // Compute the integral term separately ahead of time
-    iTerm += alteredKi * error;
+    // The state lives in locals for the whole block
+    for(size_t i = 0; i < n; i++)
+    {
+        in = inputs[i];
+        if(setpoints)
+        {
+            sp = setpoints[i];
+        }
+        
+        // The same steps as PIDCompute
+        if(twoDegree)
+        {
+            flags = PIDCoreUpdateWeighted(in, sp, &integral, &previous, 
+                                          &previousSetpoint, &derivative, &out, kp, 
+                                          ki, kt, b, c, alpha, kdFiltered, lower, 
+                                          upper, strategy);
+        }
+        else
+        {
+            flags = PIDCoreUpdate(in, sp, &integral, &previous, &out, kp, ki, kd, 
+                                  kt, lower, upper, strategy);
+        }
+        if(Instrumentation::enabled)
+        {
+            clamped += (flags & PID_CORE_CLAMPED) != 0;
+            saturated += (flags & PID_CORE_SATURATED) != 0;
+        }
+        
+        outputs[i] = out;
+    }
     
-    // Constrain the integrator to make sure it does not exceed output bounds
-    iTerm = CONSTRAIN(iTerm, outMin, outMax);
+    this->StatsEnd(start, n, saturated, clamped);
     
-    // Take the "derivative on measurement" instead of "derivative on error"
-    dInput = input - lastInput;
+    input = in;
+    setpoint = sp;
+    iTerm = integral;
+    lastInput = previous;
+    lastSetpoint = twoDegree ? previousSetpoint : lastSetpoint;
+    dTerm = derivative;
+    output = out;
     
-    // Run all the terms together to get the overall output
-    output = alteredKp * error + iTerm - alteredKd * dInput;
+    return true;
+}
+     
+template <typename T, typename Instrumentation>
+bool BasicPIDControl<T, Instrumentation>::
+PIDComputeBound(const BasicPIDBinding<T> &binding)
+{
+    // Read the process image in place
+    if(binding.input)
+    {
+        input = *(binding.input);
+    }
+    if(binding.setpoint)
+    {
+        setpoint = *(binding.setpoint);
+    }
     
-    // Bound the output
-    output = CONSTRAIN(output, outMin, outMax);
+    if(!PIDCompute())
+    {
+        return false;
+    }
     
-    // Make the current input the former input
-    lastInput = input;
+    // Write the process image in place
+    if(binding.output)
+    {
+        *(binding.output) = output;
+    }
     
     return true;
 }
      
-void PIDControl::
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
 PIDModeSet(PIDMode mode)                                                                                                                                       
 {
     // If the mode changed from MANUAL to AUTOMATIC
-    if(mode != mode && mode == AUTOMATIC)
+    if(this->mode != mode && mode == AUTOMATIC)
     {
         // Initialize a few PID parameters to new values
         iTerm = output;
         lastInput = input;
+        lastSetpoint = setpoint;
+        dTerm = T(0);
         
         // Constrain the integrator to make sure it does not exceed output bounds
-        iTerm = CONSTRAIN(iTerm, outMin, outMax);
+        iTerm = PIDCoreConstrain(iTerm, outMin, outMax);
+        
+        // The timed PIDCompute has no interval to go by until its next call
+        timeValid = false;
+        forceCompute = true;
     }
     
-    mode = mode;
+    this->mode = mode;
 }
 
-void PIDControl::
-PIDOutputLimitsSet(float min, float max) 							  							  
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDOutputLimitsSet(T min, T max) 							  							  
 {
     // Check if the parameters are valid
     if(min >= max)
@@ -136,20 +347,22 @@ PIDOutputLimitsSet(float min, float max)
     // Save the parameters
     outMin = min;
     outMax = max;
+    forceCompute = true;
     
     // If in automatic, apply the new constraints
     if(mode == AUTOMATIC)
     {
-        output = CONSTRAIN(output, min, max);
-        iTerm  = CONSTRAIN(iTerm,  min, max);
+        output = PIDCoreConstrain(output, min, max);
+        iTerm  = PIDCoreConstrain(iTerm,  min, max);
     }
 }
 
-void PIDControl::
-PIDTuningsSet(float kp, float ki, float kd)         	                                         
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDTuningsSet(T kp, T ki, T kd)         	                                         
 {
     // Check if the parameters are valid
-    if(kp < 0.0f || ki < 0.0f || kd < 0.0f)
+    if(kp < T(0) || ki < T(0) || kd < T(0))
     {
         return;
     }
@@ -159,68 +372,253 @@ PIDTuningsSet(float kp, float ki, float kd)
     dispKi = ki;
     dispKd = kd;
     
-    // Alter the parameters for PID
-    alteredKp = kp;
-    alteredKi = ki * sampleTime;
-    alteredKd = kd / sampleTime;
-    
-    // Apply reverse direction to the altered values if necessary
-    if(controllerDirection == REVERSE)
-    {
-        alteredKp = -(alteredKp);
-        alteredKi = -(alteredKi);
-        alteredKd = -(alteredKd);
-    }
+    // Alter the parameters for PID, reversed if necessary
+    PIDCoreGains(kp, ki, kd, sampleTime, controllerDirection == REVERSE, 
+                 &alteredKp, &alteredKi, &alteredKd);
+    PIDCoreFilter(alteredKd, filterN, sampleTime, &filterAlpha, &filterKd);
+    forceCompute = true;
 }
 
-void PIDControl::
-PIDTuningKpSet(float kp)
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDTuningKpSet(T kp)
 {
     PIDTuningsSet(kp, dispKi, dispKd);
 }
 
-void PIDControl::
-PIDTuningKiSet(float ki)
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDTuningKiSet(T ki)
 {
     PIDTuningsSet(dispKp, ki, dispKd);
 }
 
-void PIDControl::
-PIDTuningKdSet(float kd)
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDTuningKdSet(T kd)
 {
     PIDTuningsSet(dispKp, dispKi, kd);
 }
 
-void PIDControl::
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
 PIDControllerDirectionSet(PIDDirection controllerDirection)	  									  									  									  
 {
     // If in automatic mode and the controller's sense of direction is reversed
     if(mode == AUTOMATIC && controllerDirection == REVERSE)
     {
         // Reverse sense of direction of PID gain constants
-        alteredKp = -(alteredKp);
-        alteredKi = -(alteredKi);
-        alteredKd = -(alteredKd);
+        PIDCoreGainsReverse(&alteredKp, &alteredKi, &alteredKd);
+        filterKd = -filterKd;
     }
     
-    controllerDirection = controllerDirection;
+    this->controllerDirection = controllerDirection;
+    forceCompute = true;
 }
 
-void PIDControl::
-PIDSampleTimeSet(float sampleTimeSeconds)                                                       									  									  									   
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDSampleTimeSet(T sampleTimeSeconds)                                                       									  									  									   
 {
-    float ratio;
+    T ratio;
 
-    if(sampleTimeSeconds > 0.0f)
+    if(sampleTimeSeconds > T(0))
     {
         // Find the ratio of change and apply to the altered values
         ratio = sampleTimeSeconds / sampleTime;
-        alteredKi *= ratio;
-        alteredKd /= ratio;
+        PIDCoreSampleTimeScale(ratio, &alteredKi, &alteredKd);
+        alteredKt *= ratio;
         
         // Save the new sampling time
         sampleTime = sampleTimeSeconds;
+        sampleRate = T(1) / sampleTimeSeconds;
+        PIDCoreFilter(alteredKd, filterN, sampleTime, &filterAlpha, &filterKd);
+        forceCompute = true;
+    }
+}
+
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDAntiWindupSet(PIDAntiWindup antiWindup, T kt)
+{
+    // Check if the parameters are valid
+    if(kt < T(0))
+    {
+        return;
+    }
+    
+    // The tracking gain works on the output, so the direction does not 
+    // change its sign
+    this->antiWindup = antiWindup;
+    dispKt = kt;
+    alteredKt = kt * sampleTime;
+    forceCompute = true;
+}
+
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDSetpointWeightsSet(T b, T c)
+{
+    // Check if the parameters are valid
+    if(b < T(0) || c < T(0))
+    {
+        return;
+    }
+    
+    setpointWeightB = b;
+    setpointWeightC = c;
+    PIDWeightedUpdate();
+}
+
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDDerivativeFilterSet(T n)
+{
+    // Check if the parameters are valid
+    if(n < T(0))
+    {
+        return;
+    }
+    
+    filterN = n;
+    PIDCoreFilter(alteredKd, n, sampleTime, &filterAlpha, &filterKd);
+    PIDWeightedUpdate();
+}
+
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDWeightedUpdate()
+{
+    bool twoDegree = (setpointWeightB != T(1) || setpointWeightC != T(0) || 
+                      filterN > T(0));
+    
+    // The plain law does not keep the weighted law's state up to date
+    if(twoDegree && !weighted)
+    {
+        lastSetpoint = setpoint;
+        dTerm = T(0);
+    }
+    
+    weighted = twoDegree;
+    forceCompute = true;
+}
+
+template <typename T, typename Instrumentation>
+void BasicPIDControl<T, Instrumentation>::
+PIDCheckpointSave(PIDCheckpointRecord &record) const
+{
+    record.input = float(input);
+    record.lastInput = float(lastInput);
+    record.output = float(output);
+    record.iTerm = float(iTerm);
+    record.setpoint = float(setpoint);
+    record.dispKp = float(dispKp);
+    record.dispKi = float(dispKi);
+    record.dispKd = float(dispKd);
+    record.alteredKp = float(alteredKp);
+    record.alteredKi = float(alteredKi);
+    record.alteredKd = float(alteredKd);
+    record.sampleTime = float(sampleTime);
+    record.outMin = float(outMin);
+    record.outMax = float(outMax);
+    record.deadband = float(deadband);
+    record.mode = (uint8_t)mode;
+    record.controllerDirection = (uint8_t)controllerDirection;
+    record.antiWindup = (uint8_t)antiWindup;
+    record.reserved = 0;
+    record.dispKt = float(dispKt);
+    record.setpointWeightB = float(setpointWeightB);
+    record.setpointWeightC = float(setpointWeightC);
+    record.filterN = float(filterN);
+    record.dTerm = float(dTerm);
+    record.lastSetpoint = float(lastSetpoint);
+    memset(record.padding, 0, sizeof(record.padding));
+}
+
+template <typename T, typename Instrumentation>
+bool BasicPIDControl<T, Instrumentation>::
+PIDCheckpointRestore(const PIDCheckpointRecord &record)
+{
+    if(!PIDCheckpointRecordValid(record))
+    {
+        return false;
     }
+    
+    input = T(record.input);
+    lastInput = T(record.lastInput);
+    output = T(record.output);
+    iTerm = T(record.iTerm);
+    setpoint = T(record.setpoint);
+    dispKp = T(record.dispKp);
+    dispKi = T(record.dispKi);
+    dispKd = T(record.dispKd);
+    alteredKp = T(record.alteredKp);
+    alteredKi = T(record.alteredKi);
+    alteredKd = T(record.alteredKd);
+    sampleTime = T(record.sampleTime);
+    outMin = T(record.outMin);
+    outMax = T(record.outMax);
+    deadband = T(record.deadband);
+    mode = (PIDMode)record.mode;
+    controllerDirection = (PIDDirection)record.controllerDirection;
+    antiWindup = (PIDAntiWindup)record.antiWindup;
+    dispKt = T(record.dispKt);
+    setpointWeightB = T(record.setpointWeightB);
+    setpointWeightC = T(record.setpointWeightC);
+    filterN = T(record.filterN);
+    dTerm = T(record.dTerm);
+    lastSetpoint = T(record.lastSetpoint);
+    
+    // The coefficients worked out from the settings are altered for the 
+    // restored gains and sample time, and the state that is not saved starts
+    // over. The weighted law is chosen as PIDWeightedUpdate does.
+    sampleRate = T(1) / sampleTime;
+    alteredKt = dispKt * sampleTime;
+    PIDCoreFilter(alteredKd, filterN, sampleTime, &filterAlpha, &filterKd);
+    weighted = (setpointWeightB != T(1) || setpointWeightC != T(0) || filterN > T(0));
+    lastTime = 0;
+    timeValid = false;
+    outputChanged = false;
+    forceCompute = true;
+    
+    return true;
 }
 
+//*********************************************************************************
+// Explicit Instantiations
+//*********************************************************************************
+template class BasicPIDControl<float, PIDInstrumentationNone>;
+template class BasicPIDControl<float, PIDInstrumentationCounters>;
+template class BasicPIDControl<double, PIDInstrumentationNone>;
+template class BasicPIDControl<double, PIDInstrumentationCounters>;
+
+#if defined(PID_HAS_FLOAT16)
+    template class BasicPIDControl<_Float16, PIDInstrumentationNone>;
+    template class BasicPIDControl<_Float16, PIDInstrumentationCounters>;
+#endif
+
+//*********************************************************************************
+// Real Time Contract
+//*********************************************************************************
+// 
+// What PIDComputeConstantTime promises is checked here rather than trusted: 
+// it cannot throw, and an uninstrumented controller owns nothing on the heap,
+// so copying one into a real time thread allocates nothing and it never 
+// needs freeing. tools/pid_wcet.cpp is built without exceptions to catch the
+// rest.
+// 
+template <typename T>
+struct
+PIDRealTimeCheck
+{
+    typedef BasicPIDControl<T, PIDInstrumentationNone> Controller;
+
+    static_assert(noexcept(std::declval<Controller&>().PIDComputeConstantTime()), 
+                  "PIDComputeConstantTime must not throw");
+    static_assert(std::is_trivially_copyable<Controller>::value && 
+                  std::is_trivially_destructible<Controller>::value, 
+                  "an uninstrumented controller must not own heap memory");
+};
 
+template struct PIDRealTimeCheck<float>;
+template struct PIDRealTimeCheck<double>;
@@ -42,8 +42,11 @@
 //*********************************************************************************
 // Headers
 //*********************************************************************************
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "pid_core.h"
+#include "pid_instrumentation.h"
 
 //*********************************************************************************
 // Macros and Globals
@@ -63,12 +66,47 @@ typedef enum
 }
 PIDDirection;
 
+// 
+// What the integrator does while the output is held at a limit, see 
+// PIDAntiWindupSet
+// 
+typedef enum
+{
+    CLAMPING = PID_CORE_CLAMPING,
+    CONDITIONAL_INTEGRATION = PID_CORE_CONDITIONAL,
+    BACK_CALCULATION = PID_CORE_BACK_CALCULATION
+}
+PIDAntiWindup;
+
+// 
+// Locations outside of the controller, such as a shared memory process image
+// or memory mapped registers, that PIDComputeBound reads its input and
+// setpoint from and writes its output to. Any of them may be nullptr to use
+// the controller's own field instead.
+// 
+template <typename T>
+struct
+BasicPIDBinding
+{
+    const volatile T *input;
+    const volatile T *setpoint;
+    volatile T *output;
+};
+
+typedef BasicPIDBinding<float> PIDBinding;
+
+// 
+// One controller of a checkpoint, see pid_checkpoint.h
+// 
+struct PIDCheckpointRecord;
+
 //*********************************************************************************
 // Class
 //*********************************************************************************
 
+template <typename T, typename Instrumentation = PIDInstrumentationDefault>
 class
-PIDControl
+BasicPIDControl : private Instrumentation
 {
     public:
         // 
@@ -97,9 +135,9 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        PIDControl(float kp, float ki, float kd, float sampleTimeSeconds, 
-                   float minOutput, float maxOutput, PIDMode mode, 
-                   PIDDirection controllerDirection);     	
+        BasicPIDControl(T kp, T ki, T kd, T sampleTimeSeconds, 
+                        T minOutput, T maxOutput, PIDMode mode, 
+                        PIDDirection controllerDirection);     	
         
         // 
         // PID Compute
@@ -112,7 +150,108 @@ PIDControl
         // Returns:
         //      True if in AUTOMATIC. False if in MANUAL.
         //                     
-        bool PIDCompute(); 
+        inline bool PIDCompute(); 
+        
+        // 
+        // PID Compute Constant Time
+        // Description:
+        //      PIDCompute for hard real time loops. It runs the same 
+        //      instructions whatever the mode, the settings and the values,
+        //      with no branch on any of them, cannot throw and does not 
+        //      allocate, so its worst case is its every case. The results are
+        //      bit identical to PIDCompute's, except that the deadband is 
+        //      ignored and the instrumentation is not told. Building with 
+        //      PID_REAL_TIME defined makes PIDCompute call it.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      True if in AUTOMATIC. False if in MANUAL.
+        // 
+        inline bool PIDComputeConstantTime() noexcept; 
+        
+        // 
+        // PID Compute
+        // Description:
+        //      Same as PIDCompute, but for callers that cannot guarantee the 
+        //      call interval. The time since the last computing call is taken 
+        //      from the timestamp, and the I and D terms are scaled by its ratio
+        //      to the sample time, so no PIDSampleTimeSet is needed when the 
+        //      interval drifts. A call less than half a sample time after the 
+        //      last one is treated as over polling and computes nothing. A gap 
+        //      of more than PID_CORE_INTERVAL_MAX (4) sample times, such as 
+        //      after the caller stalled, is treated as a restart: the 
+        //      derivative starts over from the current input, the integrator 
+        //      is kept, and the call computes with the nominal sample time, as
+        //      the first call and the first call after switching to AUTOMATIC
+        //      do. Do not mix with the untimed PIDCompute on the same 
+        //      controller.
+        // Parameters:
+        //      timestampMicros - A monotonic clock in microseconds. It may wrap
+        //          around.
+        // Returns:
+        //      True if a new output was computed. False if in MANUAL or called
+        //      early.
+        // 
+        bool PIDCompute(uint32_t timestampMicros); 
+        
+        // 
+        // PID Deadband Set
+        // Description:
+        //      Turns on deadband mode, in which PIDCompute leaves the controller
+        //      at rest instead of updating it when nothing has moved: the input
+        //      and the setpoint are within the deadband of their values at the 
+        //      last compute, the error is within the deadband or the 
+        //      integrator is already held at the limit the error pushes it 
+        //      into, and the output carries no more derivative than kp times
+        //      the deadband would. PIDOutputChangedGet then returns false. A 
+        //      deadband of 0 only rests when the update could not change the 
+        //      output at all. 
+        //      Changing any other setting wakes the controller up. The timed 
+        //      PIDCompute and PIDComputeBlock ignore the deadband.
+        // Parameters:
+        //      deadband - The tolerance, or a negative value to turn deadband 
+        //          mode off, which is the default.
+        // Returns:
+        //      Nothing.
+        // 
+        void PIDDeadbandSet(T deadband);
+        
+        // 
+        // PID Compute Block
+        // Description:
+        //      Runs PIDCompute once for every sample of a block, as if 
+        //      PIDSetpointSet, PIDInputSet, PIDCompute and PIDOutputGet were 
+        //      called for each sample in turn. The integral term and the 
+        //      previous input are carried through the block, and the results 
+        //      are identical to the per sample calls. In MANUAL every output is 
+        //      the current output.
+        // Parameters:
+        //      inputs - Array of n input samples.
+        //      setpoints - Array of n setpoints, or nullptr to keep the current 
+        //          setpoint for the whole block.
+        //      outputs - Array that receives the n outputs.
+        //      n - Number of samples in the block.
+        // Returns:
+        //      True if in AUTOMATIC. False if in MANUAL.
+        // 
+        bool PIDComputeBlock(const T *inputs, const T *setpoints, T *outputs, 
+                             size_t n);
+        
+        // 
+        // PID Compute Bound
+        // Description:
+        //      Same as PIDCompute, except that the input and setpoint are read 
+        //      straight from the bound locations and the output is written 
+        //      straight to the bound location, so no copy in or out of the 
+        //      controller is needed. The output location is only written in 
+        //      AUTOMATIC, so that in MANUAL it keeps whatever value the user 
+        //      puts there.
+        // Parameters:
+        //      binding - The locations to read from and write to.
+        // Returns:
+        //      True if in AUTOMATIC. False if in MANUAL.
+        // 
+        bool PIDComputeBound(const BasicPIDBinding<T> &binding);
         
         // 
         // PID Mode Set
@@ -141,7 +280,7 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        void PIDOutputLimitsSet(float min, float max); 							  							  
+        void PIDOutputLimitsSet(T min, T max); 							  							  
         
         // 
         // PID Tunings Set
@@ -154,7 +293,7 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        void PIDTuningsSet(float kp, float ki, float kd);         	                                         
+        void PIDTuningsSet(T kp, T ki, T kd);         	                                         
         
         // 
         // PID Tuning Gain Constant P Set
@@ -165,7 +304,7 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        void PIDTuningKpSet(float kp);
+        void PIDTuningKpSet(T kp);
         
         // 
         // PID Tuning Gain Constant I Set
@@ -176,7 +315,7 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        void PIDTuningKiSet(float ki);
+        void PIDTuningKiSet(T ki);
         
         // 
         // PID Tuning Gain Constant D Set
@@ -187,7 +326,33 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        void PIDTuningKdSet(float kd);
+        void PIDTuningKdSet(T kd);
+        
+        // 
+        // PID Scheduled Gains Set
+        // Description:
+        //      Sets gains that are already altered for the sample time and the 
+        //      direction, as PIDGainSchedule hands them out, so nothing is 
+        //      recomputed on the way in. Meant to be called every tick. 
+        //      PIDKpGet, PIDKiGet and PIDKdGet keep returning the gains of the 
+        //      last PIDTuningsSet. A resting controller is only woken up when 
+        //      the gains move.
+        // Parameters:
+        //      kp - The altered P gain, kp with its direction applied.
+        //      ki - The altered I gain, ki times the sample time.
+        //      kd - The altered D gain, kd divided by the sample time.
+        // Returns:
+        //      Nothing.
+        // 
+        inline void PIDScheduledGainsSet(T kp, T ki, T kd)
+        {
+            forceCompute = forceCompute || kp != alteredKp || ki != alteredKi || 
+                           kd != alteredKd;
+            alteredKp = kp;
+            alteredKi = ki;
+            alteredKd = kd;
+            filterKd = kd * (T(1) - filterAlpha);
+        }
         
         // 
         // PID Controller Direction Set
@@ -212,7 +377,65 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        void PIDSampleTimeSet(float sampleTimeSeconds);                                                       									  									  									   
+        void PIDSampleTimeSet(T sampleTimeSeconds);                                                       									  									  									   
+        
+        // 
+        // PID Anti-Windup Set
+        // Description:
+        //      Chooses what keeps the integrator from winding up while the 
+        //      output is held at a limit. CLAMPING, the default, only bounds 
+        //      the integrator to the output limits. CONDITIONAL_INTEGRATION 
+        //      also stops integrating while the output is beyond the limit the
+        //      error pushes it into. BACK_CALCULATION instead pulls the 
+        //      integrator back by kt times the part of the output the limits 
+        //      cut off, every second; ki / kp is a common choice of kt. All 
+        //      three keep the integrator within the output limits and compute
+        //      without a branch. Checkpoints carry the strategy and kt.
+        // Parameters:
+        //      antiWindup - The strategy.
+        //      kt - Positive tracking gain, only used by BACK_CALCULATION.
+        // Returns:
+        //      Nothing.
+        // 
+        void PIDAntiWindupSet(PIDAntiWindup antiWindup, T kt);
+        
+        // 
+        // PID Setpoint Weights Set
+        // Description:
+        //      Sets the 2-DOF setpoint weights. The proportional term then 
+        //      acts on b times the setpoint less the input and the derivative
+        //      term on c times the setpoint less the input, while the integral
+        //      term keeps acting on the full error. b below 1 softens the 
+        //      response to setpoint steps without slowing the response to 
+        //      disturbances. The defaults, b at 1 and c at 0, are the plain 
+        //      law with the derivative on the measurement. Checkpoints carry
+        //      the weights.
+        // Parameters:
+        //      b - Positive proportional setpoint weight.
+        //      c - Positive derivative setpoint weight.
+        // Returns:
+        //      Nothing.
+        // 
+        void PIDSetpointWeightsSet(T b, T c);
+        
+        // 
+        // PID Derivative Filter Set
+        // Description:
+        //      Low pass filters the derivative term with a time constant of 
+        //      1/n seconds, which limits its gain on measurement noise to kd 
+        //      times n. Typical values of n put the time constant at a tenth 
+        //      to a twentieth of kd / kp. The filter coefficients are worked 
+        //      out here and by PIDTuningsSet and PIDSampleTimeSet, so 
+        //      PIDCompute has no division to do; the timed PIDCompute has one
+        //      per call for the real interval. Checkpoints carry n and the
+        //      filter state.
+        // Parameters:
+        //      n - Positive filter coefficient, or 0 to turn the filter off, 
+        //          which is the default.
+        // Returns:
+        //      Nothing.
+        // 
+        void PIDDerivativeFilterSet(T n);
         
         // 
         // PID Setpoint Set
@@ -224,7 +447,7 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        inline void PIDSetpointSet(float setpoint) { pid->setpoint = setpoint; }
+        inline void PIDSetpointSet(T setpoint) { this->setpoint = setpoint; }
         
         // 
         // PID Input Set
@@ -236,7 +459,7 @@ PIDControl
         // Returns:
         //      Nothing.
         // 
-        inline void PIDInputSet(float input) { pid->input = input; }
+        inline void PIDInputSet(T input) { this->input = input; }
         
         // 
         // PID Output Get
@@ -248,7 +471,21 @@ PIDControl
         // Returns:
         //      The output of the specific PID controller.
         // 
-        inline float PIDOutputGet() { return pid->output; }
+        inline T PIDOutputGet() { return output; }
+        
+        // 
+        // PID Input, Setpoint and Integral Get
+        // Description:
+        //      Return the input and setpoint the controller last saw and its
+        //      integral term, for logging and telemetry.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The requested value.
+        // 
+        inline T PIDInputGet() { return input; }
+        inline T PIDSetpointGet() { return setpoint; }
+        inline T PIDIntegralGet() { return iTerm; }
         
         // 
         // PID Proportional Gain Constant Get
@@ -260,7 +497,7 @@ PIDControl
         // Returns:
         //      The proportional gain constant.
         // 
-        inline float PIDKpGet() { return pid->dispKp; }						  
+        inline T PIDKpGet() { return dispKp; }						  
         
         // 
         // PID Integral Gain Constant Get
@@ -272,7 +509,7 @@ PIDControl
         // Returns:
         //      The integral gain constant.
         // 
-        inline float PIDKiGet() { return pid->dispKi; }						  
+        inline T PIDKiGet() { return dispKi; }						  
         
         // 
         // PID Derivative Gain Constant Get
@@ -284,7 +521,7 @@ PIDControl
         // Returns:
         //      The derivative gain constant.
         // 
-        inline float PIDKdGet() { return pid->dispKd; }						  
+        inline T PIDKdGet() { return dispKd; }						  
         
         // 
         // PID Mode Get
@@ -296,7 +533,7 @@ PIDControl
         //      MANUAL or AUTOMATIC depending on what the user set the 
         //      controller to.
         // 
-        inline PIDMode PIDModeGet() { return pid->mode; }						  
+        inline PIDMode PIDModeGet() { return mode; }						  
         
         // 
         // PID Direction Get
@@ -308,61 +545,238 @@ PIDControl
         //      DIRECT or REVERSE depending on what the user set the
         //      controller to.
         // 
-        inline PIDDirection PIDDirectionGet() { return pid->controllerDirection; }
+        inline PIDDirection PIDDirectionGet() { return controllerDirection; }
+        
+        // 
+        // PID Anti-Windup Get
+        // Description:
+        //      Returns the anti-windup strategy the particular controller is 
+        //      set to.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      CLAMPING, CONDITIONAL_INTEGRATION or BACK_CALCULATION.
+        // 
+        inline PIDAntiWindup PIDAntiWindupGet() { return antiWindup; }
+        
+        // 
+        // PID Tracking Gain Constant Get
+        // Description:
+        //      Returns the back-calculation tracking gain constant value the
+        //      particular controller is set to.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The tracking gain constant.
+        // 
+        inline T PIDKtGet() { return dispKt; }
+        
+        // 
+        // PID Setpoint Weight B Get
+        // Description:
+        //      Returns the proportional setpoint weight the particular 
+        //      controller is set to.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The proportional setpoint weight.
+        // 
+        inline T PIDSetpointWeightBGet() { return setpointWeightB; }
+        
+        // 
+        // PID Setpoint Weight C Get
+        // Description:
+        //      Returns the derivative setpoint weight the particular 
+        //      controller is set to.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The derivative setpoint weight.
+        // 
+        inline T PIDSetpointWeightCGet() { return setpointWeightC; }
+        
+        // 
+        // PID Derivative Filter Get
+        // Description:
+        //      Returns the derivative filter coefficient the particular 
+        //      controller is set to.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The filter coefficient, 0 when the filter is off.
+        // 
+        inline T PIDDerivativeFilterGet() { return filterN; }
+        
+        // 
+        // PID Output Changed Get
+        // Description:
+        //      Tells whether the last PIDCompute updated the controller or left
+        //      it at rest in deadband mode.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      False if the last PIDCompute left the output unchanged. True 
+        //      otherwise.
+        // 
+        inline bool PIDOutputChangedGet() { return outputChanged; }
+        
+        // 
+        // PID Stats Read
+        // Description:
+        //      Returns the counters the instrumentation policy has recorded for 
+        //      this controller: how often the output and the integrator were 
+        //      clamped, how long PIDCompute took and how regularly it was 
+        //      called. With PIDInstrumentationNone every counter reads 0. It is 
+        //      safe to call while another thread runs PIDCompute.
+        // Parameters:
+        //      stats - Receives the counters.
+        // Returns:
+        //      Nothing.
+        // 
+        inline void PIDStatsRead(PIDStats &stats) const { this->StatsRead(stats); }
+        
+        // 
+        // PID Stats Reset
+        // Description:
+        //      Zeroes the counters of the instrumentation policy.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      Nothing.
+        // 
+        inline void PIDStatsReset() { this->StatsReset(); }
+        
+        // 
+        // PID Checkpoint Save
+        // Description:
+        //      Copies the state and settings of the controller into a record of
+        //      the checkpoint format in pid_checkpoint.h.
+        // Parameters:
+        //      record - Receives the controller.
+        // Returns:
+        //      Nothing.
+        // 
+        void PIDCheckpointSave(PIDCheckpointRecord &record) const;
+        
+        // 
+        // PID Checkpoint Restore
+        // Description:
+        //      Puts the controller back into the state of a record. It carries 
+        //      on from the saved integrator, filtered derivative, last input, 
+        //      last setpoint and output, so the next PIDCompute is bumpless. 
+        //      The timed PIDCompute starts a new interval and a controller in 
+        //      deadband mode computes once before it can rest. Instrumentation
+        //      counters are left alone.
+        // Parameters:
+        //      record - The record to restore from.
+        // Returns:
+        //      False, leaving the controller untouched, if PIDCheckpointRecordValid
+        //      rejects the record. True otherwise.
+        // 
+        bool PIDCheckpointRestore(const PIDCheckpointRecord &record);
         
     private:
+        // 
+        // Works out whether the controller leaves the plain update law, and
+        // starts the weighted law's own state over when it is turned on
+        // 
+        void PIDWeightedUpdate();
+        
         // 
         // Input to the PID Controller
         // 
-        float input;
+        T input;
         
         // 
         // Previous input to the PID Controller
         // 
-        float lastInput;
+        T lastInput;
         
         // 
         // Output of the PID Controller
         // 
-        float output;
+        T output;
         
         // 
         // Gain constant values that were passed by the user
         // These are for display purposes
         // 
-        float dispKp;
-        float dispKi;
-        float dispKd;
+        T dispKp;
+        T dispKi;
+        T dispKd;
         
         // 
         // Gain constant values that the controller alters for
         // its own use
         // 
-        float alteredKp;
-        float alteredKi;
-        float alteredKd;
+        T alteredKp;
+        T alteredKi;
+        T alteredKd;
         
         // 
         // The Integral Term
         // 
-        float iTerm;
+        T iTerm;
+        
+        // 
+        // The anti-windup strategy, and the tracking gain of back-calculation
+        // as passed by the user and as altered for the sample time
+        // 
+        PIDAntiWindup antiWindup;
+        T dispKt;
+        T alteredKt;
+        
+        // 
+        // 2-DOF setpoint weights of the proportional and derivative terms, 
+        // the derivative filter coefficient as passed by the user, the 
+        // filter coefficients as altered for the sample time, and the 
+        // filtered derivative term. weighted is set when any of them leaves
+        // the plain update law, which PIDCompute keeps to otherwise.
+        // 
+        T setpointWeightB;
+        T setpointWeightC;
+        T filterN;
+        T filterAlpha;
+        T filterKd;
+        T dTerm;
+        bool weighted;
         
         // 
         // The interval (in seconds) on which the PID controller
         // will be called
         // 
-        float sampleTime;
+        T sampleTime;
+        
+        // 
+        // The reciprocal of sampleTime, and the timestamp of the last
+        // timed PIDCompute call that computed, which is used to scale 
+        // the I and D terms by the real interval between calls
+        // 
+        T sampleRate;
+        uint32_t lastTime;
+        bool timeValid;
         
         // 
         // The values that the output will be constrained to
         // 
-        float outMin;
-        float outMax;
+        T outMin;
+        T outMax;
         
         // 
         // The user chosen operating point
         // 
-        float setpoint;
+        T setpoint;
+        
+        // 
+        // Deadband mode: the tolerance set with PIDDeadbandSet (negative 
+        // when off), the setpoint of the last compute, which the weighted 
+        // derivative also works from, whether the last PIDCompute changed 
+        // the output, and whether a setting changed since the last compute
+        // 
+        T deadband;
+        T lastSetpoint;
+        bool outputChanged;
+        bool forceCompute;
         
         // 
         // The sense of direction of the controller
@@ -378,6 +792,110 @@ PIDControl
         // AUTOMATIC: PID controller is on.
         // 
         PIDMode mode;
+};
+
+//*********************************************************************************
+// Inline Class Functions
+//*********************************************************************************
+
+// 
+// PIDCompute is defined here, on top of pid_core.h, so that it inlines into
+// the caller's loop
+// 
+template <typename T, typename Instrumentation>
+inline bool BasicPIDControl<T, Instrumentation>::
+PIDComputeConstantTime() noexcept
+{
+    bool automatic = (mode == AUTOMATIC);
+    
+    PIDCoreUpdateConstantTime(automatic, weighted, input, setpoint, &iTerm, 
+                              &lastInput, &lastSetpoint, &dTerm, &output, 
+                              alteredKp, alteredKi, alteredKd, alteredKt, 
+                              setpointWeightB, setpointWeightC, filterAlpha, 
+                              filterKd, outMin, outMax, antiWindup);
+    
+    // As PIDCompute leaves them, without branching on the mode
+    outputChanged = outputChanged | automatic;
+    forceCompute = forceCompute & !automatic;
+    
+    return automatic;
 }
 
+template <typename T, typename Instrumentation>
+inline bool BasicPIDControl<T, Instrumentation>::
+PIDCompute() 
+{
+#ifdef PID_REAL_TIME
+    return PIDComputeConstantTime();
+#else
+    uint64_t start;
+    unsigned flags;
+
+    if(mode == MANUAL)
+    {
+        return false;
+    }
+    
+    // In deadband mode, leave the controller at rest while nothing moves
+    if(deadband >= T(0) && !forceCompute && 
+       PIDCoreAtRest(input, lastInput, setpoint, lastSetpoint, iTerm, output, 
+                     alteredKp, alteredKi, weighted ? setpointWeightB : T(1), 
+                     weighted ? filterAlpha * dTerm : T(0), outMin, outMax, 
+                     deadband))
+    {
+        outputChanged = false;
+        return true;
+    }
+    
+    start = this->StatsBegin();
+    
+    if(weighted)
+    {
+        flags = PIDCoreUpdateWeighted(input, setpoint, &iTerm, &lastInput, 
+                                      &lastSetpoint, &dTerm, &output, alteredKp, 
+                                      alteredKi, alteredKt, setpointWeightB, 
+                                      setpointWeightC, filterAlpha, filterKd, 
+                                      outMin, outMax, antiWindup);
+    }
+    else
+    {
+        flags = PIDCoreUpdate(input, setpoint, &iTerm, &lastInput, &output, 
+                              alteredKp, alteredKi, alteredKd, alteredKt, outMin, 
+                              outMax, antiWindup);
+    }
+    
+    // Remember what the output was computed from for deadband mode
+    lastSetpoint = setpoint;
+    outputChanged = true;
+    forceCompute = false;
+    
+    this->StatsEnd(start, 1, (flags & PID_CORE_SATURATED) != 0, 
+                   (flags & PID_CORE_CLAMPED) != 0);
+    
+    return true;
+#endif
+}
+
+//
+// The controller is generic over its scalar type T. PIDControl is the float
+// controller the library has always provided; double keeps long running
+// integrators from losing small errors and _Float16, where the compiler
+// supports it, halves the size of each controller. Only these types are
+// instantiated in pid_controller.cpp, each with both instrumentation policies.
+//
+typedef BasicPIDControl<float> PIDControl;
+typedef BasicPIDControl<double> PIDControlDouble;
+
+extern template class BasicPIDControl<float, PIDInstrumentationNone>;
+extern template class BasicPIDControl<float, PIDInstrumentationCounters>;
+extern template class BasicPIDControl<double, PIDInstrumentationNone>;
+extern template class BasicPIDControl<double, PIDInstrumentationCounters>;
+
+#if defined(__FLT16_MANT_DIG__)
+    #define PID_HAS_FLOAT16 1
+    typedef BasicPIDControl<_Float16> PIDControlHalf;
+    extern template class BasicPIDControl<_Float16, PIDInstrumentationNone>;
+    extern template class BasicPIDControl<_Float16, PIDInstrumentationCounters>;
+#endif
+
 #endif  // PID_CONTROLLER_H
@@ -0,0 +1,307 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Fixed point (Q15 and Q31) versions of PIDControl for targets
+// without a floating point unit. The compute path only uses integer multiplies,
+// shifts and saturating adds. Gains are still given as floats and go through the
+// same scaling as PIDTuningsSet before being converted, so floating point is
+// only needed when the controller is configured.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include "pid_controller_fixed.h"
+#include "pid_core_fixed.h"
+
+//*********************************************************************************
+// Format Functions
+//*********************************************************************************
+
+PIDFormatQ15::Value PIDFormatQ15::
+Difference(Value a, Value b)
+{
+    return PIDCoreSat16((int32_t)a - (int32_t)b);
+}
+
+int32_t PIDFormatQ15::
+Multiply(Gain gain, uint8_t frac, Value x)
+{
+    return PIDCoreMulQ15ToQ31(gain, frac, x);
+}
+
+PIDFormatQ31::Value PIDFormatQ31::
+Difference(Value a, Value b)
+{
+    return PIDCoreSatSub32(a, b);
+}
+
+int32_t PIDFormatQ31::
+Multiply(Gain gain, uint8_t frac, Value x)
+{
+    return PIDCoreMulQ31(gain, frac, x);
+}
+
+int16_t
+PIDQ15FromFloat(float x)
+{
+    return (x >= 1.0f) ? INT16_MAX : ((x <= -1.0f) ? INT16_MIN : (int16_t)(x * 32768.0f));
+}
+
+float
+PIDQ15ToFloat(int16_t x)
+{
+    return (float)x / 32768.0f;
+}
+
+int32_t
+PIDQ31FromFloat(float x)
+{
+    return (x >= 1.0f) ? INT32_MAX : ((x <= -1.0f) ? INT32_MIN : (int32_t)((double)x * 2147483648.0));
+}
+
+float
+PIDQ31ToFloat(int32_t x)
+{
+    return (float)((double)x / 2147483648.0);
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+template <typename Format>
+PIDControlFixed<Format>::
+PIDControlFixed(float kp, float ki, float kd, float sampleTimeSeconds,
+                Value minOutput, Value maxOutput, PIDMode mode,
+                PIDDirection controllerDirection)
+{
+    this->controllerDirection = controllerDirection;
+    this->mode = mode;
+    iTerm = 0;
+    input = 0;
+    lastInput = 0;
+    output = 0;
+    setpoint = 0;
+
+    if(sampleTimeSeconds > 0.0f)
+    {
+        sampleTime = sampleTimeSeconds;
+    }
+    else
+    {
+        // If the passed parameter was incorrect, set to 1 second
+        sampleTime = 1.0f;
+    }
+
+    PIDOutputLimitsSet(minOutput, maxOutput);
+    PIDTuningsSet(kp, ki, kd);
+}
+
+template <typename Format>
+bool PIDControlFixed<Format>::
+PIDCompute()
+{
+    Value error, dInput;
+    int32_t accumulatorMin, accumulatorMax, result;
+
+    if(mode == MANUAL)
+    {
+        return false;
+    }
+
+    // The output limits in the format of the integrator
+    accumulatorMin = Format::ToAccumulator(outMin);
+    accumulatorMax = Format::ToAccumulator(outMax);
+
+    // The classic PID error term
+    error = Format::Difference(setpoint, input);
+
+    // Compute the integral term separately ahead of time
+    iTerm = PIDCoreSatAdd32(iTerm, Format::Multiply(alteredKi, alteredKiFrac, error));
+
+    // Constrain the integrator to make sure it does not exceed output bounds
+    iTerm = PID_CORE_CONSTRAIN(iTerm, accumulatorMin, accumulatorMax);
+
+    // Take the "derivative on measurement" instead of "derivative on error"
+    dInput = Format::Difference(input, lastInput);
+
+    // Run all the terms together to get the overall output
+    result = PIDCoreSatAdd32(Format::Multiply(alteredKp, alteredKpFrac, error), iTerm);
+    result = PIDCoreSatSub32(result, Format::Multiply(alteredKd, alteredKdFrac, dInput));
+
+    // Bound the output
+    result = PID_CORE_CONSTRAIN(result, accumulatorMin, accumulatorMax);
+    output = Format::FromAccumulator(result);
+
+    // Make the current input the former input
+    lastInput = input;
+
+    return true;
+}
+
+template <typename Format>
+void PIDControlFixed<Format>::
+PIDModeSet(PIDMode mode)
+{
+    // If the mode changed from MANUAL to AUTOMATIC
+    if(this->mode != mode && mode == AUTOMATIC)
+    {
+        // Initialize a few PID parameters to new values
+        iTerm = Format::ToAccumulator(output);
+        lastInput = input;
+
+        // Constrain the integrator to make sure it does not exceed output bounds
+        iTerm = PID_CORE_CONSTRAIN(iTerm, Format::ToAccumulator(outMin),
+                                   Format::ToAccumulator(outMax));
+    }
+
+    this->mode = mode;
+}
+
+template <typename Format>
+void PIDControlFixed<Format>::
+PIDOutputLimitsSet(Value min, Value max)
+{
+    // Check if the parameters are valid
+    if(min >= max)
+    {
+        return;
+    }
+
+    // Save the parameters
+    outMin = min;
+    outMax = max;
+
+    // If in automatic, apply the new constraints
+    if(mode == AUTOMATIC)
+    {
+        output = PID_CORE_CONSTRAIN(output, min, max);
+        iTerm  = PID_CORE_CONSTRAIN(iTerm, Format::ToAccumulator(min),
+                                    Format::ToAccumulator(max));
+    }
+}
+
+template <typename Format>
+void PIDControlFixed<Format>::
+PIDTuningsSet(float kp, float ki, float kd)
+{
+    float scaledKp, scaledKi, scaledKd;
+    int32_t mantissa;
+
+    // Check if the parameters are valid
+    if(kp < 0.0f || ki < 0.0f || kd < 0.0f)
+    {
+        return;
+    }
+
+    // Save the parameters for displaying purposes
+    dispKp = kp;
+    dispKi = ki;
+    dispKd = kd;
+
+    // Alter the parameters for PID
+    scaledKp = kp;
+    scaledKi = ki * sampleTime;
+    scaledKd = kd / sampleTime;
+
+    // Apply reverse direction to the altered values if necessary
+    if(controllerDirection == REVERSE)
+    {
+        scaledKp = -(scaledKp);
+        scaledKi = -(scaledKi);
+        scaledKd = -(scaledKd);
+    }
+
+    // Convert to fixed point
+    PIDCoreGainQuantize(scaledKp, Format::gainMax, &mantissa, &alteredKpFrac);
+    alteredKp = (Gain)mantissa;
+    PIDCoreGainQuantize(scaledKi, Format::gainMax, &mantissa, &alteredKiFrac);
+    alteredKi = (Gain)mantissa;
+    PIDCoreGainQuantize(scaledKd, Format::gainMax, &mantissa, &alteredKdFrac);
+    alteredKd = (Gain)mantissa;
+}
+
+template <typename Format>
+void PIDControlFixed<Format>::
+PIDTuningKpSet(float kp)
+{
+    PIDTuningsSet(kp, dispKi, dispKd);
+}
+
+template <typename Format>
+void PIDControlFixed<Format>::
+PIDTuningKiSet(float ki)
+{
+    PIDTuningsSet(dispKp, ki, dispKd);
+}
+
+template <typename Format>
+void PIDControlFixed<Format>::
+PIDTuningKdSet(float kd)
+{
+    PIDTuningsSet(dispKp, dispKi, kd);
+}
+
+template <typename Format>
+void PIDControlFixed<Format>::
+PIDControllerDirectionSet(PIDDirection controllerDirection)
+{
+    // If in automatic mode and the controller's sense of direction is reversed
+    if(mode == AUTOMATIC && controllerDirection == REVERSE)
+    {
+        // Reverse sense of direction of PID gain constants
+        alteredKp = -(alteredKp);
+        alteredKi = -(alteredKi);
+        alteredKd = -(alteredKd);
+    }
+
+    this->controllerDirection = controllerDirection;
+}
+
+template <typename Format>
+void PIDControlFixed<Format>::
+PIDSampleTimeSet(float sampleTimeSeconds)
+{
+    if(sampleTimeSeconds > 0.0f)
+    {
+        // Save the new sampling time and requantize the altered values from
+        // the display gains instead of scaling the mantissas, which would
+        // lose precision every time
+        sampleTime = sampleTimeSeconds;
+        PIDTuningsSet(dispKp, dispKi, dispKd);
+    }
+}
+
+//*********************************************************************************
+// Explicit Instantiations
+//*********************************************************************************
+template class PIDControlFixed<PIDFormatQ15>;
+template class PIDControlFixed<PIDFormatQ31>;
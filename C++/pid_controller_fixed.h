@@ -0,0 +1,203 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Fixed point (Q15 and Q31) versions of PIDControl for targets
+// without a floating point unit. The compute path only uses integer multiplies,
+// shifts and saturating adds. Gains are still given as floats and go through the
+// same scaling as PIDTuningsSet before being converted, so floating point is
+// only needed when the controller is configured.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_CONTROLLER_FIXED_H
+#define PID_CONTROLLER_FIXED_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include "pid_controller.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Number format and overflow behavior
+//
+// The number format and the overflow behavior are the same as for the C
+// version in C/pid_controller_fixed.h:
+// - Inputs, setpoints, outputs and output limits are Q15 (int16_t) or Q31
+//   (int32_t) values in [-1, 1).
+// - Every addition and subtraction on the compute path saturates. The error,
+//   the change in input and each of the P, I and D terms saturate at [-1, 1)
+//   before the integrator and the output are constrained to the output limits.
+// - Each altered gain is an integer mantissa over a power of two picked to keep
+//   the most precision. Gains above 32767 (Q15) or about 2^31 (Q31) saturate.
+// - Products are truncated toward negative infinity.
+// - The Q15 integral term is kept in Q31.
+//
+
+//
+// Q15 format. Signals are int16_t, gains 16 bit mantissas and the integrator
+// and the intermediate sums are Q31.
+//
+struct
+PIDFormatQ15
+{
+    typedef int16_t Value;
+    typedef int16_t Gain;
+    static const int32_t gainMax = INT16_MAX;
+
+    static inline int32_t ToAccumulator(Value x) { return (int32_t)x * 65536; }
+    static inline Value FromAccumulator(int32_t x) { return (Value)(x >> 16); }
+    static Value Difference(Value a, Value b);
+    static int32_t Multiply(Gain gain, uint8_t frac, Value x);
+};
+
+//
+// Q31 format. Signals, gains, the integrator and the sums are all 32 bits and
+// products are formed in 64 bits.
+//
+struct
+PIDFormatQ31
+{
+    typedef int32_t Value;
+    typedef int32_t Gain;
+    static const int32_t gainMax = INT32_MAX;
+
+    static inline int32_t ToAccumulator(Value x) { return x; }
+    static inline Value FromAccumulator(int32_t x) { return x; }
+    static Value Difference(Value a, Value b);
+    static int32_t Multiply(Gain gain, uint8_t frac, Value x);
+};
+
+//
+// Conversion between float and the Q formats. Only meant for configuration
+// and display, not for the compute path.
+//
+int16_t PIDQ15FromFloat(float x);
+float PIDQ15ToFloat(int16_t x);
+int32_t PIDQ31FromFloat(float x);
+float PIDQ31ToFloat(int32_t x);
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+template <typename Format>
+class
+PIDControlFixed
+{
+    public:
+        typedef typename Format::Value Value;
+
+        //
+        // Constructor and member functions
+        // Description:
+        //      Same as PIDControl. Gains and the sample time are floats, while
+        //      output limits, setpoints, inputs and outputs are in the Q format.
+        //
+        PIDControlFixed(float kp, float ki, float kd, float sampleTimeSeconds,
+                        Value minOutput, Value maxOutput, PIDMode mode,
+                        PIDDirection controllerDirection);
+
+        bool PIDCompute();
+        void PIDModeSet(PIDMode mode);
+        void PIDOutputLimitsSet(Value min, Value max);
+        void PIDTuningsSet(float kp, float ki, float kd);
+        void PIDTuningKpSet(float kp);
+        void PIDTuningKiSet(float ki);
+        void PIDTuningKdSet(float kd);
+        void PIDControllerDirectionSet(PIDDirection controllerDirection);
+        void PIDSampleTimeSet(float sampleTimeSeconds);
+
+        inline void PIDSetpointSet(Value value) { setpoint = value; }
+        inline void PIDInputSet(Value value) { input = value; }
+        inline Value PIDOutputGet() { return output; }
+        inline float PIDKpGet() { return dispKp; }
+        inline float PIDKiGet() { return dispKi; }
+        inline float PIDKdGet() { return dispKd; }
+        inline PIDMode PIDModeGet() { return mode; }
+        inline PIDDirection PIDDirectionGet() { return controllerDirection; }
+
+    private:
+        typedef typename Format::Gain Gain;
+
+        //
+        // Signals of the PID Controller in the Q format
+        //
+        Value input;
+        Value lastInput;
+        Value output;
+        Value setpoint;
+        Value outMin;
+        Value outMax;
+
+        //
+        // Gain constant values that the controller alters for its own use.
+        // Each gain is mantissa / 2^frac.
+        //
+        Gain alteredKp;
+        Gain alteredKi;
+        Gain alteredKd;
+        uint8_t alteredKpFrac;
+        uint8_t alteredKiFrac;
+        uint8_t alteredKdFrac;
+
+        //
+        // The Integral Term (Q31)
+        //
+        int32_t iTerm;
+
+        //
+        // Gain constant values that were passed by the user
+        // These are for display purposes
+        //
+        float dispKp;
+        float dispKi;
+        float dispKd;
+
+        //
+        // The interval (in seconds) on which the PID controller
+        // will be called
+        //
+        float sampleTime;
+
+        PIDDirection controllerDirection;
+        PIDMode mode;
+};
+
+typedef PIDControlFixed<PIDFormatQ15> PIDControlQ15;
+typedef PIDControlFixed<PIDFormatQ31> PIDControlQ31;
+
+#endif  // PID_CONTROLLER_FIXED_H
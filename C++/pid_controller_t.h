@@ -0,0 +1,513 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Compile time specialized PID controller. PIDControlT takes a
+// configuration type that can fix the gains, sample time, output limits,
+// direction and enabled terms at compile time, so that P-only or PI loops only
+// store and compute what they actually use.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_CONTROLLER_T_H
+#define PID_CONTROLLER_T_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include "pid_controller.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Terms a PIDControlT computes. Combine with | for Config::terms.
+//
+#define PID_TERM_P      0x1u
+#define PID_TERM_I      0x2u
+#define PID_TERM_D      0x4u
+#define PID_TERMS_PI    (PID_TERM_P | PID_TERM_I)
+#define PID_TERMS_PID   (PID_TERM_P | PID_TERM_I | PID_TERM_D)
+
+//
+// Default configuration. Derive from it and override what should be fixed at
+// compile time.
+// terms - Which of the P, I and D terms exist at all.
+// staticGains - When true, kp, ki, kd, sampleTime and direction below are
+//      used as compile time constants and the tuning setters are unavailable.
+// staticLimits - When true, outMin and outMax below are compile time
+//      constants and PIDOutputLimitsSet is unavailable.
+// hasMode - When false, the controller is always in AUTOMATIC and never
+//      checks its mode.
+//
+struct
+PIDConfigDefault
+{
+    static constexpr unsigned terms = PID_TERMS_PID;
+
+    static constexpr bool staticGains = false;
+    static constexpr float kp = 0.0f;
+    static constexpr float ki = 0.0f;
+    static constexpr float kd = 0.0f;
+    static constexpr float sampleTime = 1.0f;
+    static constexpr PIDDirection direction = DIRECT;
+
+    static constexpr bool staticLimits = false;
+    static constexpr float outMin = 0.0f;
+    static constexpr float outMax = 1.0f;
+
+    static constexpr bool hasMode = true;
+};
+
+//
+// Storage that only exists when the configuration needs it. The empty
+// specializations cost nothing thanks to the empty base optimization.
+//
+template <bool Enabled> struct PIDIntegralState { float iTerm; };
+template <> struct PIDIntegralState<false> {};
+
+template <bool Enabled> struct PIDDerivativeState { float lastInput; };
+template <> struct PIDDerivativeState<false> {};
+
+template <bool Dynamic>
+struct
+PIDGainState
+{
+    float dispKp;
+    float dispKi;
+    float dispKd;
+    float alteredKp;
+    float alteredKi;
+    float alteredKd;
+    float sampleTime;
+    PIDDirection controllerDirection;
+};
+template <> struct PIDGainState<false> {};
+
+template <bool Dynamic> struct PIDLimitState { float outMin; float outMax; };
+template <> struct PIDLimitState<false> {};
+
+template <bool Enabled> struct PIDModeState { PIDMode mode; };
+template <> struct PIDModeState<false> {};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+template <typename Config>
+class
+PIDControlT :
+    private PIDIntegralState<(Config::terms & PID_TERM_I) != 0>,
+    private PIDDerivativeState<(Config::terms & PID_TERM_D) != 0>,
+    private PIDGainState<!Config::staticGains>,
+    private PIDLimitState<!Config::staticLimits>,
+    private PIDModeState<Config::hasMode>
+{
+    public:
+        static constexpr bool hasP = (Config::terms & PID_TERM_P) != 0;
+        static constexpr bool hasI = (Config::terms & PID_TERM_I) != 0;
+        static constexpr bool hasD = (Config::terms & PID_TERM_D) != 0;
+
+        //
+        // Constructor
+        // Description:
+        //      Initializes a controller whose gains and limits, if any are
+        //      dynamic, still need to be set with the setters below. The mode is
+        //      AUTOMATIC.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      Nothing.
+        //
+        PIDControlT()
+        {
+            Init(0.0f, 0.0f, 0.0f, Config::sampleTime, Config::outMin,
+                 Config::outMax, AUTOMATIC, Config::direction);
+        }
+
+        //
+        // Constructor
+        // Description:
+        //      Same as the PIDControl constructor. Arguments for anything the
+        //      configuration fixes at compile time are ignored.
+        //
+        PIDControlT(float kp, float ki, float kd, float sampleTimeSeconds,
+                    float minOutput, float maxOutput, PIDMode mode,
+                    PIDDirection controllerDirection)
+        {
+            Init(kp, ki, kd, sampleTimeSeconds, minOutput, maxOutput, mode,
+                 controllerDirection);
+        }
+
+        //
+        // PID Compute
+        // Description:
+        //      Same as PIDControl::PIDCompute, with clamping anti-windup and the
+        //      update law of pid_core.h limited to the enabled terms. With every
+        //      term enabled and nothing fixed the results are identical.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      True if in AUTOMATIC. False if in MANUAL.
+        //
+        bool PIDCompute()
+        {
+            if constexpr(Config::hasMode)
+            {
+                if(this->mode == MANUAL)
+                {
+                    return false;
+                }
+            }
+
+            if constexpr(hasP && hasI && hasD)
+            {
+                PIDCoreUpdate(input, setpoint, &this->iTerm, &this->lastInput, &output,
+                              AlteredKp(), AlteredKi(), AlteredKd(), 0.0f, OutMin(),
+                              OutMax(), PID_CORE_CLAMPING);
+            }
+            else
+            {
+                // The terms that are left out are zero, and without the integral
+                // term there is no integrator to clamp
+                float error = setpoint - input;
+                float proportional = hasP ? AlteredKp() * error : 0.0f;
+                float derivative = 0.0f;
+
+                if constexpr(hasD)
+                {
+                    derivative = AlteredKd() * (input - this->lastInput);
+                    this->lastInput = input;
+                }
+
+                if constexpr(hasI)
+                {
+                    PIDCoreOutput(proportional, derivative, AlteredKi() * error,
+                                  &this->iTerm, &output, 0.0f, OutMin(), OutMax(),
+                                  PID_CORE_CLAMPING);
+                }
+                else
+                {
+                    output = Constrain(proportional - derivative);
+                }
+            }
+
+            return true;
+        }
+
+        //
+        // PID Mode Set
+        // Description:
+        //      Same as PIDControl::PIDModeSet. Only available when
+        //      Config::hasMode is true.
+        //
+        void PIDModeSet(PIDMode mode)
+        {
+            static_assert(Config::hasMode, "this configuration has no mode");
+
+            // If the mode changed from MANUAL to AUTOMATIC
+            if(this->mode != mode && mode == AUTOMATIC)
+            {
+                if constexpr(hasI)
+                {
+                    this->iTerm = Constrain(output);
+                }
+                if constexpr(hasD)
+                {
+                    this->lastInput = input;
+                }
+            }
+
+            this->mode = mode;
+        }
+
+        //
+        // PID Output Limits Set
+        // Description:
+        //      Same as PIDControl::PIDOutputLimitsSet. Only available when
+        //      Config::staticLimits is false.
+        //
+        void PIDOutputLimitsSet(float min, float max)
+        {
+            static_assert(!Config::staticLimits, "output limits are fixed at compile time");
+
+            // Check if the parameters are valid
+            if(min >= max)
+            {
+                return;
+            }
+
+            // Save the parameters
+            this->outMin = min;
+            this->outMax = max;
+
+            // If in automatic, apply the new constraints
+            if(PIDModeGet() == AUTOMATIC)
+            {
+                output = Constrain(output);
+                if constexpr(hasI)
+                {
+                    this->iTerm = Constrain(this->iTerm);
+                }
+            }
+        }
+
+        //
+        // PID Tunings Set
+        // Description:
+        //      Same as PIDControl::PIDTuningsSet. Only available when
+        //      Config::staticGains is false.
+        //
+        void PIDTuningsSet(float kp, float ki, float kd)
+        {
+            static_assert(!Config::staticGains, "gains are fixed at compile time");
+
+            // Check if the parameters are valid
+            if(kp < 0.0f || ki < 0.0f || kd < 0.0f)
+            {
+                return;
+            }
+
+            // Save the parameters for displaying purposes
+            this->dispKp = kp;
+            this->dispKi = ki;
+            this->dispKd = kd;
+
+            // Alter the parameters for PID, reversed if necessary
+            PIDCoreGains(kp, ki, kd, this->sampleTime, this->controllerDirection == REVERSE,
+                         &this->alteredKp, &this->alteredKi, &this->alteredKd);
+        }
+
+        void PIDTuningKpSet(float kp) { PIDTuningsSet(kp, PIDKiGet(), PIDKdGet()); }
+        void PIDTuningKiSet(float ki) { PIDTuningsSet(PIDKpGet(), ki, PIDKdGet()); }
+        void PIDTuningKdSet(float kd) { PIDTuningsSet(PIDKpGet(), PIDKiGet(), kd); }
+
+        //
+        // PID Controller Direction Set
+        // Description:
+        //      Same as PIDControl::PIDControllerDirectionSet. Only available when
+        //      Config::staticGains is false.
+        //
+        void PIDControllerDirectionSet(PIDDirection controllerDirection)
+        {
+            static_assert(!Config::staticGains, "direction is fixed at compile time");
+
+            // If in automatic mode and the controller's sense of direction is reversed
+            if(PIDModeGet() == AUTOMATIC && controllerDirection == REVERSE)
+            {
+                // Reverse sense of direction of PID gain constants
+                PIDCoreGainsReverse(&this->alteredKp, &this->alteredKi, &this->alteredKd);
+            }
+
+            this->controllerDirection = controllerDirection;
+        }
+
+        //
+        // PID Sample Time Set
+        // Description:
+        //      Same as PIDControl::PIDSampleTimeSet. Only available when
+        //      Config::staticGains is false.
+        //
+        void PIDSampleTimeSet(float sampleTimeSeconds)
+        {
+            static_assert(!Config::staticGains, "sample time is fixed at compile time");
+
+            float ratio;
+
+            if(sampleTimeSeconds > 0.0f)
+            {
+                // Find the ratio of change and apply to the altered values
+                ratio = sampleTimeSeconds / this->sampleTime;
+                PIDCoreSampleTimeScale(ratio, &this->alteredKi, &this->alteredKd);
+
+                // Save the new sampling time
+                this->sampleTime = sampleTimeSeconds;
+            }
+        }
+
+        //
+        // Basic Set and Get Functions, same as PIDControl
+        //
+        inline void PIDSetpointSet(float value) { setpoint = value; }
+        inline void PIDInputSet(float value) { input = value; }
+        inline float PIDOutputGet() const { return output; }
+
+        inline float PIDKpGet() const
+        {
+            if constexpr(Config::staticGains) { return Config::kp; }
+            else { return this->dispKp; }
+        }
+
+        inline float PIDKiGet() const
+        {
+            if constexpr(Config::staticGains) { return Config::ki; }
+            else { return this->dispKi; }
+        }
+
+        inline float PIDKdGet() const
+        {
+            if constexpr(Config::staticGains) { return Config::kd; }
+            else { return this->dispKd; }
+        }
+
+        inline PIDMode PIDModeGet() const
+        {
+            if constexpr(Config::hasMode) { return this->mode; }
+            else { return AUTOMATIC; }
+        }
+
+        inline PIDDirection PIDDirectionGet() const
+        {
+            if constexpr(Config::staticGains) { return Config::direction; }
+            else { return this->controllerDirection; }
+        }
+
+    private:
+        //
+        // Gains and limits as the compute path uses them. For fixed values
+        // these fold to constants.
+        //
+        inline float AlteredKp() const
+        {
+            if constexpr(Config::staticGains)
+            {
+                return (Config::direction == REVERSE) ? -Config::kp : Config::kp;
+            }
+            else { return this->alteredKp; }
+        }
+
+        inline float AlteredKi() const
+        {
+            if constexpr(Config::staticGains)
+            {
+                constexpr float ki = Config::ki * Config::sampleTime;
+                return (Config::direction == REVERSE) ? -ki : ki;
+            }
+            else { return this->alteredKi; }
+        }
+
+        inline float AlteredKd() const
+        {
+            if constexpr(Config::staticGains)
+            {
+                constexpr float kd = Config::kd / Config::sampleTime;
+                return (Config::direction == REVERSE) ? -kd : kd;
+            }
+            else { return this->alteredKd; }
+        }
+
+        inline float OutMin() const
+        {
+            if constexpr(Config::staticLimits) { return Config::outMin; }
+            else { return this->outMin; }
+        }
+
+        inline float OutMax() const
+        {
+            if constexpr(Config::staticLimits) { return Config::outMax; }
+            else { return this->outMax; }
+        }
+
+        inline float Constrain(float x) const
+        {
+            return PIDCoreConstrain(x, OutMin(), OutMax());
+        }
+
+        void Init(float kp, float ki, float kd, float sampleTimeSeconds,
+                  float minOutput, float maxOutput, PIDMode mode,
+                  PIDDirection controllerDirection)
+        {
+            static_assert(!Config::staticGains ||
+                          (Config::kp >= 0.0f && Config::ki >= 0.0f && Config::kd >= 0.0f),
+                          "gains must be positive");
+            static_assert(!Config::staticGains || Config::sampleTime > 0.0f,
+                          "sample time must be positive");
+            static_assert(!Config::staticLimits || Config::outMin < Config::outMax,
+                          "outMin must be less than outMax");
+
+            if constexpr(Config::hasMode) { this->mode = mode; }
+            if constexpr(hasI) { this->iTerm = 0.0f; }
+            if constexpr(hasD) { this->lastInput = 0.0f; }
+            input = 0.0f;
+            output = 0.0f;
+            setpoint = 0.0f;
+
+            if constexpr(!Config::staticGains)
+            {
+                this->controllerDirection = controllerDirection;
+
+                // If the passed parameter was incorrect, set to 1 second
+                this->sampleTime = (sampleTimeSeconds > 0.0f) ? sampleTimeSeconds : 1.0f;
+
+                // Starts out cleared, as if PIDTuningsSet had been given zeros
+                this->dispKp = this->dispKi = this->dispKd = 0.0f;
+                this->alteredKp = this->alteredKi = this->alteredKd = 0.0f;
+                PIDTuningsSet(kp, ki, kd);
+            }
+            else
+            {
+                (void)kp; (void)ki; (void)kd;
+                (void)sampleTimeSeconds; (void)controllerDirection;
+            }
+
+            if constexpr(!Config::staticLimits)
+            {
+                // Starts out as [0, 1] if the passed limits are invalid
+                this->outMin = 0.0f;
+                this->outMax = 1.0f;
+                PIDOutputLimitsSet(minOutput, maxOutput);
+            }
+            else
+            {
+                (void)minOutput; (void)maxOutput;
+            }
+
+            (void)mode;
+        }
+
+        float input;
+        float output;
+        float setpoint;
+};
+
+//
+// Configuration that fixes nothing. PIDControlT<PIDDynamicConfig<>> behaves
+// like PIDControl. Terms can still be dropped, e.g. PIDDynamicConfig<PID_TERMS_PI>.
+//
+template <unsigned Terms = PID_TERMS_PID>
+struct
+PIDDynamicConfig : PIDConfigDefault
+{
+    static constexpr unsigned terms = Terms;
+};
+
+#endif  // PID_CONTROLLER_T_H
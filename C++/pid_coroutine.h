@@ -0,0 +1,406 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: C++20 coroutine driver for event loop based control services. A
+// PIDTickSource is a single periodic tick that any number of control loops
+// co_await. One timer of the event loop, an asio steady_timer, an io_uring
+// timeout or the PIDTickSourceRun loop below, calls Tick and every waiting loop
+// is resumed in that one wakeup, with no allocation and no dispatch per
+// controller. Compiles to nothing before C++20.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_COROUTINE_H
+#define PID_COROUTINE_H
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <thread>
+#include <utility>
+#include "pid_controller.h"
+
+//*********************************************************************************
+// Classes
+//*********************************************************************************
+
+class
+PIDTickSource
+{
+    private:
+        class Awaiter;
+
+        //
+        // An intrusive list of suspended loops. The nodes live in the
+        // coroutine frames, so waiting never allocates.
+        //
+        struct
+        WaitList
+        {
+            Awaiter *head = nullptr;
+            Awaiter *tail = nullptr;
+            size_t count = 0;
+        };
+
+        class
+        Awaiter
+        {
+            public:
+                explicit Awaiter(PIDTickSource &source) : source(source) {}
+
+                Awaiter(const Awaiter &) = delete;
+                Awaiter &operator=(const Awaiter &) = delete;
+
+                //
+                // A loop that is destroyed while it waits leaves the list
+                //
+                ~Awaiter()
+                {
+                    if(list)
+                    {
+                        Unlink();
+                    }
+                }
+
+                inline bool await_ready() const noexcept { return false; }
+
+                inline void await_suspend(std::coroutine_handle<> handle) noexcept
+                {
+                    this->handle = handle;
+                    Link(source.waiting);
+                }
+
+                //
+                // The number of the tick that resumed the loop
+                //
+                inline uint64_t await_resume() const noexcept { return source.tick; }
+
+            private:
+                friend class PIDTickSource;
+
+                inline void Link(WaitList &to)
+                {
+                    list = &to;
+                    previous = to.tail;
+                    next = nullptr;
+                    if(to.tail)
+                    {
+                        to.tail->next = this;
+                    }
+                    else
+                    {
+                        to.head = this;
+                    }
+                    to.tail = this;
+                    to.count++;
+                }
+
+                inline void Unlink()
+                {
+                    if(previous)
+                    {
+                        previous->next = next;
+                    }
+                    else
+                    {
+                        list->head = next;
+                    }
+                    if(next)
+                    {
+                        next->previous = previous;
+                    }
+                    else
+                    {
+                        list->tail = previous;
+                    }
+                    list->count--;
+                    list = nullptr;
+                }
+
+                PIDTickSource &source;
+                std::coroutine_handle<> handle;
+                WaitList *list = nullptr;
+                Awaiter *previous = nullptr;
+                Awaiter *next = nullptr;
+        };
+
+    public:
+        PIDTickSource() {}
+
+        PIDTickSource(const PIDTickSource &) = delete;
+        PIDTickSource &operator=(const PIDTickSource &) = delete;
+
+        //
+        // Next Tick
+        // Description:
+        //      co_await source.NextTick() suspends the calling coroutine until
+        //      the next Tick and evaluates to that tick's number.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The awaitable.
+        //
+        inline Awaiter NextTick() { return Awaiter(*this); }
+
+        //
+        // Tick
+        // Description:
+        //      Resumes every loop waiting on the source, in the order they
+        //      started waiting, on the calling thread. A loop that awaits again
+        //      while Tick runs waits for the next Tick. A loop may destroy
+        //      other loops, waiting or not, while it runs. The source is not
+        //      thread safe: Tick and every loop it drives belong to the thread
+        //      of the event loop.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of loops resumed.
+        //
+        size_t Tick()
+        {
+            size_t resumed = 0;
+
+            tick++;
+
+            // Move the waiting loops aside so that those that await again
+            // queue up for the next tick
+            ready = waiting;
+            waiting = WaitList();
+            for(Awaiter *node = ready.head; node; node = node->next)
+            {
+                node->list = &ready;
+            }
+
+            // Always take the head: an awaiter destroyed by an earlier loop has
+            // already unlinked itself
+            while(ready.head)
+            {
+                Awaiter *node = ready.head;
+
+                node->Unlink();
+                node->handle.resume();
+                resumed++;
+            }
+
+            return resumed;
+        }
+
+        //
+        // Number of loops waiting for the next Tick
+        //
+        inline size_t WaitingGet() const { return waiting.count; }
+
+        //
+        // Number of Ticks so far
+        //
+        inline uint64_t TickCountGet() const { return tick; }
+
+    private:
+        WaitList waiting;
+        WaitList ready;
+        uint64_t tick = 0;
+};
+
+//
+// The return type of a control loop coroutine. The loop starts running as
+// soon as it is called, up to its first co_await. Its frame is allocated once,
+// when it is called, and destroyed with the PIDTask, which also takes a waiting
+// loop off its source.
+//
+class
+PIDTask
+{
+    public:
+        struct
+        promise_type
+        {
+            PIDTask get_return_object()
+            {
+                return PIDTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+
+            // A control loop has nowhere to report to, so a throw is fatal
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+
+        PIDTask() {}
+        PIDTask(PIDTask &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+        PIDTask &operator=(PIDTask &&other) noexcept
+        {
+            if(this != &other)
+            {
+                Reset();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+
+        ~PIDTask() { Reset(); }
+
+        //
+        // True once the loop has returned
+        //
+        inline bool Done() const { return !handle || handle.done(); }
+
+        //
+        // Destroys the loop wherever it is suspended
+        //
+        inline void Reset()
+        {
+            if(handle)
+            {
+                handle.destroy();
+                handle = nullptr;
+            }
+        }
+
+    private:
+        explicit PIDTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        std::coroutine_handle<promise_type> handle;
+};
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+//
+// PID Tick Loop
+// Description:
+//      A control loop that calls body once per tick of source for as long as
+//      body returns true. body can compute a PIDBank with ComputeAll, run a
+//      PIDScheduler, hand the tick to a PIDBankExecutor to use several cores,
+//      or step a batch of PIDControls, so a whole plant is served by a single
+//      wakeup. body is copied into the loop's frame.
+// Parameters:
+//      source - The tick to follow.
+//      body - Called as body(tick) with the tick's number.
+// Returns:
+//      The loop.
+//
+template <typename Body>
+PIDTask
+PIDTickLoop(PIDTickSource &source, Body body)
+{
+    for(;;)
+    {
+        uint64_t tick = co_await source.NextTick();
+
+        if(!body(tick))
+        {
+            co_return;
+        }
+    }
+}
+
+//
+// PID Tick Loop
+// Description:
+//      A control loop that computes count controllers once per tick of source
+//      until it is destroyed. Inputs and setpoints are written between ticks
+//      as usual.
+// Parameters:
+//      source - The tick to follow.
+//      pids - The controllers, which must outlive the loop.
+//      count - The number of controllers.
+// Returns:
+//      The loop.
+//
+template <typename Controller>
+PIDTask
+PIDTickLoop(PIDTickSource &source, Controller *pids, size_t count)
+{
+    for(;;)
+    {
+        co_await source.NextTick();
+        for(size_t i = 0; i < count; i++)
+        {
+            pids[i].PIDCompute();
+        }
+    }
+}
+
+//
+// PID Tick Source Run
+// Description:
+//      A minimal event loop for services without one of their own: ticks
+//      source every period on the calling thread until stop is set. Deadlines
+//      are absolute, so the period does not drift. After an overrun the next
+//      deadline is one period from now rather than a burst of late ticks.
+// Parameters:
+//      source - The source to tick.
+//      period - The tick period.
+//      stop - Checked before every tick.
+// Returns:
+//      The number of ticks run.
+//
+template <typename Rep, typename Period>
+uint64_t
+PIDTickSourceRun(PIDTickSource &source, std::chrono::duration<Rep, Period> period,
+                 const std::atomic<bool> &stop)
+{
+    auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    auto deadline = std::chrono::steady_clock::now() + step;
+    uint64_t ticks = 0;
+
+    while(!stop.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_until(deadline);
+        source.Tick();
+        ticks++;
+
+        deadline += step;
+        auto now = std::chrono::steady_clock::now();
+        if(deadline < now)
+        {
+            deadline = now + step;
+        }
+    }
+
+    return ticks;
+}
+
+#endif  // C++20 coroutines
+
+#endif  // PID_COROUTINE_H
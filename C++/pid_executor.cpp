@@ -0,0 +1,180 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Multi-threaded executor for a PIDBank. The bank is split into
+// cache line aligned shards, one per worker thread, all shards are stepped each
+// tick and the outputs of a finished tick are published to a double buffer.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <string.h>
+#include "pid_executor.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Number of controllers that fill one cache line of a bank array
+//
+#define PID_SHARD_ALIGNMENT     (PID_CACHE_LINE_SIZE / sizeof(float))
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDBankExecutor::
+PIDBankExecutor(PIDBank &bank, unsigned workers, bool pinThreads, unsigned firstCpu) :
+    bank(bank),
+    size(bank.Size()),
+    writing(0),
+    published(0)
+{
+    size_t shardSize, first;
+
+    if(workers == 0)
+    {
+        workers = std::thread::hardware_concurrency();
+        workers = workers ? workers : 1;
+    }
+
+    // Round the shard size up to whole cache lines. Small banks may end up
+    // with fewer shards than requested.
+    shardSize = (size + workers - 1) / workers;
+    shardSize = (shardSize + PID_SHARD_ALIGNMENT - 1) / PID_SHARD_ALIGNMENT * PID_SHARD_ALIGNMENT;
+    shardSize = shardSize ? shardSize : PID_SHARD_ALIGNMENT;
+
+    for(first = 0; first < size || shardFirst.empty(); first += shardSize)
+    {
+        shardFirst.push_back(first);
+    }
+    shardFirst.push_back(size);
+
+    buffers[0].assign(size, 0.0f);
+    buffers[1].assign(size, 0.0f);
+
+    // The tick a shard is run for is the one being written
+    pool.Start(ShardCount(), [this](size_t shard)
+               {
+                   RunShard(shard, writing.load(std::memory_order_relaxed));
+               },
+               pinThreads, firstCpu);
+}
+
+PIDBankExecutor::
+~PIDBankExecutor()
+{
+    pool.Stop();
+}
+
+uint64_t PIDBankExecutor::
+Tick()
+{
+    uint64_t tick = published.load(std::memory_order_relaxed) + 1;
+
+    // Claim the back buffer before anyone writes into it
+    writing.store(tick, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // The calling thread takes the first shard
+    pool.Run();
+
+    published.store(tick, std::memory_order_release);
+
+    return tick;
+}
+
+uint64_t PIDBankExecutor::
+OutputsRead(float *destination) const
+{
+    uint64_t tick;
+
+    for(;;)
+    {
+        tick = published.load(std::memory_order_acquire);
+        if(tick == 0)
+        {
+            return 0;
+        }
+
+        memcpy(destination, buffers[tick & 1].data(), size * sizeof(float));
+
+        // The copy is good unless a later tick started writing the same buffer
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(writing.load(std::memory_order_relaxed) < tick + 2)
+        {
+            return tick;
+        }
+    }
+}
+
+float PIDBankExecutor::
+OutputRead(size_t index, uint64_t *tick) const
+{
+    uint64_t current;
+    float value;
+
+    for(;;)
+    {
+        current = published.load(std::memory_order_acquire);
+        value = current ? buffers[current & 1][index] : 0.0f;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(writing.load(std::memory_order_relaxed) < current + 2)
+        {
+            break;
+        }
+    }
+
+    if(tick != nullptr)
+    {
+        *tick = current;
+    }
+
+    return value;
+}
+
+//*********************************************************************************
+// Private Class Functions
+//*********************************************************************************
+
+void PIDBankExecutor::
+RunShard(size_t shard, uint64_t tick)
+{
+    size_t first = ShardBegin(shard);
+    size_t last = ShardEnd(shard);
+
+    bank.ComputeRange(first, last);
+
+    memcpy(buffers[tick & 1].data() + first, bank.OutputData() + first,
+           (last - first) * sizeof(float));
+}
@@ -0,0 +1,173 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Multi-threaded executor for a PIDBank. The bank is split into
+// cache line aligned shards, one per worker thread, all shards are stepped each
+// tick and the outputs of a finished tick are published to a double buffer.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_EXECUTOR_H
+#define PID_EXECUTOR_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_parallel.h"
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class
+PIDBankExecutor
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Splits the bank into shards and starts one worker thread per shard
+        //      beyond the first. The thread calling Tick computes the first
+        //      shard itself. The bank must not have controllers added to it
+        //      while the executor is attached.
+        // Parameters:
+        //      bank - The bank of controllers to step.
+        //      workers - Number of shards. Zero uses one per hardware thread.
+        //      pinThreads - Pin worker i to CPU (firstCpu + i) where the
+        //          platform supports it. The thread calling Tick computes 
+        //          shard 0 and is pinned to firstCpu by its first Tick.
+        //      firstCpu - CPU of the thread calling Tick.
+        // Returns:
+        //      Nothing.
+        //
+        PIDBankExecutor(PIDBank &bank, unsigned workers = 0, bool pinThreads = true,
+                        unsigned firstCpu = 0);
+
+        //
+        // Destructor
+        // Description:
+        //      Stops and joins the worker threads.
+        //
+        ~PIDBankExecutor();
+
+        PIDBankExecutor(const PIDBankExecutor &) = delete;
+        PIDBankExecutor &operator=(const PIDBankExecutor &) = delete;
+
+        //
+        // Tick
+        // Description:
+        //      Steps every shard of the bank once and returns after all of them
+        //      have finished. The outputs of the tick are then published. Inputs
+        //      and setpoints must not be written while Tick is running.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of the tick that was just published, starting at 1.
+        //
+        uint64_t Tick();
+
+        //
+        // Outputs Read
+        // Description:
+        //      Copies the outputs of the most recently published tick. Safe to
+        //      call from any thread while Tick runs. It never blocks the
+        //      workers; if a tick is published in the middle of the copy, the
+        //      copy is retried so the result always belongs to a single tick.
+        // Parameters:
+        //      destination - Array of at least Size() floats.
+        // Returns:
+        //      The tick the outputs belong to, or 0 if nothing was published yet.
+        //
+        uint64_t OutputsRead(float *destination) const;
+
+        //
+        // Output Read
+        // Description:
+        //      Same as OutputsRead but for the output of a single controller.
+        // Parameters:
+        //      index - Index of the controller within the bank.
+        //      tick - If not null, receives the tick the output belongs to.
+        // Returns:
+        //      The published output of the controller.
+        //
+        float OutputRead(size_t index, uint64_t *tick = nullptr) const;
+
+        //
+        // Basic Get Functions
+        //
+        inline size_t Size() const { return size; }
+        inline size_t ShardCount() const { return shardFirst.size() - 1; }
+        inline size_t ShardBegin(size_t shard) const { return shardFirst[shard]; }
+        inline size_t ShardEnd(size_t shard) const { return shardFirst[shard + 1]; }
+        inline uint64_t TickCount() const { return published.load(std::memory_order_acquire); }
+
+    private:
+        typedef std::vector<float, PIDAlignedAllocator<float> > FloatArray;
+
+        //
+        // Computes a shard and copies its outputs into the buffer being written
+        //
+        void RunShard(size_t shard, uint64_t tick);
+
+        PIDBank &bank;
+        size_t size;
+
+        //
+        // Shard s covers controllers [shardFirst[s], shardFirst[s + 1]). Every
+        // boundary is a multiple of a cache line worth of floats.
+        //
+        std::vector<size_t> shardFirst;
+
+        //
+        // The two output buffers. Tick n writes buffer n & 1.
+        //
+        FloatArray buffers[2];
+
+        //
+        // Tick being written and the last tick published. A reader's copy is
+        // valid as long as writing has not moved onto the buffer it read.
+        //
+        std::atomic<uint64_t> writing;
+        std::atomic<uint64_t> published;
+
+        //
+        // One worker per shard. Last, so that it stops before the rest goes.
+        //
+        PIDWorkerPool pool;
+};
+
+#endif  // PID_EXECUTOR_H
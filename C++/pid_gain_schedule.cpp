@@ -0,0 +1,158 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Gain scheduling. A sorted table of breakpoints maps an operating
+// point, the input or any external variable, to a set of gains by linear
+// interpolation. The gains are altered for the sample time and direction when
+// the table is built, so a scheduled tick is a short branch free search, three
+// multiply-adds and three stores ahead of an ordinary PIDCompute.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include "pid_gain_schedule.h"
+#include "pid_core.h"
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDGainSchedule::
+PIDGainSchedule() :
+    cellScale(0.0f),
+    lastKey(0.0f)
+{
+}
+
+bool PIDGainSchedule::
+Build(const PIDGainBreakpoint *points, size_t count, float sampleTimeSeconds,
+      PIDDirection direction)
+{
+    std::vector<float, PIDAlignedAllocator<float> > newKeys(count + 1);
+    CellArray newCells;
+    std::vector<Segment, PIDAlignedAllocator<Segment> > newSegments(count);
+    float newScale;
+
+    // Written so that NaN fails the checks
+    if(count == 0 || !(sampleTimeSeconds > 0.0f))
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+        const PIDGainBreakpoint &point = points[i];
+        Segment &segment = newSegments[i];
+
+        if(!isfinite(point.key) || (i > 0 && !(point.key > points[i - 1].key)) ||
+           !(point.kp >= 0.0f) || !(point.ki >= 0.0f) || !(point.kd >= 0.0f))
+        {
+            return false;
+        }
+
+        newKeys[i] = point.key;
+        segment.key = point.key;
+        PIDCoreGains(point.kp, point.ki, point.kd, sampleTimeSeconds, direction == REVERSE,
+                     &segment.kp, &segment.ki, &segment.kd);
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+        Segment &segment = newSegments[i];
+        Segment *next = (i + 1 < count) ? &newSegments[i + 1] : nullptr;
+
+        // Worked out in double so that narrow segments keep their accuracy
+        double width = next ? (double)next->key - (double)segment.key : 1.0;
+
+        segment.slopeKp = next ? (float)(((double)next->kp - segment.kp) / width) : 0.0f;
+        segment.slopeKi = next ? (float)(((double)next->ki - segment.ki) / width) : 0.0f;
+        segment.slopeKd = next ? (float)(((double)next->kd - segment.kd) / width) : 0.0f;
+    }
+
+    newKeys[count] = INFINITY;
+    CellsBuild(newKeys.data(), count, newCells, newScale);
+
+    keys.swap(newKeys);
+    cells.swap(newCells);
+    segments.swap(newSegments);
+    cellScale = newScale;
+    lastKey = keys[count - 1];
+
+    return true;
+}
+
+//*********************************************************************************
+// Private Class Functions
+//*********************************************************************************
+
+void PIDGainSchedule::
+CellsBuild(const float *keys, size_t count, CellArray &cells, float &scale)
+{
+    float narrowest = INFINITY;
+    size_t last, index = 0;
+
+    for(size_t i = 1; i < count; i++)
+    {
+        narrowest = fminf(narrowest, keys[i] - keys[i - 1]);
+    }
+
+    // Two cells per narrowest segment. A single breakpoint needs one cell.
+    scale = (count > 1) ? 2.0f / narrowest : 0.0f;
+    cells.clear();
+    if(!isfinite(scale) ||
+       ((double)keys[count - 1] - keys[0]) * scale >= PID_GAIN_SCHEDULE_MAX_CELLS)
+    {
+        return;
+    }
+
+    // Cells are found with the same expression Lookup uses, and each must
+    // hold at most one key, or the table keeps to the binary search
+    last = (size_t)((keys[count - 1] - keys[0]) * scale);
+    for(size_t i = 1; i < count; i++)
+    {
+        if((size_t)((keys[i] - keys[0]) * scale) <= (size_t)((keys[i - 1] - keys[0]) * scale))
+        {
+            return;
+        }
+    }
+
+    cells.resize(last + 1);
+    for(size_t cell = 0; cell <= last; cell++)
+    {
+        // The last key in an earlier cell, which is below every key in this one
+        while(index + 1 < count && (size_t)((keys[index + 1] - keys[0]) * scale) < cell)
+        {
+            index++;
+        }
+        cells[cell] = (uint32_t)index;
+    }
+}
@@ -0,0 +1,252 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Gain scheduling. A sorted table of breakpoints maps an operating
+// point, the input or any external variable, to a set of gains by linear
+// interpolation. The gains are altered for the sample time and direction when
+// the table is built, so a scheduled tick is a short branch free search, three
+// multiply-adds and three stores ahead of an ordinary PIDCompute.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_GAIN_SCHEDULE_H
+#define PID_GAIN_SCHEDULE_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "pid_aligned_allocator.h"
+#include "pid_controller.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// The most entries the cell index of a schedule may have, enough for tables
+// whose narrowest segment is 1/512 of their span
+//
+#define PID_GAIN_SCHEDULE_MAX_CELLS     1024
+
+//
+// The gains to use at one operating point, in the units PIDTuningsSet takes
+//
+struct
+PIDGainBreakpoint
+{
+    float key;
+    float kp;
+    float ki;
+    float kd;
+};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class
+PIDGainSchedule
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates an empty schedule. Build must succeed before Lookup or
+        //      Apply is used.
+        //
+        PIDGainSchedule();
+
+        //
+        // Build
+        // Description:
+        //      Precomputes the table. The gains of every breakpoint are altered
+        //      for the sample time and direction exactly as PIDTuningsSet does,
+        //      and the slope of each segment is worked out, so a lookup only
+        //      searches and interpolates. A schedule serves every controller
+        //      with that sample time and direction; rebuild it after
+        //      PIDSampleTimeSet or PIDControllerDirectionSet.
+        // Parameters:
+        //      points - The breakpoints, sorted by strictly increasing key.
+        //      count - The number of breakpoints, at least 1.
+        //      sampleTimeSeconds - The sample time of the controllers.
+        //      direction - The direction of the controllers.
+        // Returns:
+        //      True if the table was built. False if a key is out of order or
+        //      not finite, a gain is negative or the sample time is not
+        //      positive, in which case the schedule is left as it was.
+        //
+        bool Build(const PIDGainBreakpoint *points, size_t count, float sampleTimeSeconds,
+                   PIDDirection direction);
+
+        //
+        // Lookup
+        // Description:
+        //      Interpolates the altered gains at key. Keys outside the table
+        //      get the gains of the nearest end, and NaN gets those of the
+        //      first breakpoint. The key range is cut into equal cells no wider
+        //      than half the narrowest segment, each of which knows the segment
+        //      it starts in, so finding the segment is one multiply, one load
+        //      from a small index and one compare, without a branch. Tables
+        //      too uneven for PID_GAIN_SCHEDULE_MAX_CELLS cells fall back to a
+        //      branch free binary search instead.
+        // Parameters:
+        //      key - The operating point.
+        //      kp, ki, kd - Receive the altered gains.
+        // Returns:
+        //      Nothing.
+        //
+        inline void Lookup(float key, float &kp, float &ki, float &kd) const
+        {
+            size_t index;
+
+            // Clamp into the table, written so that NaN ends up at the start
+            key = key > keys[0] ? key : keys[0];
+            key = key < lastKey ? key : lastKey;
+
+            // The last key not above the operating point. A cell holds at most
+            // one key, and keys ends in +inf, so one step from the segment the
+            // cell starts in is enough.
+            if(!cells.empty())
+            {
+                index = cells[(size_t)((key - keys[0]) * cellScale)];
+                index += (keys[index + 1] <= key) ? 1 : 0;
+            }
+            else
+            {
+                const float *base = keys.data();
+                size_t n = segments.size();
+
+                while(n > 1)
+                {
+                    size_t half = n / 2;
+
+                    base = (base[half] <= key) ? base + half : base;
+                    n -= half;
+                }
+                index = (size_t)(base - keys.data());
+            }
+
+            const Segment &segment = segments[index];
+            float offset = key - segment.key;
+
+            kp = segment.kp + segment.slopeKp * offset;
+            ki = segment.ki + segment.slopeKi * offset;
+            kd = segment.kd + segment.slopeKd * offset;
+        }
+
+        //
+        // Apply
+        // Description:
+        //      Looks up the gains at key and hands them to the controller with
+        //      PIDScheduledGainsSet. Call it before the controller's compute.
+        //      Works with any controller that has PIDScheduledGainsSet, such as
+        //      PIDControl or PIDBankView.
+        // Parameters:
+        //      pid - The controller to schedule.
+        //      key - The operating point.
+        // Returns:
+        //      Nothing.
+        //
+        template <typename Controller>
+        void Apply(Controller &pid, float key) const
+        {
+            float kp, ki, kd;
+
+            Lookup(key, kp, ki, kd);
+            pid.PIDScheduledGainsSet(kp, ki, kd);
+        }
+
+        //
+        // Apply
+        // Description:
+        //      Same as above, keyed on the controller's input. Call it after
+        //      PIDInputSet.
+        //
+        template <typename Controller>
+        void Apply(Controller &pid) const
+        {
+            Apply(pid, static_cast<float>(pid.PIDInputGet()));
+        }
+
+        //
+        // Size
+        // Description:
+        //      Returns the number of breakpoints.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of breakpoints, 0 before the first Build.
+        //
+        inline size_t Size() const { return segments.size(); }
+
+    private:
+        typedef std::vector<uint32_t, PIDAlignedAllocator<uint32_t> > CellArray;
+
+        //
+        // Fills the cell index over keys, or leaves it empty when the table
+        // needs more than PID_GAIN_SCHEDULE_MAX_CELLS cells
+        //
+        static void CellsBuild(const float *keys, size_t count, CellArray &cells,
+                               float &scale);
+
+        //
+        // The altered gains at a breakpoint and their change per unit of key
+        // up to the next one. The last breakpoint has slopes of 0.
+        //
+        struct
+        alignas(32) Segment
+        {
+            float key;
+            float kp;
+            float ki;
+            float kd;
+            float slopeKp;
+            float slopeKi;
+            float slopeKd;
+        };
+
+        //
+        // The key of every breakpoint followed by +inf, the segment each cell
+        // starts in and the number of cells per unit of key
+        //
+        std::vector<float, PIDAlignedAllocator<float> > keys;
+        CellArray cells;
+        float cellScale;
+        float lastKey;
+
+        std::vector<Segment, PIDAlignedAllocator<Segment> > segments;
+};
+
+#endif  // PID_GAIN_SCHEDULE_H
@@ -0,0 +1,436 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Runs cascades and other multi-loop graphs of controllers in a
+// PIDBank. The graph is sorted once into a flat schedule of kernel passes and
+// edge copies, independent parts of the graph run on their own threads, and each
+// controller can run at its own fraction of the tick rate.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <algorithm>
+#include "pid_graph.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Shares of a level are whole cache lines of the bank arrays, so that two 
+// threads do not write the same line
+//
+#define PID_GRAPH_ALIGNMENT     (PID_CACHE_LINE_SIZE / sizeof(float))
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDGraph::
+PIDGraph(PIDBank &bank) :
+    bank(bank),
+    levelCount(0),
+    tickCount(0)
+{
+}
+
+PIDGraph::
+~PIDGraph()
+{
+    pool.Stop();
+}
+
+bool PIDGraph::
+Connect(size_t from, size_t to, PIDGraphPort port, float gain, float offset)
+{
+    Edge edge;
+
+    if(from >= bank.Size() || to >= bank.Size() || from == to)
+    {
+        return false;
+    }
+
+    edge.from = (uint32_t)from;
+    edge.to = (uint32_t)to;
+    edge.port = port;
+    edge.gain = gain;
+    edge.offset = offset;
+    edges.push_back(edge);
+
+    return true;
+}
+
+void PIDGraph::
+RateSet(size_t index, unsigned divider)
+{
+    if(index >= dividers.size())
+    {
+        dividers.resize(index + 1, 1);
+    }
+
+    dividers[index] = divider ? divider : 1;
+}
+
+bool PIDGraph::
+Build(unsigned threadCount, bool pinThreads, unsigned firstCpu)
+{
+    size_t n = bank.Size();
+    std::vector<std::vector<size_t> > outgoing(n);
+    std::vector<size_t> indegree(n, 0), level(n, 0), ready;
+    size_t sorted = 0, levels = 0;
+
+    dividers.resize(n, 1);
+
+    for(size_t e = 0; e < edges.size(); e++)
+    {
+        outgoing[edges[e].from].push_back(e);
+        indegree[edges[e].to]++;
+    }
+
+    // Kahn's algorithm. A controller's level is one past the deepest
+    // controller feeding it.
+    for(size_t i = 0; i < n; i++)
+    {
+        if(indegree[i] == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+
+    while(!ready.empty())
+    {
+        size_t node = ready.back();
+
+        ready.pop_back();
+        sorted++;
+        levels = std::max(levels, level[node] + 1);
+
+        for(size_t e : outgoing[node])
+        {
+            size_t to = edges[e].to;
+
+            level[to] = std::max(level[to], level[node] + 1);
+            if(--indegree[to] == 0)
+            {
+                ready.push_back(to);
+            }
+        }
+    }
+
+    if(sorted != n)
+    {
+        return false;
+    }
+
+    // Every controller in schedule order, by level, then divider, then index,
+    // and the groups of it that share a level and a divider
+    std::vector<uint32_t> order(n);
+    std::vector<size_t> groupFirst;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        order[i] = (uint32_t)i;
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+              {
+                  if(level[a] != level[b])
+                  {
+                      return level[a] < level[b];
+                  }
+                  if(dividers[a] != dividers[b])
+                  {
+                      return dividers[a] < dividers[b];
+                  }
+                  return a < b;
+              });
+
+    for(size_t k = 0; k < n; k++)
+    {
+        if(k == 0 || level[order[k]] != level[order[k - 1]] || 
+           dividers[order[k]] != dividers[order[k - 1]])
+        {
+            groupFirst.push_back(k);
+        }
+    }
+    groupFirst.push_back(n);
+
+    if(threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+        threadCount = threadCount ? threadCount : 1;
+    }
+
+    size_t partCount = 1;
+
+    for(size_t g = 0; g + 1 < groupFirst.size(); g++)
+    {
+        size_t size = groupFirst[g + 1] - groupFirst[g];
+
+        partCount = std::max(partCount, size / PID_GRAPH_MIN_SHARE);
+    }
+    partCount = std::min<size_t>(partCount, threadCount);
+
+    // Each group large enough is cut into one share per part, alike but for
+    // the last. The others go whole onto the least loaded part.
+    std::vector<uint32_t> owner(n, 0);
+    std::vector<size_t> load(partCount, 0);
+
+    for(size_t g = 0; g + 1 < groupFirst.size(); g++)
+    {
+        size_t first = groupFirst[g];
+        size_t size = groupFirst[g + 1] - first;
+        size_t shares = std::min(partCount, size / PID_GRAPH_MIN_SHARE);
+
+        if(shares <= 1)
+        {
+            size_t lightest = 0;
+
+            for(size_t p = 1; p < partCount; p++)
+            {
+                lightest = (load[p] < load[lightest]) ? p : lightest;
+            }
+            for(size_t k = first; k < first + size; k++)
+            {
+                owner[order[k]] = (uint32_t)lightest;
+            }
+            load[lightest] += size;
+            continue;
+        }
+
+        size_t share = (size + shares - 1) / shares;
+
+        share = (share + PID_GRAPH_ALIGNMENT - 1) / PID_GRAPH_ALIGNMENT * PID_GRAPH_ALIGNMENT;
+        for(size_t k = 0; k < size; k++)
+        {
+            size_t p = std::min(k / share, shares - 1);
+
+            owner[order[first + k]] = (uint32_t)p;
+            load[p]++;
+        }
+    }
+
+    // The edges into each controller are delivered by the thread computing
+    // it, before its level, in the order the edges' sources are computed in
+    // a single thread, so that edges into the same port land as they would
+    std::vector<size_t> rank(n), into(edges.size());
+
+    for(size_t k = 0; k < n; k++)
+    {
+        rank[order[k]] = k;
+    }
+    for(size_t e = 0; e < edges.size(); e++)
+    {
+        into[e] = e;
+    }
+    std::sort(into.begin(), into.end(), [&](size_t a, size_t b)
+              {
+                  if(rank[edges[a].from] != rank[edges[b].from])
+                  {
+                      return rank[edges[a].from] < rank[edges[b].from];
+                  }
+                  return a < b;
+              });
+
+    std::vector<std::vector<size_t> > levelEdges(levels);
+
+    for(size_t e : into)
+    {
+        levelEdges[level[edges[e].to]].push_back(e);
+    }
+
+    // A wait before a level is needed only if an edge into it comes from
+    // another thread's controller at or past the last wait
+    std::vector<bool> sync(levels, false);
+    size_t fence = 0;
+
+    for(size_t l = 1; l < levels; l++)
+    {
+        for(size_t e : levelEdges[l])
+        {
+            const Edge &edge = edges[e];
+
+            if(owner[edge.from] != owner[edge.to] && level[edge.from] >= fence)
+            {
+                sync[l] = true;
+                fence = l;
+                break;
+            }
+        }
+    }
+
+    // Flatten every part into its levels
+    std::vector<Part> built(partCount);
+    std::vector<uint32_t> share;
+    size_t g = 0;
+
+    for(size_t l = 0; l < levels; l++)
+    {
+        for(size_t p = 0; p < partCount; p++)
+        {
+            Level entry;
+
+            entry.sync = sync[l];
+            entry.copyFirst = built[p].copies.size();
+            entry.stepFirst = built[p].steps.size();
+            built[p].levels.push_back(entry);
+        }
+
+        for(size_t e : levelEdges[l])
+        {
+            const Edge &edge = edges[e];
+            Part &part = built[owner[edge.to]];
+            Copy copy;
+
+            copy.source = bank.OutputData() + edge.from;
+            copy.target = (edge.port == PID_GRAPH_SETPOINT) ? bank.SetpointData() + edge.to
+                                                           : bank.InputData() + edge.to;
+            copy.gain = edge.gain;
+            copy.offset = edge.offset;
+            copy.divider = dividers[edge.from];
+            part.copies.push_back(copy);
+        }
+
+        for( ; g + 1 < groupFirst.size() && level[order[groupFirst[g]]] == l; g++)
+        {
+            for(size_t p = 0; p < partCount; p++)
+            {
+                Part &part = built[p];
+                Step step;
+
+                share.clear();
+                for(size_t k = groupFirst[g]; k < groupFirst[g + 1]; k++)
+                {
+                    if(owner[order[k]] == p)
+                    {
+                        share.push_back(order[k]);
+                    }
+                }
+                if(share.empty())
+                {
+                    continue;
+                }
+
+                step.divider = dividers[share.front()];
+                step.runFirst = part.runs.size();
+                step.gatherFirst = part.gather.size();
+                PIDRunsSplit(share.data(), share.size(), part.runs, part.gather);
+                step.runLast = part.runs.size();
+                step.gatherLast = part.gather.size();
+                part.steps.push_back(step);
+            }
+        }
+
+        for(size_t p = 0; p < partCount; p++)
+        {
+            built[p].levels.back().copyLast = built[p].copies.size();
+            built[p].levels.back().stepLast = built[p].steps.size();
+        }
+    }
+
+    for(size_t p = 0; p < partCount; p++)
+    {
+        built[p].size = load[p];
+    }
+
+    // Swap in the new schedule and its threads
+    pool.Stop();
+
+    parts.swap(built);
+    levelCount = levels;
+
+    pool.Start(parts.size(), [this](size_t part) { RunPart(part, tickCount); },
+               pinThreads, firstCpu);
+
+    return true;
+}
+
+uint64_t PIDGraph::
+Tick()
+{
+    uint64_t tick = ++tickCount;
+
+    if(!parts.empty())
+    {
+        pool.Run();
+    }
+
+    return tick;
+}
+
+//*********************************************************************************
+// Private Class Functions
+//*********************************************************************************
+
+void PIDGraph::
+RunPart(size_t index, uint64_t tick)
+{
+    const Part &part = parts[index];
+
+    for(const Level &level : part.levels)
+    {
+        if(level.sync)
+        {
+            pool.Sync();
+        }
+
+        // The first tick runs every controller
+        for(size_t c = level.copyFirst; c < level.copyLast; c++)
+        {
+            const Copy &copy = part.copies[c];
+
+            if((tick - 1) % copy.divider == 0)
+            {
+                *(copy.target) = copy.gain * *(copy.source) + copy.offset;
+            }
+        }
+
+        for(size_t s = level.stepFirst; s < level.stepLast; s++)
+        {
+            const Step &step = part.steps[s];
+
+            if((tick - 1) % step.divider != 0)
+            {
+                continue;
+            }
+
+            for(size_t r = step.runFirst; r < step.runLast; r++)
+            {
+                bank.ComputeRange(part.runs[r].first, part.runs[r].last);
+            }
+
+            if(step.gatherLast != step.gatherFirst)
+            {
+                bank.ComputeIndices(part.gather.data() + step.gatherFirst,
+                                    step.gatherLast - step.gatherFirst);
+            }
+        }
+    }
+}
@@ -0,0 +1,268 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Runs cascades and other multi-loop graphs of controllers in a
+// PIDBank. The graph is sorted once into a flat schedule of kernel passes and
+// edge copies, independent parts of the graph run on their own threads, and each
+// controller can run at its own fraction of the tick rate.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_GRAPH_H
+#define PID_GRAPH_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_parallel.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Fewest controllers of a level worth a thread of their own. Below it the 
+// wait for the other threads costs more than sharing the level saves.
+//
+#define PID_GRAPH_MIN_SHARE     64
+
+//
+// Where an edge of the graph writes the output of its source controller
+//
+typedef enum
+{
+    PID_GRAPH_SETPOINT,
+    PID_GRAPH_INPUT
+}
+PIDGraphPort;
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class
+PIDGraph
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates a graph over the controllers of a bank with no edges.
+        //      Every controller of the bank is a node. The bank must not be
+        //      bound, and must not have controllers added to it after Build.
+        // Parameters:
+        //      bank - The bank of controllers to run.
+        // Returns:
+        //      Nothing.
+        //
+        explicit PIDGraph(PIDBank &bank);
+
+        //
+        // Destructor
+        // Description:
+        //      Stops and joins the worker threads.
+        //
+        ~PIDGraph();
+
+        PIDGraph(const PIDGraph &) = delete;
+        PIDGraph &operator=(const PIDGraph &) = delete;
+
+        //
+        // Connect
+        // Description:
+        //      Adds an edge that, every time controller from is computed,
+        //      writes gain * output + offset of from into the setpoint or the
+        //      input of controller to. A cascade connects the outer loop to
+        //      the setpoint of the inner loop. Takes effect on the next Build.
+        // Parameters:
+        //      from - Index of the source controller in the bank.
+        //      to - Index of the target controller in the bank.
+        //      port - PID_GRAPH_SETPOINT or PID_GRAPH_INPUT of the target.
+        //      gain - Scale applied to the source output.
+        //      offset - Offset added after the scale.
+        // Returns:
+        //      False if either index is not in the bank or they are the same.
+        //      True otherwise.
+        //
+        bool Connect(size_t from, size_t to, PIDGraphPort port = PID_GRAPH_SETPOINT,
+                     float gain = 1.0f, float offset = 0.0f);
+
+        //
+        // Rate Set
+        // Description:
+        //      Runs a controller only on every divider-th tick, starting with
+        //      the first, so a slow outer loop is not computed on every tick
+        //      of a fast inner loop. Its output, and the edges from it, hold
+        //      in between. The controller's sample time should be divider
+        //      tick periods. Takes effect on the next Build.
+        // Parameters:
+        //      index - Index of the controller in the bank.
+        //      divider - Number of ticks per compute. 0 is taken as 1.
+        // Returns:
+        //      Nothing.
+        //
+        void RateSet(size_t index, unsigned divider);
+
+        //
+        // Build
+        // Description:
+        //      Sorts the graph into levels, where every controller comes after
+        //      the controllers feeding it. Every tick runs the levels in 
+        //      order, with the controllers of each level that share a divider
+        //      split into cache line aligned shares, one per thread. A thread
+        //      delivers the edges into the controllers it computes, and waits 
+        //      for the others before a level only if one of those edges comes 
+        //      from a controller another thread computed since the last wait.
+        //      Contiguous runs of controllers of a share are computed in 
+        //      place, the rest are gathered.
+        // Parameters:
+        //      threads - Number of threads to run the graph on, including the
+        //          one calling Tick. Zero uses one per hardware thread. Fewer
+        //          are used if no level has PID_GRAPH_MIN_SHARE controllers 
+        //          per thread.
+        //      pinThreads - Pin worker i to CPU (firstCpu + i) where the
+        //          platform supports it. The thread calling Tick computes 
+        //          part 0 and is pinned to firstCpu by its first Tick.
+        //      firstCpu - CPU of the thread calling Tick.
+        // Returns:
+        //      False, leaving the previous schedule in place, if the edges
+        //      form a cycle. True otherwise.
+        //
+        bool Build(unsigned threads = 1, bool pinThreads = false, unsigned firstCpu = 0);
+
+        //
+        // Tick
+        // Description:
+        //      Runs the schedule once and returns when every part is done.
+        //      Inputs of controllers that are not fed by an edge, and
+        //      setpoints of the outermost loops, are set by the caller before.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of the tick that was just run, starting at 1.
+        //
+        uint64_t Tick();
+
+        //
+        // Schedule Information
+        //
+        inline size_t LevelCount() const { return levelCount; }
+        inline size_t PartCount() const { return parts.size(); }
+        inline uint64_t TickCount() const { return tickCount; }
+
+    private:
+        struct
+        Edge
+        {
+            uint32_t from;
+            uint32_t to;
+            PIDGraphPort port;
+            float gain;
+            float offset;
+        };
+
+        //
+        // A resolved edge of the schedule, delivered on the ticks its source
+        // is computed on
+        //
+        struct
+        Copy
+        {
+            const float *source;
+            float *target;
+            float gain;
+            float offset;
+            unsigned divider;
+        };
+
+        //
+        // A thread's share of the controllers of one level that share a 
+        // divider. The members index the arrays of the Part.
+        //
+        struct
+        Step
+        {
+            unsigned divider;
+            size_t runFirst, runLast;
+            size_t gatherFirst, gatherLast;
+        };
+
+        //
+        // A thread's share of one level: the edges into its controllers 
+        // there, then its steps. Every thread has the same levels and waits
+        // for the others before a level with sync set.
+        //
+        struct
+        Level
+        {
+            bool sync;
+            size_t copyFirst, copyLast;
+            size_t stepFirst, stepLast;
+        };
+
+        //
+        // The schedule of one thread
+        //
+        struct
+        Part
+        {
+            std::vector<Level> levels;
+            std::vector<Step> steps;
+            std::vector<PIDRun> runs;
+            std::vector<uint32_t> gather;
+            std::vector<Copy> copies;
+            size_t size;
+        };
+
+        //
+        // Runs the schedule of a part for a tick
+        //
+        void RunPart(size_t part, uint64_t tick);
+
+        PIDBank &bank;
+        std::vector<Edge> edges;
+        std::vector<unsigned> dividers;
+        std::vector<Part> parts;
+        size_t levelCount;
+        uint64_t tickCount;
+
+        //
+        // One worker per part. Last, so that it stops before the rest goes.
+        //
+        PIDWorkerPool pool;
+};
+
+#endif  // PID_GRAPH_H
@@ -0,0 +1,432 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Optional instrumentation for the PID controllers and banks.
+// Counts how often the output and the integrator are clamped, keeps a histogram
+// of compute latencies and tracks how far the real call period drifts and
+// jitters. The policy is chosen at compile time, and the default policy records
+// nothing and costs nothing.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <string.h>
+#include "pid_instrumentation.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// The slot of a PIDStatsCollector each thread records into. A thread takes a
+// free slot the first time it records and gives it back when it exits. Slot
+// PID_STATS_THREAD_SLOTS stands for the shared overflow counters.
+//
+struct
+PIDStatsThread
+{
+    PIDStatsThread();
+    ~PIDStatsThread();
+
+    unsigned slot;
+    uint64_t id;
+};
+
+static std::mutex threadSlotMutex;
+static bool threadSlotTaken[PID_STATS_THREAD_SLOTS];
+static std::atomic<uint64_t> threadNextId(1);
+static thread_local PIDStatsThread statsThread;
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+PIDStatsThread::
+PIDStatsThread() : slot(PID_STATS_THREAD_SLOTS), id(threadNextId.fetch_add(1))
+{
+    std::lock_guard<std::mutex> lock(threadSlotMutex);
+
+    for(unsigned i = 0; i < PID_STATS_THREAD_SLOTS; i++)
+    {
+        if(!threadSlotTaken[i])
+        {
+            threadSlotTaken[i] = true;
+            slot = i;
+            break;
+        }
+    }
+}
+
+PIDStatsThread::
+~PIDStatsThread()
+{
+    std::lock_guard<std::mutex> lock(threadSlotMutex);
+
+    if(slot < PID_STATS_THREAD_SLOTS)
+    {
+        threadSlotTaken[slot] = false;
+    }
+}
+
+//
+// Only the owning thread writes a counter, so a load and a store is enough
+// and avoids a locked read-modify-write on the hot path
+//
+static inline void
+CounterAdd(std::atomic<uint64_t> &counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+static inline uint64_t
+CounterGet(const std::atomic<uint64_t> &counter)
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+static inline void
+CounterSet(std::atomic<uint64_t> &counter, uint64_t value)
+{
+    counter.store(value, std::memory_order_relaxed);
+}
+
+static inline unsigned
+LatencyBucket(uint64_t nanoseconds)
+{
+    unsigned bucket;
+
+    if(nanoseconds < 2)
+    {
+        return 0;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    bucket = 63 - __builtin_clzll(nanoseconds);
+#else
+    for(bucket = 0; nanoseconds > 1; bucket++)
+    {
+        nanoseconds >>= 1;
+    }
+#endif
+
+    return (bucket < PID_LATENCY_BUCKETS) ? bucket : PID_LATENCY_BUCKETS - 1;
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+void PIDStats::
+Reset()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+void PIDStats::
+Merge(const PIDStats &other)
+{
+    calls += other.calls;
+    computes += other.computes;
+    outputSaturated += other.outputSaturated;
+    integratorClamped += other.integratorClamped;
+
+    for(unsigned i = 0; i < PID_LATENCY_BUCKETS; i++)
+    {
+        latency[i] += other.latency[i];
+    }
+
+    if(other.periods == 0)
+    {
+        return;
+    }
+
+    periodMin = (periods == 0 || other.periodMin < periodMin) ? other.periodMin : periodMin;
+    periodMax = (other.periodMax > periodMax) ? other.periodMax : periodMax;
+    periods += other.periods;
+    periodSum += other.periodSum;
+    periodSquares += other.periodSquares;
+}
+
+double PIDStats::
+PeriodMean() const
+{
+    return periods ? (double)periodSum / (double)periods : 0.0;
+}
+
+double PIDStats::
+PeriodJitter() const
+{
+    double mean, variance;
+
+    if(periods == 0)
+    {
+        return 0.0;
+    }
+
+    mean = PeriodMean();
+    variance = periodSquares / (double)periods - mean * mean;
+
+    // Rounding can leave a tiny negative variance for a perfectly steady period
+    return (variance > 0.0) ? sqrt(variance) : 0.0;
+}
+
+uint64_t PIDStats::
+LatencyPercentile(double fraction) const
+{
+    uint64_t total = 0;
+    uint64_t seen = 0;
+    uint64_t target;
+
+    for(unsigned i = 0; i < PID_LATENCY_BUCKETS; i++)
+    {
+        total += latency[i];
+    }
+
+    if(total == 0)
+    {
+        return 0;
+    }
+
+    target = (uint64_t)ceil(fraction * (double)total);
+    target = target ? target : 1;
+
+    for(unsigned i = 0; i < PID_LATENCY_BUCKETS; i++)
+    {
+        seen += latency[i];
+        if(seen >= target)
+        {
+            return (uint64_t)2 << i;
+        }
+    }
+
+    return (uint64_t)2 << (PID_LATENCY_BUCKETS - 1);
+}
+
+PIDStatsCounter::
+PIDStatsCounter()
+{
+    Reset();
+}
+
+PIDStatsCounter::
+PIDStatsCounter(const PIDStatsCounter &other)
+{
+    *this = other;
+}
+
+PIDStatsCounter &PIDStatsCounter::
+operator=(const PIDStatsCounter &other)
+{
+    CounterSet(calls, CounterGet(other.calls));
+    CounterSet(computes, CounterGet(other.computes));
+    CounterSet(outputSaturated, CounterGet(other.outputSaturated));
+    CounterSet(integratorClamped, CounterGet(other.integratorClamped));
+
+    for(unsigned i = 0; i < PID_LATENCY_BUCKETS; i++)
+    {
+        CounterSet(latency[i], CounterGet(other.latency[i]));
+    }
+
+    CounterSet(periods, CounterGet(other.periods));
+    CounterSet(periodSum, CounterGet(other.periodSum));
+    periodSquares.store(other.periodSquares.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    CounterSet(periodMin, CounterGet(other.periodMin));
+    CounterSet(periodMax, CounterGet(other.periodMax));
+
+    // A copy is a different controller, its first call starts a new period
+    CounterSet(lastStart, 0);
+
+    return *this;
+}
+
+void PIDStatsCounter::
+Record(uint64_t start, uint64_t end, uint64_t computes, uint64_t saturated,
+       uint64_t clamped)
+{
+    uint64_t last = CounterGet(lastStart);
+
+    CounterAdd(calls, 1);
+    CounterAdd(this->computes, computes);
+    CounterAdd(outputSaturated, saturated);
+    CounterAdd(integratorClamped, clamped);
+    CounterAdd(latency[LatencyBucket(end - start)], 1);
+
+    if(last != 0 && start >= last)
+    {
+        uint64_t period = start - last;
+
+        CounterAdd(periods, 1);
+        CounterAdd(periodSum, period);
+        periodSquares.store(periodSquares.load(std::memory_order_relaxed) +
+                            (double)period * (double)period,
+                            std::memory_order_relaxed);
+        if(period < CounterGet(periodMin))
+        {
+            CounterSet(periodMin, period);
+        }
+        if(period > CounterGet(periodMax))
+        {
+            CounterSet(periodMax, period);
+        }
+    }
+
+    CounterSet(lastStart, start);
+}
+
+void PIDStatsCounter::
+Read(PIDStats &stats) const
+{
+    stats.calls = CounterGet(calls);
+    stats.computes = CounterGet(computes);
+    stats.outputSaturated = CounterGet(outputSaturated);
+    stats.integratorClamped = CounterGet(integratorClamped);
+
+    for(unsigned i = 0; i < PID_LATENCY_BUCKETS; i++)
+    {
+        stats.latency[i] = CounterGet(latency[i]);
+    }
+
+    stats.periods = CounterGet(periods);
+    stats.periodSum = CounterGet(periodSum);
+    stats.periodSquares = periodSquares.load(std::memory_order_relaxed);
+    stats.periodMin = stats.periods ? CounterGet(periodMin) : 0;
+    stats.periodMax = CounterGet(periodMax);
+}
+
+void PIDStatsCounter::
+Reset()
+{
+    CounterSet(calls, 0);
+    CounterSet(computes, 0);
+    CounterSet(outputSaturated, 0);
+    CounterSet(integratorClamped, 0);
+
+    for(unsigned i = 0; i < PID_LATENCY_BUCKETS; i++)
+    {
+        CounterSet(latency[i], 0);
+    }
+
+    CounterSet(periods, 0);
+    CounterSet(periodSum, 0);
+    periodSquares.store(0.0, std::memory_order_relaxed);
+    CounterSet(periodMin, UINT64_MAX);
+    CounterSet(periodMax, 0);
+    CounterSet(lastStart, 0);
+}
+
+PIDStatsCollector::
+PIDStatsCollector(const PIDStatsCollector &other)
+{
+    *this = other;
+}
+
+PIDStatsCollector &PIDStatsCollector::
+operator=(const PIDStatsCollector &other)
+{
+    if(this == &other)
+    {
+        return *this;
+    }
+
+    for(unsigned i = 0; i < PID_STATS_THREAD_SLOTS; i++)
+    {
+        slots[i].counter = other.slots[i].counter;
+        slots[i].owner = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(other.overflowMutex);
+    overflow.counter = other.overflow.counter;
+    overflow.owner = 0;
+
+    return *this;
+}
+
+void PIDStatsCollector::
+Record(uint64_t start, uint64_t end, uint64_t computes, uint64_t saturated,
+       uint64_t clamped)
+{
+    PIDStatsThread &thread = statsThread;
+
+    if(thread.slot < PID_STATS_THREAD_SLOTS)
+    {
+        Slot &slot = slots[thread.slot];
+
+        if(slot.owner != thread.id)
+        {
+            slot.owner = thread.id;
+            slot.counter.ForgetPeriod();
+        }
+        slot.counter.Record(start, end, computes, saturated, clamped);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(overflowMutex);
+
+    if(overflow.owner != thread.id)
+    {
+        overflow.owner = thread.id;
+        overflow.counter.ForgetPeriod();
+    }
+    overflow.counter.Record(start, end, computes, saturated, clamped);
+}
+
+void PIDStatsCollector::
+Read(PIDStats &stats) const
+{
+    PIDStats slotStats;
+
+    stats.Reset();
+
+    for(unsigned i = 0; i < PID_STATS_THREAD_SLOTS; i++)
+    {
+        slots[i].counter.Read(slotStats);
+        stats.Merge(slotStats);
+    }
+
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    overflow.counter.Read(slotStats);
+    stats.Merge(slotStats);
+}
+
+void PIDStatsCollector::
+Reset()
+{
+    for(unsigned i = 0; i < PID_STATS_THREAD_SLOTS; i++)
+    {
+        slots[i].counter.Reset();
+    }
+
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    overflow.counter.Reset();
+}
@@ -0,0 +1,354 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Optional instrumentation for the PID controllers and banks.
+// Counts how often the output and the integrator are clamped, keeps a histogram
+// of compute latencies and tracks how far the real call period drifts and
+// jitters. The policy is chosen at compile time, and the default policy records
+// nothing and costs nothing.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_INSTRUMENTATION_H
+#define PID_INSTRUMENTATION_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include "pid_aligned_allocator.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Latency histogram bucket b counts the calls that took [2^b, 2^(b+1))
+// nanoseconds. Bucket 0 also counts calls under a nanosecond and the last
+// bucket also counts everything slower.
+//
+#define PID_LATENCY_BUCKETS         24
+
+//
+// Number of threads a PIDStatsCollector gives a private set of counters.
+// Threads beyond this share one set of counters behind a mutex.
+//
+#define PID_STATS_THREAD_SLOTS      64
+
+//
+// A snapshot of the counters of a controller, a bank or a thread. Times are
+// in nanoseconds of std::chrono::steady_clock.
+//
+struct
+PIDStats
+{
+    //
+    // Number of compute calls and the number of controller updates they made.
+    // A PIDCompute call makes one update, a block or a bank pass makes many.
+    //
+    uint64_t calls;
+    uint64_t computes;
+
+    //
+    // Number of updates whose output was bounded by outMin or outMax, and
+    // whose integrator was bounded by outMin or outMax
+    //
+    uint64_t outputSaturated;
+    uint64_t integratorClamped;
+
+    //
+    // Histogram of the time each call took
+    //
+    uint64_t latency[PID_LATENCY_BUCKETS];
+
+    //
+    // Time between the starts of consecutive calls: the number of periods
+    // measured, their sum, sum of squares, minimum and maximum
+    //
+    uint64_t periods;
+    uint64_t periodSum;
+    double periodSquares;
+    uint64_t periodMin;
+    uint64_t periodMax;
+
+    //
+    // Reset
+    // Description:
+    //      Zeroes every counter.
+    //
+    void Reset();
+
+    //
+    // Merge
+    // Description:
+    //      Adds the counters of another snapshot to this one.
+    // Parameters:
+    //      other - The snapshot to add.
+    // Returns:
+    //      Nothing.
+    //
+    void Merge(const PIDStats &other);
+
+    //
+    // Period Mean and Jitter
+    // Description:
+    //      The mean call period and its standard deviation. Comparing the mean
+    //      with the sample time shows drift, the deviation shows jitter.
+    // Parameters:
+    //      None.
+    // Returns:
+    //      Nanoseconds, or 0 if fewer than one period was measured.
+    //
+    double PeriodMean() const;
+    double PeriodJitter() const;
+
+    //
+    // Latency Percentile
+    // Description:
+    //      Returns an upper bound on the given percentile of the call latency,
+    //      to the resolution of the histogram.
+    // Parameters:
+    //      fraction - The percentile as a fraction, such as 0.99.
+    // Returns:
+    //      Nanoseconds, or 0 if no calls were recorded.
+    //
+    uint64_t LatencyPercentile(double fraction) const;
+};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+//
+// PID Stats Now
+// Description:
+//      The clock all instrumentation timestamps are taken from.
+// Parameters:
+//      None.
+// Returns:
+//      Nanoseconds since an arbitrary epoch.
+//
+inline uint64_t
+PIDStatsNow()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//
+// The live counters behind a PIDStats. Only one thread may record into a
+// counter at a time, which lets every update be a plain load and store, but
+// any thread may read it at any time.
+//
+class
+PIDStatsCounter
+{
+    public:
+        PIDStatsCounter();
+        PIDStatsCounter(const PIDStatsCounter &other);
+        PIDStatsCounter &operator=(const PIDStatsCounter &other);
+
+        //
+        // Record
+        // Description:
+        //      Records one compute call.
+        // Parameters:
+        //      start - PIDStatsNow when the call started.
+        //      end - PIDStatsNow when the call finished.
+        //      computes - Number of controller updates the call made.
+        //      saturated - Number of those updates with a bounded output.
+        //      clamped - Number of those updates with a bounded integrator.
+        // Returns:
+        //      Nothing.
+        //
+        void Record(uint64_t start, uint64_t end, uint64_t computes,
+                    uint64_t saturated, uint64_t clamped);
+
+        //
+        // Read
+        // Description:
+        //      Copies the counters into a snapshot.
+        // Parameters:
+        //      stats - Receives the counters.
+        // Returns:
+        //      Nothing.
+        //
+        void Read(PIDStats &stats) const;
+
+        //
+        // Reset
+        // Description:
+        //      Zeroes the counters. The next call starts a new period. Calls
+        //      recorded while Reset runs may be partly kept.
+        //
+        void Reset();
+
+        //
+        // Forget Period
+        // Description:
+        //      Makes the next call start a new period instead of measuring the
+        //      time since the last one.
+        //
+        inline void ForgetPeriod() { lastStart.store(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> computes;
+        std::atomic<uint64_t> outputSaturated;
+        std::atomic<uint64_t> integratorClamped;
+        std::atomic<uint64_t> latency[PID_LATENCY_BUCKETS];
+        std::atomic<uint64_t> periods;
+        std::atomic<uint64_t> periodSum;
+        std::atomic<double> periodSquares;
+        std::atomic<uint64_t> periodMin;
+        std::atomic<uint64_t> periodMax;
+        std::atomic<uint64_t> lastStart;
+};
+
+//
+// Counters for objects, such as a PIDBank, that are computed from several
+// threads. Each thread records into its own cache line aligned PIDStatsCounter
+// and Read adds them up.
+//
+class
+PIDStatsCollector
+{
+    public:
+        PIDStatsCollector() {}
+        PIDStatsCollector(const PIDStatsCollector &other);
+        PIDStatsCollector &operator=(const PIDStatsCollector &other);
+
+        //
+        // Record
+        // Description:
+        //      Same as PIDStatsCounter::Record, into the calling thread's
+        //      counters.
+        //
+        void Record(uint64_t start, uint64_t end, uint64_t computes,
+                    uint64_t saturated, uint64_t clamped);
+
+        //
+        // Read
+        // Description:
+        //      Adds the counters of every thread into a snapshot.
+        // Parameters:
+        //      stats - Receives the counters.
+        // Returns:
+        //      Nothing.
+        //
+        void Read(PIDStats &stats) const;
+
+        //
+        // Reset
+        // Description:
+        //      Zeroes the counters of every thread.
+        //
+        void Reset();
+
+    private:
+        struct
+        alignas(PID_CACHE_LINE_SIZE) Slot
+        {
+            PIDStatsCounter counter;
+
+            //
+            // Thread that last recorded into the slot. A thread taking over
+            // the slot of a thread that exited starts a new period.
+            //
+            uint64_t owner = 0;
+        };
+
+        Slot slots[PID_STATS_THREAD_SLOTS];
+
+        //
+        // Shared by the threads that did not get a slot of their own
+        //
+        Slot overflow;
+        mutable std::mutex overflowMutex;
+};
+
+//
+// Instrumentation Policies
+// Description:
+//      A controller inherits from its instrumentation policy and calls
+//      StatsBegin at the start of each compute and StatsEnd at the end.
+//      PIDInstrumentationNone is empty and every call does nothing, so the
+//      compiler removes the instrumentation along with the clamp checks that
+//      feed it. PIDInstrumentationCounters records into a PIDStatsCounter.
+//
+class
+PIDInstrumentationNone
+{
+    public:
+        static constexpr bool enabled = false;
+
+        inline uint64_t StatsBegin() const { return 0; }
+        inline void StatsEnd(uint64_t, uint64_t, uint64_t, uint64_t) {}
+        inline void StatsRead(PIDStats &stats) const { stats.Reset(); }
+        inline void StatsReset() {}
+};
+
+class
+PIDInstrumentationCounters
+{
+    public:
+        static constexpr bool enabled = true;
+
+        inline uint64_t StatsBegin() const { return PIDStatsNow(); }
+        inline void StatsEnd(uint64_t start, uint64_t computes, uint64_t saturated,
+                             uint64_t clamped)
+        {
+            counter.Record(start, PIDStatsNow(), computes, saturated, clamped);
+        }
+        inline void StatsRead(PIDStats &stats) const { counter.Read(stats); }
+        inline void StatsReset() { counter.Reset(); }
+
+    private:
+        PIDStatsCounter counter;
+};
+
+//
+// Building with PID_INSTRUMENTATION defined, or configuring CMake with
+// -DPID_INSTRUMENTATION=ON, instruments every controller and bank that does
+// not pick a policy of its own.
+//
+#ifdef PID_INSTRUMENTATION
+    typedef PIDInstrumentationCounters PIDInstrumentationDefault;
+#else
+    typedef PIDInstrumentationNone PIDInstrumentationDefault;
+#endif
+
+#endif  // PID_INSTRUMENTATION_H
@@ -0,0 +1,289 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Internal helpers shared by the bank executor, the controller
+// graph and the scheduler. See pid_parallel.h.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include "pid_parallel.h"
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Number of times a waiting thread polls before it goes to sleep. At a 1 kHz
+// tick this keeps the wake up latency in the sub microsecond range without
+// burning a core for the whole tick period.
+//
+#define PID_SPIN_COUNT          4096
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+PinThread(std::thread::native_handle_type thread, unsigned cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    unsigned cpuCount = std::thread::hardware_concurrency();
+
+    CPU_ZERO(&set);
+    CPU_SET(cpuCount ? cpu % cpuCount : cpu, &set);
+    pthread_setaffinity_np(thread, sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+static void
+PinCaller(unsigned cpu)
+{
+#if defined(__linux__)
+    PinThread(pthread_self(), cpu);
+#else
+    (void)cpu;
+#endif
+}
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+void
+PIDRunsSplit(const uint32_t *indices, size_t count, std::vector<PIDRun> &runs,
+             std::vector<uint32_t> &gather)
+{
+    for(size_t runFirst = 0; runFirst < count; )
+    {
+        size_t runLast = runFirst + 1;
+
+        while(runLast < count && indices[runLast] == indices[runLast - 1] + 1)
+        {
+            runLast++;
+        }
+
+        if(runLast - runFirst >= PID_MIN_RUN)
+        {
+            PIDRun run = { indices[runFirst], (size_t)indices[runLast - 1] + 1 };
+
+            runs.push_back(run);
+        }
+        else
+        {
+            gather.insert(gather.end(), indices + runFirst, indices + runLast);
+        }
+
+        runFirst = runLast;
+    }
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDWorkerPool::
+PIDWorkerPool() :
+    generation(0),
+    remaining(0),
+    stopping(false),
+    arrived(0),
+    phase(0),
+    callerPin(false),
+    callerCpu(0)
+{
+}
+
+PIDWorkerPool::
+~PIDWorkerPool()
+{
+    Stop();
+}
+
+void PIDWorkerPool::
+Start(size_t workers, Job job, bool pinThreads, unsigned firstCpu)
+{
+    Stop();
+
+    this->job = job;
+    callerPin = pinThreads;
+    callerCpu = firstCpu;
+
+    for(size_t worker = 1; worker < workers; worker++)
+    {
+        threads.emplace_back(&PIDWorkerPool::WorkerMain, this, worker,
+                             generation.load(std::memory_order_relaxed));
+
+        if(pinThreads)
+        {
+            PinThread(threads.back().native_handle(), firstCpu + (unsigned)worker);
+        }
+    }
+}
+
+void PIDWorkerPool::
+Run()
+{
+    int spins;
+
+    // The caller computes worker 0, so the first Run pins it with the rest
+    if(callerPin)
+    {
+        PinCaller(callerCpu);
+        callerPin = false;
+    }
+
+    if(threads.empty())
+    {
+        job(0);
+        return;
+    }
+
+    // Release the workers
+    remaining.store(threads.size(), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        generation.store(generation.load(std::memory_order_relaxed) + 1, 
+                         std::memory_order_release);
+    }
+    wake.notify_all();
+
+    // The calling thread is worker 0
+    job(0);
+
+    // End of run barrier
+    for(spins = 0; remaining.load(std::memory_order_acquire) != 0; spins++)
+    {
+        if(spins > PID_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void PIDWorkerPool::
+Sync()
+{
+    uint64_t current;
+    int spins;
+
+    if(threads.empty())
+    {
+        return;
+    }
+
+    // The phase is read before arriving, so the last worker cannot have moved
+    // it on yet
+    current = phase.load(std::memory_order_acquire);
+    if(arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == Size())
+    {
+        arrived.store(0, std::memory_order_relaxed);
+        phase.store(current + 1, std::memory_order_release);
+        return;
+    }
+
+    for(spins = 0; phase.load(std::memory_order_acquire) == current; spins++)
+    {
+        if(spins > PID_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void PIDWorkerPool::
+Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping.store(true, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    for(size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+
+    threads.clear();
+    stopping.store(false, std::memory_order_relaxed);
+}
+
+//*********************************************************************************
+// Private Class Functions
+//*********************************************************************************
+
+void PIDWorkerPool::
+WorkerMain(size_t worker, uint64_t seen)
+{
+    uint64_t signal;
+    int spins;
+
+    for(;;)
+    {
+        // Wait for the next run, spinning first and then sleeping
+        for(spins = 0; ; spins++)
+        {
+            signal = generation.load(std::memory_order_acquire);
+            if(signal != seen || stopping.load(std::memory_order_acquire))
+            {
+                break;
+            }
+
+            if(spins > PID_SPIN_COUNT)
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait(lock, [&] {
+                    return generation.load(std::memory_order_acquire) != seen ||
+                           stopping.load(std::memory_order_acquire);
+                });
+            }
+        }
+
+        if(stopping.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        seen = signal;
+        job(worker);
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
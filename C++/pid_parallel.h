@@ -0,0 +1,205 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Internal helpers shared by the bank executor, the controller
+// graph and the scheduler: a pool of worker threads that run a job together
+// every tick, and the split of a step's controllers into runs computed in place
+// and the rest, which are gathered.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_PARALLEL_H
+#define PID_PARALLEL_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pid_bank.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Contiguous runs of at least this many controllers of a step are computed in
+// place. Shorter runs are cheaper to gather than to pass through the kernel's
+// scalar tail on their own.
+//
+#define PID_MIN_RUN             16
+
+//
+// Controllers [first, last) of a bank, computed in place
+//
+struct
+PIDRun
+{
+    size_t first;
+    size_t last;
+};
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+//
+// PID Runs Split
+// Description:
+//      Appends the controllers of one step to a schedule: the contiguous 
+//      runs of at least PID_MIN_RUN to runs, the rest to gather.
+// Parameters:
+//      indices - The controllers of the step, in ascending order.
+//      count - Number of controllers.
+//      runs - Receives the runs.
+//      gather - Receives the controllers outside them.
+// Returns:
+//      Nothing.
+//
+void PIDRunsSplit(const uint32_t *indices, size_t count, std::vector<PIDRun> &runs,
+                  std::vector<uint32_t> &gather);
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+//
+// Threads that run the same job together, each with its own number. The
+// caller of Run is worker 0, so a pool of n workers starts n - 1 threads.
+// Between runs the threads spin for a short while before sleeping on a 
+// condition variable.
+//
+class
+PIDWorkerPool
+{
+    public:
+        typedef std::function<void(size_t worker)> Job;
+
+        //
+        // Constructor
+        // Description:
+        //      Creates a pool of one worker, the caller, until Start.
+        //
+        PIDWorkerPool();
+
+        //
+        // Destructor
+        // Description:
+        //      Stops and joins the worker threads.
+        //
+        ~PIDWorkerPool();
+
+        PIDWorkerPool(const PIDWorkerPool &) = delete;
+        PIDWorkerPool &operator=(const PIDWorkerPool &) = delete;
+
+        //
+        // Start
+        // Description:
+        //      Stops the threads of the last Start and starts new ones for a
+        //      job. Must not be called while Run is running.
+        // Parameters:
+        //      workers - Number of workers, including the caller of Run. 0 is
+        //          taken as 1.
+        //      job - What every worker runs on each Run, given its number.
+        //      pinThreads - Pin worker i to CPU (firstCpu + i) where the
+        //          platform supports it. Worker 0 is the thread that makes 
+        //          the first Run after Start, and is pinned by that Run.
+        //      firstCpu - CPU of worker 0.
+        // Returns:
+        //      Nothing.
+        //
+        void Start(size_t workers, Job job, bool pinThreads, unsigned firstCpu);
+
+        //
+        // Run
+        // Description:
+        //      Runs the job once on every worker and returns when all of them
+        //      are done.
+        //
+        void Run();
+
+        //
+        // Sync
+        // Description:
+        //      Barrier for the workers of a Run. Returns once every worker has
+        //      called it, so what each wrote before is seen by all of them 
+        //      after. Every worker must call it the same number of times.
+        //
+        void Sync();
+
+        //
+        // Stop
+        // Description:
+        //      Stops and joins the worker threads, leaving the caller alone.
+        //
+        void Stop();
+
+        inline size_t Size() const { return threads.size() + 1; }
+
+    private:
+        //
+        // Body of each worker thread. seen is the generation at start up.
+        //
+        void WorkerMain(size_t worker, uint64_t seen);
+
+        Job job;
+        std::vector<std::thread> threads;
+
+        //
+        // Start signal and end of run barrier
+        //
+        alignas(PID_CACHE_LINE_SIZE) std::atomic<uint64_t> generation;
+        alignas(PID_CACHE_LINE_SIZE) std::atomic<size_t> remaining;
+        std::atomic<bool> stopping;
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+
+        //
+        // Barrier within a run. The last worker to arrive moves phase on.
+        //
+        alignas(PID_CACHE_LINE_SIZE) std::atomic<size_t> arrived;
+        std::atomic<uint64_t> phase;
+
+        //
+        // Whether the next Run pins its caller, and to which CPU
+        //
+        bool callerPin;
+        unsigned callerCpu;
+};
+
+#endif  // PID_PARALLEL_H
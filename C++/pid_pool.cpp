@@ -0,0 +1,122 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Pools for large and changing populations of controllers. PIDPool
+// places objects such as PIDControl in cache line aligned slabs and hands out
+// stable handles, and PIDBankPool gives the controllers of a PIDBank stable
+// handles while the bank itself stays dense.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include "pid_pool.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// End of the free list
+//
+#define PID_POOL_NO_SLOT        0xFFFFFFFFu
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDBankPool::
+PIDBankPool(PIDBank &bank) :
+    bank(bank),
+    generation(bank.Size(), 1),
+    slotIndex(bank.Size()),
+    indexSlot(bank.Size()),
+    freeHead(PID_POOL_NO_SLOT)
+{
+    for(size_t i = 0; i < bank.Size(); i++)
+    {
+        slotIndex[i] = (uint32_t)i;
+        indexSlot[i] = (uint32_t)i;
+    }
+}
+
+PIDHandle PIDBankPool::
+PIDAdd(float kp, float ki, float kd, float sampleTimeSeconds, float minOutput,
+       float maxOutput, PIDMode mode, PIDDirection controllerDirection)
+{
+    size_t index = bank.PIDAdd(kp, ki, kd, sampleTimeSeconds, minOutput, maxOutput,
+                               mode, controllerDirection);
+    uint32_t slot;
+
+    if(freeHead != PID_POOL_NO_SLOT)
+    {
+        slot = freeHead;
+        // The generation was moved on when the slot was freed
+        freeHead = slotIndex[slot];
+    }
+    else
+    {
+        slot = (uint32_t)generation.size();
+        generation.push_back(1);
+        slotIndex.push_back(0);
+    }
+
+    slotIndex[slot] = (uint32_t)index;
+    indexSlot.push_back(slot);
+
+    return ((PIDHandle)generation[slot] << 32) | slot;
+}
+
+bool PIDBankPool::
+PIDRemove(PIDHandle handle)
+{
+    uint32_t slot = (uint32_t)handle;
+    size_t index, moved;
+
+    if(!Valid(handle))
+    {
+        return false;
+    }
+
+    index = slotIndex[slot];
+    moved = bank.PIDRemove(index);
+
+    // The last controller took the removed one's index
+    indexSlot[index] = indexSlot[moved];
+    slotIndex[indexSlot[index]] = (uint32_t)index;
+    indexSlot.pop_back();
+
+    // Old handles to the slot stop matching until it is handed out again
+    generation[slot] = (generation[slot] + 1) ? (generation[slot] + 1) : 1;
+    slotIndex[slot] = freeHead;
+    freeHead = slot;
+
+    return true;
+}
@@ -0,0 +1,355 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Pools for large and changing populations of controllers. PIDPool
+// places objects such as PIDControl in cache line aligned slabs and hands out
+// stable handles, and PIDBankPool gives the controllers of a PIDBank stable
+// handles while the bank itself stays dense.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_POOL_H
+#define PID_POOL_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+#include <vector>
+#include "pid_aligned_allocator.h"
+#include "pid_bank.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// A handle names a slot in its low 32 bits and the generation of the slot in
+// its high 32 bits. Removing an object moves its slot to the next generation,
+// so old handles to the slot stop resolving. Generations start at 1, so no
+// handle that was handed out is PID_HANDLE_NONE.
+//
+typedef uint64_t PIDHandle;
+
+#define PID_HANDLE_NONE         ((PIDHandle)0)
+
+//
+// Objects per PIDPool slab
+//
+#define PID_POOL_SLAB_CELLS     64
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+template <typename T>
+class
+PIDPool
+{
+    public:
+        PIDPool() : freeHead(NoSlot), count(0) {}
+
+        //
+        // Destructor
+        // Description:
+        //      Destroys the objects still in the pool and frees the slabs.
+        //
+        ~PIDPool()
+        {
+            for(uint32_t slot = 0; slot < next.size(); slot++)
+            {
+                if(next[slot] == LiveSlot)
+                {
+                    Object(slot)->~T();
+                }
+            }
+
+            for(size_t s = 0; s < slabs.size(); s++)
+            {
+                allocator.deallocate(slabs[s], PID_POOL_SLAB_CELLS);
+            }
+        }
+
+        PIDPool(const PIDPool &) = delete;
+        PIDPool &operator=(const PIDPool &) = delete;
+
+        //
+        // Create
+        // Description:
+        //      Constructs an object in the pool. The most recently freed slot
+        //      is reused first, and a new slab is only allocated when every
+        //      slot is in use. Each object sits in its own cache line sized
+        //      cell and never moves, so its address stays good for its life.
+        // Parameters:
+        //      args - Passed on to the constructor of T.
+        // Returns:
+        //      The handle of the new object.
+        //
+        template <typename... Args>
+        PIDHandle Create(Args &&... args)
+        {
+            uint32_t slot;
+
+            if(freeHead != NoSlot)
+            {
+                slot = freeHead;
+                freeHead = next[slot];
+            }
+            else
+            {
+                slot = (uint32_t)next.size();
+                if(slot % PID_POOL_SLAB_CELLS == 0)
+                {
+                    slabs.push_back(allocator.allocate(PID_POOL_SLAB_CELLS));
+                }
+                generation.push_back(1);
+                next.push_back(NoSlot);
+            }
+
+            new (slabs[slot / PID_POOL_SLAB_CELLS][slot % PID_POOL_SLAB_CELLS].storage)
+                T(std::forward<Args>(args)...);
+            next[slot] = LiveSlot;
+            count++;
+
+            return ((PIDHandle)generation[slot] << 32) | slot;
+        }
+
+        //
+        // Destroy
+        // Description:
+        //      Destroys an object and puts its slot on the free list.
+        // Parameters:
+        //      handle - Handle of the object.
+        // Returns:
+        //      False if the handle does not name a live object. True otherwise.
+        //
+        bool Destroy(PIDHandle handle)
+        {
+            T *object = Get(handle);
+            uint32_t slot = (uint32_t)handle;
+
+            if(object == nullptr)
+            {
+                return false;
+            }
+
+            object->~T();
+
+            // Skip generation 0 when the counter wraps
+            generation[slot] = (generation[slot] + 1) ? (generation[slot] + 1) : 1;
+            next[slot] = freeHead;
+            freeHead = slot;
+            count--;
+
+            return true;
+        }
+
+        //
+        // Get
+        // Description:
+        //      Resolves a handle.
+        // Parameters:
+        //      handle - Handle of the object.
+        // Returns:
+        //      The object, or null if the handle does not name a live object.
+        //
+        inline T *Get(PIDHandle handle) const
+        {
+            uint32_t slot = (uint32_t)handle;
+
+            if(slot >= next.size() || next[slot] != LiveSlot ||
+               generation[slot] != (uint32_t)(handle >> 32))
+            {
+                return nullptr;
+            }
+
+            return Object(slot);
+        }
+
+        //
+        // For Each
+        // Description:
+        //      Calls function on every live object in address order.
+        // Parameters:
+        //      function - Called as function(T &).
+        // Returns:
+        //      Nothing.
+        //
+        template <typename Function>
+        void ForEach(Function function)
+        {
+            for(uint32_t slot = 0; slot < next.size(); slot++)
+            {
+                if(next[slot] == LiveSlot)
+                {
+                    function(*Object(slot));
+                }
+            }
+        }
+
+        //
+        // Size
+        // Description:
+        //      Returns the number of live objects.
+        //
+        inline size_t Size() const { return count; }
+
+    private:
+        //
+        // Values of next that are not slots
+        //
+        static constexpr uint32_t NoSlot = 0xFFFFFFFFu;
+        static constexpr uint32_t LiveSlot = 0xFFFFFFFEu;
+
+        //
+        // Storage for one object, padded to whole cache lines so that no two
+        // objects share one
+        //
+        struct alignas(PID_CACHE_LINE_SIZE)
+        Cell
+        {
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        inline T *Object(uint32_t slot) const
+        {
+            return std::launder(reinterpret_cast<T *>(
+                slabs[slot / PID_POOL_SLAB_CELLS][slot % PID_POOL_SLAB_CELLS].storage));
+        }
+
+        //
+        // The slabs hold the objects only. The bookkeeping of each slot is
+        // kept apart so that looking up a handle does not touch the objects.
+        // next is the next free slot of a free slot and LiveSlot otherwise.
+        //
+        PIDAlignedAllocator<Cell> allocator;
+        std::vector<Cell *> slabs;
+        std::vector<uint32_t> generation;
+        std::vector<uint32_t> next;
+        uint32_t freeHead;
+        size_t count;
+};
+
+class
+PIDBankPool
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Gives every controller already in the bank a handle. From then
+        //      on controllers must be added and removed through the pool only.
+        // Parameters:
+        //      bank - The bank of controllers.
+        // Returns:
+        //      Nothing.
+        //
+        explicit PIDBankPool(PIDBank &bank);
+
+        //
+        // PID Add
+        // Description:
+        //      Appends a controller to the bank, as PIDBank::PIDAdd does, and
+        //      gives it a handle. Amortized constant time.
+        // Parameters:
+        //      Same as the PIDControl constructor.
+        // Returns:
+        //      The handle of the new controller.
+        //
+        PIDHandle PIDAdd(float kp, float ki, float kd, float sampleTimeSeconds,
+                         float minOutput, float maxOutput, PIDMode mode,
+                         PIDDirection controllerDirection);
+
+        //
+        // PID Remove
+        // Description:
+        //      Removes a controller in constant time with PIDBank::PIDRemove,
+        //      which moves the last controller of the bank into its index. The
+        //      handles of every other controller stay good, so passes over the
+        //      whole bank stay dense without the caller renumbering anything.
+        // Parameters:
+        //      handle - Handle of the controller.
+        // Returns:
+        //      False if the handle does not name a controller. True otherwise.
+        //
+        bool PIDRemove(PIDHandle handle);
+
+        //
+        // Valid, Index and Handle At
+        // Description:
+        //      Valid tells whether a handle names a controller of the bank.
+        //      Index is the current index of a valid handle's controller in
+        //      the bank, good until the next PIDRemove. HandleAt goes the other
+        //      way.
+        //
+        inline bool Valid(PIDHandle handle) const
+        {
+            uint32_t slot = (uint32_t)handle;
+
+            return slot < generation.size() && generation[slot] == (uint32_t)(handle >> 32);
+        }
+        inline size_t Index(PIDHandle handle) const { return slotIndex[(uint32_t)handle]; }
+        inline PIDHandle HandleAt(size_t index) const
+        {
+            uint32_t slot = indexSlot[index];
+
+            return ((PIDHandle)generation[slot] << 32) | slot;
+        }
+
+        //
+        // View
+        // Description:
+        //      Returns a PIDBankView of a valid handle's controller, good until
+        //      the next PIDRemove.
+        //
+        inline PIDBankView View(PIDHandle handle) { return bank.View(Index(handle)); }
+
+        inline size_t Size() const { return bank.Size(); }
+
+    private:
+        //
+        // generation and slotIndex are per slot. slotIndex is the bank index
+        // of a slot in use and the next free slot otherwise. A free slot's
+        // generation has not been handed out yet, so it never matches a
+        // handle. indexSlot is per bank index.
+        //
+        PIDBank &bank;
+        std::vector<uint32_t> generation;
+        std::vector<uint32_t> slotIndex;
+        std::vector<uint32_t> indexSlot;
+        uint32_t freeHead;
+};
+
+#endif  // PID_POOL_H
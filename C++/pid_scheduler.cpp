@@ -0,0 +1,215 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Runs the controllers of a PIDBank at their own sample times from
+// one fixed tick. Controllers are grouped by period and each group is spread
+// evenly over the ticks of its period so that slow loops do not all fire on the
+// same tick.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <algorithm>
+#include <math.h>
+#include <utility>
+#include "pid_scheduler.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Longest period in ticks. Sample times beyond it are run at this period.
+//
+#define PID_SCHEDULER_MAX_PERIOD    ((uint64_t)1 << 40)
+
+//
+// Fractional part of the golden ratio. Successive multiples of it are spread
+// evenly over [0, 1) and offset the phases of each group from the others.
+//
+#define PID_SCHEDULER_GOLDEN    0.6180339887498949
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDScheduler::
+PIDScheduler(PIDBank &bank, float tickSeconds) :
+    bank(bank),
+    tickSeconds(tickSeconds),
+    tickCount(0)
+{
+}
+
+void PIDScheduler::
+Build()
+{
+    size_t n = bank.Size();
+    std::vector<uint32_t> order(n);
+    std::vector<std::pair<uint64_t, uint32_t> > due;
+    std::vector<uint32_t> indices;
+
+    periods.resize(n);
+    groups.clear();
+    slots.clear();
+    runs.clear();
+    gather.clear();
+    tickCount = 0;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        double ticks = (double)bank.PIDSampleTimeGet(i) / tickSeconds;
+
+        // Also catches a non-finite ratio
+        if(!(ticks >= 1.0))
+        {
+            periods[i] = 1;
+        }
+        else if(ticks >= (double)PID_SCHEDULER_MAX_PERIOD)
+        {
+            periods[i] = PID_SCHEDULER_MAX_PERIOD;
+        }
+        else
+        {
+            periods[i] = (uint64_t)llround(ticks);
+        }
+
+        order[i] = (uint32_t)i;
+    }
+
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+              {
+                  return (periods[a] != periods[b]) ? (periods[a] < periods[b]) : (a < b);
+              });
+
+    for(size_t first = 0; first < n; )
+    {
+        uint64_t period = periods[order[first]];
+        size_t last = first;
+        size_t count;
+        uint64_t rotation;
+        double spread;
+        Group group;
+
+        while(last < n && periods[order[last]] == period)
+        {
+            last++;
+        }
+        count = last - first;
+
+        // Controller k of the group is due on phase k * period / count,
+        // rotated by a different amount for every group
+        spread = PID_SCHEDULER_GOLDEN * (double)groups.size();
+        rotation = (uint64_t)((spread - floor(spread)) * (double)period) % period;
+
+        due.clear();
+        for(size_t k = 0; k < count; k++)
+        {
+            uint64_t phase = (uint64_t)((double)k * (double)period / (double)count);
+
+            due.push_back(std::make_pair((phase + rotation) % period, order[first + k]));
+        }
+        std::sort(due.begin(), due.end());
+
+        group.period = period;
+        group.slotFirst = slots.size();
+
+        for(size_t d = 0; d < due.size(); )
+        {
+            size_t dLast = d;
+            Slot slot;
+
+            while(dLast < due.size() && due[dLast].first == due[d].first)
+            {
+                dLast++;
+            }
+
+            slot.phase = due[d].first;
+            slot.runFirst = runs.size();
+            slot.gatherFirst = gather.size();
+
+            indices.clear();
+            for(size_t r = d; r < dLast; r++)
+            {
+                indices.push_back(due[r].second);
+            }
+            PIDRunsSplit(indices.data(), indices.size(), runs, gather);
+
+            slot.runLast = runs.size();
+            slot.gatherLast = gather.size();
+            slots.push_back(slot);
+
+            d = dLast;
+        }
+
+        group.slotLast = slots.size();
+        group.next = group.slotFirst;
+        groups.push_back(group);
+
+        first = last;
+    }
+}
+
+size_t PIDScheduler::
+Tick()
+{
+    size_t computed = 0;
+
+    for(Group &group : groups)
+    {
+        const Slot &slot = slots[group.next];
+
+        if(slot.phase != tickCount % group.period)
+        {
+            continue;
+        }
+
+        for(size_t r = slot.runFirst; r < slot.runLast; r++)
+        {
+            bank.ComputeRange(runs[r].first, runs[r].last);
+            computed += runs[r].last - runs[r].first;
+        }
+
+        if(slot.gatherLast != slot.gatherFirst)
+        {
+            bank.ComputeIndices(gather.data() + slot.gatherFirst,
+                                slot.gatherLast - slot.gatherFirst);
+            computed += slot.gatherLast - slot.gatherFirst;
+        }
+
+        // Slots are in phase order, so the next one due follows this one
+        group.next = (group.next + 1 == group.slotLast) ? group.slotFirst : group.next + 1;
+    }
+
+    tickCount++;
+
+    return computed;
+}
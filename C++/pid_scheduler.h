@@ -0,0 +1,153 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Runs the controllers of a PIDBank at their own sample times from
+// one fixed tick. Controllers are grouped by period and each group is spread
+// evenly over the ticks of its period so that slow loops do not all fire on the
+// same tick.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_SCHEDULER_H
+#define PID_SCHEDULER_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_parallel.h"
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class
+PIDScheduler
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates a scheduler for the controllers of a bank. Nothing is
+        //      scheduled until Build is called.
+        // Parameters:
+        //      bank - The bank of controllers to run.
+        //      tickSeconds - Time between calls to Tick. Should divide the
+        //          sample time of every controller in the bank.
+        // Returns:
+        //      Nothing.
+        //
+        PIDScheduler(PIDBank &bank, float tickSeconds);
+
+        //
+        // Build
+        // Description:
+        //      Groups the controllers of the bank by their sample time, rounded
+        //      to a whole number of ticks (at least one), and gives each
+        //      controller of a group a phase within the group's period. A
+        //      group with more controllers than ticks in its period gets an even
+        //      share on every tick. A group with fewer gets them spaced out and
+        //      offset from the other groups. Must be called again after
+        //      controllers are added or PIDSampleTimeSet is called, and
+        //      restarts the schedule at tick 0.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      Nothing.
+        //
+        void Build();
+
+        //
+        // Tick
+        // Description:
+        //      Computes the controllers that are due on this tick. Contiguous
+        //      runs of controllers are computed in place, the rest are gathered.
+        //      Every controller is computed exactly once per period, the first
+        //      time within the first period. Like ComputeRange, the deadband
+        //      is ignored.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of controllers computed.
+        //
+        size_t Tick();
+
+        //
+        // Schedule Information
+        // Description:
+        //      GroupCount is the number of distinct periods. PeriodTicks is the
+        //      period of a controller in ticks as of the last Build.
+        //
+        inline size_t GroupCount() const { return groups.size(); }
+        inline uint64_t TickCount() const { return tickCount; }
+        inline uint64_t PeriodTicks(size_t index) const { return periods[index]; }
+
+    private:
+        //
+        // The controllers of a group that are due on one phase of its period.
+        // The members index runs and gather.
+        //
+        struct
+        Slot
+        {
+            uint64_t phase;
+            size_t runFirst, runLast;
+            size_t gatherFirst, gatherLast;
+        };
+
+        //
+        // The controllers sharing a period. Only phases with controllers have
+        // a slot, [slotFirst, slotLast) in phase order, and next is the slot
+        // that comes due next.
+        //
+        struct
+        Group
+        {
+            uint64_t period;
+            size_t slotFirst, slotLast;
+            size_t next;
+        };
+
+        PIDBank &bank;
+        float tickSeconds;
+        uint64_t tickCount;
+        std::vector<uint64_t> periods;
+        std::vector<Group> groups;
+        std::vector<Slot> slots;
+        std::vector<PIDRun> runs;
+        std::vector<uint32_t> gather;
+};
+
+#endif  // PID_SCHEDULER_H
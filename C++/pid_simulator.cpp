@@ -0,0 +1,568 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Closed loop simulation without hardware. See pid_simulator.h.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "pid_simulator.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// Taylor terms of the matrix exponential once its norm is scaled below 1/2
+#define PID_SIMULATOR_EXP_TERMS     16
+
+// Steps summed in float between additions to the metrics
+#define PID_SIMULATOR_BLOCK         1024
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// exp(m) by scaling and squaring, for the discretization of the plant models
+//
+static void
+MatrixExponential(const double m[3][3], double e[3][3])
+{
+    double scaled[3][3], term[3][3], next[3][3];
+    double norm = 0.0;
+    int squarings = 0;
+
+    for(int r = 0; r < 3; r++)
+    {
+        norm = std::max(norm, fabs(m[r][0]) + fabs(m[r][1]) + fabs(m[r][2]));
+    }
+    while(norm > 0.5)
+    {
+        norm *= 0.5;
+        squarings++;
+    }
+
+    for(int r = 0; r < 3; r++)
+    {
+        for(int c = 0; c < 3; c++)
+        {
+            scaled[r][c] = ldexp(m[r][c], -squarings);
+            term[r][c] = e[r][c] = (r == c) ? 1.0 : 0.0;
+        }
+    }
+
+    for(int k = 1; k <= PID_SIMULATOR_EXP_TERMS; k++)
+    {
+        for(int r = 0; r < 3; r++)
+        {
+            for(int c = 0; c < 3; c++)
+            {
+                next[r][c] = (term[r][0] * scaled[0][c] + term[r][1] * scaled[1][c] +
+                              term[r][2] * scaled[2][c]) / k;
+            }
+        }
+        for(int r = 0; r < 3; r++)
+        {
+            for(int c = 0; c < 3; c++)
+            {
+                term[r][c] = next[r][c];
+                e[r][c] += term[r][c];
+            }
+        }
+    }
+
+    while(squarings-- > 0)
+    {
+        for(int r = 0; r < 3; r++)
+        {
+            for(int c = 0; c < 3; c++)
+            {
+                next[r][c] = e[r][0] * e[0][c] + e[r][1] * e[1][c] + e[r][2] * e[2][c];
+            }
+        }
+        memcpy(e, next, sizeof(next));
+    }
+}
+
+//
+// One step of every plant. The arrays are declared restrict, as in the 
+// PIDBank kernels, so that the compiler vectorizes the loop without overlap
+// checks. With Delayed the input of each plant is gathered from the history,
+// where this step's inputs have already been written.
+//
+template <bool Delayed>
+static void
+StepLanes(const float *__restrict control, const float *__restrict history, 
+          const uint32_t *__restrict delay, size_t mask, uint64_t head, 
+          const float *__restrict phi11, const float *__restrict phi12, 
+          const float *__restrict phi21, const float *__restrict phi22, 
+          const float *__restrict gamma1, const float *__restrict gamma2, 
+          float *__restrict x1, float *__restrict x2, size_t n)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        float u = Delayed ? history[((head - delay[i]) & mask) * n + i] : control[i];
+        float y = x1[i];
+        float v = x2[i];
+
+        x1[i] = phi11[i] * y + phi12[i] * v + gamma1[i] * u;
+        x2[i] = phi21[i] * y + phi22[i] * v + gamma2[i] * u;
+    }
+}
+
+//
+// One step of every loop added to the sums of the block, with local the step
+// within the block. Written with selects and no branches so that it 
+// vectorizes. The excess past the setpoint of a loop with a direction only
+// matters once it is positive, so it is taken against 0.
+//
+static void
+AccumulateLanes(const float *__restrict setpoint, const float *__restrict output, 
+                const float *__restrict control, const float *__restrict direction, 
+                const float *__restrict undirected, const float *__restrict stepSize, 
+                float band, float local, float *__restrict absoluteSum, 
+                float *__restrict squareSum, float *__restrict timedSum, 
+                float *__restrict effortSum, float *__restrict outside, 
+                float *__restrict overshoot, float *__restrict lastControl, size_t n)
+{
+    float next = local + 1.0f;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        float error = setpoint[i] - output[i];
+        float absolute = fabsf(error);
+        float past = std::max(-direction[i] * error, undirected[i] * absolute);
+
+        absoluteSum[i] += absolute;
+        squareSum[i] += error * error;
+        timedSum[i] += local * absolute;
+        effortSum[i] += fabsf(control[i] - lastControl[i]);
+        lastControl[i] = control[i];
+        overshoot[i] = std::max(overshoot[i], past);
+        outside[i] = (absolute > band * stepSize[i]) ? next : outside[i];
+    }
+}
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDPlantBank::
+PIDPlantBank(float sampleTimeSeconds, size_t reserve) :
+    sampleTime(sampleTimeSeconds),
+    depth(1),
+    historyDepth(1),
+    historyPlants(0),
+    head(0)
+{
+    phi11.reserve(reserve);
+    phi12.reserve(reserve);
+    phi21.reserve(reserve);
+    phi22.reserve(reserve);
+    gamma1.reserve(reserve);
+    gamma2.reserve(reserve);
+    x1.reserve(reserve);
+    x2.reserve(reserve);
+    delay.reserve(reserve);
+}
+
+size_t PIDPlantBank::
+AddFirstOrder(float gain, float timeConstant, float deadTime)
+{
+    double a = (timeConstant > 0.0f) ? exp(-(double)sampleTime / timeConstant) : 0.0;
+    double phi[2][2] = { { a, 0.0 }, { 0.0, 0.0 } };
+    double gamma[2] = { gain * (1.0 - a), 0.0 };
+
+    return Add(phi, gamma, deadTime);
+}
+
+size_t PIDPlantBank::
+AddSecondOrder(float gain, float naturalFrequency, float damping, float deadTime)
+{
+    double wn = naturalFrequency;
+    double t = sampleTime;
+    double m[3][3] = { { 0.0, t, 0.0 }, 
+                       { -wn * wn * t, -2.0 * damping * wn * t, gain * wn * wn * t }, 
+                       { 0.0, 0.0, 0.0 } };
+    double e[3][3];
+
+    // exp of the model augmented with its input is Phi and Gamma together
+    MatrixExponential(m, e);
+
+    double phi[2][2] = { { e[0][0], e[0][1] }, { e[1][0], e[1][1] } };
+    double gamma[2] = { e[0][2], e[1][2] };
+
+    return Add(phi, gamma, deadTime);
+}
+
+void PIDPlantBank::
+Step(const float *control)
+{
+    size_t n = x1.size();
+
+    if(depth > 1)
+    {
+        if(historyDepth != depth || historyPlants != n)
+        {
+            HistoryFit();
+        }
+        memcpy(&history[(head & (depth - 1)) * n], control, n * sizeof(float));
+        StepLanes<true>(control, history.data(), delay.data(), depth - 1, head, 
+                        phi11.data(), phi12.data(), phi21.data(), phi22.data(), 
+                        gamma1.data(), gamma2.data(), x1.data(), x2.data(), n);
+    }
+    else
+    {
+        StepLanes<false>(control, history.data(), delay.data(), 0, head, 
+                         phi11.data(), phi12.data(), phi21.data(), phi22.data(), 
+                         gamma1.data(), gamma2.data(), x1.data(), x2.data(), n);
+    }
+
+    head++;
+}
+
+void PIDPlantBank::
+Reset()
+{
+    std::fill(x1.begin(), x1.end(), 0.0f);
+    std::fill(x2.begin(), x2.end(), 0.0f);
+    std::fill(history.begin(), history.end(), 0.0f);
+    head = 0;
+}
+
+size_t PIDPlantBank::
+MemoryBytes() const
+{
+    return (phi11.capacity() + phi12.capacity() + phi21.capacity() + phi22.capacity() +
+            gamma1.capacity() + gamma2.capacity() + x1.capacity() + x2.capacity() +
+            history.capacity()) * sizeof(float) + delay.capacity() * sizeof(uint32_t);
+}
+
+PIDSimulator::
+PIDSimulator(PIDPlantBank &plants, float settlingBand) :
+    plants(plants),
+    settlingBand(settlingBand),
+    blockStart(0),
+    blockSteps(0),
+    steps(0),
+    seconds(0.0),
+    controllerBytes(0)
+{
+}
+
+bool PIDSimulator::
+Run(PIDBank &bank, uint64_t count)
+{
+    size_t n = plants.Size();
+
+    if(bank.Size() != n)
+    {
+        return false;
+    }
+
+    if(steps == 0)
+    {
+        Start(bank.SetpointData(), bank.OutputData());
+    }
+    controllerBytes = n ? bank.MemoryBytes() / n : 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(uint64_t step = 0; step < count; step++)
+    {
+        memcpy(bank.InputData(), plants.OutputData(), n * sizeof(float));
+        bank.ComputeAll();
+        Accumulate(bank.SetpointData(), bank.OutputData());
+        plants.Step(bank.OutputData());
+    }
+
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - 
+                                             start).count();
+
+    return true;
+}
+
+bool PIDSimulator::
+Run(PIDControl *pids, size_t count, uint64_t stepCount)
+{
+    size_t n = plants.Size();
+    FloatArray setpoint(n), control(n);
+
+    if(count != n)
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        setpoint[i] = pids[i].PIDSetpointGet();
+        control[i] = pids[i].PIDOutputGet();
+    }
+    if(steps == 0)
+    {
+        Start(setpoint.data(), control.data());
+    }
+    controllerBytes = sizeof(PIDControl);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(uint64_t step = 0; step < stepCount; step++)
+    {
+        const float *output = plants.OutputData();
+
+        for(size_t i = 0; i < n; i++)
+        {
+            pids[i].PIDInputSet(output[i]);
+            pids[i].PIDCompute();
+            control[i] = pids[i].PIDOutputGet();
+            setpoint[i] = pids[i].PIDSetpointGet();
+        }
+        Accumulate(setpoint.data(), control.data());
+        plants.Step(control.data());
+    }
+
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - 
+                                             start).count();
+
+    return true;
+}
+
+void PIDSimulator::
+Reset()
+{
+    steps = 0;
+    seconds = 0.0;
+}
+
+void PIDSimulator::
+LoopMetricsGet(size_t index, PIDLoopMetrics &metrics) const
+{
+    double dt = plants.SampleTimeGet();
+    uint64_t outside = (blockOutside[index] > 0.0f) ? 
+                       blockStart + (uint64_t)blockOutside[index] : lastOutside[index];
+
+    // With the block so far added in as Flush would, so that the metrics do
+    // not depend on how the steps were split into runs
+    metrics.iae = iae[index] + dt * blockAbsolute[index];
+    metrics.ise = ise[index] + dt * blockSquare[index];
+    metrics.itae = itae[index] + dt * dt * ((double)blockStart * blockAbsolute[index] + 
+                                            blockTimed[index]);
+    metrics.overshoot = overshoot[index] / stepSize[index];
+    metrics.settlingTime = (float)((double)outside * dt);
+    metrics.settled = outside != steps || steps == 0;
+    metrics.effort = effort[index] + blockEffort[index];
+}
+
+PIDSimulationReport PIDSimulator::
+ReportGet() const
+{
+    PIDSimulationReport report;
+    size_t n = std::min(plants.Size(), iae.size());
+
+    memset(&report, 0, sizeof(report));
+    report.loops = n;
+    report.steps = steps;
+    report.seconds = seconds;
+    if(seconds > 0.0 && n > 0 && steps > 0)
+    {
+        report.loopStepsPerSecond = (double)steps * (double)n / seconds;
+        report.nsPerLoopStep = seconds * 1e9 / ((double)steps * (double)n);
+    }
+    if(n > 0)
+    {
+        size_t metricBytes = (iae.capacity() + ise.capacity() + itae.capacity() + 
+                              effort.capacity()) * sizeof(double) + 
+                             (direction.capacity() + undirected.capacity() + 
+                              stepSize.capacity() + overshoot.capacity() + 
+                              lastControl.capacity() + blockAbsolute.capacity() + 
+                              blockSquare.capacity() + blockTimed.capacity() + 
+                              blockEffort.capacity() + blockOutside.capacity()) * sizeof(float) + 
+                             lastOutside.capacity() * sizeof(uint64_t);
+
+        report.bytesPerLoop = controllerBytes + (plants.MemoryBytes() + metricBytes) / n;
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        PIDLoopMetrics metrics;
+
+        LoopMetricsGet(i, metrics);
+        report.meanIae += metrics.iae / (double)n;
+        report.maxIae = std::max(report.maxIae, metrics.iae);
+        report.meanIse += metrics.ise / (double)n;
+        report.maxOvershoot = std::max(report.maxOvershoot, metrics.overshoot);
+        report.maxSettlingTime = std::max(report.maxSettlingTime, metrics.settlingTime);
+        report.unsettled += metrics.settled ? 0 : 1;
+        report.meanEffort += metrics.effort / (double)n;
+    }
+
+    return report;
+}
+
+//*********************************************************************************
+// Private Class Functions
+//*********************************************************************************
+
+size_t PIDPlantBank::
+Add(const double phi[2][2], const double gamma[2], float deadTime)
+{
+    size_t index = x1.size();
+    double samples = (sampleTime > 0.0f && deadTime > 0.0f) ? 
+                     floor((double)deadTime / sampleTime + 0.5) : 0.0;
+    uint32_t delayed = (uint32_t)std::min(samples, (double)UINT32_MAX / 2);
+
+    phi11.push_back((float)phi[0][0]);
+    phi12.push_back((float)phi[0][1]);
+    phi21.push_back((float)phi[1][0]);
+    phi22.push_back((float)phi[1][1]);
+    gamma1.push_back((float)gamma[0]);
+    gamma2.push_back((float)gamma[1]);
+    x1.push_back(0.0f);
+    x2.push_back(0.0f);
+    delay.push_back(delayed);
+
+    while(depth <= delayed)
+    {
+        depth *= 2;
+    }
+
+    return index;
+}
+
+void PIDPlantBank::
+HistoryFit()
+{
+    size_t n = x1.size();
+    size_t mask = depth - 1;
+    size_t fittedMask = historyDepth - 1;
+    FloatArray fitted(depth * n, 0.0f);
+
+    // The steps still held move to their rows at the new depth, which is no
+    // less than the old one. The plants added since were at rest, with no 
+    // inputs.
+    if(historyPlants > 0)
+    {
+        uint64_t kept = std::min<uint64_t>(head, historyDepth);
+
+        for(uint64_t step = head - kept; step < head; step++)
+        {
+            memcpy(&fitted[(step & mask) * n], 
+                   &history[(step & fittedMask) * historyPlants], 
+                   historyPlants * sizeof(float));
+        }
+    }
+
+    history.swap(fitted);
+    historyDepth = depth;
+    historyPlants = n;
+}
+
+void PIDSimulator::
+Start(const float *setpoint, const float *control)
+{
+    size_t n = plants.Size();
+    const float *output = plants.OutputData();
+
+    iae.assign(n, 0.0);
+    ise.assign(n, 0.0);
+    itae.assign(n, 0.0);
+    effort.assign(n, 0.0);
+    direction.resize(n);
+    undirected.resize(n);
+    stepSize.resize(n);
+    overshoot.assign(n, 0.0f);
+    lastControl.assign(control, control + n);
+    lastOutside.assign(n, 0);
+    blockAbsolute.assign(n, 0.0f);
+    blockSquare.assign(n, 0.0f);
+    blockTimed.assign(n, 0.0f);
+    blockEffort.assign(n, 0.0f);
+    blockOutside.assign(n, 0.0f);
+    blockStart = 0;
+    blockSteps = 0;
+
+    // A loop that starts at its setpoint measures overshoot both ways and 
+    // the settling band in output units
+    for(size_t i = 0; i < n; i++)
+    {
+        float step = setpoint[i] - output[i];
+
+        direction[i] = (step > 0.0f) ? 1.0f : ((step < 0.0f) ? -1.0f : 0.0f);
+        undirected[i] = (step == 0.0f) ? 1.0f : 0.0f;
+        stepSize[i] = (step != 0.0f) ? fabsf(step) : 1.0f;
+    }
+}
+
+void PIDSimulator::
+Accumulate(const float *setpoint, const float *control)
+{
+    AccumulateLanes(setpoint, plants.OutputData(), control, direction.data(), 
+                    undirected.data(), stepSize.data(), settlingBand, (float)blockSteps, 
+                    blockAbsolute.data(), blockSquare.data(), blockTimed.data(), 
+                    blockEffort.data(), blockOutside.data(), overshoot.data(), 
+                    lastControl.data(), plants.Size());
+
+    steps++;
+    if(++blockSteps == PID_SIMULATOR_BLOCK)
+    {
+        Flush();
+    }
+}
+
+void PIDSimulator::
+Flush()
+{
+    size_t n = std::min(plants.Size(), iae.size());
+    double dt = plants.SampleTimeGet();
+    double start = (double)blockStart;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        iae[i] += dt * blockAbsolute[i];
+        ise[i] += dt * blockSquare[i];
+        itae[i] += dt * dt * (start * blockAbsolute[i] + blockTimed[i]);
+        effort[i] += blockEffort[i];
+        lastOutside[i] = (blockOutside[i] > 0.0f) ? blockStart + (uint64_t)blockOutside[i] : 
+                                                    lastOutside[i];
+    }
+
+    std::fill(blockAbsolute.begin(), blockAbsolute.end(), 0.0f);
+    std::fill(blockSquare.begin(), blockSquare.end(), 0.0f);
+    std::fill(blockTimed.begin(), blockTimed.end(), 0.0f);
+    std::fill(blockEffort.begin(), blockEffort.end(), 0.0f);
+    std::fill(blockOutside.begin(), blockOutside.end(), 0.0f);
+    blockStart = steps;
+    blockSteps = 0;
+}
@@ -0,0 +1,335 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Closed loop simulation without hardware. PIDPlantBank steps many
+// plants at once, each a first or second order lag with an optional dead time,
+// discretized exactly for the sample time and stored as a structure of arrays so
+// that one pass steps them all. PIDSimulator closes the loops through a PIDBank
+// or through PIDControl objects for millions of steps and reports how well they
+// were controlled next to how fast and in how much memory they ran.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_SIMULATOR_H
+#define PID_SIMULATOR_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "pid_aligned_allocator.h"
+#include "pid_bank.h"
+#include "pid_controller.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// How well one loop was controlled, measured as a response to the step from
+// the plant's output when the run started to the controller's setpoint.
+//
+struct
+PIDLoopMetrics
+{
+    // Integrals of the absolute error, the squared error and the time 
+    // weighted absolute error
+    double iae;
+    double ise;
+    double itae;
+
+    // Largest excursion past the setpoint, as a fraction of the step, or in
+    // output units when the loop started at its setpoint
+    float overshoot;
+
+    // Seconds until the error last left the settling band, and whether it
+    // was still outside at the end
+    float settlingTime;
+    bool settled;
+
+    // Total variation of the controller output, the actuator travel
+    double effort;
+};
+
+//
+// A whole run: throughput and memory next to the control quality of every 
+// loop summed up
+//
+struct
+PIDSimulationReport
+{
+    size_t loops;
+    uint64_t steps;
+    double seconds;
+
+    // Loop updates, each a controller compute and a plant step, per second 
+    // on the one core the run used
+    double loopStepsPerSecond;
+    double nsPerLoopStep;
+    size_t bytesPerLoop;
+
+    double meanIae;
+    double maxIae;
+    double meanIse;
+    float maxOvershoot;
+    float maxSettlingTime;
+    size_t unsettled;
+    double meanEffort;
+};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+//
+// Plants stepped together. Each has the state space form
+// 
+//      x[k + 1] = Phi x[k] + Gamma u[k - delay]
+//      y[k] = x1[k]
+//
+// with Phi and Gamma precomputed by the exact zero order hold discretization
+// of its continuous model, so that they are as accurate at a coarse sample 
+// time as at a fine one. A first order plant uses only x1.
+//
+class
+PIDPlantBank
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates an empty bank of plants.
+        // Parameters:
+        //      sampleTimeSeconds - Time each Step advances every plant by.
+        //      reserve - Number of plants to reserve space for.
+        // Returns:
+        //      Nothing.
+        //
+        explicit PIDPlantBank(float sampleTimeSeconds, size_t reserve = 0);
+
+        //
+        // Add First Order
+        // Description:
+        //      Adds the plant gain * exp(-deadTime s) / (timeConstant s + 1),
+        //      at rest at 0. The dead time is rounded to whole samples.
+        // Parameters:
+        //      gain - Steady state gain.
+        //      timeConstant - Time constant in seconds. 0 or less is a pure 
+        //          gain.
+        //      deadTime - Dead time in seconds.
+        // Returns:
+        //      The index of the new plant.
+        //
+        size_t AddFirstOrder(float gain, float timeConstant, float deadTime = 0.0f);
+
+        //
+        // Add Second Order
+        // Description:
+        //      Adds the plant 
+        //          gain * wn^2 * exp(-deadTime s) / (s^2 + 2 zeta wn s + wn^2),
+        //      at rest at 0, otherwise as AddFirstOrder.
+        // Parameters:
+        //      gain - Steady state gain.
+        //      naturalFrequency - wn in radians per second.
+        //      damping - zeta. Below 1 the plant rings.
+        //      deadTime - Dead time in seconds.
+        // Returns:
+        //      The index of the new plant.
+        //
+        size_t AddSecondOrder(float gain, float naturalFrequency, float damping,
+                              float deadTime = 0.0f);
+
+        //
+        // Step
+        // Description:
+        //      Advances every plant by one sample time.
+        // Parameters:
+        //      control - The input of every plant, such as the outputs of a 
+        //          PIDBank, held over the step.
+        // Returns:
+        //      Nothing.
+        //
+        void Step(const float *control);
+
+        //
+        // Reset
+        // Description:
+        //      Puts every plant back at rest at 0.
+        //
+        void Reset();
+
+        //
+        // Returns the memory the plants have allocated, including the space
+        // reserved for plants not yet added
+        //
+        size_t MemoryBytes() const;
+
+        //
+        // Plant Information
+        //
+        inline size_t Size() const { return x1.size(); }
+        inline float SampleTimeGet() const { return sampleTime; }
+        inline float OutputGet(size_t index) const { return x1[index]; }
+        inline const float *OutputData() const { return x1.data(); }
+
+    private:
+        typedef std::vector<float, PIDAlignedAllocator<float> > FloatArray;
+
+        //
+        // Appends a plant from its discretized model
+        //
+        size_t Add(const double phi[2][2], const double gamma[2], float deadTime);
+
+        //
+        // Lays the history out again for the plants and depth there are now,
+        // keeping the inputs of the plants it was laid out for
+        //
+        void HistoryFit();
+
+        float sampleTime;
+
+        FloatArray phi11, phi12, phi21, phi22;
+        FloatArray gamma1, gamma2;
+        FloatArray x1, x2;
+
+        //
+        // Dead time: the last depth control inputs of every plant, a row per
+        // step, depth being a power of two above every plant's delay. Adding
+        // plants only raises depth; the history is laid out again on the next
+        // Step, once however many plants were added.
+        //
+        std::vector<uint32_t, PIDAlignedAllocator<uint32_t> > delay;
+        FloatArray history;
+        size_t depth;
+        size_t historyDepth;
+        size_t historyPlants;
+        uint64_t head;
+};
+
+//
+// Closes loops of a PIDPlantBank through controllers. Plant i feeds the input
+// of controller i, and the output of controller i drives plant i.
+//
+class
+PIDSimulator
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates a simulator over plants, which must not be added to 
+        //      after the first Run.
+        // Parameters:
+        //      plants - The plants to control.
+        //      settlingBand - Half width of the settling band as a fraction
+        //          of the step.
+        // Returns:
+        //      Nothing.
+        //
+        explicit PIDSimulator(PIDPlantBank &plants, float settlingBand = 0.02f);
+
+        //
+        // Run
+        // Description:
+        //      Runs every loop for a number of steps, continuing from where 
+        //      the last Run left off. The controllers' sample time should be 
+        //      the plants'. The bank must not be bound.
+        // Parameters:
+        //      bank - or pids and count: the controllers, one per plant.
+        //      steps - Number of sample times to run.
+        // Returns:
+        //      False, running nothing, if there is not one controller per 
+        //      plant. True otherwise.
+        //
+        bool Run(PIDBank &bank, uint64_t steps);
+        bool Run(PIDControl *pids, size_t count, uint64_t steps);
+
+        //
+        // Reset
+        // Description:
+        //      Starts the metrics over: the next Run measures a new step 
+        //      response. The plants and controllers are left as they are.
+        //
+        void Reset();
+
+        //
+        // Metrics
+        // Description:
+        //      The control quality of one loop, and the whole run so far.
+        //
+        void LoopMetricsGet(size_t index, PIDLoopMetrics &metrics) const;
+        PIDSimulationReport ReportGet() const;
+
+    private:
+        typedef std::vector<double, PIDAlignedAllocator<double> > DoubleArray;
+        typedef std::vector<float, PIDAlignedAllocator<float> > FloatArray;
+
+        //
+        // Sizes the metrics to the plants and records where each step starts
+        //
+        void Start(const float *setpoint, const float *control);
+
+        //
+        // Adds one step of every loop to the sums of the block
+        //
+        void Accumulate(const float *setpoint, const float *control);
+
+        //
+        // Adds the sums of the block to the metrics and starts a new block
+        //
+        void Flush();
+
+        PIDPlantBank &plants;
+        float settlingBand;
+
+        DoubleArray iae, ise, itae, effort;
+        FloatArray direction, undirected, stepSize, overshoot, lastControl;
+        std::vector<uint64_t, PIDAlignedAllocator<uint64_t> > lastOutside;
+
+        //
+        // The steps since the last Flush are summed in float, which the 
+        // compiler vectorizes, and only added to the double metrics every
+        // PID_SIMULATOR_BLOCK steps, before float sums start losing steps.
+        // The times are in steps from the start of the block.
+        //
+        FloatArray blockAbsolute, blockSquare, blockTimed, blockEffort, blockOutside;
+        uint64_t blockStart;
+        unsigned blockSteps;
+
+        uint64_t steps;
+        double seconds;
+        size_t controllerBytes;
+};
+
+#endif  // PID_SIMULATOR_H
@@ -0,0 +1,148 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Streaming telemetry for controllers running on a real time
+// thread. A tap copies the input, setpoint, output and integral term of selected
+// controllers into fixed size records once every so many ticks and pushes them
+// into a lock free single producer, single consumer ring. A consumer thread
+// drains the ring in batches to a file, a socket or shared memory, so the
+// compute thread never allocates, locks or makes a system call to log.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <string.h>
+#include "pid_telemetry.h"
+#include "pid_bank.h"
+
+//*********************************************************************************
+// Ring Functions
+//*********************************************************************************
+
+PIDTelemetryRing::
+PIDTelemetryRing(size_t capacity) :
+    mask(1),
+    head(0),
+    cachedTail(0),
+    dropped(0),
+    tail(0),
+    cachedHead(0)
+{
+    while(mask + 1 < capacity)
+    {
+        mask = mask * 2 + 1;
+    }
+
+    records.resize(mask + 1);
+}
+
+size_t PIDTelemetryRing::
+Drain(PIDTelemetryRecord *out, size_t maxRecords)
+{
+    return DrainTo([&out](const PIDTelemetryRecord *span, size_t count)
+                   {
+                       memcpy(out, span, count * sizeof(PIDTelemetryRecord));
+                       out += count;
+                   }, maxRecords);
+}
+
+size_t PIDTelemetryRing::
+Size() const
+{
+    size_t consumed = tail.load(std::memory_order_acquire);
+
+    return head.load(std::memory_order_acquire) - consumed;
+}
+
+size_t PIDTelemetryRing::
+Available(size_t position, size_t maxRecords)
+{
+    // Only look at the producer's cache line when the ring seems empty
+    if(cachedHead - position < maxRecords)
+    {
+        cachedHead = head.load(std::memory_order_acquire);
+    }
+
+    return cachedHead - position < maxRecords ? cachedHead - position : maxRecords;
+}
+
+//*********************************************************************************
+// Tap Functions
+//*********************************************************************************
+
+PIDTelemetryTap::
+PIDTelemetryTap(PIDTelemetryRing &ring, uint32_t decimation) :
+    ring(ring),
+    decimation(decimation == 0 ? 1 : decimation),
+    countdown(0),
+    tick(0)
+{
+}
+
+void PIDTelemetryTap::
+DecimationSet(uint32_t decimation)
+{
+    if(decimation == 0)
+    {
+        return;
+    }
+
+    this->decimation = decimation;
+    countdown = 0;
+}
+
+size_t PIDTelemetryTap::
+Sample(const PIDBank &bank, const uint32_t *indices, size_t count)
+{
+    PIDTelemetryRecord record;
+    size_t pushed = 0;
+
+    if(!Due())
+    {
+        return 0;
+    }
+
+    record.tick = tick - 1;
+    for(size_t i = 0; i < count; i++)
+    {
+        size_t index = indices ? indices[i] : i;
+
+        record.index = static_cast<uint32_t>(index);
+        record.input = bank.PIDInputGet(index);
+        record.setpoint = bank.PIDSetpointGet(index);
+        record.output = bank.PIDOutputGet(index);
+        record.iTerm = bank.PIDIntegralGet(index);
+
+        pushed += ring.Push(record) ? 1 : 0;
+    }
+
+    return pushed;
+}
@@ -0,0 +1,356 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Streaming telemetry for controllers running on a real time
+// thread. A tap copies the input, setpoint, output and integral term of selected
+// controllers into fixed size records once every so many ticks and pushes them
+// into a lock free single producer, single consumer ring. A consumer thread
+// drains the ring in batches to a file, a socket or shared memory, so the
+// compute thread never allocates, locks or makes a system call to log.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_TELEMETRY_H
+#define PID_TELEMETRY_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "pid_aligned_allocator.h"
+
+class PIDBank;
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// One sample of one controller. Trivially copyable and free of padding, so a
+// drained batch can be written out as raw bytes.
+//
+struct
+PIDTelemetryRecord
+{
+    // Controller index in its bank, or the id the caller gave a PIDControl
+    uint32_t index;
+
+    // Tap tick the sample was taken on
+    uint32_t tick;
+
+    float input;
+    float setpoint;
+    float output;
+    float iTerm;
+};
+
+//*********************************************************************************
+// Classes
+//*********************************************************************************
+
+class
+PIDTelemetryRing
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Allocates the ring up front. Nothing is allocated afterwards.
+        // Parameters:
+        //      capacity - The number of records the ring holds. Rounded up to
+        //                 a power of two, and to at least 2.
+        //
+        explicit PIDTelemetryRing(size_t capacity);
+
+        PIDTelemetryRing(const PIDTelemetryRing &) = delete;
+        PIDTelemetryRing &operator=(const PIDTelemetryRing &) = delete;
+
+        //
+        // Push
+        // Description:
+        //      Appends a record. Only one thread, the producer, may push. Wait
+        //      free: when the ring is full the record is dropped and counted
+        //      rather than waiting for the consumer.
+        // Parameters:
+        //      record - The record to append.
+        // Returns:
+        //      True if the record was stored. False if it was dropped.
+        //
+        inline bool Push(const PIDTelemetryRecord &record)
+        {
+            size_t position = head.load(std::memory_order_relaxed);
+
+            // Only look at the consumer's cache line when the ring seems full
+            if(position - cachedTail > mask)
+            {
+                cachedTail = tail.load(std::memory_order_acquire);
+
+                if(position - cachedTail > mask)
+                {
+                    dropped.store(dropped.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+                    return false;
+                }
+            }
+
+            records[position & mask] = record;
+            head.store(position + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        //
+        // Drain
+        // Description:
+        //      Copies out the oldest records and frees their slots. Only one
+        //      thread, the consumer, may drain.
+        // Parameters:
+        //      out - Receives the records in the order they were pushed.
+        //      maxRecords - The most records to copy.
+        // Returns:
+        //      The number of records copied.
+        //
+        size_t Drain(PIDTelemetryRecord *out, size_t maxRecords);
+
+        //
+        // Drain To
+        // Description:
+        //      Hands the oldest records to sink in place, without copying them,
+        //      and frees their slots once sink returns. sink is called as
+        //      sink(const PIDTelemetryRecord *records, size_t count) once, or
+        //      twice when the records wrap around the end of the ring. A sink
+        //      that fwrites, sends or memcpys the span to shared memory drains
+        //      the ring in a single call. Only the consumer may drain.
+        // Parameters:
+        //      sink - Called with each contiguous span of records.
+        //      maxRecords - The most records to hand over.
+        // Returns:
+        //      The number of records handed over.
+        //
+        template <typename Sink>
+        size_t DrainTo(Sink &&sink, size_t maxRecords = SIZE_MAX)
+        {
+            size_t position = tail.load(std::memory_order_relaxed);
+            size_t count = Available(position, maxRecords);
+            size_t first = position & mask;
+            size_t firstCount = count < Capacity() - first ? count : Capacity() - first;
+
+            if(count == 0)
+            {
+                return 0;
+            }
+
+            sink(static_cast<const PIDTelemetryRecord *>(&records[first]), firstCount);
+            if(count > firstCount)
+            {
+                sink(static_cast<const PIDTelemetryRecord *>(&records[0]), count - firstCount);
+            }
+
+            tail.store(position + count, std::memory_order_release);
+
+            return count;
+        }
+
+        //
+        // Capacity
+        // Description:
+        //      Returns the number of records the ring holds.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The capacity, a power of two.
+        //
+        inline size_t Capacity() const { return mask + 1; }
+
+        //
+        // Size
+        // Description:
+        //      Returns the number of records waiting to be drained. Exact only
+        //      when called from the producer or the consumer while the other
+        //      one is idle.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of records in the ring.
+        //
+        size_t Size() const;
+
+        //
+        // Dropped Get
+        // Description:
+        //      Returns how many records Push dropped because the ring was full.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      The number of dropped records.
+        //
+        inline uint64_t DroppedGet() const { return dropped.load(std::memory_order_relaxed); }
+
+    private:
+        //
+        // Returns how many records the consumer may take, at most maxRecords
+        //
+        size_t Available(size_t position, size_t maxRecords);
+
+        //
+        // Written once by the constructor
+        //
+        std::vector<PIDTelemetryRecord, PIDAlignedAllocator<PIDTelemetryRecord> > records;
+        size_t mask;
+
+        //
+        // Owned by the producer. Positions count up forever and are reduced
+        // with mask, so head - tail is the number of records in the ring.
+        //
+        alignas(PID_CACHE_LINE_SIZE) std::atomic<size_t> head;
+        size_t cachedTail;
+        std::atomic<uint64_t> dropped;
+
+        //
+        // Owned by the consumer
+        //
+        alignas(PID_CACHE_LINE_SIZE) std::atomic<size_t> tail;
+        size_t cachedHead;
+};
+
+class
+PIDTelemetryTap
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates a tap that feeds ring. The tap and the ring's producer
+        //      side belong to the compute thread.
+        // Parameters:
+        //      ring - The ring the records are pushed into.
+        //      decimation - A sample is taken on every decimation-th tick,
+        //                   starting with the first. 0 is treated as 1.
+        //
+        PIDTelemetryTap(PIDTelemetryRing &ring, uint32_t decimation = 1);
+
+        //
+        // Decimation Set
+        // Description:
+        //      Changes how often samples are taken. The next tick is sampled.
+        // Parameters:
+        //      decimation - A sample is taken on every decimation-th tick.
+        //                   Ignored if 0.
+        // Returns:
+        //      Nothing.
+        //
+        void DecimationSet(uint32_t decimation);
+
+        //
+        // Sample
+        // Description:
+        //      Called once per tick after the controller has been computed.
+        //      On a sampled tick pushes one record for pid. Works with any
+        //      controller that has PIDInputGet, PIDSetpointGet, PIDOutputGet
+        //      and PIDIntegralGet, such as PIDControl or PIDBankView.
+        // Parameters:
+        //      pid - The controller to sample.
+        //      id - Stored in the record's index field.
+        // Returns:
+        //      True if a record was pushed. False if the tick was skipped or
+        //      the ring was full.
+        //
+        template <typename Controller>
+        bool Sample(Controller &pid, uint32_t id = 0)
+        {
+            PIDTelemetryRecord record;
+
+            if(!Due())
+            {
+                return false;
+            }
+
+            record.index = id;
+            record.tick = tick - 1;
+            record.input = static_cast<float>(pid.PIDInputGet());
+            record.setpoint = static_cast<float>(pid.PIDSetpointGet());
+            record.output = static_cast<float>(pid.PIDOutputGet());
+            record.iTerm = static_cast<float>(pid.PIDIntegralGet());
+
+            return ring.Push(record);
+        }
+
+        //
+        // Sample
+        // Description:
+        //      Called once per tick after the bank has been computed. On a
+        //      sampled tick pushes one record for each selected controller.
+        // Parameters:
+        //      bank - The bank to sample.
+        //      indices - The controllers to sample. If null, the first count.
+        //      count - The number of controllers to sample.
+        // Returns:
+        //      The number of records pushed.
+        //
+        size_t Sample(const PIDBank &bank, const uint32_t *indices, size_t count);
+
+        inline uint32_t DecimationGet() const { return decimation; }
+
+        //
+        // Number of ticks seen so far
+        //
+        inline uint32_t TickGet() const { return tick; }
+
+    private:
+        //
+        // Advances the tick. True if this tick is sampled.
+        //
+        inline bool Due()
+        {
+            tick++;
+            if(countdown != 0)
+            {
+                countdown--;
+                return false;
+            }
+            countdown = decimation - 1;
+
+            return true;
+        }
+
+        PIDTelemetryRing &ring;
+        uint32_t decimation;
+
+        // Ticks left to skip before the next sample
+        uint32_t countdown;
+        uint32_t tick;
+};
+
+#endif  // PID_TELEMETRY_H
@@ -0,0 +1,755 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Columnar binary traces of recorded plant data. A trace holds a
+// timestamp column and an input, setpoint and output column per channel, stored
+// in chunks so that a file of any size can be memory mapped and streamed through
+// PIDComputeBlock or a PIDBank one chunk at a time. Timestamp, input and
+// setpoint columns can be delta compressed. The output columns are always stored
+// raw, so a replay writes its results straight into the mapped file.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <string.h>
+#include "pid_trace.h"
+#include "pid_bank.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define PID_TRACE_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Chunks and columns start on a cache line
+//
+#define PID_TRACE_ALIGNMENT         64
+
+static inline uint64_t
+AlignUp(uint64_t value)
+{
+    return (value + PID_TRACE_ALIGNMENT - 1) & ~(uint64_t)(PID_TRACE_ALIGNMENT - 1);
+}
+
+static inline size_t
+ColumnCount(uint32_t channels)
+{
+    return 1 + 3 * (size_t)channels;
+}
+
+//
+// Where the column table and the first column of a chunk start
+//
+static inline uint64_t
+ColumnsStart(size_t columns)
+{
+    return AlignUp(sizeof(PIDTraceChunkHeader) + columns * sizeof(PIDTraceColumnHeader));
+}
+
+//
+// Delta Encode
+// Description:
+//      Encodes each value as the zigzagged difference from the one before it,
+//      in 7 bit groups with the top bit set on all but the last. Unsigned
+//      arithmetic throughout, so wrapping differences are well defined.
+//
+template <typename U>
+static size_t
+DeltaEncode(const void *source, size_t n, uint8_t *out)
+{
+    const int bits = sizeof(U) * 8;
+    U previous = 0;
+    size_t bytes = 0;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        U value, difference, zigzag;
+
+        memcpy(&value, static_cast<const uint8_t *>(source) + i * sizeof(U), sizeof(U));
+        difference = value - previous;
+        zigzag = (U)(difference << 1) ^ (U)(0 - (difference >> (bits - 1)));
+        previous = value;
+
+        while(zigzag >= 0x80)
+        {
+            out[bytes++] = (uint8_t)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        out[bytes++] = (uint8_t)zigzag;
+    }
+
+    return bytes;
+}
+
+template <typename U>
+static bool
+DeltaDecode(const uint8_t *in, size_t bytes, void *destination, size_t n)
+{
+    const int bits = sizeof(U) * 8;
+    U previous = 0;
+    size_t position = 0;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        U zigzag = 0;
+        int shift = 0;
+        uint8_t byte;
+
+        do
+        {
+            if(position == bytes || shift >= bits)
+            {
+                return false;
+            }
+            byte = in[position++];
+            zigzag |= (U)(byte & 0x7f) << shift;
+            shift += 7;
+        }
+        while(byte & 0x80);
+
+        previous += (zigzag >> 1) ^ (U)(0 - (zigzag & 1));
+        memcpy(static_cast<uint8_t *>(destination) + i * sizeof(U), &previous, sizeof(U));
+    }
+
+    return position == bytes;
+}
+
+//*********************************************************************************
+// Writer Functions
+//*********************************************************************************
+
+PIDTraceWriter::
+PIDTraceWriter() :
+    file(nullptr),
+    delta(false),
+    failed(false),
+    channels(0),
+    chunkSamples(0),
+    pending(0),
+    position(0),
+    samples(0)
+{
+}
+
+PIDTraceWriter::
+~PIDTraceWriter()
+{
+    Close();
+}
+
+bool PIDTraceWriter::
+Open(const char *path, uint32_t channels, uint32_t chunkSamples, bool delta)
+{
+    PIDTraceHeader blank;
+
+    Close();
+    if(channels == 0 || chunkSamples == 0)
+    {
+        return false;
+    }
+
+    file = fopen(path, "wb");
+    if(!file)
+    {
+        return false;
+    }
+
+    this->delta = delta;
+    this->channels = channels;
+    this->chunkSamples = chunkSamples;
+    failed = false;
+    pending = 0;
+    samples = 0;
+    timestamps.assign(chunkSamples, 0);
+    values.assign(3 * (size_t)channels * chunkSamples, 0.0f);
+
+    // The worst case of a delta encoded 64 bit column
+    encoded.resize((size_t)chunkSamples * 10);
+    directory.clear();
+
+    // Room for the header, which Close fills in
+    memset(&blank, 0, sizeof(blank));
+    failed = fwrite(&blank, sizeof(blank), 1, file) != 1;
+    position = sizeof(blank);
+
+    return !failed;
+}
+
+bool PIDTraceWriter::
+Append(int64_t timestamp, const float *inputs, const float *setpoints, const float *outputs)
+{
+    float *columns = values.data();
+
+    if(!file || failed)
+    {
+        return false;
+    }
+
+    // Transpose the sample into the columns of the chunk
+    timestamps[pending] = timestamp;
+    for(uint32_t channel = 0; channel < channels; channel++)
+    {
+        size_t at = (size_t)channel * chunkSamples + pending;
+
+        columns[at] = inputs[channel];
+        columns[((size_t)channels + channel) * chunkSamples + pending] = setpoints[channel];
+        columns[(2 * (size_t)channels + channel) * chunkSamples + pending] =
+            outputs ? outputs[channel] : 0.0f;
+    }
+
+    pending++;
+    samples++;
+    if(pending == chunkSamples)
+    {
+        failed = !ChunkWrite();
+    }
+
+    return !failed;
+}
+
+bool PIDTraceWriter::
+Close()
+{
+    PIDTraceHeader header;
+    bool ok;
+
+    if(!file)
+    {
+        return false;
+    }
+
+    if(!failed && pending > 0)
+    {
+        failed = !ChunkWrite();
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = PID_TRACE_MAGIC;
+    header.version = PID_TRACE_VERSION;
+    header.channels = channels;
+    header.chunkSamples = chunkSamples;
+    header.chunkCount = directory.size();
+    header.samples = samples;
+    header.directoryOffset = position;
+
+    if(!failed && !directory.empty())
+    {
+        failed = fwrite(directory.data(), sizeof(uint64_t), directory.size(), file) !=
+                 directory.size();
+    }
+    if(!failed)
+    {
+        failed = fseek(file, 0, SEEK_SET) != 0 ||
+                 fwrite(&header, sizeof(header), 1, file) != 1;
+    }
+
+    ok = fclose(file) == 0 && !failed;
+    file = nullptr;
+
+    return ok;
+}
+
+bool PIDTraceWriter::
+ChunkWrite()
+{
+    size_t columns = ColumnCount(channels);
+    std::vector<PIDTraceColumnHeader> table(columns);
+    PIDTraceChunkHeader chunk;
+    uint64_t start = position;
+    uint64_t offset = ColumnsStart(columns);
+
+    // Lay the columns out, encoding the ones that shrink under delta. The
+    // encoded form of all but the last is redone when the column is written,
+    // which keeps a single encode buffer.
+    for(size_t column = 0; column < columns; column++)
+    {
+        bool wide = column == 0;
+        bool output = column > 2 * (size_t)channels;
+        const void *source = wide ? (const void *)timestamps.data() :
+                                    (const void *)(values.data() + (column - 1) * chunkSamples);
+        size_t raw = (size_t)pending * (wide ? sizeof(int64_t) : sizeof(float));
+        size_t bytes = raw;
+
+        if(delta && !output)
+        {
+            bytes = wide ? DeltaEncode<uint64_t>(source, pending, encoded.data()) :
+                           DeltaEncode<uint32_t>(source, pending, encoded.data());
+        }
+
+        table[column].encoding = bytes < raw ? PID_TRACE_DELTA : PID_TRACE_RAW;
+        table[column].bytes = (uint32_t)(bytes < raw ? bytes : raw);
+        table[column].offset = offset;
+        offset = AlignUp(offset + table[column].bytes);
+    }
+
+    chunk.samples = pending;
+    chunk.columns = (uint32_t)columns;
+    if(fwrite(&chunk, sizeof(chunk), 1, file) != 1 ||
+       fwrite(table.data(), sizeof(PIDTraceColumnHeader), columns, file) != columns)
+    {
+        return false;
+    }
+    position += sizeof(chunk) + columns * sizeof(PIDTraceColumnHeader);
+
+    for(size_t column = 0; column < columns; column++)
+    {
+        bool wide = column == 0;
+        const void *source = wide ? (const void *)timestamps.data() :
+                                    (const void *)(values.data() + (column - 1) * chunkSamples);
+
+        if(!PadTo(start + table[column].offset))
+        {
+            return false;
+        }
+
+        if(table[column].encoding == PID_TRACE_DELTA)
+        {
+            if(wide)
+            {
+                DeltaEncode<uint64_t>(source, pending, encoded.data());
+            }
+            else
+            {
+                DeltaEncode<uint32_t>(source, pending, encoded.data());
+            }
+            source = encoded.data();
+        }
+
+        if(table[column].bytes > 0 && fwrite(source, table[column].bytes, 1, file) != 1)
+        {
+            return false;
+        }
+        position += table[column].bytes;
+    }
+
+    if(!PadTo(AlignUp(position)))
+    {
+        return false;
+    }
+
+    directory.push_back(start);
+    pending = 0;
+
+    return true;
+}
+
+bool PIDTraceWriter::
+PadTo(uint64_t target)
+{
+    static const uint8_t zeros[PID_TRACE_ALIGNMENT] = { 0 };
+    size_t gap = (size_t)(target - position);
+
+    if(gap > 0 && fwrite(zeros, 1, gap, file) != gap)
+    {
+        return false;
+    }
+    position = target;
+
+    return true;
+}
+
+//*********************************************************************************
+// Reader Functions
+//*********************************************************************************
+
+PIDTraceReader::
+PIDTraceReader() :
+    data(nullptr),
+    size(0),
+    writable(false)
+{
+    memset(&header, 0, sizeof(header));
+}
+
+PIDTraceReader::
+~PIDTraceReader()
+{
+    Close();
+}
+
+bool PIDTraceReader::
+Open(const char *path, bool writable)
+{
+    Close();
+    this->writable = writable;
+
+#ifdef PID_TRACE_MMAP
+    struct stat status;
+    int descriptor = open(path, writable ? O_RDWR : O_RDONLY);
+
+    if(descriptor < 0)
+    {
+        return false;
+    }
+
+    if(fstat(descriptor, &status) != 0 || status.st_size < (off_t)sizeof(PIDTraceHeader))
+    {
+        close(descriptor);
+        return false;
+    }
+
+    size = (size_t)status.st_size;
+    void *mapping = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                         MAP_SHARED, descriptor, 0);
+
+    // The mapping stays valid without the descriptor
+    close(descriptor);
+    if(mapping == MAP_FAILED)
+    {
+        size = 0;
+        return false;
+    }
+
+    data = static_cast<uint8_t *>(mapping);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+#else
+    FILE *file = fopen(path, "rb");
+    long length;
+
+    if(!file)
+    {
+        return false;
+    }
+
+    if(fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < (long)sizeof(PIDTraceHeader) ||
+       fseek(file, 0, SEEK_SET) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    contents.resize((size_t)length);
+    if(fread(contents.data(), 1, contents.size(), file) != contents.size())
+    {
+        fclose(file);
+        contents.clear();
+        return false;
+    }
+    fclose(file);
+
+    this->path.assign(path, path + strlen(path) + 1);
+    data = contents.data();
+    size = contents.size();
+#endif
+
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != PID_TRACE_MAGIC || header.version != PID_TRACE_VERSION ||
+       header.channels == 0 || header.chunkSamples == 0 ||
+       header.directoryOffset > size ||
+       header.chunkCount > (size - header.directoryOffset) / sizeof(uint64_t) ||
+       !ChunksCheck())
+    {
+        // Nothing was written, so there is nothing to write back
+        this->writable = false;
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool PIDTraceReader::
+Close()
+{
+    bool ok = true;
+
+    if(!data)
+    {
+        return true;
+    }
+
+#ifdef PID_TRACE_MMAP
+    if(writable)
+    {
+        ok = msync(data, size, MS_SYNC) == 0;
+    }
+    ok = munmap(data, size) == 0 && ok;
+#else
+    if(writable)
+    {
+        FILE *file = fopen(path.data(), "r+b");
+
+        ok = file && fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+        ok = file && fclose(file) == 0 && ok;
+    }
+    contents.clear();
+    path.clear();
+#endif
+
+    data = nullptr;
+    size = 0;
+    chunks.clear();
+    memset(&header, 0, sizeof(header));
+
+    return ok;
+}
+
+uint32_t PIDTraceReader::
+ChunkSamplesGet(size_t chunk) const
+{
+    PIDTraceChunkHeader chunkHeader;
+
+    memcpy(&chunkHeader, data + chunks[chunk], sizeof(chunkHeader));
+
+    return chunkHeader.samples;
+}
+
+const int64_t *PIDTraceReader::
+TimestampRead(size_t chunk, int64_t *scratch) const
+{
+    const PIDTraceColumnHeader &column = ColumnHeader(chunk, 0);
+    const uint8_t *source = data + chunks[chunk] + column.offset;
+    uint32_t n = ChunkSamplesGet(chunk);
+
+    if(column.encoding == PID_TRACE_RAW)
+    {
+        return reinterpret_cast<const int64_t *>(source);
+    }
+
+    return DeltaDecode<uint64_t>(source, column.bytes, scratch, n) ? scratch : nullptr;
+}
+
+const float *PIDTraceReader::
+ColumnRead(size_t chunk, PIDTraceColumn kind, uint32_t channel, float *scratch) const
+{
+    const PIDTraceColumnHeader &column =
+        ColumnHeader(chunk, 1 + (size_t)kind * header.channels + channel);
+    const uint8_t *source = data + chunks[chunk] + column.offset;
+    uint32_t n = ChunkSamplesGet(chunk);
+
+    if(column.encoding == PID_TRACE_RAW)
+    {
+        return reinterpret_cast<const float *>(source);
+    }
+
+    return DeltaDecode<uint32_t>(source, column.bytes, scratch, n) ? scratch : nullptr;
+}
+
+float *PIDTraceReader::
+OutputColumn(size_t chunk, uint32_t channel)
+{
+    const PIDTraceColumnHeader &column =
+        ColumnHeader(chunk, 1 + 2 * (size_t)header.channels + channel);
+
+    if(!writable)
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<float *>(data + chunks[chunk] + column.offset);
+}
+
+const PIDTraceColumnHeader &PIDTraceReader::
+ColumnHeader(size_t chunk, size_t column) const
+{
+    return reinterpret_cast<const PIDTraceColumnHeader *>(
+        data + chunks[chunk] + sizeof(PIDTraceChunkHeader))[column];
+}
+
+bool PIDTraceReader::
+ChunksCheck()
+{
+    size_t columns = ColumnCount(header.channels);
+    uint64_t total = 0;
+
+    chunks.resize((size_t)header.chunkCount);
+    memcpy(chunks.data(), data + header.directoryOffset, chunks.size() * sizeof(uint64_t));
+
+    for(size_t chunk = 0; chunk < chunks.size(); chunk++)
+    {
+        PIDTraceChunkHeader chunkHeader;
+        uint64_t start = chunks[chunk];
+
+        // Chunks are aligned, which keeps the column table and raw columns
+        // aligned in the mapping
+        if(start % PID_TRACE_ALIGNMENT != 0 || start > size ||
+           size - start < ColumnsStart(columns))
+        {
+            return false;
+        }
+
+        memcpy(&chunkHeader, data + start, sizeof(chunkHeader));
+        if(chunkHeader.columns != columns || chunkHeader.samples == 0 ||
+           chunkHeader.samples > header.chunkSamples)
+        {
+            return false;
+        }
+        total += chunkHeader.samples;
+
+        for(size_t column = 0; column < columns; column++)
+        {
+            const PIDTraceColumnHeader &table = ColumnHeader(chunk, column);
+            size_t width = column == 0 ? sizeof(int64_t) : sizeof(float);
+            bool output = column > 2 * (size_t)header.channels;
+
+            if(table.offset % PID_TRACE_ALIGNMENT != 0 || table.offset > size - start ||
+               table.bytes > size - start - table.offset)
+            {
+                return false;
+            }
+
+            // Raw columns are used in place, so they must be complete. Output
+            // columns are written in place, so they must be raw.
+            if(table.encoding == PID_TRACE_RAW)
+            {
+                if(table.bytes != (uint64_t)chunkHeader.samples * width)
+                {
+                    return false;
+                }
+            }
+            else if(table.encoding != PID_TRACE_DELTA || output)
+            {
+                return false;
+            }
+        }
+    }
+
+    return total == header.samples;
+}
+
+//*********************************************************************************
+// Replay Functions
+//*********************************************************************************
+
+bool
+PIDTraceReplay(PIDTraceReader &trace, PIDControl *controllers, bool timed)
+{
+    uint32_t channels = trace.ChannelsGet();
+    std::vector<int64_t> timeScratch(trace.ChunkSamplesGet());
+    std::vector<float> inputScratch(trace.ChunkSamplesGet());
+    std::vector<float> setpointScratch(trace.ChunkSamplesGet());
+
+    for(size_t chunk = 0; chunk < trace.ChunkCountGet(); chunk++)
+    {
+        uint32_t n = trace.ChunkSamplesGet(chunk);
+        const int64_t *timestamps = nullptr;
+
+        if(timed && !(timestamps = trace.TimestampRead(chunk, timeScratch.data())))
+        {
+            return false;
+        }
+
+        for(uint32_t channel = 0; channel < channels; channel++)
+        {
+            PIDControl &pid = controllers[channel];
+            const float *inputs = trace.ColumnRead(chunk, PID_TRACE_INPUT, channel,
+                                                   inputScratch.data());
+            const float *setpoints = trace.ColumnRead(chunk, PID_TRACE_SETPOINT, channel,
+                                                      setpointScratch.data());
+            float *outputs = trace.OutputColumn(chunk, channel);
+
+            if(!inputs || !setpoints || !outputs)
+            {
+                return false;
+            }
+
+            if(!timed)
+            {
+                pid.PIDComputeBlock(inputs, setpoints, outputs, n);
+                continue;
+            }
+
+            for(uint32_t i = 0; i < n; i++)
+            {
+                pid.PIDSetpointSet(setpoints[i]);
+                pid.PIDInputSet(inputs[i]);
+                pid.PIDCompute((uint32_t)timestamps[i]);
+                outputs[i] = pid.PIDOutputGet();
+            }
+        }
+    }
+
+    return true;
+}
+
+bool
+PIDTraceReplay(PIDTraceReader &trace, PIDBank &bank)
+{
+    uint32_t channels = trace.ChannelsGet();
+    size_t samples = trace.ChunkSamplesGet();
+    std::vector<float> scratch(2 * (size_t)channels * samples);
+    std::vector<const float *> inputs(channels);
+    std::vector<const float *> setpoints(channels);
+    std::vector<float *> outputs(channels);
+    float *bankInput = bank.InputData();
+    float *bankSetpoint = bank.SetpointData();
+    const float *bankOutput = bank.OutputData();
+
+    if(bank.Size() != channels)
+    {
+        return false;
+    }
+
+    for(size_t chunk = 0; chunk < trace.ChunkCountGet(); chunk++)
+    {
+        uint32_t n = trace.ChunkSamplesGet(chunk);
+
+        for(uint32_t channel = 0; channel < channels; channel++)
+        {
+            inputs[channel] = trace.ColumnRead(chunk, PID_TRACE_INPUT, channel,
+                                               &scratch[(size_t)channel * samples]);
+            setpoints[channel] = trace.ColumnRead(chunk, PID_TRACE_SETPOINT, channel,
+                                                  &scratch[((size_t)channels + channel) *
+                                                           samples]);
+            outputs[channel] = trace.OutputColumn(chunk, channel);
+
+            if(!inputs[channel] || !setpoints[channel] || !outputs[channel])
+            {
+                return false;
+            }
+        }
+
+        for(uint32_t i = 0; i < n; i++)
+        {
+            for(uint32_t channel = 0; channel < channels; channel++)
+            {
+                bankInput[channel] = inputs[channel][i];
+                bankSetpoint[channel] = setpoints[channel][i];
+            }
+
+            bank.ComputeAll();
+
+            for(uint32_t channel = 0; channel < channels; channel++)
+            {
+                outputs[channel][i] = bankOutput[channel];
+            }
+        }
+    }
+
+    return true;
+}
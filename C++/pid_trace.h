@@ -0,0 +1,393 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Columnar binary traces of recorded plant data. A trace holds a
+// timestamp column and an input, setpoint and output column per channel, stored
+// in chunks so that a file of any size can be memory mapped and streamed through
+// PIDComputeBlock or a PIDBank one chunk at a time. Timestamp, input and
+// setpoint columns can be delta compressed. The output columns are always stored
+// raw, so a replay writes its results straight into the mapped file.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_TRACE_H
+#define PID_TRACE_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "pid_controller.h"
+
+class PIDBank;
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Trace format, version 1
+//
+// A trace is a 64 byte PIDTraceHeader, then its chunks, then a directory of
+// chunkCount uint64_t chunk offsets. Every chunk holds up to chunkSamples
+// consecutive samples of all channels as 1 + 3 * channels columns: the
+// timestamps, then the inputs, the setpoints and the outputs of each channel.
+// A chunk starts with a PIDTraceChunkHeader and one PIDTraceColumnHeader per
+// column. Chunks and columns start on a 64 byte boundary, so raw columns can be
+// read in place from a mapping. Timestamps are int64_t microseconds, the other
+// columns are float. All values are in the native byte order of the machine
+// that wrote them; a trace from a machine of the other byte order is rejected
+// by its magic number.
+//
+#define PID_TRACE_MAGIC             0x54444950u
+#define PID_TRACE_VERSION           1
+
+//
+// Column encodings
+//
+// PID_TRACE_RAW stores the values as they are. PID_TRACE_DELTA stores the
+// difference between the bit patterns of each value and the one before it,
+// zigzag and varint encoded, which turns slowly moving signals and regular
+// timestamps into one or two bytes per sample. Both are lossless.
+//
+#define PID_TRACE_RAW               0
+#define PID_TRACE_DELTA             1
+
+struct
+PIDTraceHeader
+{
+    //
+    // PID_TRACE_MAGIC and PID_TRACE_VERSION
+    //
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved0;
+
+    //
+    // Number of channels, the most samples a chunk holds and the number of
+    // chunks
+    //
+    uint32_t channels;
+    uint32_t chunkSamples;
+    uint64_t chunkCount;
+
+    //
+    // Samples per channel over the whole trace, and where the directory is
+    //
+    uint64_t samples;
+    uint64_t directoryOffset;
+
+    //
+    // Zero, for future versions
+    //
+    uint32_t reserved[6];
+};
+
+struct
+PIDTraceChunkHeader
+{
+    uint32_t samples;
+    uint32_t columns;
+};
+
+struct
+PIDTraceColumnHeader
+{
+    //
+    // PID_TRACE_RAW or PID_TRACE_DELTA, the encoded size and the position
+    // relative to the start of the chunk
+    //
+    uint32_t encoding;
+    uint32_t bytes;
+    uint64_t offset;
+};
+
+static_assert(sizeof(PIDTraceHeader) == 64, "trace header layout is fixed");
+static_assert(sizeof(PIDTraceColumnHeader) == 16, "trace column header layout is fixed");
+
+//
+// The per channel columns of a chunk
+//
+typedef enum
+{
+    PID_TRACE_INPUT = 0,
+    PID_TRACE_SETPOINT = 1,
+    PID_TRACE_OUTPUT = 2
+}
+PIDTraceColumn;
+
+//*********************************************************************************
+// Classes
+//*********************************************************************************
+
+class
+PIDTraceWriter
+{
+    public:
+        PIDTraceWriter();
+        ~PIDTraceWriter();
+
+        PIDTraceWriter(const PIDTraceWriter &) = delete;
+        PIDTraceWriter &operator=(const PIDTraceWriter &) = delete;
+
+        //
+        // Open
+        // Description:
+        //      Creates a trace file, replacing any file at path, and allocates
+        //      the buffers of one chunk.
+        // Parameters:
+        //      path - The file to create.
+        //      channels - Number of channels, at least 1.
+        //      chunkSamples - The most samples per chunk, at least 1.
+        //      delta - True to delta compress the timestamp, input and setpoint
+        //              columns. A column that would not get smaller is stored
+        //              raw anyway.
+        // Returns:
+        //      True if the file was created. False otherwise.
+        //
+        bool Open(const char *path, uint32_t channels, uint32_t chunkSamples, bool delta);
+
+        //
+        // Append
+        // Description:
+        //      Adds one sample of every channel. A full chunk is written out.
+        // Parameters:
+        //      timestamp - Time of the sample in microseconds.
+        //      inputs - The input of each channel.
+        //      setpoints - The setpoint of each channel.
+        //      outputs - The output of each channel, or nullptr to store 0s.
+        // Returns:
+        //      True if the sample was added. False if the trace is not open or
+        //      a write failed.
+        //
+        bool Append(int64_t timestamp, const float *inputs, const float *setpoints,
+                    const float *outputs);
+
+        //
+        // Close
+        // Description:
+        //      Writes the last chunk, the directory and the header and closes
+        //      the file. Also done by the destructor.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      True if the whole trace was written. False otherwise.
+        //
+        bool Close();
+
+    private:
+        bool ChunkWrite();
+        bool PadTo(uint64_t alignment);
+
+        FILE *file;
+        bool delta;
+        bool failed;
+        uint32_t channels;
+        uint32_t chunkSamples;
+        uint32_t pending;
+        uint64_t position;
+        uint64_t samples;
+
+        //
+        // The columns of the chunk being filled, one after the other, and the
+        // space to encode one of them
+        //
+        std::vector<int64_t> timestamps;
+        std::vector<float> values;
+        std::vector<uint8_t> encoded;
+        std::vector<uint64_t> directory;
+};
+
+class
+PIDTraceReader
+{
+    public:
+        PIDTraceReader();
+        ~PIDTraceReader();
+
+        PIDTraceReader(const PIDTraceReader &) = delete;
+        PIDTraceReader &operator=(const PIDTraceReader &) = delete;
+
+        //
+        // Open
+        // Description:
+        //      Maps a trace into memory and checks that every chunk and column
+        //      lies within the file. Where memory mapping is not available the
+        //      file is read into memory instead, and written back by Close if
+        //      it was opened writable.
+        // Parameters:
+        //      path - The trace to open.
+        //      writable - True to map it for writing, which OutputColumn needs.
+        // Returns:
+        //      True if the trace was opened. False if it could not be mapped or
+        //      is not a valid trace.
+        //
+        bool Open(const char *path, bool writable);
+
+        //
+        // Close
+        // Description:
+        //      Unmaps the trace. Outputs written through OutputColumn end up in
+        //      the file. Also done by the destructor.
+        // Parameters:
+        //      None.
+        // Returns:
+        //      True if the outputs were written back. False otherwise.
+        //
+        bool Close();
+
+        inline uint32_t ChannelsGet() const { return header.channels; }
+        inline uint32_t ChunkSamplesGet() const { return header.chunkSamples; }
+        inline uint64_t SamplesGet() const { return header.samples; }
+        inline size_t ChunkCountGet() const { return chunks.size(); }
+
+        //
+        // Chunk Samples Get
+        // Description:
+        //      Returns the number of samples in a chunk.
+        // Parameters:
+        //      chunk - The chunk, below ChunkCountGet().
+        // Returns:
+        //      The number of samples, at most ChunkSamplesGet().
+        //
+        uint32_t ChunkSamplesGet(size_t chunk) const;
+
+        //
+        // Timestamp Read
+        // Description:
+        //      Returns the timestamps of a chunk, decoding them into scratch if
+        //      they are delta compressed.
+        // Parameters:
+        //      chunk - The chunk, below ChunkCountGet().
+        //      scratch - Space for ChunkSamplesGet() values.
+        // Returns:
+        //      The timestamps, in the mapping or in scratch. Null if the column
+        //      does not decode.
+        //
+        const int64_t *TimestampRead(size_t chunk, int64_t *scratch) const;
+
+        //
+        // Column Read
+        // Description:
+        //      Returns a column of a chunk, decoding it into scratch if it is
+        //      delta compressed.
+        // Parameters:
+        //      chunk - The chunk, below ChunkCountGet().
+        //      column - Which column of the channel.
+        //      channel - The channel, below ChannelsGet().
+        //      scratch - Space for ChunkSamplesGet() values.
+        // Returns:
+        //      The values, in the mapping or in scratch. Null if the column
+        //      does not decode.
+        //
+        const float *ColumnRead(size_t chunk, PIDTraceColumn column, uint32_t channel,
+                                float *scratch) const;
+
+        //
+        // Output Column
+        // Description:
+        //      Returns the output column of a channel in a chunk for writing.
+        // Parameters:
+        //      chunk - The chunk, below ChunkCountGet().
+        //      channel - The channel, below ChannelsGet().
+        // Returns:
+        //      The column in the mapping. Null unless opened writable.
+        //
+        float *OutputColumn(size_t chunk, uint32_t channel);
+
+    private:
+        const PIDTraceColumnHeader &ColumnHeader(size_t chunk, size_t column) const;
+        bool ChunksCheck();
+
+        uint8_t *data;
+        size_t size;
+        bool writable;
+        PIDTraceHeader header;
+
+        //
+        // Offset of each chunk
+        //
+        std::vector<uint64_t> chunks;
+
+        //
+        // The file contents and the path to write them back to when memory
+        // mapping is not available
+        //
+        std::vector<uint8_t> contents;
+        std::vector<char> path;
+};
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+//
+// PID Trace Replay
+// Description:
+//      Runs every sample of a trace through one controller per channel and
+//      writes the outputs into the output columns. Each chunk goes through
+//      PIDComputeBlock one channel at a time, so a controller's state stays in
+//      registers for a whole chunk. With timed set, each sample goes through
+//      the timed PIDCompute with its recorded timestamp instead, for traces
+//      taken with a jittery sample period. The controllers are left in their
+//      state after the last sample.
+// Parameters:
+//      trace - The trace, opened writable.
+//      controllers - One controller per channel.
+//      timed - True to use the recorded timestamps.
+// Returns:
+//      True if the whole trace was replayed. False if it is not writable or a
+//      column does not decode.
+//
+bool PIDTraceReplay(PIDTraceReader &trace, PIDControl *controllers, bool timed);
+
+//
+// PID Trace Replay
+// Description:
+//      Runs every sample of a trace through a bank of one controller per
+//      channel and writes the outputs into the output columns. Each tick loads
+//      the inputs and setpoints of the sample into the bank, runs ComputeAll
+//      and stores the outputs. A delta compressed trace needs its chunks
+//      decoded whole, so keep their chunkSamples times channels modest.
+// Parameters:
+//      trace - The trace, opened writable.
+//      bank - A bank of ChannelsGet() controllers.
+// Returns:
+//      True if the whole trace was replayed. False if it is not writable, the
+//      bank has the wrong size or a column does not decode.
+//
+bool PIDTraceReplay(PIDTraceReader &trace, PIDBank &bank);
+
+#endif  // PID_TRACE_H
@@ -0,0 +1,115 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Lock free publication of new tunings to a controller that is
+// being computed on another thread. The management thread publishes a complete
+// parameter set through a sequence lock and the real time thread picks it up
+// between computes without ever blocking, so it never sees a mix of old and new
+// gains and limits.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include "pid_tuning_channel.h"
+
+//*********************************************************************************
+// Public Class Functions
+//*********************************************************************************
+
+PIDTuningChannel::
+PIDTuningChannel() :
+    sequence(0),
+    kp(0.0f),
+    ki(0.0f),
+    kd(0.0f),
+    outMin(0.0f),
+    outMax(0.0f),
+    appliedSequence(0)
+{
+}
+
+uint32_t PIDTuningChannel::
+Publish(const PIDTuning &tuning)
+{
+    // The comparisons are false for NaN too
+    if(!(tuning.kp >= 0.0f && tuning.ki >= 0.0f && tuning.kd >= 0.0f && 
+         tuning.outMin < tuning.outMax))
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(publishMutex);
+    uint32_t start = sequence.load(std::memory_order_relaxed);
+
+    // Mark the parameters as being written
+    sequence.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    kp.store(tuning.kp, std::memory_order_relaxed);
+    ki.store(tuning.ki, std::memory_order_relaxed);
+    kd.store(tuning.kd, std::memory_order_relaxed);
+    outMin.store(tuning.outMin, std::memory_order_relaxed);
+    outMax.store(tuning.outMax, std::memory_order_relaxed);
+
+    // Mark them as stable again
+    sequence.store(start + 2, std::memory_order_release);
+
+    return (start + 2) / 2;
+}
+
+bool PIDTuningChannel::
+Read(PIDTuning &tuning, uint32_t &version) const
+{
+    uint32_t before = sequence.load(std::memory_order_acquire);
+
+    // Nothing published yet, or a publish is in progress
+    if(before == 0 || (before & 1u) != 0)
+    {
+        return false;
+    }
+
+    tuning.kp = kp.load(std::memory_order_relaxed);
+    tuning.ki = ki.load(std::memory_order_relaxed);
+    tuning.kd = kd.load(std::memory_order_relaxed);
+    tuning.outMin = outMin.load(std::memory_order_relaxed);
+    tuning.outMax = outMax.load(std::memory_order_relaxed);
+
+    // The snapshot is only consistent if no publish started meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(sequence.load(std::memory_order_relaxed) != before)
+    {
+        return false;
+    }
+
+    version = before / 2;
+
+    return true;
+}
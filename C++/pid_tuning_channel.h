@@ -0,0 +1,180 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Lock free publication of new tunings to a controller that is
+// being computed on another thread. The management thread publishes a complete
+// parameter set through a sequence lock and the real time thread picks it up
+// between computes without ever blocking, so it never sees a mix of old and new
+// gains and limits.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//
+// Header Guard
+//
+#ifndef PID_TUNING_CHANNEL_H
+#define PID_TUNING_CHANNEL_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include "pid_aligned_allocator.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// A complete set of parameters that is applied to a controller as one unit
+//
+struct
+PIDTuning
+{
+    float kp;
+    float ki;
+    float kd;
+    float outMin;
+    float outMax;
+};
+
+//*********************************************************************************
+// Class
+//*********************************************************************************
+
+class
+PIDTuningChannel
+{
+    public:
+        //
+        // Constructor
+        // Description:
+        //      Creates a channel with nothing published yet.
+        //
+        PIDTuningChannel();
+
+        PIDTuningChannel(const PIDTuningChannel &) = delete;
+        PIDTuningChannel &operator=(const PIDTuningChannel &) = delete;
+
+        //
+        // Publish
+        // Description:
+        //      Makes a new parameter set available to the compute thread. Meant
+        //      for the management thread; publishers are serialized among
+        //      themselves but never wait for the compute thread. A set the
+        //      controller would take only part of, with a negative or NaN
+        //      gain or outMin not below outMax, is refused, so that Poll
+        //      applies every set whole.
+        // Parameters:
+        //      tuning - The parameters to publish.
+        // Returns:
+        //      The version number of the published set, starting at 1, or 0
+        //      if the set was refused and the last one stays published.
+        //
+        uint32_t Publish(const PIDTuning &tuning);
+
+        //
+        // Read
+        // Description:
+        //      Takes a consistent snapshot of the latest published set without
+        //      blocking. Fails if a publish is in progress at that moment, in
+        //      which case the caller simply tries again on its next tick.
+        // Parameters:
+        //      tuning - Receives the parameters.
+        //      version - Receives the version of the parameters.
+        // Returns:
+        //      True if a consistent, published set was read. False otherwise.
+        //
+        bool Read(PIDTuning &tuning, uint32_t &version) const;
+
+        //
+        // Poll
+        // Description:
+        //      Called by the compute thread between computes. If a set newer
+        //      than the last one applied has been published, it is applied with
+        //      PIDOutputLimitsSet and PIDTuningsSet right away, both of which
+        //      take every set Publish lets through. Works with any
+        //      controller that has those two functions, such as PIDControl,
+        //      PIDBankView or a dynamic PIDControlT. Wait free.
+        // Parameters:
+        //      pid - The controller the channel feeds.
+        // Returns:
+        //      True if new parameters were applied. False otherwise.
+        //
+        template <typename Controller>
+        bool Poll(Controller &pid)
+        {
+            PIDTuning tuning;
+            uint32_t version;
+
+            // Cheap check that keeps the common case to a single load
+            if(sequence.load(std::memory_order_relaxed) == appliedSequence)
+            {
+                return false;
+            }
+
+            if(!Read(tuning, version))
+            {
+                return false;
+            }
+
+            pid.PIDOutputLimitsSet(tuning.outMin, tuning.outMax);
+            pid.PIDTuningsSet(tuning.kp, tuning.ki, tuning.kd);
+            appliedSequence = version * 2;
+
+            return true;
+        }
+
+    private:
+        //
+        // Even while the parameters are stable, odd while a publish is writing
+        // them. Version n of the parameters has sequence 2n.
+        //
+        alignas(PID_CACHE_LINE_SIZE) std::atomic<uint32_t> sequence;
+        std::atomic<float> kp;
+        std::atomic<float> ki;
+        std::atomic<float> kd;
+        std::atomic<float> outMin;
+        std::atomic<float> outMax;
+
+        //
+        // Serializes publishers. Never touched by the compute thread.
+        //
+        std::mutex publishMutex;
+
+        //
+        // Sequence of the last set Poll applied. Only used by the compute
+        // thread, so it sits on its own cache line.
+        //
+        alignas(PID_CACHE_LINE_SIZE) uint32_t appliedSequence;
+};
+
+#endif  // PID_TUNING_CHANNEL_H
@@ -0,0 +1,207 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: Checkpoint and restore of PIDControl state in a versioned, fixed
+// layout binary format, so a restarted process can pick its controllers up where
+// they left off instead of re-converging from a zero integrator.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <string.h>
+#include "pid_checkpoint.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// 
+// The format is fixed, so catch a compiler that pads the structures
+// 
+typedef char PIDCheckpointHeaderSizeCheck[(sizeof(PIDCheckpointHeader) == 64) ? 1 : -1];
+typedef char PIDCheckpointRecordSizeCheck[(sizeof(PIDCheckpointRecord) == 128) ? 1 : -1];
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+void
+PIDCheckpointSave(const PIDControl *pid, PIDCheckpointRecord *record)
+{
+    record->input = pid->input;
+    record->lastInput = pid->lastInput;
+    record->output = pid->output;
+    record->iTerm = pid->iTerm;
+    record->setpoint = pid->setpoint;
+    record->dispKp = pid->dispKp;
+    record->dispKi = pid->dispKi;
+    record->dispKd = pid->dispKd;
+    record->alteredKp = pid->alteredKp;
+    record->alteredKi = pid->alteredKi;
+    record->alteredKd = pid->alteredKd;
+    record->sampleTime = pid->sampleTime;
+    record->outMin = pid->outMin;
+    record->outMax = pid->outMax;
+    record->deadband = pid->deadband;
+    record->mode = (uint8_t)(pid->mode);
+    record->controllerDirection = (uint8_t)(pid->controllerDirection);
+    record->antiWindup = (uint8_t)(pid->antiWindup);
+    record->reserved = 0;
+    record->dispKt = pid->dispKt;
+    record->setpointWeightB = pid->setpointWeightB;
+    record->setpointWeightC = pid->setpointWeightC;
+    record->filterN = pid->filterN;
+    record->dTerm = pid->dTerm;
+    record->lastSetpoint = pid->lastSetpoint;
+    memset(record->padding, 0, sizeof(record->padding));
+}
+
+bool
+PIDCheckpointRestore(PIDControl *pid, const PIDCheckpointRecord *record)
+{
+    // Check if the record is valid. The comparisons are written so that NaN
+    // fails them.
+    if((record->mode != MANUAL && record->mode != AUTOMATIC) ||
+       (record->controllerDirection != DIRECT && record->controllerDirection != REVERSE) ||
+       (record->antiWindup != CLAMPING && record->antiWindup != CONDITIONAL_INTEGRATION &&
+        record->antiWindup != BACK_CALCULATION) ||
+       !(record->sampleTime > 0.0f) || !(record->outMin < record->outMax) ||
+       !(record->dispKt >= 0.0f) || !(record->setpointWeightB >= 0.0f) || 
+       !(record->setpointWeightC >= 0.0f) || !(record->filterN >= 0.0f))
+    {
+        return false;
+    }
+    
+    pid->input = record->input;
+    pid->lastInput = record->lastInput;
+    pid->output = record->output;
+    pid->iTerm = record->iTerm;
+    pid->setpoint = record->setpoint;
+    pid->dispKp = record->dispKp;
+    pid->dispKi = record->dispKi;
+    pid->dispKd = record->dispKd;
+    pid->alteredKp = record->alteredKp;
+    pid->alteredKi = record->alteredKi;
+    pid->alteredKd = record->alteredKd;
+    pid->sampleTime = record->sampleTime;
+    pid->outMin = record->outMin;
+    pid->outMax = record->outMax;
+    pid->deadband = record->deadband;
+    pid->mode = (PIDMode)(record->mode);
+    pid->controllerDirection = (PIDDirection)(record->controllerDirection);
+    pid->antiWindup = (PIDAntiWindup)(record->antiWindup);
+    pid->dispKt = record->dispKt;
+    pid->setpointWeightB = record->setpointWeightB;
+    pid->setpointWeightC = record->setpointWeightC;
+    pid->filterN = record->filterN;
+    pid->dTerm = record->dTerm;
+    pid->lastSetpoint = record->lastSetpoint;
+    
+    // The coefficients worked out from the settings are altered for the 
+    // restored gains and sample time, and the state that is not saved starts
+    // over. The weighted law is chosen as PIDSetpointWeightsSet does.
+    pid->sampleRate = 1.0f / pid->sampleTime;
+    pid->alteredKt = pid->dispKt * pid->sampleTime;
+    PIDCoreFilter(pid->alteredKd, pid->filterN, pid->sampleTime, 
+                  &(pid->filterAlpha), &(pid->filterKd));
+    pid->weighted = (pid->setpointWeightB != 1.0f || pid->setpointWeightC != 0.0f || 
+                     pid->filterN > 0.0f);
+    pid->lastTime = 0;
+    pid->timeValid = false;
+    pid->outputChanged = false;
+    pid->forceCompute = true;
+    
+    return true;
+}
+
+size_t
+PIDCheckpointSize(size_t count)
+{
+    return sizeof(PIDCheckpointHeader) + count * sizeof(PIDCheckpointRecord);
+}
+
+size_t
+PIDCheckpointWrite(const PIDControl *pids, size_t count, void *buffer, size_t size)
+{
+    PIDCheckpointHeader *header = (PIDCheckpointHeader *)buffer;
+    PIDCheckpointRecord *records = (PIDCheckpointRecord *)(header + 1);
+    size_t i;
+    
+    if(size < PIDCheckpointSize(count) || count > UINT32_MAX)
+    {
+        return 0;
+    }
+    
+    memset(header, 0, sizeof(*header));
+    header->magic = PID_CHECKPOINT_MAGIC;
+    header->version = PID_CHECKPOINT_VERSION;
+    header->recordSize = (uint16_t)sizeof(PIDCheckpointRecord);
+    header->count = (uint32_t)count;
+    
+    for(i = 0; i < count; i++)
+    {
+        PIDCheckpointSave(&pids[i], &records[i]);
+    }
+    
+    return PIDCheckpointSize(count);
+}
+
+size_t
+PIDCheckpointRead(PIDControl *pids, size_t count, const void *buffer, size_t size)
+{
+    const PIDCheckpointHeader *header = (const PIDCheckpointHeader *)buffer;
+    const PIDCheckpointRecord *records = (const PIDCheckpointRecord *)(header + 1);
+    size_t i;
+    
+    if(size < sizeof(PIDCheckpointHeader) ||
+       header->magic != PID_CHECKPOINT_MAGIC ||
+       header->version != PID_CHECKPOINT_VERSION ||
+       header->recordSize != sizeof(PIDCheckpointRecord) ||
+       (size - sizeof(PIDCheckpointHeader)) / sizeof(PIDCheckpointRecord) < header->count)
+    {
+        return 0;
+    }
+    
+    if(count > header->count)
+    {
+        count = header->count;
+    }
+    
+    for(i = 0; i < count; i++)
+    {
+        if(!PIDCheckpointRestore(&pids[i], &records[i]))
+        {
+            return 0;
+        }
+    }
+    
+    return count;
+}
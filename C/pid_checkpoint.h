@@ -0,0 +1,234 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: Checkpoint and restore of PIDControl state in a versioned, fixed
+// layout binary format, so a restarted process can pick its controllers up where
+// they left off instead of re-converging from a zero integrator.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+// 
+// Header Guard
+// 
+#ifndef PID_CHECKPOINT_H
+#define PID_CHECKPOINT_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "pid_controller.h"
+
+// 
+// C Binding for C++ Compilers
+// 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// 
+// Checkpoint format, version 1
+// 
+// A checkpoint is a 64 byte PIDCheckpointHeader followed by count 128 byte 
+// PIDCheckpointRecords, one per controller, so records start on a cache line 
+// when the checkpoint does. All values are in the native byte order and float
+// format of the machine that wrote them; a checkpoint from a machine of the 
+// other byte order is rejected by its magic number. The C++ library writes the
+// same format, so a checkpoint can move between the two.
+// 
+#define PID_CHECKPOINT_MAGIC        0x43444950u
+#define PID_CHECKPOINT_VERSION      1
+
+typedef struct
+{
+    // 
+    // PID_CHECKPOINT_MAGIC, PID_CHECKPOINT_VERSION, sizeof(PIDCheckpointRecord)
+    // and the number of records that follow
+    // 
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t count;
+    
+    // 
+    // Zero, for future versions
+    // 
+    uint32_t reserved[13];
+}
+PIDCheckpointHeader;
+
+typedef struct
+{
+    // 
+    // The state and settings of one controller, see PIDControl for the 
+    // meaning of each field
+    // 
+    float input;
+    float lastInput;
+    float output;
+    float iTerm;
+    float setpoint;
+    float dispKp;
+    float dispKi;
+    float dispKd;
+    float alteredKp;
+    float alteredKi;
+    float alteredKd;
+    float sampleTime;
+    float outMin;
+    float outMax;
+    float deadband;
+    
+    // 
+    // PIDMode, PIDDirection and PIDAntiWindup values
+    // 
+    uint8_t mode;
+    uint8_t controllerDirection;
+    uint8_t antiWindup;
+    
+    // 
+    // Zero, for future versions
+    // 
+    uint8_t reserved;
+    
+    // 
+    // The tracking gain, the setpoint weights, the derivative filter 
+    // coefficient and the state the weighted law keeps
+    // 
+    float dispKt;
+    float setpointWeightB;
+    float setpointWeightC;
+    float filterN;
+    float dTerm;
+    float lastSetpoint;
+    
+    // 
+    // Zero, for future versions
+    // 
+    uint32_t padding[10];
+}
+PIDCheckpointRecord;
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+// 
+// PID Checkpoint Save
+// Description:
+//      Copies the state and settings of a controller into a record.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+//      record - Receives the controller.
+// Returns:
+//      Nothing.
+// 
+extern void PIDCheckpointSave(const PIDControl *pid, PIDCheckpointRecord *record);
+
+// 
+// PID Checkpoint Restore
+// Description:
+//      Puts a controller back into the state of a record. The controller 
+//      carries on from the saved integrator, filtered derivative, last input,
+//      last setpoint and output, so the next PIDCompute is bumpless. 
+//      PIDComputeAt starts a new interval and a controller in deadband mode 
+//      computes once before it can rest.
+// Parameters:
+//      pid - The address of a PIDControl instantiation. It need not have been
+//            initialized.
+//      record - The record to restore from.
+// Returns:
+//      False, leaving the controller untouched, if the record holds an 
+//      invalid mode, direction, anti-windup strategy, sample time, pair of 
+//      limits, or negative tracking gain, setpoint weight or filter 
+//      coefficient. True otherwise.
+// 
+extern bool PIDCheckpointRestore(PIDControl *pid, const PIDCheckpointRecord *record);
+
+// 
+// PID Checkpoint Size
+// Description:
+//      Returns the number of bytes a checkpoint of count controllers takes.
+// Parameters:
+//      count - Number of controllers.
+// Returns:
+//      The size in bytes.
+// 
+extern size_t PIDCheckpointSize(size_t count);
+
+// 
+// PID Checkpoint Write
+// Description:
+//      Writes a checkpoint of an array of controllers into a buffer, such as a
+//      memory mapped file.
+// Parameters:
+//      pids - Array of count controllers.
+//      count - Number of controllers.
+//      buffer - Receives the checkpoint. It must be aligned to 4 bytes.
+//      size - Size of the buffer in bytes.
+// Returns:
+//      The number of bytes written, or 0 if the buffer is too small.
+// 
+extern size_t PIDCheckpointWrite(const PIDControl *pids, size_t count, 
+                                 void *buffer, size_t size);
+
+// 
+// PID Checkpoint Read
+// Description:
+//      Restores an array of controllers from a checkpoint, such as a memory 
+//      mapped file, in one pass over the records.
+// Parameters:
+//      pids - Array of count controllers.
+//      count - Number of controllers in the array.
+//      buffer - The checkpoint. It must be aligned to 4 bytes.
+//      size - Size of the checkpoint in bytes.
+// Returns:
+//      The number of controllers restored, which is the smaller of count and 
+//      the number of records. 0 if the checkpoint is truncated, has the wrong
+//      magic number, version or record size, or holds an invalid record, in 
+//      which case the records before the invalid one have been restored.
+// 
+extern size_t PIDCheckpointRead(PIDControl *pids, size_t count, 
+                                const void *buffer, size_t size);
+
+// 
+// End of C Binding
+// 
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PID_CHECKPOINT_H
@@ -38,14 +38,99 @@
 //*********************************************************************************
 #include "pid_controller.h"
 
-//*********************************************************************************
-// Macros and Globals
-//*********************************************************************************
-#define CONSTRAIN(x,lower,upper)    ((x)<(lower)?(lower):((x)>(upper)?(upper):(x)))
-
 //*********************************************************************************
 // Functions
 //*********************************************************************************
+
+// 
+// PIDCompute and the basic set and get functions are defined inline in the
+// header. These declarations make this file provide the one external 
+// definition C99 needs for calls the compiler decides not to inline.
+// 
+extern inline bool PIDComputeConstantTime(PIDControl *pid);
+extern inline bool PIDCompute(PIDControl *pid);
+extern inline void PIDSetpointSet(PIDControl *pid, float setpoint);
+extern inline void PIDInputSet(PIDControl *pid, float input);
+extern inline float PIDOutputGet(PIDControl *pid);
+extern inline float PIDKpGet(PIDControl *pid);
+extern inline float PIDKiGet(PIDControl *pid);
+extern inline float PIDKdGet(PIDControl *pid);
+extern inline PIDMode PIDModeGet(PIDControl *pid);
+extern inline PIDDirection PIDDirectionGet(PIDControl *pid);
+extern inline PIDAntiWindup PIDAntiWindupGet(PIDControl *pid);
+extern inline float PIDKtGet(PIDControl *pid);
+extern inline float PIDSetpointWeightBGet(PIDControl *pid);
+extern inline float PIDSetpointWeightCGet(PIDControl *pid);
+extern inline float PIDDerivativeFilterGet(PIDControl *pid);
+extern inline bool PIDOutputChangedGet(PIDControl *pid);
+
+// 
+// The same for the shared core of pid_core.h
+// 
+extern inline float PIDCoreConstrain(float x, float lower, float upper);
+extern inline float PIDCoreHold(float output, float step, float outMin, float outMax);
+extern inline unsigned PIDCoreOutput(float proportional, float derivative, 
+                                     float step, float *iTerm, float *output, 
+                                     float kt, float outMin, float outMax, 
+                                     int antiWindup);
+extern inline unsigned PIDCoreUpdate(float input, float setpoint, float *iTerm, 
+                                     float *lastInput, float *output, float kp, 
+                                     float ki, float kd, float kt, float outMin, 
+                                     float outMax, int antiWindup);
+extern inline unsigned PIDCoreUpdateWeighted(float input, float setpoint, 
+                                             float *iTerm, float *lastInput, 
+                                             float *lastSetpoint, float *dTerm, 
+                                             float *output, float kp, float ki, 
+                                             float kt, float b, float c, 
+                                             float filterAlpha, float filterKd, 
+                                             float outMin, float outMax, 
+                                             int antiWindup);
+extern inline float PIDCoreSelect(bool condition, float a, float b);
+extern inline float PIDCoreConstrainSelect(float x, float lower, float upper);
+extern inline unsigned PIDCoreUpdateConstantTime(bool automatic, bool weighted, 
+                                                 float input, float setpoint, 
+                                                 float *iTerm, float *lastInput, 
+                                                 float *lastSetpoint, float *dTerm, 
+                                                 float *output, float kp, float ki, 
+                                                 float kd, float kt, float b, 
+                                                 float c, float filterAlpha, 
+                                                 float filterKd, float outMin, 
+                                                 float outMax, int antiWindup);
+extern inline bool PIDCoreAtRest(float input, float lastInput, float setpoint, 
+                                 float lastSetpoint, float iTerm, float output, 
+                                 float kp, float ki, float b, float derivative, 
+                                 float outMin, float outMax, float deadband);
+extern inline void PIDCoreGains(float kp, float ki, float kd, float sampleTime, 
+                                bool reverse, float *alteredKp, float *alteredKi, 
+                                float *alteredKd);
+extern inline void PIDCoreGainsReverse(float *alteredKp, float *alteredKi, 
+                                       float *alteredKd);
+extern inline void PIDCoreSampleTimeScale(float ratio, float *alteredKi, 
+                                          float *alteredKd);
+extern inline void PIDCoreFilter(float alteredKd, float n, float sampleTime, 
+                                 float *filterAlpha, float *filterKd);
+
+// 
+// Works out whether the controller leaves the plain update law. The weighted
+// law's own state starts over when it is turned on, since the plain law does
+// not keep it up to date.
+// 
+static void
+PIDWeightedUpdate(PIDControl *pid)
+{
+    bool weighted = (pid->setpointWeightB != 1.0f || pid->setpointWeightC != 0.0f || 
+                     pid->filterN > 0.0f);
+    
+    if(weighted && !(pid->weighted))
+    {
+        pid->lastSetpoint = pid->setpoint;
+        pid->dTerm = 0.0f;
+    }
+    
+    pid->weighted = weighted;
+    pid->forceCompute = true;
+}
+
 void PIDInit(PIDControl *pid, float kp, float ki, float kd, 
              float sampleTimeSeconds, float minOutput, float maxOutput, 
              PIDMode mode, PIDDirection controllerDirection)     	
@@ -68,40 +153,210 @@ void PIDInit(PIDControl *pid, float kp, float ki, float kd,
         pid->sampleTime = 1.0f;
     }
     
+    pid->sampleRate = 1.0f / pid->sampleTime;
+    pid->lastTime = 0;
+    pid->timeValid = false;
+    pid->deadband = -1.0f;
+    pid->lastSetpoint = 0.0f;
+    pid->outputChanged = false;
+    pid->forceCompute = true;
+    pid->antiWindup = CLAMPING;
+    pid->dispKt = 0.0f;
+    pid->alteredKt = 0.0f;
+    pid->setpointWeightB = 1.0f;
+    pid->setpointWeightC = 0.0f;
+    pid->filterN = 0.0f;
+    pid->dTerm = 0.0f;
+    pid->weighted = false;
+    
     PIDOutputLimitsSet(pid, minOutput, maxOutput);
     PIDTuningsSet(pid, kp, ki, kd);
 }
         
+void
+PIDDeadbandSet(PIDControl *pid, float deadband) 
+{
+    pid->deadband = deadband;
+    pid->forceCompute = true;
+}
+     
 bool
-PIDCompute(PIDControl *pid) 
+PIDComputeAt(PIDControl *pid, uint32_t timestampMicros) 
 {
-    float error, dInput;
+    float ratio, iScale, dScale, filterAlpha, filterKd;
 
     if(pid->mode == MANUAL)
     {
         return false;
     }
     
-    // The classic PID error term
-    error = (pid->setpoint) - (pid->input);
+    if(pid->timeValid)
+    {
+        // Unsigned subtraction gives the right interval across a wrap
+        ratio = (float)(timestampMicros - pid->lastTime) * 1e-6f * (pid->sampleRate);
+        
+        // The caller is polling faster than the sample time
+        if(ratio < 0.5f)
+        {
+            return false;
+        }
+        
+        // A gap of more than a few sample times is a restart, and the 
+        // derivative is not taken across it
+        if(ratio > (float)PID_CORE_INTERVAL_MAX)
+        {
+            pid->lastInput = pid->input;
+            pid->lastSetpoint = pid->setpoint;
+            pid->dTerm = 0.0f;
+            pid->timeValid = false;
+        }
+        
+        iScale = ratio;
+        dScale = 1.0f / ratio;
+    }
+    
+    // The first interval, and the first after a restart, is taken to be the 
+    // nominal sample time
+    if(!(pid->timeValid))
+    {
+        iScale = 1.0f;
+        dScale = 1.0f;
+        pid->timeValid = true;
+    }
+    
+    pid->lastTime = timestampMicros;
+    
+    // The same steps as PIDCompute with the gains scaled to the interval.
+    // The filter coefficients do not scale linearly, so they are worked out
+    // again for it.
+    if(pid->weighted)
+    {
+        PIDCoreFilter((pid->alteredKd) * dScale, pid->filterN, 
+                      (pid->sampleTime) * iScale, &filterAlpha, &filterKd);
+        PIDCoreUpdateWeighted(pid->input, pid->setpoint, &(pid->iTerm), 
+                              &(pid->lastInput), &(pid->lastSetpoint), 
+                              &(pid->dTerm), &(pid->output), pid->alteredKp, 
+                              (pid->alteredKi) * iScale, (pid->alteredKt) * iScale, 
+                              pid->setpointWeightB, pid->setpointWeightC, 
+                              filterAlpha, filterKd, pid->outMin, pid->outMax, 
+                              pid->antiWindup);
+    }
+    else
+    {
+        PIDCoreUpdate(pid->input, pid->setpoint, &(pid->iTerm), &(pid->lastInput), 
+                      &(pid->output), pid->alteredKp, (pid->alteredKi) * iScale, 
+                      (pid->alteredKd) * dScale, (pid->alteredKt) * iScale, 
+                      pid->outMin, pid->outMax, pid->antiWindup);
+    }
+    
+    return true;
+}
+     
+bool
+PIDComputeBlock(PIDControl *pid, const float *inputs, const float *setpoints, 
+                float *outputs, size_t n)
+{
+    float input, output;
+    float setpoint = pid->setpoint;
+    float iTerm = pid->iTerm;
+    float lastInput = pid->lastInput;
+    float alteredKp = pid->alteredKp;
+    float alteredKi = pid->alteredKi;
+    float alteredKd = pid->alteredKd;
+    float alteredKt = pid->alteredKt;
+    PIDAntiWindup antiWindup = pid->antiWindup;
+    float lastSetpoint = pid->lastSetpoint;
+    float dTerm = pid->dTerm;
+    float setpointWeightB = pid->setpointWeightB;
+    float setpointWeightC = pid->setpointWeightC;
+    float filterAlpha = pid->filterAlpha;
+    float filterKd = pid->filterKd;
+    bool weighted = pid->weighted;
+    float outMin = pid->outMin;
+    float outMax = pid->outMax;
+    size_t i;
+    
+    if(n == 0)
+    {
+        return pid->mode == AUTOMATIC;
+    }
     
-    // Compute the integral term separately ahead of time
-    pid->iTerm += (pid->alteredKi) * error;
+    if(pid->mode == MANUAL)
+    {
+        // Nothing is computed, but the last input and setpoint are kept just
+        // like PIDInputSet and PIDSetpointSet would have
+        for(i = 0; i < n; i++)
+        {
+            outputs[i] = pid->output;
+        }
+        pid->input = inputs[n - 1];
+        if(setpoints)
+        {
+            pid->setpoint = setpoints[n - 1];
+        }
+        return false;
+    }
     
-    // Constrain the integrator to make sure it does not exceed output bounds
-    pid->iTerm = CONSTRAIN( (pid->iTerm), (pid->outMin), (pid->outMax) );
+    // The state lives in locals for the whole block
+    for(i = 0; i < n; i++)
+    {
+        input = inputs[i];
+        if(setpoints)
+        {
+            setpoint = setpoints[i];
+        }
+        
+        // The same steps as PIDCompute
+        if(weighted)
+        {
+            PIDCoreUpdateWeighted(input, setpoint, &iTerm, &lastInput, &lastSetpoint,
+                                  &dTerm, &output, alteredKp, alteredKi, alteredKt, 
+                                  setpointWeightB, setpointWeightC, filterAlpha, 
+                                  filterKd, outMin, outMax, antiWindup);
+        }
+        else
+        {
+            PIDCoreUpdate(input, setpoint, &iTerm, &lastInput, &output, alteredKp, 
+                          alteredKi, alteredKd, alteredKt, outMin, outMax, antiWindup);
+        }
+        
+        outputs[i] = output;
+    }
     
-    // Take the "derivative on measurement" instead of "derivative on error"
-    dInput = (pid->input) - (pid->lastInput);
+    pid->input = input;
+    pid->setpoint = setpoint;
+    pid->iTerm = iTerm;
+    pid->lastInput = lastInput;
+    pid->lastSetpoint = weighted ? lastSetpoint : pid->lastSetpoint;
+    pid->dTerm = dTerm;
+    pid->output = output;
     
-    // Run all the terms together to get the overall output
-    pid->output = (pid->alteredKp) * error + (pid->iTerm) - (pid->alteredKd) * dInput;
+    return true;
+}
+     
+bool
+PIDComputeBound(PIDControl *pid, const PIDBinding *binding)
+{
+    // Read the process image in place
+    if(binding->input)
+    {
+        pid->input = *(binding->input);
+    }
+    if(binding->setpoint)
+    {
+        pid->setpoint = *(binding->setpoint);
+    }
     
-    // Bound the output
-    pid->output = CONSTRAIN( (pid->output), (pid->outMin), (pid->outMax) );
+    if(!PIDCompute(pid))
+    {
+        return false;
+    }
     
-    // Make the current input the former input
-    pid->lastInput = pid->input;
+    // Write the process image in place
+    if(binding->output)
+    {
+        *(binding->output) = pid->output;
+    }
     
     return true;
 }
@@ -115,9 +370,15 @@ PIDModeSet(PIDControl *pid, PIDMode mode)
         // Initialize a few PID parameters to new values
         pid->iTerm = pid->output;
         pid->lastInput = pid->input;
+        pid->lastSetpoint = pid->setpoint;
+        pid->dTerm = 0.0f;
         
         // Constrain the integrator to make sure it does not exceed output bounds
-        pid->iTerm = CONSTRAIN( (pid->iTerm), (pid->outMin), (pid->outMax) );
+        pid->iTerm = PIDCoreConstrain(pid->iTerm, pid->outMin, pid->outMax);
+        
+        // PIDComputeAt has no interval to go by until its next call
+        pid->timeValid = false;
+        pid->forceCompute = true;
     }
     
     pid->mode = mode;
@@ -135,12 +396,13 @@ PIDOutputLimitsSet(PIDControl *pid, float min, float max)
     // Save the parameters
     pid->outMin = min;
     pid->outMax = max;
+    pid->forceCompute = true;
     
     // If in automatic, apply the new constraints
     if(pid->mode == AUTOMATIC)
     {
-        pid->output = CONSTRAIN(pid->output, min, max);
-        pid->iTerm  = CONSTRAIN(pid->iTerm,  min, max);
+        pid->output = PIDCoreConstrain(pid->output, min, max);
+        pid->iTerm  = PIDCoreConstrain(pid->iTerm,  min, max);
     }
 }
 
@@ -158,18 +420,12 @@ PIDTuningsSet(PIDControl *pid, float kp, float ki, float kd)
     pid->dispKi = ki;
     pid->dispKd = kd;
     
-    // Alter the parameters for PID
-    pid->alteredKp = kp;
-    pid->alteredKi = ki * pid->sampleTime;
-    pid->alteredKd = kd / pid->sampleTime;
-    
-    // Apply reverse direction to the altered values if necessary
-    if(pid->controllerDirection == REVERSE)
-    {
-        pid->alteredKp = -(pid->alteredKp);
-        pid->alteredKi = -(pid->alteredKi);
-        pid->alteredKd = -(pid->alteredKd);
-    }
+    // Alter the parameters for PID, reversed if necessary
+    PIDCoreGains(kp, ki, kd, pid->sampleTime, pid->controllerDirection == REVERSE, 
+                 &(pid->alteredKp), &(pid->alteredKi), &(pid->alteredKd));
+    PIDCoreFilter(pid->alteredKd, pid->filterN, pid->sampleTime, 
+                  &(pid->filterAlpha), &(pid->filterKd));
+    pid->forceCompute = true;
 }
 
 void 
@@ -197,12 +453,12 @@ PIDControllerDirectionSet(PIDControl *pid, PIDDirection controllerDirection)
     if(pid->mode == AUTOMATIC && controllerDirection == REVERSE)
     {
         // Reverse sense of direction of PID gain constants
-        pid->alteredKp = -(pid->alteredKp);
-        pid->alteredKi = -(pid->alteredKi);
-        pid->alteredKd = -(pid->alteredKd);
+        PIDCoreGainsReverse(&(pid->alteredKp), &(pid->alteredKi), &(pid->alteredKd));
+        pid->filterKd = -(pid->filterKd);
     }
     
     pid->controllerDirection = controllerDirection;
+    pid->forceCompute = true;
 }
 
 void 
@@ -214,12 +470,60 @@ PIDSampleTimeSet(PIDControl *pid, float sampleTimeSeconds)
     {
         // Find the ratio of change and apply to the altered values
         ratio = sampleTimeSeconds / pid->sampleTime;
-        pid->alteredKi *= ratio;
-        pid->alteredKd /= ratio;
+        PIDCoreSampleTimeScale(ratio, &(pid->alteredKi), &(pid->alteredKd));
+        pid->alteredKt *= ratio;
         
         // Save the new sampling time
         pid->sampleTime = sampleTimeSeconds;
+        PIDCoreFilter(pid->alteredKd, pid->filterN, sampleTimeSeconds, 
+                      &(pid->filterAlpha), &(pid->filterKd));
+        pid->sampleRate = 1.0f / sampleTimeSeconds;
+        pid->forceCompute = true;
     }
 }
 
+void 
+PIDAntiWindupSet(PIDControl *pid, PIDAntiWindup antiWindup, float kt)
+{
+    // Check if the parameters are valid
+    if(kt < 0.0f)
+    {
+        return;
+    }
+    
+    // The tracking gain works on the output, so the direction does not 
+    // change its sign
+    pid->antiWindup = antiWindup;
+    pid->dispKt = kt;
+    pid->alteredKt = kt * pid->sampleTime;
+    pid->forceCompute = true;
+}
+
+void 
+PIDSetpointWeightsSet(PIDControl *pid, float b, float c)
+{
+    // Check if the parameters are valid
+    if(b < 0.0f || c < 0.0f)
+    {
+        return;
+    }
+    
+    pid->setpointWeightB = b;
+    pid->setpointWeightC = c;
+    PIDWeightedUpdate(pid);
+}
 
+void 
+PIDDerivativeFilterSet(PIDControl *pid, float n)
+{
+    // Check if the parameters are valid
+    if(n < 0.0f)
+    {
+        return;
+    }
+    
+    pid->filterN = n;
+    PIDCoreFilter(pid->alteredKd, n, pid->sampleTime, 
+                  &(pid->filterAlpha), &(pid->filterKd));
+    PIDWeightedUpdate(pid);
+}
@@ -42,8 +42,10 @@
 //*********************************************************************************
 // Headers
 //*********************************************************************************
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "pid_core.h"
 
 // 
 // C Binding for C++ Compilers
@@ -71,6 +73,18 @@ typedef enum
 }
 PIDDirection;
 
+// 
+// What the integrator does while the output is held at a limit, see 
+// PIDAntiWindupSet
+// 
+typedef enum
+{
+    CLAMPING = PID_CORE_CLAMPING,
+    CONDITIONAL_INTEGRATION = PID_CORE_CONDITIONAL,
+    BACK_CALCULATION = PID_CORE_BACK_CALCULATION
+}
+PIDAntiWindup;
+
 typedef struct
 {
     // 
@@ -109,12 +123,44 @@ typedef struct
     // 
     float iTerm;
     
+    // 
+    // The anti-windup strategy, and the tracking gain of back-calculation
+    // as passed by the user and as altered for the sample time
+    // 
+    PIDAntiWindup antiWindup;
+    float dispKt;
+    float alteredKt;
+    
+    // 
+    // 2-DOF setpoint weights of the proportional and derivative terms, the 
+    // derivative filter coefficient as passed by the user, the filter 
+    // coefficients as altered for the sample time, and the filtered 
+    // derivative term. weighted is set when any of them leaves the plain 
+    // update law, which PIDCompute keeps to otherwise.
+    // 
+    float setpointWeightB;
+    float setpointWeightC;
+    float filterN;
+    float filterAlpha;
+    float filterKd;
+    float dTerm;
+    bool weighted;
+    
     // 
     // The interval (in seconds) on which the PID controller
     // will be called
     // 
     float sampleTime;
     
+    // 
+    // The reciprocal of sampleTime, and the timestamp of the last
+    // PIDComputeAt call that computed, which PIDComputeAt uses to 
+    // scale the I and D terms by the real interval between calls
+    // 
+    float sampleRate;
+    uint32_t lastTime;
+    bool timeValid;
+    
     // 
     // The values that the output will be constrained to
     // 
@@ -126,6 +172,17 @@ typedef struct
     // 
     float setpoint;
     
+    // 
+    // Deadband mode: the tolerance set with PIDDeadbandSet (negative 
+    // when off), the setpoint of the last compute, which the weighted 
+    // derivative also works from, whether the last PIDCompute changed 
+    // the output, and whether a setting changed since the last compute
+    // 
+    float deadband;
+    float lastSetpoint;
+    bool outputChanged;
+    bool forceCompute;
+    
     // 
     // The sense of direction of the controller
     // DIRECT:  A positive setpoint gives a positive output
@@ -143,6 +200,20 @@ typedef struct
 }
 PIDControl;
 
+// 
+// Locations outside of the controller, such as a shared memory process image
+// or memory mapped registers, that PIDComputeBound reads its input and
+// setpoint from and writes its output to. Any of them may be NULL to use the
+// controller's own field instead.
+// 
+typedef struct
+{
+    const volatile float *input;
+    const volatile float *setpoint;
+    volatile float *output;
+}
+PIDBinding;
+
 //*********************************************************************************
 // Prototypes
 //*********************************************************************************
@@ -175,6 +246,39 @@ extern void PIDInit(PIDControl *pid, float kp, float ki, float kd,
                     float sampleTimeSeconds, float minOutput, float maxOutput, 
                     PIDMode mode, PIDDirection controllerDirection);     	
 
+// 
+// PID Compute Constant Time
+// Description:
+//      PIDCompute for hard real time loops. It runs the same instructions 
+//      whatever the mode, the settings and the values, with no branch on 
+//      any of them, so its worst case is its every case. The results are 
+//      bit identical to PIDCompute's, except that the deadband is ignored. 
+//      Building with PID_REAL_TIME defined makes PIDCompute call it.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+// Returns:
+//      True if in AUTOMATIC. False if in MANUAL.
+// 
+inline bool 
+PIDComputeConstantTime(PIDControl *pid) 
+{
+    bool automatic = (pid->mode == AUTOMATIC);
+    
+    PIDCoreUpdateConstantTime(automatic, pid->weighted, pid->input, pid->setpoint, 
+                              &(pid->iTerm), &(pid->lastInput), &(pid->lastSetpoint), 
+                              &(pid->dTerm), &(pid->output), pid->alteredKp, 
+                              pid->alteredKi, pid->alteredKd, pid->alteredKt, 
+                              pid->setpointWeightB, pid->setpointWeightC, 
+                              pid->filterAlpha, pid->filterKd, pid->outMin, 
+                              pid->outMax, pid->antiWindup);
+    
+    // As PIDCompute leaves them, without branching on the mode
+    pid->outputChanged = pid->outputChanged | automatic;
+    pid->forceCompute = pid->forceCompute & !automatic;
+    
+    return automatic;
+}
+
 // 
 // PID Compute
 // Description:
@@ -186,7 +290,136 @@ extern void PIDInit(PIDControl *pid, float kp, float ki, float kd,
 // Returns:
 //      True if in AUTOMATIC. False if in MANUAL.
 //                     
-extern bool PIDCompute(PIDControl *pid); 
+inline bool 
+PIDCompute(PIDControl *pid) 
+{
+#ifdef PID_REAL_TIME
+    return PIDComputeConstantTime(pid);
+#else
+    if(pid->mode == MANUAL)
+    {
+        return false;
+    }
+    
+    // In deadband mode, leave the controller at rest while nothing moves
+    if(pid->deadband >= 0.0f && !(pid->forceCompute) && 
+       PIDCoreAtRest(pid->input, pid->lastInput, pid->setpoint, pid->lastSetpoint, 
+                     pid->iTerm, pid->output, pid->alteredKp, pid->alteredKi, 
+                     pid->weighted ? pid->setpointWeightB : 1.0f, 
+                     pid->weighted ? pid->filterAlpha * pid->dTerm : 0.0f, 
+                     pid->outMin, pid->outMax, pid->deadband))
+    {
+        pid->outputChanged = false;
+        return true;
+    }
+    
+    if(pid->weighted)
+    {
+        PIDCoreUpdateWeighted(pid->input, pid->setpoint, &(pid->iTerm), 
+                              &(pid->lastInput), &(pid->lastSetpoint), 
+                              &(pid->dTerm), &(pid->output), pid->alteredKp, 
+                              pid->alteredKi, pid->alteredKt, pid->setpointWeightB, 
+                              pid->setpointWeightC, pid->filterAlpha, pid->filterKd, 
+                              pid->outMin, pid->outMax, pid->antiWindup);
+    }
+    else
+    {
+        PIDCoreUpdate(pid->input, pid->setpoint, &(pid->iTerm), &(pid->lastInput), 
+                      &(pid->output), pid->alteredKp, pid->alteredKi, pid->alteredKd, 
+                      pid->alteredKt, pid->outMin, pid->outMax, pid->antiWindup);
+    }
+    
+    // Remember what the output was computed from for deadband mode
+    pid->lastSetpoint = pid->setpoint;
+    pid->outputChanged = true;
+    pid->forceCompute = false;
+    
+    return true;
+#endif
+}
+
+// 
+// PID Deadband Set
+// Description:
+//      Turns on deadband mode, in which PIDCompute leaves the controller at
+//      rest instead of updating it when nothing has moved: the input and the
+//      setpoint are within the deadband of their values at the last compute, 
+//      the error is within the deadband or the integrator is already held at
+//      the limit the error pushes it into, and the output carries no more 
+//      derivative than kp times the deadband would. PIDOutputChangedGet then 
+//      returns false. A deadband of 0 only rests when the update could not 
+//      change the output at all. Changing any other setting wakes the 
+//      controller up. 
+//      PIDComputeAt, PIDComputeBlock and PIDComputeBound ignore the deadband,
+//      except that PIDComputeBound calls PIDCompute.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+//      deadband - The tolerance, or a negative value to turn deadband mode 
+//                 off, which is the default.
+// Returns:
+//      Nothing.
+// 
+extern void PIDDeadbandSet(PIDControl *pid, float deadband); 
+
+// 
+// PID Compute At
+// Description:
+//      Same as PIDCompute, but for callers that cannot guarantee the call 
+//      interval. The time since the last computing call is taken from the 
+//      timestamp, and the I and D terms are scaled by its ratio to the sample
+//      time, so no PIDSampleTimeSet is needed when the interval drifts. A call
+//      less than half a sample time after the last one is treated as over 
+//      polling and computes nothing. A gap of more than PID_CORE_INTERVAL_MAX
+//      (4) sample times, such as after the caller stalled, is treated as a 
+//      restart: the derivative starts over from the current input, the 
+//      integrator is kept, and the call computes with the nominal sample 
+//      time, as the first call and the first call after switching to 
+//      AUTOMATIC do. Do not mix with PIDCompute on the same controller.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+//      timestampMicros - A monotonic clock in microseconds, such as micros()
+//                        on Arduino. It may wrap around.
+// Returns:
+//      True if a new output was computed. False if in MANUAL or called early.
+// 
+extern bool PIDComputeAt(PIDControl *pid, uint32_t timestampMicros); 
+
+// 
+// PID Compute Block
+// Description:
+//      Runs PIDCompute once for every sample of a block, as if PIDSetpointSet,
+//      PIDInputSet, PIDCompute and PIDOutputGet were called for each sample in
+//      turn. The integral term and the previous input are carried through the
+//      block, and the results are identical to the per sample calls. In MANUAL
+//      every output is the current output.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+//      inputs - Array of n input samples.
+//      setpoints - Array of n setpoints, or NULL to keep the current setpoint
+//                  for the whole block.
+//      outputs - Array that receives the n outputs.
+//      n - Number of samples in the block.
+// Returns:
+//      True if in AUTOMATIC. False if in MANUAL.
+// 
+extern bool PIDComputeBlock(PIDControl *pid, const float *inputs, 
+                            const float *setpoints, float *outputs, size_t n);
+
+// 
+// PID Compute Bound
+// Description:
+//      Same as PIDCompute, except that the input and setpoint are read straight
+//      from the bound locations and the output is written straight to the 
+//      bound location, so no copy in or out of the controller is needed. The 
+//      output location is only written in AUTOMATIC, so that in MANUAL it 
+//      keeps whatever value the user puts there.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+//      binding - The locations to read from and write to.
+// Returns:
+//      True if in AUTOMATIC. False if in MANUAL.
+// 
+extern bool PIDComputeBound(PIDControl *pid, const PIDBinding *binding);
 
 // 
 // PID Mode Set
@@ -295,6 +528,65 @@ extern void PIDControllerDirectionSet(PIDControl *pid,
 // 
 extern void PIDSampleTimeSet(PIDControl *pid, float sampleTimeSeconds);                                                       									  									  									   
 
+// 
+// PID Anti-Windup Set
+// Description:
+//      Chooses what keeps the integrator from winding up while the output is
+//      held at a limit. CLAMPING, the default, only bounds the integrator to
+//      the output limits. CONDITIONAL_INTEGRATION also stops integrating 
+//      while the output is beyond the limit the error pushes it into. 
+//      BACK_CALCULATION instead pulls the integrator back by kt times the 
+//      part of the output the limits cut off, every second; ki / kp is a 
+//      common choice of kt. All three keep the integrator within the output
+//      limits and compute without a branch. Checkpoints carry the strategy
+//      and kt.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+//      antiWindup - The strategy.
+//      kt - Positive tracking gain, only used by BACK_CALCULATION.
+// Returns:
+//      Nothing.
+// 
+extern void PIDAntiWindupSet(PIDControl *pid, PIDAntiWindup antiWindup, float kt);
+
+// 
+// PID Setpoint Weights Set
+// Description:
+//      Sets the 2-DOF setpoint weights. The proportional term then acts on b
+//      times the setpoint less the input and the derivative term on c times 
+//      the setpoint less the input, while the integral term keeps acting on
+//      the full error. b below 1 softens the response to setpoint steps 
+//      without slowing the response to disturbances. The defaults, b at 1 and
+//      c at 0, are the plain law with the derivative on the measurement. 
+//      Checkpoints carry the weights.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+//      b - Positive proportional setpoint weight.
+//      c - Positive derivative setpoint weight.
+// Returns:
+//      Nothing.
+// 
+extern void PIDSetpointWeightsSet(PIDControl *pid, float b, float c);
+
+// 
+// PID Derivative Filter Set
+// Description:
+//      Low pass filters the derivative term with a time constant of 1/n
+//      seconds, which limits its gain on measurement noise to kd times n. 
+//      Typical values of n put the time constant at a tenth to a twentieth 
+//      of kd / kp. The filter coefficients are worked out here and by 
+//      PIDTuningsSet and PIDSampleTimeSet, so PIDCompute has no division to
+//      do; PIDComputeAt has one per call for the real interval. 
+//      Checkpoints carry n and the filter state.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+//      n - Positive filter coefficient, or 0 to turn the filter off, which
+//          is the default.
+// Returns:
+//      Nothing.
+// 
+extern void PIDDerivativeFilterSet(PIDControl *pid, float n);
+
 // 
 // Basic Set and Get Functions for PID Parameters
 // 
@@ -404,6 +696,83 @@ PIDModeGet(PIDControl *pid) { return pid->mode; }
 inline PIDDirection 
 PIDDirectionGet(PIDControl *pid) { return pid->controllerDirection; }		
 
+// 
+// PID Anti-Windup Get
+// Description:
+//      Returns the anti-windup strategy the particular controller is set to.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+// Returns:
+//      CLAMPING, CONDITIONAL_INTEGRATION or BACK_CALCULATION.
+// 
+inline PIDAntiWindup 
+PIDAntiWindupGet(PIDControl *pid) { return pid->antiWindup; }
+
+// 
+// PID Tracking Gain Constant Get
+// Description:
+//      Returns the back-calculation tracking gain constant value the 
+//      particular controller is set to.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+// Returns:
+//      The tracking gain constant.
+// 
+inline float 
+PIDKtGet(PIDControl *pid) { return pid->dispKt; }
+
+// 
+// PID Setpoint Weight B Get
+// Description:
+//      Returns the proportional setpoint weight the particular controller is
+//      set to.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+// Returns:
+//      The proportional setpoint weight.
+// 
+inline float 
+PIDSetpointWeightBGet(PIDControl *pid) { return pid->setpointWeightB; }
+
+// 
+// PID Setpoint Weight C Get
+// Description:
+//      Returns the derivative setpoint weight the particular controller is
+//      set to.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+// Returns:
+//      The derivative setpoint weight.
+// 
+inline float 
+PIDSetpointWeightCGet(PIDControl *pid) { return pid->setpointWeightC; }
+
+// 
+// PID Derivative Filter Get
+// Description:
+//      Returns the derivative filter coefficient the particular controller is
+//      set to.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+// Returns:
+//      The filter coefficient, 0 when the filter is off.
+// 
+inline float 
+PIDDerivativeFilterGet(PIDControl *pid) { return pid->filterN; }
+
+// 
+// PID Output Changed Get
+// Description:
+//      Tells whether the last PIDCompute updated the controller or left it at 
+//      rest in deadband mode.
+// Parameters:
+//      pid - The address of a PIDControl instantiation.
+// Returns:
+//      False if the last PIDCompute left the output unchanged. True otherwise.
+// 
+inline bool 
+PIDOutputChangedGet(PIDControl *pid) { return pid->outputChanged; }
+
 
 // 
 // End of C Binding
@@ -0,0 +1,427 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: Fixed point (Q15 and Q31) versions of the PID controller for
+// targets without a floating point unit. The compute path only uses integer
+// multiplies, shifts and saturating adds. Gains are still given as floats and go
+// through the same scaling as PIDTuningsSet before being converted, so floating
+// point is only needed when the controller is configured.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include "pid_controller_fixed.h"
+#include "pid_core_fixed.h"
+
+//*********************************************************************************
+// Q15 Functions
+//*********************************************************************************
+void 
+PIDQ15Init(PIDControlQ15 *pid, float kp, float ki, float kd, 
+           float sampleTimeSeconds, int16_t minOutput, int16_t maxOutput, 
+           PIDMode mode, PIDDirection controllerDirection)
+{
+    pid->controllerDirection = controllerDirection;
+    pid->mode = mode;
+    pid->iTerm = 0;
+    pid->input = 0;
+    pid->lastInput = 0;
+    pid->output = 0;
+    pid->setpoint = 0;
+    
+    if(sampleTimeSeconds > 0.0f)
+    {
+        pid->sampleTime = sampleTimeSeconds;
+    }
+    else
+    {
+        // If the passed parameter was incorrect, set to 1 second
+        pid->sampleTime = 1.0f;
+    }
+    
+    PIDQ15OutputLimitsSet(pid, minOutput, maxOutput);
+    PIDQ15TuningsSet(pid, kp, ki, kd);
+}
+
+bool
+PIDQ15Compute(PIDControlQ15 *pid)
+{
+    int16_t error, dInput;
+    int32_t outMin, outMax, output;
+    
+    if(pid->mode == MANUAL)
+    {
+        return false;
+    }
+    
+    // The output limits in the Q31 format of the integrator
+    outMin = (int32_t)pid->outMin * 65536;
+    outMax = (int32_t)pid->outMax * 65536;
+    
+    // The classic PID error term
+    error = PIDCoreSat16((int32_t)pid->setpoint - (int32_t)pid->input);
+    
+    // Compute the integral term separately ahead of time
+    pid->iTerm = PIDCoreSatAdd32(pid->iTerm, 
+                                 PIDCoreMulQ15ToQ31(pid->alteredKi, pid->alteredKiFrac, error));
+    
+    // Constrain the integrator to make sure it does not exceed output bounds
+    pid->iTerm = PID_CORE_CONSTRAIN(pid->iTerm, outMin, outMax);
+    
+    // Take the "derivative on measurement" instead of "derivative on error"
+    dInput = PIDCoreSat16((int32_t)pid->input - (int32_t)pid->lastInput);
+    
+    // Run all the terms together to get the overall output
+    output = PIDCoreSatAdd32(PIDCoreMulQ15ToQ31(pid->alteredKp, pid->alteredKpFrac, error), 
+                             pid->iTerm);
+    output = PIDCoreSatSub32(output, 
+                             PIDCoreMulQ15ToQ31(pid->alteredKd, pid->alteredKdFrac, dInput));
+    
+    // Bound the output and bring it back to Q15
+    output = PID_CORE_CONSTRAIN(output, outMin, outMax);
+    pid->output = (int16_t)(output >> 16);
+    
+    // Make the current input the former input
+    pid->lastInput = pid->input;
+    
+    return true;
+}
+
+void 
+PIDQ15ModeSet(PIDControlQ15 *pid, PIDMode mode)
+{
+    int32_t outMin = (int32_t)pid->outMin * 65536;
+    int32_t outMax = (int32_t)pid->outMax * 65536;
+    
+    // If the mode changed from MANUAL to AUTOMATIC
+    if(pid->mode != mode && mode == AUTOMATIC)
+    {
+        // Initialize a few PID parameters to new values
+        pid->iTerm = (int32_t)pid->output * 65536;
+        pid->lastInput = pid->input;
+        
+        // Constrain the integrator to make sure it does not exceed output bounds
+        pid->iTerm = PID_CORE_CONSTRAIN(pid->iTerm, outMin, outMax);
+    }
+    
+    pid->mode = mode;
+}
+
+void 
+PIDQ15OutputLimitsSet(PIDControlQ15 *pid, int16_t min, int16_t max)
+{
+    // Check if the parameters are valid
+    if(min >= max)
+    {
+        return;
+    }
+    
+    // Save the parameters
+    pid->outMin = min;
+    pid->outMax = max;
+    
+    // If in automatic, apply the new constraints
+    if(pid->mode == AUTOMATIC)
+    {
+        pid->output = PID_CORE_CONSTRAIN(pid->output, min, max);
+        pid->iTerm  = PID_CORE_CONSTRAIN(pid->iTerm, (int32_t)min * 65536, (int32_t)max * 65536);
+    }
+}
+
+void 
+PIDQ15TuningsSet(PIDControlQ15 *pid, float kp, float ki, float kd)
+{
+    float alteredKp, alteredKi, alteredKd;
+    int32_t mantissa;
+    
+    // Check if the parameters are valid
+    if(kp < 0.0f || ki < 0.0f || kd < 0.0f)
+    {
+        return;
+    }
+    
+    // Save the parameters for displaying purposes
+    pid->dispKp = kp;
+    pid->dispKi = ki;
+    pid->dispKd = kd;
+    
+    // Alter the parameters for PID
+    alteredKp = kp;
+    alteredKi = ki * pid->sampleTime;
+    alteredKd = kd / pid->sampleTime;
+    
+    // Apply reverse direction to the altered values if necessary
+    if(pid->controllerDirection == REVERSE)
+    {
+        alteredKp = -(alteredKp);
+        alteredKi = -(alteredKi);
+        alteredKd = -(alteredKd);
+    }
+    
+    // Convert to fixed point
+    PIDCoreGainQuantize(alteredKp, INT16_MAX, &mantissa, &pid->alteredKpFrac);
+    pid->alteredKp = (int16_t)mantissa;
+    PIDCoreGainQuantize(alteredKi, INT16_MAX, &mantissa, &pid->alteredKiFrac);
+    pid->alteredKi = (int16_t)mantissa;
+    PIDCoreGainQuantize(alteredKd, INT16_MAX, &mantissa, &pid->alteredKdFrac);
+    pid->alteredKd = (int16_t)mantissa;
+}
+
+void 
+PIDQ15TuningKpSet(PIDControlQ15 *pid, float kp)
+{
+    PIDQ15TuningsSet(pid, kp, pid->dispKi, pid->dispKd);
+}
+
+void 
+PIDQ15TuningKiSet(PIDControlQ15 *pid, float ki)
+{
+    PIDQ15TuningsSet(pid, pid->dispKp, ki, pid->dispKd);
+}
+
+void 
+PIDQ15TuningKdSet(PIDControlQ15 *pid, float kd)
+{
+    PIDQ15TuningsSet(pid, pid->dispKp, pid->dispKi, kd);
+}
+
+void 
+PIDQ15ControllerDirectionSet(PIDControlQ15 *pid, PIDDirection controllerDirection)
+{
+    // If in automatic mode and the controller's sense of direction is reversed
+    if(pid->mode == AUTOMATIC && controllerDirection == REVERSE)
+    {
+        // Reverse sense of direction of PID gain constants
+        pid->alteredKp = -(pid->alteredKp);
+        pid->alteredKi = -(pid->alteredKi);
+        pid->alteredKd = -(pid->alteredKd);
+    }
+    
+    pid->controllerDirection = controllerDirection;
+}
+
+void 
+PIDQ15SampleTimeSet(PIDControlQ15 *pid, float sampleTimeSeconds)
+{
+    if(sampleTimeSeconds > 0.0f)
+    {
+        // Save the new sampling time and requantize the altered values from
+        // the display gains instead of scaling the mantissas, which would
+        // lose precision every time
+        pid->sampleTime = sampleTimeSeconds;
+        PIDQ15TuningsSet(pid, pid->dispKp, pid->dispKi, pid->dispKd);
+    }
+}
+
+//*********************************************************************************
+// Q31 Functions
+//*********************************************************************************
+void 
+PIDQ31Init(PIDControlQ31 *pid, float kp, float ki, float kd, 
+           float sampleTimeSeconds, int32_t minOutput, int32_t maxOutput, 
+           PIDMode mode, PIDDirection controllerDirection)
+{
+    pid->controllerDirection = controllerDirection;
+    pid->mode = mode;
+    pid->iTerm = 0;
+    pid->input = 0;
+    pid->lastInput = 0;
+    pid->output = 0;
+    pid->setpoint = 0;
+    
+    if(sampleTimeSeconds > 0.0f)
+    {
+        pid->sampleTime = sampleTimeSeconds;
+    }
+    else
+    {
+        // If the passed parameter was incorrect, set to 1 second
+        pid->sampleTime = 1.0f;
+    }
+    
+    PIDQ31OutputLimitsSet(pid, minOutput, maxOutput);
+    PIDQ31TuningsSet(pid, kp, ki, kd);
+}
+
+bool
+PIDQ31Compute(PIDControlQ31 *pid)
+{
+    int32_t error, dInput, output;
+    
+    if(pid->mode == MANUAL)
+    {
+        return false;
+    }
+    
+    // The classic PID error term
+    error = PIDCoreSatSub32(pid->setpoint, pid->input);
+    
+    // Compute the integral term separately ahead of time
+    pid->iTerm = PIDCoreSatAdd32(pid->iTerm, 
+                                 PIDCoreMulQ31(pid->alteredKi, pid->alteredKiFrac, error));
+    
+    // Constrain the integrator to make sure it does not exceed output bounds
+    pid->iTerm = PID_CORE_CONSTRAIN(pid->iTerm, pid->outMin, pid->outMax);
+    
+    // Take the "derivative on measurement" instead of "derivative on error"
+    dInput = PIDCoreSatSub32(pid->input, pid->lastInput);
+    
+    // Run all the terms together to get the overall output
+    output = PIDCoreSatAdd32(PIDCoreMulQ31(pid->alteredKp, pid->alteredKpFrac, error), 
+                             pid->iTerm);
+    output = PIDCoreSatSub32(output, 
+                             PIDCoreMulQ31(pid->alteredKd, pid->alteredKdFrac, dInput));
+    
+    // Bound the output
+    pid->output = PID_CORE_CONSTRAIN(output, pid->outMin, pid->outMax);
+    
+    // Make the current input the former input
+    pid->lastInput = pid->input;
+    
+    return true;
+}
+
+void 
+PIDQ31ModeSet(PIDControlQ31 *pid, PIDMode mode)
+{
+    // If the mode changed from MANUAL to AUTOMATIC
+    if(pid->mode != mode && mode == AUTOMATIC)
+    {
+        // Initialize a few PID parameters to new values
+        pid->iTerm = pid->output;
+        pid->lastInput = pid->input;
+        
+        // Constrain the integrator to make sure it does not exceed output bounds
+        pid->iTerm = PID_CORE_CONSTRAIN(pid->iTerm, pid->outMin, pid->outMax);
+    }
+    
+    pid->mode = mode;
+}
+
+void 
+PIDQ31OutputLimitsSet(PIDControlQ31 *pid, int32_t min, int32_t max)
+{
+    // Check if the parameters are valid
+    if(min >= max)
+    {
+        return;
+    }
+    
+    // Save the parameters
+    pid->outMin = min;
+    pid->outMax = max;
+    
+    // If in automatic, apply the new constraints
+    if(pid->mode == AUTOMATIC)
+    {
+        pid->output = PID_CORE_CONSTRAIN(pid->output, min, max);
+        pid->iTerm  = PID_CORE_CONSTRAIN(pid->iTerm,  min, max);
+    }
+}
+
+void 
+PIDQ31TuningsSet(PIDControlQ31 *pid, float kp, float ki, float kd)
+{
+    float alteredKp, alteredKi, alteredKd;
+    
+    // Check if the parameters are valid
+    if(kp < 0.0f || ki < 0.0f || kd < 0.0f)
+    {
+        return;
+    }
+    
+    // Save the parameters for displaying purposes
+    pid->dispKp = kp;
+    pid->dispKi = ki;
+    pid->dispKd = kd;
+    
+    // Alter the parameters for PID
+    alteredKp = kp;
+    alteredKi = ki * pid->sampleTime;
+    alteredKd = kd / pid->sampleTime;
+    
+    // Apply reverse direction to the altered values if necessary
+    if(pid->controllerDirection == REVERSE)
+    {
+        alteredKp = -(alteredKp);
+        alteredKi = -(alteredKi);
+        alteredKd = -(alteredKd);
+    }
+    
+    // Convert to fixed point
+    PIDCoreGainQuantize(alteredKp, INT32_MAX, &pid->alteredKp, &pid->alteredKpFrac);
+    PIDCoreGainQuantize(alteredKi, INT32_MAX, &pid->alteredKi, &pid->alteredKiFrac);
+    PIDCoreGainQuantize(alteredKd, INT32_MAX, &pid->alteredKd, &pid->alteredKdFrac);
+}
+
+void 
+PIDQ31TuningKpSet(PIDControlQ31 *pid, float kp)
+{
+    PIDQ31TuningsSet(pid, kp, pid->dispKi, pid->dispKd);
+}
+
+void 
+PIDQ31TuningKiSet(PIDControlQ31 *pid, float ki)
+{
+    PIDQ31TuningsSet(pid, pid->dispKp, ki, pid->dispKd);
+}
+
+void 
+PIDQ31TuningKdSet(PIDControlQ31 *pid, float kd)
+{
+    PIDQ31TuningsSet(pid, pid->dispKp, pid->dispKi, kd);
+}
+
+void 
+PIDQ31ControllerDirectionSet(PIDControlQ31 *pid, PIDDirection controllerDirection)
+{
+    // If in automatic mode and the controller's sense of direction is reversed
+    if(pid->mode == AUTOMATIC && controllerDirection == REVERSE)
+    {
+        // Reverse sense of direction of PID gain constants
+        pid->alteredKp = -(pid->alteredKp);
+        pid->alteredKi = -(pid->alteredKi);
+        pid->alteredKd = -(pid->alteredKd);
+    }
+    
+    pid->controllerDirection = controllerDirection;
+}
+
+void 
+PIDQ31SampleTimeSet(PIDControlQ31 *pid, float sampleTimeSeconds)
+{
+    if(sampleTimeSeconds > 0.0f)
+    {
+        // Save the new sampling time and requantize the altered values
+        pid->sampleTime = sampleTimeSeconds;
+        PIDQ31TuningsSet(pid, pid->dispKp, pid->dispKi, pid->dispKd);
+    }
+}
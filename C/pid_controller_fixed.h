@@ -0,0 +1,301 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: Fixed point (Q15 and Q31) versions of the PID controller for
+// targets without a floating point unit. The compute path only uses integer
+// multiplies, shifts and saturating adds. Gains are still given as floats and go
+// through the same scaling as PIDTuningsSet before being converted, so floating
+// point is only needed when the controller is configured.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+// 
+// Header Guard
+// 
+#ifndef PID_CONTROLLER_FIXED_H
+#define PID_CONTROLLER_FIXED_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+#include "pid_controller.h"
+
+// 
+// C Binding for C++ Compilers
+// 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// 
+// Number format
+// 
+// Q15 values are int16_t where 32767 is just under 1.0 and -32768 is -1.0. Q31
+// values are the same with int32_t. Inputs, setpoints, outputs and output
+// limits are all in the controller's Q format, so the application scales its
+// signals so that full scale maps to [-1, 1). Gains are dimensionless in those
+// units.
+// 
+// Overflow behavior
+// 
+// Every addition and subtraction on the compute path saturates instead of
+// wrapping.
+// - The error (setpoint - input) and the change in input saturate at [-1, 1).
+// - Each of the P, I and D terms saturates at [-1, 1) before they are added.
+// - The integral term is then constrained to the output limits, and so is the
+//   sum of the terms, exactly like the floating point controller.
+// Gains are stored as an integer mantissa and a number of fractional bits,
+// chosen per gain to keep as much precision as possible. The largest usable
+// altered gain (kd / sampleTime for the D term) is 32767 for Q15 and about
+// 2^31 for Q31; larger gains saturate at that value. Products are truncated
+// toward negative infinity.
+// 
+// The integral term of the Q15 controller is kept in Q31 so that small errors
+// keep accumulating.
+// 
+
+// 
+// Conversion between float and the Q formats. Only meant for configuration
+// and display, not for the compute path.
+// 
+#define PID_Q15_FROM_FLOAT(x)   ((int16_t)((x) >= 1.0f ? 32767 : ((x) <= -1.0f ? -32768 : (int32_t)((x) * 32768.0f))))
+#define PID_Q15_TO_FLOAT(x)     ((float)(x) / 32768.0f)
+#define PID_Q31_FROM_FLOAT(x)   ((int32_t)((x) >= 1.0f ? INT32_MAX : ((x) <= -1.0f ? INT32_MIN : (int32_t)((double)(x) * 2147483648.0))))
+#define PID_Q31_TO_FLOAT(x)     ((float)((double)(x) / 2147483648.0))
+
+typedef struct
+{
+    // 
+    // Input to the PID Controller (Q15)
+    // 
+    int16_t input;
+    
+    // 
+    // Previous input to the PID Controller (Q15)
+    // 
+    int16_t lastInput;
+    
+    // 
+    // Output of the PID Controller (Q15)
+    // 
+    int16_t output;
+    
+    // 
+    // The user chosen operating point (Q15)
+    // 
+    int16_t setpoint;
+    
+    // 
+    // The values that the output will be constrained to (Q15)
+    // 
+    int16_t outMin;
+    int16_t outMax;
+    
+    // 
+    // Gain constant values that the controller alters for its own use. Each
+    // gain is mantissa / 2^frac.
+    // 
+    int16_t alteredKp;
+    int16_t alteredKi;
+    int16_t alteredKd;
+    uint8_t alteredKpFrac;
+    uint8_t alteredKiFrac;
+    uint8_t alteredKdFrac;
+    
+    // 
+    // The Integral Term (Q31)
+    // 
+    int32_t iTerm;
+    
+    // 
+    // Gain constant values that were passed by the user
+    // These are for display purposes
+    // 
+    float dispKp;
+    float dispKi;
+    float dispKd;
+    
+    // 
+    // The interval (in seconds) on which the PID controller
+    // will be called
+    // 
+    float sampleTime;
+    
+    // 
+    // The sense of direction of the controller
+    // DIRECT:  A positive setpoint gives a positive output
+    // REVERSE: A positive setpoint gives a negative output
+    // 
+    PIDDirection controllerDirection;
+    
+    // 
+    // Tells how the controller should respond if the user has
+    // taken over manual control or not
+    // MANUAL:    PID controller is off.
+    // AUTOMATIC: PID controller is on.
+    // 
+    PIDMode mode;
+}
+PIDControlQ15;
+
+typedef struct
+{
+    // 
+    // Signals of the PID Controller (Q31). See PIDControlQ15.
+    // 
+    int32_t input;
+    int32_t lastInput;
+    int32_t output;
+    int32_t setpoint;
+    int32_t outMin;
+    int32_t outMax;
+    
+    // 
+    // The Integral Term (Q31)
+    // 
+    int32_t iTerm;
+    
+    // 
+    // Gain constant values that the controller alters for its own use. Each
+    // gain is mantissa / 2^frac.
+    // 
+    int32_t alteredKp;
+    int32_t alteredKi;
+    int32_t alteredKd;
+    uint8_t alteredKpFrac;
+    uint8_t alteredKiFrac;
+    uint8_t alteredKdFrac;
+    
+    // 
+    // Display gains, sample time, direction and mode. See PIDControlQ15.
+    // 
+    float dispKp;
+    float dispKi;
+    float dispKd;
+    float sampleTime;
+    PIDDirection controllerDirection;
+    PIDMode mode;
+}
+PIDControlQ31;
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+// 
+// Q15 and Q31 Functions
+// Description:
+//      These behave like the floating point functions of the same name in
+//      pid_controller.h (PIDQ15Init like PIDInit, PIDQ15Compute like
+//      PIDCompute and so on). Gains and the sample time are floats, while
+//      output limits, setpoints, inputs and outputs are in the controller's
+//      Q format.
+// 
+extern void PIDQ15Init(PIDControlQ15 *pid, float kp, float ki, float kd, 
+                       float sampleTimeSeconds, int16_t minOutput, 
+                       int16_t maxOutput, PIDMode mode, 
+                       PIDDirection controllerDirection);
+extern bool PIDQ15Compute(PIDControlQ15 *pid);
+extern void PIDQ15ModeSet(PIDControlQ15 *pid, PIDMode mode);
+extern void PIDQ15OutputLimitsSet(PIDControlQ15 *pid, int16_t min, int16_t max);
+extern void PIDQ15TuningsSet(PIDControlQ15 *pid, float kp, float ki, float kd);
+extern void PIDQ15TuningKpSet(PIDControlQ15 *pid, float kp);
+extern void PIDQ15TuningKiSet(PIDControlQ15 *pid, float ki);
+extern void PIDQ15TuningKdSet(PIDControlQ15 *pid, float kd);
+extern void PIDQ15ControllerDirectionSet(PIDControlQ15 *pid, 
+                                         PIDDirection controllerDirection);
+extern void PIDQ15SampleTimeSet(PIDControlQ15 *pid, float sampleTimeSeconds);
+
+extern void PIDQ31Init(PIDControlQ31 *pid, float kp, float ki, float kd, 
+                       float sampleTimeSeconds, int32_t minOutput, 
+                       int32_t maxOutput, PIDMode mode, 
+                       PIDDirection controllerDirection);
+extern bool PIDQ31Compute(PIDControlQ31 *pid);
+extern void PIDQ31ModeSet(PIDControlQ31 *pid, PIDMode mode);
+extern void PIDQ31OutputLimitsSet(PIDControlQ31 *pid, int32_t min, int32_t max);
+extern void PIDQ31TuningsSet(PIDControlQ31 *pid, float kp, float ki, float kd);
+extern void PIDQ31TuningKpSet(PIDControlQ31 *pid, float kp);
+extern void PIDQ31TuningKiSet(PIDControlQ31 *pid, float ki);
+extern void PIDQ31TuningKdSet(PIDControlQ31 *pid, float kd);
+extern void PIDQ31ControllerDirectionSet(PIDControlQ31 *pid, 
+                                         PIDDirection controllerDirection);
+extern void PIDQ31SampleTimeSet(PIDControlQ31 *pid, float sampleTimeSeconds);
+
+// 
+// Basic Set and Get Functions for PID Parameters
+// 
+static inline void 
+PIDQ15SetpointSet(PIDControlQ15 *pid, int16_t setpoint) { pid->setpoint = setpoint; }
+static inline void 
+PIDQ15InputSet(PIDControlQ15 *pid, int16_t input) { pid->input = input; }
+static inline int16_t 
+PIDQ15OutputGet(PIDControlQ15 *pid) { return pid->output; }
+static inline float 
+PIDQ15KpGet(PIDControlQ15 *pid) { return pid->dispKp; }
+static inline float 
+PIDQ15KiGet(PIDControlQ15 *pid) { return pid->dispKi; }
+static inline float 
+PIDQ15KdGet(PIDControlQ15 *pid) { return pid->dispKd; }
+static inline PIDMode 
+PIDQ15ModeGet(PIDControlQ15 *pid) { return pid->mode; }
+static inline PIDDirection 
+PIDQ15DirectionGet(PIDControlQ15 *pid) { return pid->controllerDirection; }
+
+static inline void 
+PIDQ31SetpointSet(PIDControlQ31 *pid, int32_t setpoint) { pid->setpoint = setpoint; }
+static inline void 
+PIDQ31InputSet(PIDControlQ31 *pid, int32_t input) { pid->input = input; }
+static inline int32_t 
+PIDQ31OutputGet(PIDControlQ31 *pid) { return pid->output; }
+static inline float 
+PIDQ31KpGet(PIDControlQ31 *pid) { return pid->dispKp; }
+static inline float 
+PIDQ31KiGet(PIDControlQ31 *pid) { return pid->dispKi; }
+static inline float 
+PIDQ31KdGet(PIDControlQ31 *pid) { return pid->dispKd; }
+static inline PIDMode 
+PIDQ31ModeGet(PIDControlQ31 *pid) { return pid->mode; }
+static inline PIDDirection 
+PIDQ31DirectionGet(PIDControlQ31 *pid) { return pid->controllerDirection; }
+
+// 
+// End of C Binding
+// 
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PID_CONTROLLER_FIXED_H
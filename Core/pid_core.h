@@ -0,0 +1,559 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: The update law shared by the C and C++ controllers and banks, as
+// force inlined functions in one header so that PIDCompute inlines at the call
+// site without link time optimization. Compiled as C the functions work on
+// float; compiled as C++ they are templates over the scalar type of the
+// controller.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+// 
+// Header Guard
+// 
+#ifndef PID_CORE_H
+#define PID_CORE_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// 
+// Every function below is written once against PIDScalar. C has a single
+// float version, which pid_controller.c provides the external definitions
+// of. C++ makes each one a template, so the C++ controller can use it for
+// each of its scalar types.
+// 
+#ifdef __cplusplus
+    #define PID_CORE_GENERIC    template <typename PIDScalar>
+#else
+    #define PID_CORE_GENERIC
+    typedef float PIDScalar;
+#endif
+
+// 
+// The unsigned integer type of the width of PIDScalar, for PIDCoreSelect
+// 
+#ifdef __cplusplus
+    template <int Size> struct PIDCoreBitsOf;
+    template <> struct PIDCoreBitsOf<2> { typedef uint16_t Type; };
+    template <> struct PIDCoreBitsOf<4> { typedef uint32_t Type; };
+    template <> struct PIDCoreBitsOf<8> { typedef uint64_t Type; };
+    #define PID_CORE_BITS       typename PIDCoreBitsOf<sizeof(PIDScalar)>::Type
+#else
+    #define PID_CORE_BITS       uint32_t
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define PID_CORE_INLINE     inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+    #define PID_CORE_INLINE     __forceinline
+#else
+    #define PID_CORE_INLINE     inline
+#endif
+
+// 
+// Compiled by nvcc, every function below is also a device function, so the 
+// CUDA backend runs this same law. Its kernels are built with --fmad=false, 
+// which keeps the multiplies and adds apart as -ffp-contract=off does here.
+// 
+#ifdef __CUDACC__
+    #define PID_CORE_HOST_DEVICE    __host__ __device__
+#else
+    #define PID_CORE_HOST_DEVICE
+#endif
+
+// 
+// Flags returned by PIDCoreUpdate
+// PID_CORE_CLAMPED:   The integrator was held at an output limit
+// PID_CORE_SATURATED: The output was held at an output limit
+// 
+#define PID_CORE_CLAMPED        0x1u
+#define PID_CORE_SATURATED      0x2u
+
+// 
+// Anti-windup strategies of PIDCoreUpdate, the values of PIDAntiWindup
+// PID_CORE_CLAMPING:         The integrator is bounded to the output limits
+// PID_CORE_CONDITIONAL:      The integrator also stops integrating while the
+//                            output is beyond the limit the error pushes into
+// PID_CORE_BACK_CALCULATION: The integrator is also pulled back by the part
+//                            of the output the limits cut off, times the 
+//                            tracking gain
+// 
+#define PID_CORE_CLAMPING           0
+#define PID_CORE_CONDITIONAL        1
+#define PID_CORE_BACK_CALCULATION   2
+
+// 
+// Longest interval, in sample times, that a timed compute scales its gains 
+// to. Past it the integrator would take the whole gap in one step and the 
+// derivative would all but vanish, so a longer gap is taken as a restart.
+// 
+#define PID_CORE_INTERVAL_MAX       4
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+// 
+// PID Core Constrain
+// Description:
+//      Bounds x to [lower, upper]. A NaN x is passed through.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE PIDScalar
+PIDCoreConstrain(PIDScalar x, PIDScalar lower, PIDScalar upper)
+{
+    return (x < lower) ? lower : ((x > upper) ? upper : x);
+}
+
+// 
+// PID Core Hold
+// Description:
+//      The part of an integral step that conditional integration lets 
+//      through: a step that would drive an output already beyond a limit 
+//      further past it is dropped. Written as min and max against zero and 
+//      two selects, so that it vectorizes without a branch per lane.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE PIDScalar
+PIDCoreHold(PIDScalar output, PIDScalar step, PIDScalar outMin, PIDScalar outMax)
+{
+    PIDScalar zero = (PIDScalar)0;
+    PIDScalar down = (step < zero) ? step : zero;
+    PIDScalar up = (step > zero) ? step : zero;
+    PIDScalar held = (output > outMax) ? down : step;
+    
+    return (output < outMin) ? up : held;
+}
+
+// 
+// PID Core Output
+// Description:
+//      The part of the update law after the proportional and derivative 
+//      terms are known: the integral term is accumulated and clamped to the
+//      output limits, the terms are summed and the output is bounded. Every 
+//      anti-windup strategy is computed and the result picked with selects, 
+//      so the law has no data dependent branch.
+// Parameters:
+//      proportional - The proportional term.
+//      derivative - The derivative term, subtracted from the output.
+//      step - The integral step of this compute.
+//      iTerm, output - The state, updated in place.
+//      kt - The altered tracking gain of back-calculation.
+//      outMin, outMax - The output limits.
+//      antiWindup - One of the PID_CORE_CLAMPING, PID_CORE_CONDITIONAL and 
+//          PID_CORE_BACK_CALCULATION strategies.
+// Returns:
+//      PID_CORE_CLAMPED and PID_CORE_SATURATED as they apply.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE unsigned
+PIDCoreOutput(PIDScalar proportional, PIDScalar derivative, PIDScalar step, 
+              PIDScalar *iTerm, PIDScalar *output, PIDScalar kt, 
+              PIDScalar outMin, PIDScalar outMax, int antiWindup)
+{
+    PIDScalar held, out, bounded, tracked;
+    bool conditional = (antiWindup == PID_CORE_CONDITIONAL);
+    unsigned flags = 0;
+    
+    // Conditional integration holds the integral term while the output is 
+    // pinned at a limit
+    held = PIDCoreHold(proportional + *iTerm - derivative, step, outMin, outMax);
+    flags |= (conditional && held != step) ? PID_CORE_CLAMPED : 0u;
+    *iTerm += conditional ? held : step;
+    
+    // Constrain the integrator to make sure it does not exceed output bounds
+    flags |= (*iTerm < outMin || *iTerm > outMax) ? PID_CORE_CLAMPED : 0u;
+    *iTerm = PIDCoreConstrain(*iTerm, outMin, outMax);
+    
+    // Run all the terms together to get the overall output
+    out = proportional + *iTerm - derivative;
+    
+    // Bound the output
+    flags |= (out < outMin || out > outMax) ? PID_CORE_SATURATED : 0u;
+    bounded = PIDCoreConstrain(out, outMin, outMax);
+    *output = bounded;
+    
+    // Back-calculation feeds the part of the output the limits cut off back
+    // into the integrator
+    tracked = PIDCoreConstrain(*iTerm + kt * (bounded - out), outMin, outMax);
+    *iTerm = (antiWindup == PID_CORE_BACK_CALCULATION) ? tracked : *iTerm;
+    
+    return flags;
+}
+
+// 
+// PID Core Update
+// Description:
+//      One step of the update law: the integral term is accumulated and
+//      clamped to the output limits, the derivative is taken on the
+//      measurement and the output is bounded. Timed computes pass ki, kd 
+//      and kt already scaled to the interval. The expression inlines into 
+//      the caller and so follows the caller's floating point contraction; 
+//      build with -ffp-contract=off on FMA targets to match the PIDBank 
+//      kernels bit for bit.
+// Parameters:
+//      input, setpoint - The process value and the target.
+//      iTerm, lastInput, output - The state, updated in place.
+//      kp, ki, kd - The altered gains.
+//      kt - The altered tracking gain of back-calculation.
+//      outMin, outMax - The output limits.
+//      antiWindup - One of the PID_CORE_CLAMPING, PID_CORE_CONDITIONAL and 
+//          PID_CORE_BACK_CALCULATION strategies.
+// Returns:
+//      PID_CORE_CLAMPED and PID_CORE_SATURATED as they apply. The flags cost
+//      nothing when the caller ignores them.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE unsigned
+PIDCoreUpdate(PIDScalar input, PIDScalar setpoint, PIDScalar *iTerm, 
+              PIDScalar *lastInput, PIDScalar *output, PIDScalar kp, PIDScalar ki, 
+              PIDScalar kd, PIDScalar kt, PIDScalar outMin, PIDScalar outMax, 
+              int antiWindup)
+{
+    PIDScalar error, dInput;
+    unsigned flags;
+    
+    // The classic PID error term
+    error = setpoint - input;
+    
+    // Take the "derivative on measurement" instead of "derivative on error"
+    dInput = input - *lastInput;
+    
+    // Compute the integral term separately ahead of time
+    flags = PIDCoreOutput(kp * error, kd * dInput, ki * error, iTerm, output, 
+                          kt, outMin, outMax, antiWindup);
+    
+    // Make the current input the former input
+    *lastInput = input;
+    
+    return flags;
+}
+
+// 
+// PID Core Update Weighted
+// Description:
+//      The update law with 2-DOF setpoint weighting and a first order filter
+//      on the derivative. The proportional term acts on b times the setpoint 
+//      less the input, the derivative term on c times the setpoint less the 
+//      input, and the derivative term is filterAlpha times its last value 
+//      plus filterKd times the change. The integral term still acts on the 
+//      full error, so the loop settles on the setpoint whatever b and c are.
+//      With filterAlpha 0 and filterKd the altered derivative gain the 
+//      filter is off. Every coefficient comes from PIDCoreFilter ahead of 
+//      time, so a compute is a few multiply-adds more than PIDCoreUpdate.
+// Parameters:
+//      input, setpoint - The process value and the target.
+//      iTerm, lastInput, lastSetpoint, dTerm, output - The state, updated in
+//          place. dTerm is the derivative term of the last compute.
+//      kp, ki - The altered proportional and integral gains.
+//      kt - The altered tracking gain of back-calculation.
+//      b, c - The setpoint weights of the proportional and derivative terms.
+//      filterAlpha, filterKd - The altered derivative filter coefficients.
+//      outMin, outMax - The output limits.
+//      antiWindup - One of the anti-windup strategies.
+// Returns:
+//      PID_CORE_CLAMPED and PID_CORE_SATURATED as they apply.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE unsigned
+PIDCoreUpdateWeighted(PIDScalar input, PIDScalar setpoint, PIDScalar *iTerm, 
+                      PIDScalar *lastInput, PIDScalar *lastSetpoint, 
+                      PIDScalar *dTerm, PIDScalar *output, PIDScalar kp, 
+                      PIDScalar ki, PIDScalar kt, PIDScalar b, PIDScalar c, 
+                      PIDScalar filterAlpha, PIDScalar filterKd, 
+                      PIDScalar outMin, PIDScalar outMax, int antiWindup)
+{
+    PIDScalar error, dInput;
+    unsigned flags;
+    
+    // The integral term acts on the full error
+    error = setpoint - input;
+    
+    // The change of the weighted derivative error, sign flipped so that with
+    // c at zero this is the change of the measurement
+    dInput = (input - *lastInput) - c * (setpoint - *lastSetpoint);
+    *dTerm = filterAlpha * (*dTerm) + filterKd * dInput;
+    
+    flags = PIDCoreOutput(kp * (b * setpoint - input), *dTerm, ki * error, iTerm, 
+                          output, kt, outMin, outMax, antiWindup);
+    
+    *lastInput = input;
+    *lastSetpoint = setpoint;
+    
+    return flags;
+}
+
+// 
+// PID Core Select
+// Description:
+//      a if condition holds, b otherwise, picked with a mask on the bits of
+//      the two values. Unlike the conditional operator this leaves the 
+//      compiler no branch to emit, whatever the optimizer makes of it.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE PIDScalar
+PIDCoreSelect(bool condition, PIDScalar a, PIDScalar b)
+{
+    PID_CORE_BITS bitsA, bitsB, mask, bits;
+    PIDScalar result;
+    
+    memcpy(&bitsA, &a, sizeof(a));
+    memcpy(&bitsB, &b, sizeof(b));
+    mask = (PID_CORE_BITS)((PID_CORE_BITS)0 - (PID_CORE_BITS)condition);
+    bits = (PID_CORE_BITS)((bitsA & mask) | (bitsB & (PID_CORE_BITS)~mask));
+    memcpy(&result, &bits, sizeof(result));
+    
+    return result;
+}
+
+// 
+// PID Core Constrain Select
+// Description:
+//      PIDCoreConstrain written with PIDCoreSelect. A NaN x is passed 
+//      through.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE PIDScalar
+PIDCoreConstrainSelect(PIDScalar x, PIDScalar lower, PIDScalar upper)
+{
+    return PIDCoreSelect(x < lower, lower, PIDCoreSelect(x > upper, upper, x));
+}
+
+// 
+// PID Core Update Constant Time
+// Description:
+//      PIDCoreUpdate and PIDCoreUpdateWeighted in one, with the mode folded
+//      in, for real time callers that budget the worst case execution time.
+//      The same instructions run whatever the mode, the law, the strategy 
+//      and the values: both laws and every anti-windup strategy are 
+//      computed, every choice is a PIDCoreSelect, the flags are combined 
+//      without short circuits and in MANUAL the new state is computed and 
+//      then discarded. The results are bit identical to those of the law 
+//      weighted picks. Only subnormal operands, on processors that handle 
+//      them in microcode, still take longer; flush them to zero for that.
+// Parameters:
+//      automatic - True to update the state, false to leave it as it is.
+//      weighted - True for PIDCoreUpdateWeighted, false for PIDCoreUpdate.
+//      kd - The altered derivative gain of the plain law.
+//      The rest as for PIDCoreUpdateWeighted.
+// Returns:
+//      PID_CORE_CLAMPED and PID_CORE_SATURATED as they apply. 0 in MANUAL.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE unsigned
+PIDCoreUpdateConstantTime(bool automatic, bool weighted, PIDScalar input, 
+                          PIDScalar setpoint, PIDScalar *iTerm, 
+                          PIDScalar *lastInput, PIDScalar *lastSetpoint, 
+                          PIDScalar *dTerm, PIDScalar *output, PIDScalar kp, 
+                          PIDScalar ki, PIDScalar kd, PIDScalar kt, 
+                          PIDScalar b, PIDScalar c, 
+                          PIDScalar filterAlpha, PIDScalar filterKd, 
+                          PIDScalar outMin, PIDScalar outMax, int antiWindup)
+{
+    PIDScalar zero = (PIDScalar)0;
+    PIDScalar error, dInput, weightedDInput, filtered, derivative, proportional;
+    PIDScalar step, raw;
+    PIDScalar held, integral, out, bounded, tracked;
+    bool conditional = (antiWindup == PID_CORE_CONDITIONAL);
+    bool back = (antiWindup == PID_CORE_BACK_CALCULATION);
+    bool clamped, saturated;
+    
+    // The terms of both laws
+    error = setpoint - input;
+    dInput = input - *lastInput;
+    weightedDInput = dInput - c * (setpoint - *lastSetpoint);
+    filtered = filterAlpha * (*dTerm) + filterKd * weightedDInput;
+    proportional = PIDCoreSelect(weighted, kp * (b * setpoint - input), kp * error);
+    derivative = PIDCoreSelect(weighted, filtered, kd * dInput);
+    step = ki * error;
+    
+    // PIDCoreHold
+    raw = proportional + *iTerm - derivative;
+    held = PIDCoreSelect(raw < outMin, PIDCoreSelect(step > zero, step, zero), 
+                         PIDCoreSelect(raw > outMax, 
+                                       PIDCoreSelect(step < zero, step, zero), step));
+    clamped = conditional & (held != step);
+    
+    // The rest of PIDCoreOutput
+    integral = *iTerm + PIDCoreSelect(conditional, held, step);
+    clamped = clamped | (integral < outMin) | (integral > outMax);
+    integral = PIDCoreConstrainSelect(integral, outMin, outMax);
+    out = proportional + integral - derivative;
+    saturated = (out < outMin) | (out > outMax);
+    bounded = PIDCoreConstrainSelect(out, outMin, outMax);
+    tracked = PIDCoreConstrainSelect(integral + kt * (bounded - out), outMin, outMax);
+    integral = PIDCoreSelect(back, tracked, integral);
+    
+    // Keep the new state only in AUTOMATIC
+    *iTerm = PIDCoreSelect(automatic, integral, *iTerm);
+    *output = PIDCoreSelect(automatic, bounded, *output);
+    *dTerm = PIDCoreSelect(automatic & weighted, filtered, *dTerm);
+    *lastInput = PIDCoreSelect(automatic, input, *lastInput);
+    *lastSetpoint = PIDCoreSelect(automatic, setpoint, *lastSetpoint);
+    
+    return ((unsigned)(automatic & clamped) * PID_CORE_CLAMPED) | 
+           ((unsigned)(automatic & saturated) * PID_CORE_SATURATED);
+}
+
+// 
+// PID Core At Rest
+// Description:
+//      Tells whether a controller in deadband mode can skip a compute: the
+//      input and the setpoint have moved by no more than the deadband since
+//      the last compute, either the error is inside the deadband or the 
+//      integrator is held at the limit it is being pushed into, and the 
+//      output is within kp times the deadband of the ones the last 
+//      compute's values give with the derivative of the next compute and 
+//      with none. The last test keeps a derivative kick, or a filtered 
+//      derivative still decaying, from being frozen into the output: the 
+//      derivative only decays from the one towards the other, so every 
+//      compute in between gives an output between the two. Written so that
+//      a NaN anywhere wakes the controller up.
+// Parameters:
+//      input, lastInput, setpoint, lastSetpoint, iTerm, output - The state.
+//      kp, ki - The altered proportional and integral gains.
+//      b - The setpoint weight of the proportional term, 1 on the plain law.
+//      derivative - The derivative term a compute would give with nothing
+//          moved: 0 on the plain law, filterAlpha times dTerm on the 
+//          weighted law.
+//      outMin, outMax - The output limits.
+//      deadband - The tolerance.
+// Returns:
+//      True if the compute can be skipped.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE bool
+PIDCoreAtRest(PIDScalar input, PIDScalar lastInput, PIDScalar setpoint, 
+              PIDScalar lastSetpoint, PIDScalar iTerm, PIDScalar output, 
+              PIDScalar kp, PIDScalar ki, PIDScalar b, PIDScalar derivative, 
+              PIDScalar outMin, PIDScalar outMax, PIDScalar deadband)
+{
+    PIDScalar zero = (PIDScalar)0;
+    PIDScalar error = setpoint - input;
+    PIDScalar step = ki * error;
+    PIDScalar inputMove = input - lastInput;
+    PIDScalar setpointMove = setpoint - lastSetpoint;
+    PIDScalar proportional, tolerance, next, settled;
+    
+    if(!((inputMove < zero ? -inputMove : inputMove) <= deadband) || 
+       !((setpointMove < zero ? -setpointMove : setpointMove) <= deadband))
+    {
+        return false;
+    }
+    
+    if(!((error < zero ? -error : error) <= deadband || 
+         (iTerm >= outMax && step >= zero) || 
+         (iTerm <= outMin && step <= zero)))
+    {
+        return false;
+    }
+    
+    // The same sums as PIDCoreOutput, so that with a deadband of 0 this is 
+    // exact
+    proportional = kp * (b * lastSetpoint - lastInput);
+    tolerance = (kp < zero ? -kp : kp) * deadband;
+    next = PIDCoreConstrain(proportional + iTerm - derivative, outMin, outMax) - output;
+    settled = PIDCoreConstrain(proportional + iTerm - zero, outMin, outMax) - output;
+    
+    return (next < zero ? -next : next) <= tolerance && 
+           (settled < zero ? -settled : settled) <= tolerance;
+}
+
+// 
+// PID Core Gains
+// Description:
+//      Turns the gains the user passed into the gains the update law uses:
+//      the integral gain times the sample time, the derivative gain over it,
+//      and all three negated for a reverse acting controller.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE void
+PIDCoreGains(PIDScalar kp, PIDScalar ki, PIDScalar kd, PIDScalar sampleTime, 
+             bool reverse, PIDScalar *alteredKp, PIDScalar *alteredKi, 
+             PIDScalar *alteredKd)
+{
+    *alteredKp = kp;
+    *alteredKi = ki * sampleTime;
+    *alteredKd = kd / sampleTime;
+    
+    if(reverse)
+    {
+        *alteredKp = -(*alteredKp);
+        *alteredKi = -(*alteredKi);
+        *alteredKd = -(*alteredKd);
+    }
+}
+
+// 
+// PID Core Gains Reverse
+// Description:
+//      Negates the altered gains to flip the sense of direction.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE void
+PIDCoreGainsReverse(PIDScalar *alteredKp, PIDScalar *alteredKi, PIDScalar *alteredKd)
+{
+    *alteredKp = -(*alteredKp);
+    *alteredKi = -(*alteredKi);
+    *alteredKd = -(*alteredKd);
+}
+
+// 
+// PID Core Sample Time Scale
+// Description:
+//      Rescales the altered integral and derivative gains for a sample time
+//      ratio times the old one.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE void
+PIDCoreSampleTimeScale(PIDScalar ratio, PIDScalar *alteredKi, PIDScalar *alteredKd)
+{
+    *alteredKi *= ratio;
+    *alteredKd /= ratio;
+}
+
+// 
+// PID Core Filter
+// Description:
+//      The derivative filter coefficients of PIDCoreUpdateWeighted, from the 
+//      altered derivative gain, the filter coefficient n and the sample time.
+//      The derivative is low pass filtered with a time constant of 1/n, 
+//      discretized with a backward difference; n at zero turns the filter 
+//      off. filterKd takes the sign of the altered derivative gain, so this
+//      is called again whenever that gain or the sample time changes.
+// 
+PID_CORE_GENERIC PID_CORE_HOST_DEVICE PID_CORE_INLINE void
+PIDCoreFilter(PIDScalar alteredKd, PIDScalar n, PIDScalar sampleTime, 
+              PIDScalar *filterAlpha, PIDScalar *filterKd)
+{
+    PIDScalar one = (PIDScalar)1;
+    
+    *filterAlpha = (n > (PIDScalar)0) ? one / (one + n * sampleTime) : (PIDScalar)0;
+    *filterKd = alteredKd * (one - *filterAlpha);
+}
+
+#endif  // PID_CORE_H
@@ -0,0 +1,193 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: The saturating Q15 and Q31 arithmetic shared by the C and C++
+// fixed point controllers, so both compute the same outputs bit for bit.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+// 
+// Header Guard
+// 
+#ifndef PID_CORE_FIXED_H
+#define PID_CORE_FIXED_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// 
+// Bounds x to [lower, upper] for any integer type
+// 
+#define PID_CORE_CONSTRAIN(x,lower,upper)   ((x)<(lower)?(lower):((x)>(upper)?(upper):(x)))
+
+// 
+// Largest number of fractional bits a gain mantissa may use
+// 
+#define PID_CORE_GAIN_FRAC_MAX              30
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+// 
+// PID Core Saturating Add and Subtract
+// Description:
+//      32 bit add and subtract that saturate instead of wrapping. They only 
+//      use 32 bit arithmetic so they stay cheap on 16 bit cores.
+// 
+static inline int32_t
+PIDCoreSatAdd32(int32_t a, int32_t b)
+{
+    int32_t sum = (int32_t)((uint32_t)a + (uint32_t)b);
+    
+    // Overflow happened if both operands have a different sign than the sum
+    if(((a ^ sum) & (b ^ sum)) < 0)
+    {
+        sum = (a < 0) ? INT32_MIN : INT32_MAX;
+    }
+    
+    return sum;
+}
+
+static inline int32_t
+PIDCoreSatSub32(int32_t a, int32_t b)
+{
+    int32_t difference = (int32_t)((uint32_t)a - (uint32_t)b);
+    
+    // Overflow happened if the operands differ in sign and the result does not
+    // have the sign of a
+    if(((a ^ b) & (a ^ difference)) < 0)
+    {
+        difference = (a < 0) ? INT32_MIN : INT32_MAX;
+    }
+    
+    return difference;
+}
+
+// 
+// PID Core Saturate
+// Description:
+//      Narrows a wider intermediate to the Q15 or Q31 range.
+// 
+static inline int16_t
+PIDCoreSat16(int32_t x)
+{
+    return (int16_t)PID_CORE_CONSTRAIN(x, INT16_MIN, INT16_MAX);
+}
+
+static inline int32_t
+PIDCoreSat32(int64_t x)
+{
+    return (int32_t)PID_CORE_CONSTRAIN(x, INT32_MIN, INT32_MAX);
+}
+
+// 
+// PID Core Multiply Q15 to Q31
+// Description:
+//      Multiplies a Q15 value by a gain given as mantissa / 2^frac, giving a 
+//      Q31 result. The 16x16 bit product is exact, so only the final shift by
+//      (16 - frac) can saturate.
+// 
+static inline int32_t
+PIDCoreMulQ15ToQ31(int16_t gain, uint8_t frac, int16_t x)
+{
+    int32_t product = (int32_t)gain * (int32_t)x;
+    int shift = 16 - (int)frac;
+    
+    if(shift < 0)
+    {
+        return product >> (-shift);
+    }
+    
+    if(product > (INT32_MAX >> shift))
+    {
+        return INT32_MAX;
+    }
+    if(product < (INT32_MIN >> shift))
+    {
+        return INT32_MIN;
+    }
+    
+    return (int32_t)((uint32_t)product << shift);
+}
+
+// 
+// PID Core Multiply Q31
+// Description:
+//      Multiplies a Q31 value by a gain given as mantissa / 2^frac.
+// 
+static inline int32_t
+PIDCoreMulQ31(int32_t gain, uint8_t frac, int32_t x)
+{
+    return PIDCoreSat32(((int64_t)gain * (int64_t)x) >> frac);
+}
+
+// 
+// PID Core Gain Quantize
+// Description:
+//      Splits an altered gain into a mantissa of at most maxMantissa in 
+//      magnitude and the largest number of fractional bits that still fits.
+//      Gains too large for the format saturate at maxMantissa with no 
+//      fractional bits. Only the setters call it, never the compute path.
+// 
+static inline void
+PIDCoreGainQuantize(float gain, int32_t maxMantissa, int32_t *mantissa, uint8_t *frac)
+{
+    float magnitude = (gain < 0.0f) ? -gain : gain;
+    float scaled = magnitude;
+    uint8_t bits = 0;
+    int32_t value;
+    
+    while(bits < PID_CORE_GAIN_FRAC_MAX && scaled * 2.0f <= (float)maxMantissa)
+    {
+        scaled *= 2.0f;
+        bits++;
+    }
+    
+    if(scaled >= (float)maxMantissa)
+    {
+        value = maxMantissa;
+    }
+    else
+    {
+        value = (int32_t)(scaled + 0.5f);
+        value = (value > maxMantissa) ? maxMantissa : value;
+    }
+    
+    *mantissa = (gain < 0.0f) ? -value : value;
+    *frac = bits;
+}
+
+#endif  // PID_CORE_FIXED_H
@@ -0,0 +1,896 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Micro-benchmark suite for PIDCompute and friends. Times a single
+// controller, the tuning setters and batches of controllers stepped as objects,
+// as C structs, as a PIDBank at every supported SIMD level and through a
+// PIDBankExecutor. Reports nanoseconds per update, updates per second per core
+// and cycles per update as a table and, with --json, as a JSON document.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pid_controller.h"
+#include "pid_bank.h"
+#include "pid_bank_simd.h"
+#include "pid_cluster.h"
+#include "pid_compact_bank.h"
+#include "pid_coroutine.h"
+#include "pid_executor.h"
+#include "pid_gain_schedule.h"
+#include "pid_simulator.h"
+#include "pid_telemetry.h"
+#include "pid_bench.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define PID_BENCH_HAS_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define PID_BENCH_HAS_TSC
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Every scenario performs roughly this many updates, and steps each controller
+// at least PID_BENCH_MIN_TICKS times, so small and large batches take a similar
+// amount of time.
+//
+#define PID_BENCH_UPDATES           20000000ull
+#define PID_BENCH_QUICK_UPDATES     2000000ull
+#define PID_BENCH_MIN_TICKS         3ull
+
+#define INPUT_PATTERN_SIZE          64
+
+//
+// One row of the report
+//
+struct
+BenchResult
+{
+    std::string name;
+    size_t controllers;
+    unsigned threads;
+    PIDBenchMeasurement measurement;
+};
+
+static const size_t batchSizes[] = { 1, 100, 10000, 1000000 };
+
+static float inputPattern[INPUT_PATTERN_SIZE];
+
+//
+// Every benchmark folds its results in here so nothing is optimized away
+//
+static volatile float benchSink;
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void Usage(const char *program);
+static void PatternInit();
+static void MeasureStart(PIDBenchMeasurement &result);
+static void MeasureStop(PIDBenchMeasurement &result, uint64_t updates);
+static uint64_t TicksFor(size_t controllers, uint64_t updates);
+static const char *SimdLevelName(PIDSimdLevel level);
+static bool SimdLevelSupported(PIDSimdLevel level);
+static void BenchSingleCompute(uint64_t iterations, PIDBenchMeasurement &result);
+static void BenchSingleComputeInstrumented(uint64_t iterations, PIDBenchMeasurement &result);
+static void BenchSingleComputeTelemetry(uint64_t iterations, PIDBenchMeasurement &result);
+static void BenchSingleComputeScheduled(uint64_t iterations, PIDBenchMeasurement &result);
+static void BenchTuningsSet(uint64_t iterations, PIDBenchMeasurement &result);
+static void BenchOutputLimitsSet(uint64_t iterations, PIDBenchMeasurement &result);
+static void BenchSampleTimeSet(uint64_t iterations, PIDBenchMeasurement &result);
+static void BenchObjects(size_t controllers, uint64_t ticks, PIDBenchMeasurement &result);
+static void BenchCoroutine(size_t controllers, uint64_t ticks, PIDBenchMeasurement &result);
+static void BankFill(PIDBank &bank, size_t controllers);
+static void BenchBank(size_t controllers, uint64_t ticks, bool windup, bool weighted,
+                      PIDBenchMeasurement &result);
+static void BenchCompact(size_t controllers, uint64_t ticks, PIDBenchMeasurement &result);
+static void BenchCluster(size_t controllers, uint64_t ticks, PIDBenchMeasurement &result);
+static void BenchSimulator(size_t controllers, uint64_t ticks, bool objects,
+                           PIDBenchMeasurement &result);
+static void BenchExecutor(size_t controllers, uint64_t ticks, unsigned threads,
+                          PIDBenchMeasurement &result);
+static void ReportTable(const std::vector<BenchResult> &results);
+static bool ReportJson(const std::vector<BenchResult> &results, const char *path);
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+extern "C" double
+PIDBenchSeconds(void)
+{
+    typedef std::chrono::steady_clock Clock;
+    
+    return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+extern "C" uint64_t
+PIDBenchCycles(void)
+{
+    #ifdef PID_BENCH_HAS_TSC
+        return __rdtsc();
+    #else
+        return 0;
+    #endif
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *jsonPath = nullptr;
+    const char *filter = nullptr;
+    uint64_t updates = PID_BENCH_UPDATES;
+    unsigned threads = std::thread::hardware_concurrency();
+    std::vector<BenchResult> results;
+    
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if(strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = (unsigned)strtoul(argv[++i], nullptr, 10);
+        }
+        else if(strcmp(argv[i], "--quick") == 0)
+        {
+            updates = PID_BENCH_QUICK_UPDATES;
+        }
+        else
+        {
+            Usage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+    
+    if(threads == 0)
+    {
+        threads = 1;
+    }
+    
+    PatternInit();
+    
+    PIDSimdLevel bestLevel = PIDSimdLevelGet();
+    
+    auto run = [&](const std::string &name, size_t controllers, unsigned runThreads,
+                   auto &&benchmark)
+    {
+        if(filter != nullptr && name.find(filter) == std::string::npos)
+        {
+            return;
+        }
+        
+        BenchResult result;
+        result.name = name;
+        result.controllers = controllers;
+        result.threads = runThreads;
+        benchmark(result.measurement);
+        benchSink = benchSink + result.measurement.sink;
+        results.push_back(result);
+        fprintf(stderr, "  %s\n", name.c_str());
+    };
+    
+    // 
+    // Single controller and setters
+    // 
+    run("cpp/single/PIDCompute", 1, 1, [&](PIDBenchMeasurement &m)
+        { BenchSingleCompute(updates, m); });
+    run("c/single/PIDCompute", 1, 1, [&](PIDBenchMeasurement &m)
+        { PIDBenchCSingleCompute(updates, &m); });
+    run("cpp/single/PIDCompute/instrumented", 1, 1, [&](PIDBenchMeasurement &m)
+        { BenchSingleComputeInstrumented(updates, m); });
+    run("cpp/single/PIDCompute/telemetry", 1, 1, [&](PIDBenchMeasurement &m)
+        { BenchSingleComputeTelemetry(updates, m); });
+    run("cpp/single/PIDCompute/scheduled", 1, 1, [&](PIDBenchMeasurement &m)
+        { BenchSingleComputeScheduled(updates, m); });
+    run("cpp/setter/PIDTuningsSet", 1, 1, [&](PIDBenchMeasurement &m)
+        { BenchTuningsSet(updates, m); });
+    run("c/setter/PIDTuningsSet", 1, 1, [&](PIDBenchMeasurement &m)
+        { PIDBenchCTuningsSet(updates, &m); });
+    run("cpp/setter/PIDOutputLimitsSet", 1, 1, [&](PIDBenchMeasurement &m)
+        { BenchOutputLimitsSet(updates, m); });
+    run("c/setter/PIDOutputLimitsSet", 1, 1, [&](PIDBenchMeasurement &m)
+        { PIDBenchCOutputLimitsSet(updates, &m); });
+    run("cpp/setter/PIDSampleTimeSet", 1, 1, [&](PIDBenchMeasurement &m)
+        { BenchSampleTimeSet(updates, m); });
+    run("c/setter/PIDSampleTimeSet", 1, 1, [&](PIDBenchMeasurement &m)
+        { PIDBenchCSampleTimeSet(updates, &m); });
+    
+    // 
+    // Batches
+    // 
+    for(size_t controllers : batchSizes)
+    {
+        uint64_t ticks = TicksFor(controllers, updates);
+        std::string suffix = "/" + std::to_string(controllers);
+        
+        run("cpp/objects" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+            { BenchObjects(controllers, ticks, m); });
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+        run("cpp/coroutine" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+            { BenchCoroutine(controllers, ticks, m); });
+#endif
+        run("c/structs" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+            {
+                if(!PIDBenchCBatch(controllers, ticks, &m))
+                {
+                    fprintf(stderr, "out of memory\n");
+                    exit(1);
+                }
+            });
+        
+        for(int level = PID_SIMD_SCALAR; level <= PID_SIMD_NEON; level++)
+        {
+            if(!SimdLevelSupported((PIDSimdLevel)level))
+            {
+                continue;
+            }
+            
+            run(std::string("cpp/bank/") + SimdLevelName((PIDSimdLevel)level) + suffix,
+                controllers, 1, [&](PIDBenchMeasurement &m)
+                {
+                    PIDSimdLevelSet((PIDSimdLevel)level);
+                    BenchBank(controllers, ticks, false, false, m);
+                });
+        }
+        PIDSimdLevelSet(bestLevel);
+        
+        // The same bank with all three anti-windup strategies mixed
+        run("cpp/bank/windup" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+            { BenchBank(controllers, ticks, true, false, m); });
+        
+        // And with setpoint weighting and a derivative filter on every
+        // controller
+        run("cpp/bank/weighted" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+            { BenchBank(controllers, ticks, false, true, m); });
+        
+        run("cpp/compact" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+            { BenchCompact(controllers, ticks, m); });
+        
+        if(controllers >= 2)
+        {
+            run("cpp/cluster" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+                { BenchCluster(controllers, ticks, m); });
+        }
+        
+        // Closed loops against first order plants, scored as they run
+        run("cpp/sim/bank" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+            { BenchSimulator(controllers, ticks, false, m); });
+        run("cpp/sim/objects" + suffix, controllers, 1, [&](PIDBenchMeasurement &m)
+            { BenchSimulator(controllers, ticks, true, m); });
+        
+        // Sharding a batch smaller than a shard only measures the wakeup
+        if(threads > 1 && controllers >= 10000)
+        {
+            run("cpp/executor" + suffix, controllers, threads, [&](PIDBenchMeasurement &m)
+                { BenchExecutor(controllers, ticks, threads, m); });
+        }
+    }
+    
+    ReportTable(results);
+    
+    if(jsonPath != nullptr && !ReportJson(results, jsonPath))
+    {
+        fprintf(stderr, "could not write %s\n", jsonPath);
+        return 1;
+    }
+    
+    return 0;
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+Usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [--quick] [--filter <substring>] [--threads <n>] [--json <file>]\n"
+            "  --quick    run %llu instead of %llu updates per scenario\n"
+            "  --filter   only run scenarios whose name contains the substring\n"
+            "  --threads  worker count for the executor scenarios\n"
+            "  --json     also write the results as JSON, - for stdout\n",
+            program, PID_BENCH_QUICK_UPDATES, PID_BENCH_UPDATES);
+}
+
+static void
+PatternInit()
+{
+    for(int i = 0; i < INPUT_PATTERN_SIZE; i++)
+    {
+        inputPattern[i] = (float)((i * 37) % INPUT_PATTERN_SIZE) / INPUT_PATTERN_SIZE - 0.5f;
+    }
+}
+
+static void
+MeasureStart(PIDBenchMeasurement &result)
+{
+    result.sink = 0.0f;
+    result.cycles = PIDBenchCycles();
+    result.seconds = PIDBenchSeconds();
+}
+
+static void
+MeasureStop(PIDBenchMeasurement &result, uint64_t updates)
+{
+    result.seconds = PIDBenchSeconds() - result.seconds;
+    result.cycles = PIDBenchCycles() - result.cycles;
+    result.updates = updates;
+}
+
+static uint64_t
+TicksFor(size_t controllers, uint64_t updates)
+{
+    uint64_t ticks = updates / controllers;
+    
+    return (ticks < PID_BENCH_MIN_TICKS) ? PID_BENCH_MIN_TICKS : ticks;
+}
+
+static const char *
+SimdLevelName(PIDSimdLevel level)
+{
+    switch(level)
+    {
+        case PID_SIMD_SSE2:
+            return "sse2";
+        case PID_SIMD_AVX2:
+            return "avx2";
+        case PID_SIMD_AVX512:
+            return "avx512";
+        case PID_SIMD_NEON:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+
+static bool
+SimdLevelSupported(PIDSimdLevel level)
+{
+    PIDSimdLevel current = PIDSimdLevelGet();
+    bool supported = PIDSimdLevelSet(level);
+    
+    PIDSimdLevelSet(current);
+    
+    return supported;
+}
+
+static inline PIDControl
+BenchController()
+{
+    PIDControl pid(1.2f, 0.8f, 0.05f, 0.001f, -1.0f, 1.0f, AUTOMATIC, DIRECT);
+    
+    pid.PIDSetpointSet(0.25f);
+    
+    return pid;
+}
+
+static void
+BenchSingleCompute(uint64_t iterations, PIDBenchMeasurement &result)
+{
+    PIDControl pid = BenchController();
+    
+    MeasureStart(result);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        pid.PIDInputSet(inputPattern[i % INPUT_PATTERN_SIZE]);
+        pid.PIDCompute();
+        result.sink += pid.PIDOutputGet();
+    }
+    MeasureStop(result, iterations);
+}
+
+static void
+BenchSingleComputeInstrumented(uint64_t iterations, PIDBenchMeasurement &result)
+{
+    BasicPIDControl<float, PIDInstrumentationCounters>
+        pid(1.2f, 0.8f, 0.05f, 0.001f, -1.0f, 1.0f, AUTOMATIC, DIRECT);
+    
+    pid.PIDSetpointSet(0.25f);
+    
+    MeasureStart(result);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        pid.PIDInputSet(inputPattern[i % INPUT_PATTERN_SIZE]);
+        pid.PIDCompute();
+        result.sink += pid.PIDOutputGet();
+    }
+    MeasureStop(result, iterations);
+}
+
+//
+// Every compute is sampled. The ring is drained on the same thread every
+// quarter ring, so the figure includes the consumer's share of the work.
+//
+static void
+BenchSingleComputeTelemetry(uint64_t iterations, PIDBenchMeasurement &result)
+{
+    PIDControl pid = BenchController();
+    PIDTelemetryRing ring(4096);
+    PIDTelemetryTap tap(ring);
+    
+    MeasureStart(result);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        pid.PIDInputSet(inputPattern[i % INPUT_PATTERN_SIZE]);
+        pid.PIDCompute();
+        tap.Sample(pid);
+        if((i & 1023) == 1023)
+        {
+            ring.DrainTo([&result](const PIDTelemetryRecord *records, size_t count)
+                         { result.sink += records[count - 1].output; });
+        }
+        result.sink += pid.PIDOutputGet();
+    }
+    MeasureStop(result, iterations);
+}
+
+//
+// The gains come from a 16 breakpoint schedule keyed on the input
+//
+static void
+BenchSingleComputeScheduled(uint64_t iterations, PIDBenchMeasurement &result)
+{
+    PIDControl pid = BenchController();
+    PIDGainSchedule schedule;
+    PIDGainBreakpoint points[16];
+    
+    for(int i = 0; i < 16; i++)
+    {
+        points[i].key = -1.0f + i * (2.0f / 15.0f);
+        points[i].kp = 1.2f + 0.05f * i;
+        points[i].ki = 0.8f - 0.02f * i;
+        points[i].kd = 0.05f;
+    }
+    schedule.Build(points, 16, 0.001f, DIRECT);
+    
+    MeasureStart(result);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        pid.PIDInputSet(inputPattern[i % INPUT_PATTERN_SIZE]);
+        schedule.Apply(pid);
+        pid.PIDCompute();
+        result.sink += pid.PIDOutputGet();
+    }
+    MeasureStop(result, iterations);
+}
+
+static void
+BenchTuningsSet(uint64_t iterations, PIDBenchMeasurement &result)
+{
+    PIDControl pid = BenchController();
+    
+    MeasureStart(result);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        pid.PIDTuningsSet(1.0f + inputPattern[i % INPUT_PATTERN_SIZE], 0.8f, 0.05f);
+        result.sink += pid.PIDKpGet();
+    }
+    MeasureStop(result, iterations);
+}
+
+static void
+BenchOutputLimitsSet(uint64_t iterations, PIDBenchMeasurement &result)
+{
+    PIDControl pid = BenchController();
+    
+    MeasureStart(result);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        pid.PIDOutputLimitsSet(-1.0f, 1.0f + inputPattern[i % INPUT_PATTERN_SIZE]);
+        result.sink += pid.PIDOutputGet();
+    }
+    MeasureStop(result, iterations);
+}
+
+static void
+BenchSampleTimeSet(uint64_t iterations, PIDBenchMeasurement &result)
+{
+    PIDControl pid = BenchController();
+    
+    MeasureStart(result);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        // Alternate between two sample times so the gains stay bounded
+        pid.PIDSampleTimeSet((i & 1) ? 0.001f : 0.002f);
+        result.sink += pid.PIDKiGet();
+    }
+    MeasureStop(result, iterations);
+}
+
+static void
+BenchObjects(size_t controllers, uint64_t ticks, PIDBenchMeasurement &result)
+{
+    std::vector<PIDControl> pids(controllers, BenchController());
+    
+    MeasureStart(result);
+    for(uint64_t tick = 0; tick < ticks; tick++)
+    {
+        float input = inputPattern[tick % INPUT_PATTERN_SIZE];
+        
+        for(PIDControl &pid : pids)
+        {
+            pid.PIDInputSet(input);
+            pid.PIDCompute();
+        }
+        result.sink += pids[tick % controllers].PIDOutputGet();
+    }
+    MeasureStop(result, ticks * controllers);
+}
+
+//
+// The worst case for the coroutine driver: one loop per controller, all
+// resumed by a single PIDTickSource
+//
+static void
+BenchCoroutine(size_t controllers, uint64_t ticks, PIDBenchMeasurement &result)
+{
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+    std::vector<PIDControl> pids(controllers, BenchController());
+    std::vector<PIDTask> loops;
+    PIDTickSource source;
+    float input = 0.0f;
+    
+    loops.reserve(controllers);
+    for(PIDControl &pid : pids)
+    {
+        loops.push_back(PIDTickLoop(source, [&pid, &input](uint64_t)
+                                    {
+                                        pid.PIDInputSet(input);
+                                        pid.PIDCompute();
+                                        return true;
+                                    }));
+    }
+    
+    MeasureStart(result);
+    for(uint64_t tick = 0; tick < ticks; tick++)
+    {
+        input = inputPattern[tick % INPUT_PATTERN_SIZE];
+        source.Tick();
+        result.sink += pids[tick % controllers].PIDOutputGet();
+    }
+    MeasureStop(result, ticks * controllers);
+#else
+    (void)controllers;
+    (void)ticks;
+    (void)result;
+#endif
+}
+
+static void
+BankFill(PIDBank &bank, size_t controllers)
+{
+    for(size_t i = 0; i < controllers; i++)
+    {
+        bank.PIDAdd(1.2f, 0.8f, 0.05f, 0.001f, -1.0f, 1.0f, AUTOMATIC, DIRECT);
+        bank.PIDSetpointSet(i, 0.25f);
+    }
+}
+
+static void
+BenchBank(size_t controllers, uint64_t ticks, bool windup, bool weighted,
+          PIDBenchMeasurement &result)
+{
+    PIDBank bank(controllers);
+    
+    BankFill(bank, controllers);
+    
+    for(size_t i = 0; i < controllers && windup; i++)
+    {
+        bank.PIDAntiWindupSet(i, (PIDAntiWindup)(i % 3), 0.5f);
+    }
+    
+    for(size_t i = 0; i < controllers && weighted; i++)
+    {
+        bank.PIDSetpointWeightsSet(i, 0.7f, 0.0f);
+        bank.PIDDerivativeFilterSet(i, 20.0f);
+    }
+    
+    float *input = bank.InputData();
+    
+    MeasureStart(result);
+    for(uint64_t tick = 0; tick < ticks; tick++)
+    {
+        float value = inputPattern[tick % INPUT_PATTERN_SIZE];
+        
+        for(size_t i = 0; i < controllers; i++)
+        {
+            input[i] = value;
+        }
+        bank.ComputeAll();
+        result.sink += bank.PIDOutputGet(tick % controllers);
+    }
+    MeasureStop(result, ticks * controllers);
+}
+
+static void
+BenchCompact(size_t controllers, uint64_t ticks, PIDBenchMeasurement &result)
+{
+    PIDCompactBank bank(controllers);
+    
+    for(size_t i = 0; i < controllers; i++)
+    {
+        bank.PIDAdd(1.2f, 0.8f, 0.05f, 0.001f, -1.0f, 1.0f, AUTOMATIC, DIRECT);
+        bank.PIDSetpointSet(i, 0.25f);
+    }
+    
+    float *input = bank.InputData();
+    
+    MeasureStart(result);
+    for(uint64_t tick = 0; tick < ticks; tick++)
+    {
+        float value = inputPattern[tick % INPUT_PATTERN_SIZE];
+        
+        for(size_t i = 0; i < controllers; i++)
+        {
+            input[i] = value;
+        }
+        bank.ComputeAll();
+        result.sink += bank.PIDOutputGet(tick % controllers);
+    }
+    MeasureStop(result, ticks * controllers);
+}
+
+//
+// Cascades of an outer loop on one node and an inner loop on another, both
+// nodes run on this thread and the messages handed straight across, so what
+// is timed is the packing and unpacking on top of the computes
+//
+static void
+BenchCluster(size_t controllers, uint64_t ticks, PIDBenchMeasurement &result)
+{
+    size_t pairs = controllers / 2;
+    PIDClusterPlan plan(2 * pairs);
+    PIDBank banks[2];
+    
+    for(size_t pair = 0; pair < pairs; pair++)
+    {
+        plan.Connect(2 * pair, 2 * pair + 1);
+        plan.Assign(2 * pair + 1, 1);
+    }
+    
+    BankFill(banks[0], pairs);
+    BankFill(banks[1], pairs);
+    
+    PIDClusterNode outer(plan, 0, banks[0]);
+    PIDClusterNode inner(plan, 1, banks[1]);
+    
+    outer.Build();
+    inner.Build();
+    
+    float *outerInput = banks[0].InputData();
+    float *innerInput = banks[1].InputData();
+    
+    MeasureStart(result);
+    for(uint64_t tick = 0; tick < ticks; tick++)
+    {
+        float value = inputPattern[tick % INPUT_PATTERN_SIZE];
+        
+        for(size_t i = 0; i < pairs; i++)
+        {
+            outerInput[i] = value;
+            innerInput[i] = value;
+        }
+        outer.Tick();
+        inner.Tick();
+        
+        const PIDClusterMessage &message = outer.MessageGet(0);
+        
+        inner.Receive(message.data, message.bytes);
+        result.sink += banks[1].PIDOutputGet(tick % pairs);
+    }
+    MeasureStop(result, ticks * 2 * pairs);
+}
+
+static void
+BenchExecutor(size_t controllers, uint64_t ticks, unsigned threads,
+              PIDBenchMeasurement &result)
+{
+    PIDBank bank(controllers);
+    
+    BankFill(bank, controllers);
+    
+    PIDBankExecutor executor(bank, threads);
+    float *input = bank.InputData();
+    
+    MeasureStart(result);
+    for(uint64_t tick = 0; tick < ticks; tick++)
+    {
+        float value = inputPattern[tick % INPUT_PATTERN_SIZE];
+        
+        for(size_t i = 0; i < controllers; i++)
+        {
+            input[i] = value;
+        }
+        executor.Tick();
+        result.sink += executor.OutputRead(tick % controllers);
+    }
+    MeasureStop(result, ticks * controllers);
+}
+
+static double
+NsPerUpdate(const BenchResult &result)
+{
+    return result.measurement.seconds * 1e9 / (double)result.measurement.updates;
+}
+
+static double
+UpdatesPerSecondPerCore(const BenchResult &result)
+{
+    return (double)result.measurement.updates / result.measurement.seconds /
+           (double)result.threads;
+}
+
+static double
+CyclesPerUpdate(const BenchResult &result)
+{
+    return (double)result.measurement.cycles / (double)result.measurement.updates;
+}
+
+//
+// A PI loop per plant with the plant, the compute and the metrics all timed,
+// so the difference to cpp/bank is what the simulator costs
+//
+static void
+BenchSimulator(size_t controllers, uint64_t ticks, bool objects, PIDBenchMeasurement &result)
+{
+    PIDPlantBank plants(0.001f, controllers);
+    PIDSimulator simulator(plants);
+    std::vector<PIDControl> pids;
+    PIDBank bank(objects ? 0 : controllers);
+    
+    for(size_t i = 0; i < controllers; i++)
+    {
+        plants.AddFirstOrder(1.5f, 0.05f + 0.01f * (float)(i % 8));
+        
+        if(objects)
+        {
+            pids.emplace_back(0.6f, 15.0f, 0.0f, 0.001f, -10.0f, 10.0f, AUTOMATIC, DIRECT);
+            pids.back().PIDSetpointSet(1.0f);
+        }
+        else
+        {
+            bank.PIDAdd(0.6f, 15.0f, 0.0f, 0.001f, -10.0f, 10.0f, AUTOMATIC, DIRECT);
+            bank.PIDSetpointSet(i, 1.0f);
+        }
+    }
+    
+    MeasureStart(result);
+    if(objects)
+    {
+        simulator.Run(pids.data(), pids.size(), ticks);
+    }
+    else
+    {
+        simulator.Run(bank, ticks);
+    }
+    MeasureStop(result, ticks * controllers);
+    
+    result.sink += simulator.ReportGet().meanIae;
+}
+
+static void
+ReportTable(const std::vector<BenchResult> &results)
+{
+    printf("%-36s %10s %8s %12s %16s %14s\n", "benchmark", "controllers", "threads",
+           "ns/update", "updates/s/core", "cycles/update");
+    
+    for(const BenchResult &result : results)
+    {
+        printf("%-36s %10zu %8u %12.3f %16.4g ", result.name.c_str(),
+               result.controllers, result.threads, NsPerUpdate(result),
+               UpdatesPerSecondPerCore(result));
+        #ifdef PID_BENCH_HAS_TSC
+            printf("%14.3f\n", CyclesPerUpdate(result));
+        #else
+            printf("%14s\n", "-");
+        #endif
+    }
+}
+
+static const char *
+CompilerName()
+{
+    #if defined(__clang__)
+        return "clang " __clang_version__;
+    #elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+    #elif defined(_MSC_VER)
+        return "msvc";
+    #else
+        return "unknown";
+    #endif
+}
+
+static bool
+ReportJson(const std::vector<BenchResult> &results, const char *path)
+{
+    bool toStdout = (strcmp(path, "-") == 0);
+    FILE *file = toStdout ? stdout : fopen(path, "w");
+    
+    if(file == nullptr)
+    {
+        return false;
+    }
+    
+    fprintf(file, "{\n");
+    fprintf(file, "  \"compiler\": \"%s\",\n", CompilerName());
+    fprintf(file, "  \"simd_level\": \"%s\",\n", SimdLevelName(PIDSimdLevelGet()));
+    fprintf(file, "  \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+    #ifdef PID_BENCH_HAS_TSC
+        fprintf(file, "  \"cycle_counter\": \"tsc\",\n");
+    #else
+        fprintf(file, "  \"cycle_counter\": null,\n");
+    #endif
+    fprintf(file, "  \"results\": [\n");
+    
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &result = results[i];
+        
+        fprintf(file, "    {\"name\": \"%s\", \"controllers\": %zu, \"threads\": %u, "
+                "\"updates\": %llu, \"seconds\": %.9f, \"ns_per_update\": %.4f, "
+                "\"updates_per_second_per_core\": %.1f, ",
+                result.name.c_str(), result.controllers, result.threads,
+                (unsigned long long)result.measurement.updates, result.measurement.seconds,
+                NsPerUpdate(result), UpdatesPerSecondPerCore(result));
+        #ifdef PID_BENCH_HAS_TSC
+            fprintf(file, "\"cycles_per_update\": %.4f}", CyclesPerUpdate(result));
+        #else
+            fprintf(file, "\"cycles_per_update\": null}");
+        #endif
+        fprintf(file, "%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+    
+    fprintf(file, "  ]\n}\n");
+    
+    return toStdout ? (fflush(file) == 0) : (fclose(file) == 0);
+}
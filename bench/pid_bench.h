@@ -0,0 +1,121 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: Shared declarations for the PID micro-benchmark suite. The C
+// benchmarks are compiled as C against the C library and called from the C++
+// driver through these declarations.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+// 
+// Header Guard
+// 
+#ifndef PID_BENCH_H
+#define PID_BENCH_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// 
+// C Binding for C++ Compilers
+// 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// 
+// Raw measurement of one benchmark run
+// 
+typedef struct
+{
+    // 
+    // Number of controller updates performed
+    // 
+    uint64_t updates;
+    
+    // 
+    // Wall clock time and cycle counter ticks the updates took
+    // 
+    double seconds;
+    uint64_t cycles;
+    
+    // 
+    // Folded results of all updates so the compiler cannot drop them
+    // 
+    float sink;
+}
+PIDBenchMeasurement;
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+// 
+// Timing primitives, implemented by the driver
+// 
+extern double PIDBenchSeconds(void);
+extern uint64_t PIDBenchCycles(void);
+
+// 
+// C Benchmarks
+// Description:
+//      PIDBenchCSingleCompute steps one PIDControl with PIDInputSet and 
+//      PIDCompute. PIDBenchCTuningsSet, PIDBenchCOutputLimitsSet and 
+//      PIDBenchCSampleTimeSet time the setters. PIDBenchCBatch steps an array 
+//      of controllers for a number of ticks.
+// Parameters:
+//      iterations - Number of calls to time.
+//      controllers - Number of controllers in the batch.
+//      ticks - Number of times every controller of the batch is stepped.
+//      result - Receives the measurement.
+// Returns:
+//      Nothing. PIDBenchCBatch returns zero if it could not allocate the batch.
+// 
+extern void PIDBenchCSingleCompute(uint64_t iterations, PIDBenchMeasurement *result);
+extern void PIDBenchCTuningsSet(uint64_t iterations, PIDBenchMeasurement *result);
+extern void PIDBenchCOutputLimitsSet(uint64_t iterations, PIDBenchMeasurement *result);
+extern void PIDBenchCSampleTimeSet(uint64_t iterations, PIDBenchMeasurement *result);
+extern int PIDBenchCBatch(size_t controllers, uint64_t ticks, PIDBenchMeasurement *result);
+
+// 
+// End of C Binding
+// 
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PID_BENCH_H
@@ -0,0 +1,205 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: C side of the PID micro-benchmark suite. Times PIDCompute and the
+// setters of the C library.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdlib.h>
+#include "pid_controller.h"
+#include "pid_bench.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// 
+// Inputs cycle through this many values so the controllers see a moving signal
+// without a division or a random number in the timed loop
+// 
+#define INPUT_PATTERN_SIZE      64
+
+static float inputPattern[INPUT_PATTERN_SIZE];
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+PatternInit(void)
+{
+    int i;
+    
+    for(i = 0; i < INPUT_PATTERN_SIZE; i++)
+    {
+        inputPattern[i] = (float)((i * 37) % INPUT_PATTERN_SIZE) / INPUT_PATTERN_SIZE - 0.5f;
+    }
+}
+
+static void
+ControllerInit(PIDControl *pid)
+{
+    PIDInit(pid, 1.2f, 0.8f, 0.05f, 0.001f, -1.0f, 1.0f, AUTOMATIC, DIRECT);
+    PIDSetpointSet(pid, 0.25f);
+}
+
+static void
+MeasureStart(PIDBenchMeasurement *result)
+{
+    result->sink = 0.0f;
+    result->cycles = PIDBenchCycles();
+    result->seconds = PIDBenchSeconds();
+}
+
+static void
+MeasureStop(PIDBenchMeasurement *result, uint64_t updates)
+{
+    result->seconds = PIDBenchSeconds() - result->seconds;
+    result->cycles = PIDBenchCycles() - result->cycles;
+    result->updates = updates;
+}
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+void
+PIDBenchCSingleCompute(uint64_t iterations, PIDBenchMeasurement *result)
+{
+    PIDControl pid;
+    uint64_t i;
+    
+    PatternInit();
+    ControllerInit(&pid);
+    
+    MeasureStart(result);
+    for(i = 0; i < iterations; i++)
+    {
+        PIDInputSet(&pid, inputPattern[i % INPUT_PATTERN_SIZE]);
+        PIDCompute(&pid);
+        result->sink += PIDOutputGet(&pid);
+    }
+    MeasureStop(result, iterations);
+}
+
+void
+PIDBenchCTuningsSet(uint64_t iterations, PIDBenchMeasurement *result)
+{
+    PIDControl pid;
+    uint64_t i;
+    
+    PatternInit();
+    ControllerInit(&pid);
+    
+    MeasureStart(result);
+    for(i = 0; i < iterations; i++)
+    {
+        PIDTuningsSet(&pid, 1.0f + inputPattern[i % INPUT_PATTERN_SIZE], 0.8f, 0.05f);
+        result->sink += pid.alteredKd;
+    }
+    MeasureStop(result, iterations);
+}
+
+void
+PIDBenchCOutputLimitsSet(uint64_t iterations, PIDBenchMeasurement *result)
+{
+    PIDControl pid;
+    uint64_t i;
+    
+    PatternInit();
+    ControllerInit(&pid);
+    
+    MeasureStart(result);
+    for(i = 0; i < iterations; i++)
+    {
+        PIDOutputLimitsSet(&pid, -1.0f, 1.0f + inputPattern[i % INPUT_PATTERN_SIZE]);
+        result->sink += pid.outMax;
+    }
+    MeasureStop(result, iterations);
+}
+
+void
+PIDBenchCSampleTimeSet(uint64_t iterations, PIDBenchMeasurement *result)
+{
+    PIDControl pid;
+    uint64_t i;
+    
+    PatternInit();
+    ControllerInit(&pid);
+    
+    MeasureStart(result);
+    for(i = 0; i < iterations; i++)
+    {
+        // Alternate between two sample times so the gains stay bounded
+        PIDSampleTimeSet(&pid, (i & 1) ? 0.001f : 0.002f);
+        result->sink += pid.alteredKi;
+    }
+    MeasureStop(result, iterations);
+}
+
+int
+PIDBenchCBatch(size_t controllers, uint64_t ticks, PIDBenchMeasurement *result)
+{
+    PIDControl *pids = (PIDControl *)malloc(controllers * sizeof(PIDControl));
+    uint64_t tick;
+    size_t i;
+    
+    if(pids == NULL)
+    {
+        return 0;
+    }
+    
+    PatternInit();
+    for(i = 0; i < controllers; i++)
+    {
+        ControllerInit(&pids[i]);
+    }
+    
+    MeasureStart(result);
+    for(tick = 0; tick < ticks; tick++)
+    {
+        float input = inputPattern[tick % INPUT_PATTERN_SIZE];
+        
+        for(i = 0; i < controllers; i++)
+        {
+            PIDInputSet(&pids[i], input);
+            PIDCompute(&pids[i]);
+        }
+        result->sink += PIDOutputGet(&pids[tick % controllers]);
+    }
+    MeasureStop(result, ticks * controllers);
+    
+    free(pids);
+    
+    return 1;
+}
@@ -0,0 +1,108 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: Minimal checks shared by the C and C++ tests. A test is an
+// executable that runs its checks, prints every one that fails and exits with a
+// nonzero status if any did, which is all ctest needs.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+// Header Guard
+#ifndef PID_TEST_H
+#define PID_TEST_H
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+// 
+// Number of checks that failed so far
+// 
+static int pidTestFailures = 0;
+
+// 
+// PID Test Check
+// Description:
+//      Counts and prints a failed condition with where it is. The test carries
+//      on, so one run shows every check that fails.
+// 
+#define PID_TEST_CHECK(condition)                                               \
+    do                                                                          \
+    {                                                                           \
+        if(!(condition))                                                        \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__,   \
+                    #condition);                                                \
+            pidTestFailures++;                                                  \
+        }                                                                       \
+    }                                                                           \
+    while(0)
+
+//*********************************************************************************
+// Functions
+//*********************************************************************************
+
+// 
+// PID Test Same
+// Description:
+//      Tells whether two floats have the same bits, which is what bit for bit 
+//      parity means: unlike ==, it tells 0 from -0 and matches a NaN.
+// 
+static inline bool
+PIDTestSame(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// 
+// PID Test Result
+// Description:
+//      Prints the outcome of a test and returns its exit status.
+// 
+static inline int
+PIDTestResult(const char *name)
+{
+    if(pidTestFailures > 0)
+    {
+        fprintf(stderr, "%s: %d checks failed\n", name, pidTestFailures);
+        return 1;
+    }
+    
+    printf("%s: passed\n", name);
+    return 0;
+}
+
+#endif  // PID_TEST_H
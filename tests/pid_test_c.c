@@ -0,0 +1,270 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C -
+// Platform Independent
+// 
+// Revision: 1.1
+// 
+// Description: Checks of the C library: deadband mode lets go of a derivative
+// kick, and a checkpoint restored into freshly initialized controllers carries
+// on bit for bit.
+// 
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+// 
+// Revisions can be found here:
+// https://github.com/tcleg
+// 
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+// 
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+// 
+//                                 GPLv3 License
+// 
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <stdint.h>
+#include "pid_checkpoint.h"
+#include "pid_controller.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define TEST_CONTROLLERS            9
+#define TEST_TICKS                  100
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void DeadbandCheck(float deadband);
+static void TimedGapCheck(void);
+static void CheckpointCheck(void);
+static void SetpointsSet(PIDControl *pids, int tick);
+static void ControllersRun(PIDControl *pids, int first, int last);
+static int OutputsCompare(PIDControl *a, PIDControl *b);
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main(void)
+{
+    DeadbandCheck(0.0f);
+    DeadbandCheck(0.5f);
+    TimedGapCheck();
+    CheckpointCheck();
+    
+    return PIDTestResult("pid_test_c");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+// 
+// The integrator winds up to the high limit with the input at 0, then a step
+// of the input kicks the output to the low limit through the derivative. The
+// controller in deadband mode has to follow the plain one back up.
+// 
+static void
+DeadbandCheck(float deadband)
+{
+    PIDControl plain, resting;
+    int mismatches = 0;
+    int tick;
+    
+    PIDInit(&plain, 1.0f, 1.0f, 5.0f, 0.1f, -10.0f, 10.0f, AUTOMATIC, DIRECT);
+    PIDInit(&resting, 1.0f, 1.0f, 5.0f, 0.1f, -10.0f, 10.0f, AUTOMATIC, DIRECT);
+    PIDDeadbandSet(&resting, deadband);
+    PIDSetpointSet(&plain, 100.0f);
+    PIDSetpointSet(&resting, 100.0f);
+    
+    for(tick = 0; tick < 50; tick++)
+    {
+        float input = (tick < 5) ? 0.0f : 99.9f;
+        
+        PIDInputSet(&plain, input);
+        PIDInputSet(&resting, input);
+        PIDCompute(&plain);
+        PIDCompute(&resting);
+        
+        if(tick == 5)
+        {
+            PID_TEST_CHECK(PIDOutputGet(&plain) == -10.0f);
+        }
+#ifndef PID_REAL_TIME
+        if(tick == 6)
+        {
+            PID_TEST_CHECK(PIDOutputChangedGet(&resting));
+        }
+#endif
+        mismatches += !PIDTestSame(PIDOutputGet(&plain), PIDOutputGet(&resting));
+    }
+    
+    PID_TEST_CHECK(mismatches == 0);
+    PID_TEST_CHECK(PIDOutputGet(&resting) == 10.0f);
+    
+    // With PID_REAL_TIME, PIDCompute ignores the deadband
+#ifndef PID_REAL_TIME
+    PID_TEST_CHECK(!PIDOutputChangedGet(&resting));
+#endif
+}
+
+// 
+// A pure integrator with a constant error of 1 computed every 10 ms. A gap of
+// 3 sample times scales the step by 3; a 10 s gap is a restart and gives one
+// nominal step, after which the intervals scale again.
+// 
+static void
+TimedGapCheck(void)
+{
+    PIDControl pid;
+    uint32_t now = 0;
+    float before;
+    int tick;
+    
+    PIDInit(&pid, 0.0f, 1.0f, 0.0f, 0.01f, -100.0f, 100.0f, AUTOMATIC, DIRECT);
+    PIDSetpointSet(&pid, 1.0f);
+    
+    for(tick = 0; tick < 10; tick++)
+    {
+        PID_TEST_CHECK(PIDComputeAt(&pid, now));
+        now += 10000u;
+    }
+    
+    now += 20000u;
+    before = PIDOutputGet(&pid);
+    PID_TEST_CHECK(PIDComputeAt(&pid, now));
+    PID_TEST_CHECK(fabsf(PIDOutputGet(&pid) - before - 0.03f) < 1e-4f);
+    
+    now += 10000000u;
+    before = PIDOutputGet(&pid);
+    PID_TEST_CHECK(PIDComputeAt(&pid, now));
+    PID_TEST_CHECK(fabsf(PIDOutputGet(&pid) - before - 0.01f) < 1e-4f);
+    
+    now += 20000u;
+    before = PIDOutputGet(&pid);
+    PID_TEST_CHECK(PIDComputeAt(&pid, now));
+    PID_TEST_CHECK(fabsf(PIDOutputGet(&pid) - before - 0.02f) < 1e-4f);
+}
+
+// 
+// The setpoints step every 25 ticks, so the weighted law's last setpoint 
+// matters for a checkpoint taken between a step and the next compute
+// 
+static void
+SetpointsSet(PIDControl *pids, int tick)
+{
+    size_t i;
+    
+    for(i = 0; i < TEST_CONTROLLERS; i++)
+    {
+        PIDSetpointSet(&pids[i], 0.1f * (float)((i + (size_t)tick / 25) % 5));
+    }
+}
+
+static void
+ControllersRun(PIDControl *pids, int first, int last)
+{
+    int tick;
+    size_t i;
+    
+    for(tick = first; tick < last; tick++)
+    {
+        SetpointsSet(pids, tick);
+        for(i = 0; i < TEST_CONTROLLERS; i++)
+        {
+            PIDInputSet(&pids[i], 0.05f * (float)((tick * (int)(i + 2)) % 13) - 0.3f);
+            PIDCompute(&pids[i]);
+        }
+    }
+}
+
+static void
+CheckpointCheck(void)
+{
+    PIDControl pids[TEST_CONTROLLERS];
+    PIDControl restored[TEST_CONTROLLERS];
+    uint32_t buffer[(sizeof(PIDCheckpointHeader) + 
+                     TEST_CONTROLLERS * sizeof(PIDCheckpointRecord)) / 4];
+    size_t size = PIDCheckpointSize(TEST_CONTROLLERS);
+    PIDCheckpointHeader *header = (PIDCheckpointHeader *)buffer;
+    size_t i;
+    
+    for(i = 0; i < TEST_CONTROLLERS; i++)
+    {
+        PIDInit(&pids[i], 0.8f + 0.1f * (float)i, 2.0f, 0.02f, 0.01f, -1.0f, 1.0f, 
+                (i % 4 == 3) ? MANUAL : AUTOMATIC, (i % 3 == 0) ? REVERSE : DIRECT);
+        PIDInit(&restored[i], 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, MANUAL, DIRECT);
+        
+        // Checkpoints carry the weighted law and the anti-windup setting
+        if(i % 3 == 1)
+        {
+            PIDSetpointWeightsSet(&pids[i], 0.5f, 0.25f);
+        }
+        if(i % 3 == 2)
+        {
+            PIDDerivativeFilterSet(&pids[i], 20.0f);
+        }
+        if(i % 4 == 1)
+        {
+            PIDAntiWindupSet(&pids[i], BACK_CALCULATION, 4.0f);
+        }
+    }
+    ControllersRun(pids, 0, TEST_TICKS);
+    SetpointsSet(pids, TEST_TICKS);
+    
+    PID_TEST_CHECK(PIDCheckpointWrite(pids, TEST_CONTROLLERS, buffer, size - 1) == 0);
+    PID_TEST_CHECK(PIDCheckpointWrite(pids, TEST_CONTROLLERS, buffer, size) == size);
+    
+    header->version++;
+    PID_TEST_CHECK(PIDCheckpointRead(restored, TEST_CONTROLLERS, buffer, size) == 0);
+    header->version--;
+    header->recordSize /= 2;
+    PID_TEST_CHECK(PIDCheckpointRead(restored, TEST_CONTROLLERS, buffer, size) == 0);
+    header->recordSize *= 2;
+    PID_TEST_CHECK(PIDCheckpointRead(restored, TEST_CONTROLLERS, buffer, size - 1) == 0);
+    PID_TEST_CHECK(PIDCheckpointRead(restored, TEST_CONTROLLERS, buffer, size) == 
+                   TEST_CONTROLLERS);
+    
+    // The first tick is checked too, before the outputs settle at a limit or
+    // the filtered derivative forgets a lost state
+    ControllersRun(pids, TEST_TICKS, TEST_TICKS + 1);
+    ControllersRun(restored, TEST_TICKS, TEST_TICKS + 1);
+    PID_TEST_CHECK(OutputsCompare(pids, restored) == 0);
+    ControllersRun(pids, TEST_TICKS + 1, 2 * TEST_TICKS);
+    ControllersRun(restored, TEST_TICKS + 1, 2 * TEST_TICKS);
+    PID_TEST_CHECK(OutputsCompare(pids, restored) == 0);
+}
+
+static int
+OutputsCompare(PIDControl *a, PIDControl *b)
+{
+    int mismatches = 0;
+    size_t i;
+    
+    for(i = 0; i < TEST_CONTROLLERS; i++)
+    {
+        mismatches += !PIDTestSame(PIDOutputGet(&a[i]), PIDOutputGet(&b[i]));
+    }
+    
+    return mismatches;
+}
@@ -0,0 +1,342 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks that a checkpoint of PIDControl objects or of a PIDBank,
+// restored into freshly constructed controllers of either kind, carries on with
+// the same outputs bit for bit as the controllers it was taken from, and that
+// damaged checkpoints are rejected.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_checkpoint.h"
+#include "pid_controller.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define CHECKPOINT_CONTROLLERS      37
+#define CHECKPOINT_TICKS            200
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static float InputGet(size_t index, int tick);
+static float SetpointGet(size_t index, int tick);
+static void ControllersMake(std::vector<PIDControl> &pids, PIDBank &bank);
+static void SetpointsSet(std::vector<PIDControl> &pids, PIDBank &bank, int tick);
+static void ControllersRun(std::vector<PIDControl> &pids, PIDBank &bank, int first, 
+                           int last);
+static int OutputsCompare(std::vector<PIDControl> &a, std::vector<PIDControl> &b);
+static int OutputsCompare(std::vector<PIDControl> &a, const PIDBank &b);
+static void CheckpointObjects();
+static void CheckpointBank();
+static void CheckpointDamaged();
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    CheckpointObjects();
+    CheckpointBank();
+    CheckpointDamaged();
+
+    return PIDTestResult("pid_test_checkpoint");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// A different smooth input for every controller
+//
+static float
+InputGet(size_t index, int tick)
+{
+    return 0.4f * (float)((tick * (int)(index + 3)) % 17) / 17.0f - 0.1f * (float)(index % 5);
+}
+
+static float
+SetpointGet(size_t index, int tick)
+{
+    return 0.2f * (float)((index + (size_t)tick / 25) % 4);
+}
+
+//
+// The controllers a checkpoint is taken from. Some are on the weighted law or
+// leave the default anti-windup.
+//
+static void
+ControllersMake(std::vector<PIDControl> &pids, PIDBank &bank)
+{
+    for(size_t i = 0; i < CHECKPOINT_CONTROLLERS; i++)
+    {
+        PIDMode mode = (i % 8 == 0) ? MANUAL : AUTOMATIC;
+        PIDDirection direction = (i % 3 == 0) ? REVERSE : DIRECT;
+        float kp = 0.5f + 0.05f * (float)i;
+        float setpoint = SetpointGet(i, 0);
+
+        pids.emplace_back(kp, 2.0f, 0.01f, 0.01f, -1.0f, 1.0f, mode, direction);
+        pids[i].PIDSetpointSet(setpoint);
+        bank.PIDAdd(kp, 2.0f, 0.01f, 0.01f, -1.0f, 1.0f, mode, direction);
+        bank.PIDSetpointSet(i, setpoint);
+
+        if(i % 5 == 4)
+        {
+            pids[i].PIDDeadbandSet(0.01f);
+            bank.PIDDeadbandSet(i, 0.01f);
+        }
+
+        if(i % 6 == 1 || i % 6 == 2)
+        {
+            pids[i].PIDSetpointWeightsSet(0.5f, 0.25f);
+            bank.PIDSetpointWeightsSet(i, 0.5f, 0.25f);
+        }
+        if(i % 6 == 2 || i % 6 == 3)
+        {
+            pids[i].PIDDerivativeFilterSet(20.0f);
+            bank.PIDDerivativeFilterSet(i, 20.0f);
+        }
+        if(i % 7 == 1)
+        {
+            pids[i].PIDAntiWindupSet(CONDITIONAL_INTEGRATION, 0.0f);
+            bank.PIDAntiWindupSet(i, CONDITIONAL_INTEGRATION, 0.0f);
+        }
+        if(i % 7 == 2)
+        {
+            pids[i].PIDAntiWindupSet(BACK_CALCULATION, 4.0f);
+            bank.PIDAntiWindupSet(i, BACK_CALCULATION, 4.0f);
+        }
+    }
+}
+
+//
+// The setpoints step every 25 ticks, so the weighted law's last setpoint
+// matters for a checkpoint taken between a step and the next compute
+//
+static void
+SetpointsSet(std::vector<PIDControl> &pids, PIDBank &bank, int tick)
+{
+    for(size_t i = 0; i < pids.size(); i++)
+    {
+        pids[i].PIDSetpointSet(SetpointGet(i, tick));
+    }
+    for(size_t i = 0; i < bank.Size(); i++)
+    {
+        bank.PIDSetpointSet(i, SetpointGet(i, tick));
+    }
+}
+
+static void
+ControllersRun(std::vector<PIDControl> &pids, PIDBank &bank, int first, int last)
+{
+    for(int tick = first; tick < last; tick++)
+    {
+        SetpointsSet(pids, bank, tick);
+        for(size_t i = 0; i < pids.size(); i++)
+        {
+            pids[i].PIDInputSet(InputGet(i, tick));
+            pids[i].PIDCompute();
+        }
+        for(size_t i = 0; i < bank.Size(); i++)
+        {
+            bank.PIDInputSet(i, InputGet(i, tick));
+        }
+        bank.ComputeActive();
+    }
+}
+
+static int
+OutputsCompare(std::vector<PIDControl> &a, std::vector<PIDControl> &b)
+{
+    int mismatches = 0;
+
+    for(size_t i = 0; i < a.size(); i++)
+    {
+        mismatches += !PIDTestSame(a[i].PIDOutputGet(), b[i].PIDOutputGet());
+    }
+
+    return mismatches;
+}
+
+static int
+OutputsCompare(std::vector<PIDControl> &a, const PIDBank &b)
+{
+    int mismatches = 0;
+
+    for(size_t i = 0; i < a.size(); i++)
+    {
+        mismatches += !PIDTestSame(a[i].PIDOutputGet(), b.PIDOutputGet(i));
+    }
+
+    return mismatches;
+}
+
+//
+// Objects restored into fresh objects and into a fresh bank
+//
+static void
+CheckpointObjects()
+{
+    std::vector<PIDControl> pids, restored;
+    PIDBank bank, restoredBank;
+    std::vector<PIDCheckpointHeader> buffer;
+
+    ControllersMake(pids, bank);
+    ControllersRun(pids, bank, 0, CHECKPOINT_TICKS);
+    SetpointsSet(pids, bank, CHECKPOINT_TICKS);
+
+    buffer.resize(PIDCheckpointSize(pids.size()) / sizeof(PIDCheckpointHeader) + 1);
+    PID_TEST_CHECK(PIDCheckpointWrite(pids.data(), pids.size(), buffer.data(), 
+                                      buffer.size() * sizeof(buffer[0])) == 
+                   PIDCheckpointSize(pids.size()));
+
+    restored.assign(pids.size(), PIDControl(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 
+                                            MANUAL, DIRECT));
+    PID_TEST_CHECK(PIDCheckpointRead(restored.data(), restored.size(), buffer.data(), 
+                                     PIDCheckpointSize(pids.size())) == pids.size());
+    PID_TEST_CHECK(restoredBank.CheckpointRead(buffer.data(), PIDCheckpointSize(pids.size())));
+    PID_TEST_CHECK(restoredBank.Size() == pids.size());
+    PID_TEST_CHECK(OutputsCompare(pids, restored) == 0);
+
+    // Carrying on is bumpless and exact. The filtered derivative forgets a
+    // lost state within a few hundred ticks, so the first tick is checked too.
+    ControllersRun(pids, bank, CHECKPOINT_TICKS, CHECKPOINT_TICKS + 1);
+    ControllersRun(restored, restoredBank, CHECKPOINT_TICKS, CHECKPOINT_TICKS + 1);
+    PID_TEST_CHECK(OutputsCompare(pids, restored) == 0);
+    PID_TEST_CHECK(OutputsCompare(pids, restoredBank) == 0);
+    ControllersRun(pids, bank, CHECKPOINT_TICKS + 1, 2 * CHECKPOINT_TICKS);
+    ControllersRun(restored, restoredBank, CHECKPOINT_TICKS + 1, 2 * CHECKPOINT_TICKS);
+    PID_TEST_CHECK(OutputsCompare(pids, restored) == 0);
+    PID_TEST_CHECK(OutputsCompare(pids, restoredBank) == 0);
+}
+
+//
+// A bank written out and read back into a fresh bank and fresh objects
+//
+static void
+CheckpointBank()
+{
+    std::vector<PIDControl> pids, restored;
+    PIDBank bank, restoredBank;
+    std::vector<PIDCheckpointHeader> buffer;
+
+    ControllersMake(pids, bank);
+    ControllersRun(pids, bank, 0, CHECKPOINT_TICKS);
+    SetpointsSet(pids, bank, CHECKPOINT_TICKS);
+
+    buffer.resize(bank.CheckpointSize() / sizeof(PIDCheckpointHeader) + 1);
+    PID_TEST_CHECK(bank.CheckpointWrite(buffer.data(), buffer.size() * sizeof(buffer[0])) == 
+                   bank.CheckpointSize());
+    PID_TEST_CHECK(bank.CheckpointWrite(buffer.data(), bank.CheckpointSize() - 1) == 0);
+
+    restored.assign(pids.size(), PIDControl(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 
+                                            MANUAL, DIRECT));
+    PID_TEST_CHECK(restoredBank.CheckpointRead(buffer.data(), bank.CheckpointSize()));
+    PID_TEST_CHECK(PIDCheckpointRead(restored.data(), restored.size(), buffer.data(), 
+                                     bank.CheckpointSize()) == pids.size());
+
+    ControllersRun(pids, bank, CHECKPOINT_TICKS, CHECKPOINT_TICKS + 1);
+    ControllersRun(restored, restoredBank, CHECKPOINT_TICKS, CHECKPOINT_TICKS + 1);
+    PID_TEST_CHECK(OutputsCompare(pids, restored) == 0);
+    PID_TEST_CHECK(OutputsCompare(pids, restoredBank) == 0);
+    ControllersRun(pids, bank, CHECKPOINT_TICKS + 1, 2 * CHECKPOINT_TICKS);
+    ControllersRun(restored, restoredBank, CHECKPOINT_TICKS + 1, 2 * CHECKPOINT_TICKS);
+    PID_TEST_CHECK(OutputsCompare(pids, bank) == 0);
+    PID_TEST_CHECK(OutputsCompare(pids, restored) == 0);
+    PID_TEST_CHECK(OutputsCompare(pids, restoredBank) == 0);
+}
+
+//
+// Truncated checkpoints, a foreign magic number, version or record size and 
+// invalid records are turned down, and a bank is left as it was
+//
+static void
+CheckpointDamaged()
+{
+    std::vector<PIDControl> pids, restored;
+    PIDBank bank, untouched;
+    std::vector<PIDCheckpointHeader> buffer;
+    PIDCheckpointHeader *header;
+    PIDCheckpointRecord *records;
+    size_t size;
+
+    ControllersMake(pids, bank);
+    size = bank.CheckpointSize();
+    buffer.resize(size / sizeof(PIDCheckpointHeader) + 1);
+    bank.CheckpointWrite(buffer.data(), size);
+    header = buffer.data();
+    records = (PIDCheckpointRecord *)(header + 1);
+    untouched.PIDAdd(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, AUTOMATIC, DIRECT);
+    restored.assign(pids.size(), PIDControl(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 
+                                            MANUAL, DIRECT));
+
+    PID_TEST_CHECK(!untouched.CheckpointRead(buffer.data(), size - 1));
+    PID_TEST_CHECK(PIDCheckpointRead(restored.data(), restored.size(), buffer.data(), 
+                                     sizeof(PIDCheckpointHeader) - 1) == 0);
+
+    header->magic ^= 1;
+    PID_TEST_CHECK(!untouched.CheckpointRead(buffer.data(), size));
+    header->magic ^= 1;
+    header->version++;
+    PID_TEST_CHECK(!untouched.CheckpointRead(buffer.data(), size));
+    header->version--;
+    header->recordSize /= 2;
+    PID_TEST_CHECK(!untouched.CheckpointRead(buffer.data(), size));
+    PID_TEST_CHECK(PIDCheckpointRead(restored.data(), restored.size(), buffer.data(), size) == 0);
+    header->recordSize *= 2;
+
+    records[3].mode = 7;
+    PID_TEST_CHECK(!untouched.CheckpointRead(buffer.data(), size));
+    records[3].mode = AUTOMATIC;
+    records[5].outMin = records[5].outMax;
+    PID_TEST_CHECK(!untouched.CheckpointRead(buffer.data(), size));
+    records[5].outMin = -1.0f;
+    records[6].antiWindup = 3;
+    PID_TEST_CHECK(!untouched.CheckpointRead(buffer.data(), size));
+    records[6].antiWindup = CLAMPING;
+    records[7].filterN = -1.0f;
+    PID_TEST_CHECK(!untouched.CheckpointRead(buffer.data(), size));
+    PID_TEST_CHECK(PIDCheckpointRead(restored.data(), restored.size(), buffer.data(), size) == 0);
+
+    PID_TEST_CHECK(untouched.Size() == 1);
+}
@@ -0,0 +1,313 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks PIDClusterPlan and PIDClusterNode: Balance makes a cycle
+// cross nodes, messages carry the outputs across with the plan's gains, stale,
+// duplicate and foreign messages are rejected, and extrapolation follows the age
+// of the values up to its limit.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_cluster.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Controllers 0 and 2 run on node 0. Controller 0 feeds the setpoint of
+// controller 1, and controller 2 the input of controller 3, both on node 1.
+//
+#define CLUSTER_CONTROLLERS         4
+#define CLUSTER_GAIN                2.0f
+#define CLUSTER_OFFSET              1.0f
+#define CLUSTER_MAX_TICKS           4
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void PlanMake(PIDClusterPlan &plan);
+static void BankMake(const PIDClusterPlan &plan, unsigned node, PIDBank &bank);
+static std::vector<uint8_t> MessageMake(const PIDClusterPlan &plan, uint64_t tick, 
+                                        float first, float second);
+static void BalanceCheck();
+static void RoundTripCheck();
+static void RejectCheck();
+static void CompensationCheck(PIDClusterCompensation compensation);
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    BalanceCheck();
+    RoundTripCheck();
+    RejectCheck();
+    CompensationCheck(PID_CLUSTER_HOLD);
+    CompensationCheck(PID_CLUSTER_EXTRAPOLATE);
+
+    return PIDTestResult("pid_test_cluster");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+PlanMake(PIDClusterPlan &plan)
+{
+    PID_TEST_CHECK(plan.Connect(0, 1, PID_GRAPH_SETPOINT, CLUSTER_GAIN, CLUSTER_OFFSET));
+    PID_TEST_CHECK(plan.Connect(2, 3, PID_GRAPH_INPUT));
+    PID_TEST_CHECK(plan.Assign(0, 0));
+    PID_TEST_CHECK(plan.Assign(1, 1));
+    PID_TEST_CHECK(plan.Assign(2, 0));
+    PID_TEST_CHECK(plan.Assign(3, 1));
+}
+
+//
+// A bank of a node's controllers, each with its own setpoint
+//
+static void
+BankMake(const PIDClusterPlan &plan, unsigned node, PIDBank &bank)
+{
+    std::vector<size_t> members = plan.Members(node);
+
+    for(size_t i = 0; i < members.size(); i++)
+    {
+        bank.PIDAdd(1.0f, 0.5f, 0.0f, 0.01f, -100.0f, 100.0f, AUTOMATIC, DIRECT);
+        bank.PIDSetpointSet(i, 10.0f + (float)members[i]);
+    }
+}
+
+//
+// A message from node 0 to node 1 as node 0 would pack it, with the outputs
+// of controllers 0 and 2
+//
+static std::vector<uint8_t>
+MessageMake(const PIDClusterPlan &plan, uint64_t tick, float first, float second)
+{
+    PIDClusterHeader header;
+    std::vector<uint8_t> message(sizeof(header) + 2 * sizeof(float));
+
+    header.magic = PID_CLUSTER_MAGIC;
+    header.planHash = plan.Hash();
+    header.from = 0;
+    header.to = 1;
+    header.count = 2;
+    header.tick = tick;
+    memcpy(message.data(), &header, sizeof(header));
+    memcpy(message.data() + sizeof(header), &first, sizeof(float));
+    memcpy(message.data() + sizeof(header) + sizeof(float), &second, sizeof(float));
+
+    return message;
+}
+
+//
+// A cycle between two controllers, no bigger than a share, has to be split
+// over the nodes for them to build. With one node it cannot be.
+//
+static void
+BalanceCheck()
+{
+    PIDClusterPlan plan(CLUSTER_CONTROLLERS);
+
+    PID_TEST_CHECK(plan.Connect(0, 1));
+    PID_TEST_CHECK(plan.Connect(1, 0));
+    PID_TEST_CHECK(plan.Balance(2));
+    PID_TEST_CHECK(plan.NodeGet(0) != plan.NodeGet(1));
+    PID_TEST_CHECK(plan.CutCount() == 2);
+
+    for(unsigned node = 0; node < plan.NodeCount(); node++)
+    {
+        PIDBank bank;
+
+        BankMake(plan, node, bank);
+
+        PIDClusterNode cluster(plan, node, bank);
+
+        PID_TEST_CHECK(cluster.Build());
+    }
+
+    PID_TEST_CHECK(!plan.Balance(1));
+}
+
+//
+// Node 1 computes with what node 0 sent the tick before
+//
+static void
+RoundTripCheck()
+{
+    PIDClusterPlan plan(CLUSTER_CONTROLLERS);
+    PIDBank bank0, bank1;
+
+    PlanMake(plan);
+    BankMake(plan, 0, bank0);
+    BankMake(plan, 1, bank1);
+
+    PIDClusterNode node0(plan, 0, bank0), node1(plan, 1, bank1);
+
+    PID_TEST_CHECK(node0.Build());
+    PID_TEST_CHECK(node1.Build());
+    PID_TEST_CHECK(node1.MessageCount() == 0);
+
+    for(uint64_t tick = 1; tick <= 5; tick++)
+    {
+        PID_TEST_CHECK(node0.Tick() == tick);
+        PID_TEST_CHECK(node0.MessageCount() == 1);
+
+        const PIDClusterMessage &message = node0.MessageGet(0);
+        float sent0 = bank0.PIDOutputGet(0);
+        float sent2 = bank0.PIDOutputGet(1);
+
+        PID_TEST_CHECK(message.peer == 1);
+        PID_TEST_CHECK(node1.Receive(message.data, message.bytes));
+        PID_TEST_CHECK(node1.PeerTickGet(0) == tick);
+        PID_TEST_CHECK(node1.Tick() == tick);
+
+        PID_TEST_CHECK(bank1.PIDSetpointGet(0) == CLUSTER_GAIN * sent0 + CLUSTER_OFFSET);
+        PID_TEST_CHECK(bank1.PIDInputGet(1) == sent2);
+
+        // Both the output each tick and the bytes as they were sent
+        PID_TEST_CHECK(message.bytes == sizeof(PIDClusterHeader) + 2 * sizeof(float));
+        PID_TEST_CHECK(memcmp((const uint8_t *)message.data + sizeof(PIDClusterHeader), 
+                              &sent0, sizeof(float)) == 0);
+    }
+
+    PID_TEST_CHECK(node1.RejectedCount() == 0);
+}
+
+static void
+RejectCheck()
+{
+    PIDClusterPlan plan(CLUSTER_CONTROLLERS), other(CLUSTER_CONTROLLERS);
+    PIDBank bank;
+    std::vector<uint8_t> message;
+
+    PlanMake(plan);
+    PlanMake(other);
+    PID_TEST_CHECK(other.Connect(0, 3));
+    BankMake(plan, 1, bank);
+
+    PIDClusterNode node(plan, 1, bank);
+
+    PID_TEST_CHECK(node.Build());
+
+    // Newer messages only, whatever order the transport delivers them in
+    message = MessageMake(plan, 3, 1.0f, 2.0f);
+    PID_TEST_CHECK(node.Receive(message.data(), message.size()));
+    message = MessageMake(plan, 3, 5.0f, 6.0f);
+    PID_TEST_CHECK(!node.Receive(message.data(), message.size()));
+    message = MessageMake(plan, 2, 5.0f, 6.0f);
+    PID_TEST_CHECK(!node.Receive(message.data(), message.size()));
+    PID_TEST_CHECK(node.PeerTickGet(0) == 3);
+    PID_TEST_CHECK(node.RejectedCount() == 2);
+
+    // Another plan, another node, another byte order, or the wrong length
+    message = MessageMake(other, 4, 5.0f, 6.0f);
+    PID_TEST_CHECK(!node.Receive(message.data(), message.size()));
+    message = MessageMake(plan, 4, 5.0f, 6.0f);
+    message[offsetof(PIDClusterHeader, to)] = 0;
+    PID_TEST_CHECK(!node.Receive(message.data(), message.size()));
+    message = MessageMake(plan, 4, 5.0f, 6.0f);
+    std::reverse(message.begin(), message.begin() + sizeof(uint32_t));
+    PID_TEST_CHECK(!node.Receive(message.data(), message.size()));
+    message = MessageMake(plan, 4, 5.0f, 6.0f);
+    PID_TEST_CHECK(!node.Receive(message.data(), message.size() - 1));
+    PID_TEST_CHECK(!node.Receive(message.data(), sizeof(PIDClusterHeader) - 1));
+    PID_TEST_CHECK(node.RejectedCount() == 7);
+
+    // None of which touched what the node holds
+    PID_TEST_CHECK(node.PeerTickGet(0) == 3);
+    PID_TEST_CHECK(node.Tick() == 1);
+    PID_TEST_CHECK(bank.PIDSetpointGet(0) == CLUSTER_GAIN * 1.0f + CLUSTER_OFFSET);
+    PID_TEST_CHECK(bank.PIDInputGet(1) == 2.0f);
+}
+
+//
+// Node 1 runs ahead of the values it gets. Values 10 and 12 sent on ticks 2 
+// and 3 rise by 2 a tick, so extrapolated to tick t they are 12 + 2 (t - 3),
+// up to CLUSTER_MAX_TICKS ticks past 3. A value 4 after a gap of 2 ticks 
+// carries the slope over the gap.
+//
+static void
+CompensationCheck(PIDClusterCompensation compensation)
+{
+    PIDClusterPlan plan(CLUSTER_CONTROLLERS);
+    PIDBank bank;
+    std::vector<uint8_t> message;
+    bool extrapolate = (compensation == PID_CLUSTER_EXTRAPOLATE);
+
+    PlanMake(plan);
+    BankMake(plan, 1, bank);
+
+    PIDClusterNode node(plan, 1, bank);
+
+    node.CompensationSet(compensation, CLUSTER_MAX_TICKS);
+    PID_TEST_CHECK(node.Build());
+
+    // Nothing received yet leaves the node's own setpoint
+    PID_TEST_CHECK(node.Tick() == 1);
+    PID_TEST_CHECK(bank.PIDSetpointGet(0) == 11.0f);
+    node.Tick();
+    node.Tick();
+
+    message = MessageMake(plan, 2, 10.0f, -10.0f);
+    PID_TEST_CHECK(node.Receive(message.data(), message.size()));
+    message = MessageMake(plan, 3, 12.0f, -12.0f);
+    PID_TEST_CHECK(node.Receive(message.data(), message.size()));
+
+    for(uint64_t tick = 4; tick <= 3 + CLUSTER_MAX_TICKS + 2; tick++)
+    {
+        uint64_t age = std::min<uint64_t>(tick - 3, CLUSTER_MAX_TICKS);
+        float value = extrapolate ? 12.0f + 2.0f * (float)age : 12.0f;
+
+        PID_TEST_CHECK(node.Tick() == tick);
+        PID_TEST_CHECK(bank.PIDSetpointGet(0) == CLUSTER_GAIN * value + CLUSTER_OFFSET);
+        PID_TEST_CHECK(bank.PIDInputGet(1) == -value);
+    }
+
+    // Ticks 5 apart rising by 10 are 2 a tick again, used two ticks on
+    message = MessageMake(plan, 8, 22.0f, -22.0f);
+    PID_TEST_CHECK(node.Receive(message.data(), message.size()));
+    node.Tick();
+    PID_TEST_CHECK(bank.PIDInputGet(1) == (extrapolate ? -26.0f : -22.0f));
+}
@@ -0,0 +1,192 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks that PIDBankDevice computes exactly what
+// PIDBank::ComputeAll does: the outputs of every tick of a batch and the state
+// after it, bit for bit, for the plain and weighted laws, every anti-windup
+// strategy and controllers in MANUAL. Built with PID_CUDA; without a CUDA device
+// it reports itself skipped.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_bank_cuda.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define CUDA_CONTROLLERS            1000
+#define CUDA_TICKS                  200
+
+// What ctest takes for a skipped test
+#define CUDA_SKIPPED                77
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void BankFill(PIDBank &bank);
+static void InputsMake(std::vector<float> &rows, int batch);
+static void BatchCheck(PIDBank &host, PIDBankDevice &device, PIDBank &gpu, int batch);
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    PIDBank host(CUDA_CONTROLLERS), gpu(CUDA_CONTROLLERS);
+
+    BankFill(host);
+    BankFill(gpu);
+
+    PIDBankDevice device(gpu);
+
+    if(!device.Valid())
+    {
+        printf("pid_test_cuda: no CUDA device, skipped\n");
+        return CUDA_SKIPPED;
+    }
+
+    BatchCheck(host, device, gpu, 0);
+
+    // A second batch carries on from the device state, after a setpoint step
+    for(size_t i = 0; i < CUDA_CONTROLLERS; i++)
+    {
+        host.PIDSetpointSet(i, -host.PIDSetpointGet(i));
+    }
+    PID_TEST_CHECK(device.SetpointsUpload(host.SetpointData()));
+    BatchCheck(host, device, gpu, 1);
+
+    return PIDTestResult("pid_test_cuda");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// Every law and strategy, with limits close enough to saturate
+//
+static void
+BankFill(PIDBank &bank)
+{
+    for(size_t i = 0; i < CUDA_CONTROLLERS; i++)
+    {
+        float kp = 0.5f + 0.01f * (float)(i % 17);
+
+        bank.PIDAdd(kp, 2.0f, 0.05f, 0.01f, -1.0f, 1.0f, AUTOMATIC, 
+                    (i % 11 == 0) ? REVERSE : DIRECT);
+        bank.PIDSetpointSet(i, 0.25f + 0.05f * (float)(i % 9));
+
+        switch(i % 6)
+        {
+            case 1:
+                bank.PIDSetpointWeightsSet(i, 0.5f, 0.2f);
+                break;
+            case 2:
+                bank.PIDDerivativeFilterSet(i, 10.0f);
+                break;
+            case 3:
+                bank.PIDAntiWindupSet(i, CONDITIONAL_INTEGRATION, 0.0f);
+                break;
+            case 4:
+                bank.PIDAntiWindupSet(i, BACK_CALCULATION, 0.5f);
+                bank.PIDSetpointWeightsSet(i, 0.8f, 0.0f);
+                break;
+            case 5:
+                bank.PIDModeSet(i, MANUAL);
+                break;
+        }
+    }
+}
+
+static void
+InputsMake(std::vector<float> &rows, int batch)
+{
+    rows.resize((size_t)CUDA_TICKS * CUDA_CONTROLLERS);
+
+    for(size_t t = 0; t < CUDA_TICKS; t++)
+    {
+        for(size_t i = 0; i < CUDA_CONTROLLERS; i++)
+        {
+            rows[t * CUDA_CONTROLLERS + i] = 
+                sinf(0.05f * (float)(t + batch * CUDA_TICKS) + 0.1f * (float)i);
+        }
+    }
+}
+
+//
+// One batch on the device against the same ticks on the host, then the 
+// state the device downloads against the host's
+//
+static void
+BatchCheck(PIDBank &host, PIDBankDevice &device, PIDBank &gpu, int batch)
+{
+    std::vector<float> inputs, outputs((size_t)CUDA_TICKS * CUDA_CONTROLLERS);
+    size_t mismatches = 0;
+
+    InputsMake(inputs, batch);
+    PID_TEST_CHECK(device.Run(inputs.data(), CUDA_TICKS, outputs.data()));
+
+    for(size_t t = 0; t < CUDA_TICKS; t++)
+    {
+        memcpy(host.InputData(), &inputs[t * CUDA_CONTROLLERS], 
+               CUDA_CONTROLLERS * sizeof(float));
+        host.ComputeAll();
+
+        for(size_t i = 0; i < CUDA_CONTROLLERS; i++)
+        {
+            mismatches += !PIDTestSame(outputs[t * CUDA_CONTROLLERS + i], 
+                                       host.PIDOutputGet(i));
+        }
+    }
+
+    PID_TEST_CHECK(mismatches == 0);
+    PID_TEST_CHECK(device.Download());
+
+    mismatches = 0;
+    for(size_t i = 0; i < CUDA_CONTROLLERS; i++)
+    {
+        mismatches += !PIDTestSame(gpu.PIDOutputGet(i), host.PIDOutputGet(i));
+        mismatches += !PIDTestSame(gpu.PIDInputGet(i), host.PIDInputGet(i));
+        mismatches += !PIDTestSame(gpu.PIDIntegralGet(i), host.PIDIntegralGet(i));
+    }
+    PID_TEST_CHECK(mismatches == 0);
+}
@@ -0,0 +1,182 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks that deadband mode never freezes a derivative kick into
+// the output: after a step in the input, a controller in deadband mode follows
+// the same outputs as one without, on PIDControl, PIDBank::PIDCompute and
+// ComputeActive, on both update laws.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include "pid_bank.h"
+#include "pid_controller.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Computes with the input held at 0, which winds the integrator up to its 
+// limit, and then held just below the setpoint
+//
+#define DEADBAND_WINDUP_TICKS       5
+#define DEADBAND_TICKS              50
+#define DEADBAND_SETPOINT           100.0f
+#define DEADBAND_STEP               99.9f
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static float InputGet(int tick);
+static bool OutputsClose(float a, float b, float tolerance);
+static void DeadbandCheck(float deadband, float filter);
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    DeadbandCheck(0.0f, 0.0f);
+    DeadbandCheck(0.5f, 0.0f);
+    DeadbandCheck(0.0f, 5.0f);
+    DeadbandCheck(0.5f, 5.0f);
+
+    return PIDTestResult("pid_test_deadband");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static float
+InputGet(int tick)
+{
+    return (tick < DEADBAND_WINDUP_TICKS) ? 0.0f : DEADBAND_STEP;
+}
+
+//
+// Within the tolerance deadband mode allows, which at 0 means the same bits
+//
+static bool
+OutputsClose(float a, float b, float tolerance)
+{
+    return (tolerance > 0.0f) ? fabsf(a - b) <= tolerance : PIDTestSame(a, b);
+}
+
+//
+// The sequence that used to leave the controller at rest on the kicked 
+// output: the step drives the output to the low limit through the derivative
+// while the integrator sits at the high limit. A resting output may be off 
+// by kp times the deadband, no more.
+//
+static void
+DeadbandCheck(float deadband, float filter)
+{
+    PIDControl plain(1.0f, 1.0f, 5.0f, 0.1f, -10.0f, 10.0f, AUTOMATIC, DIRECT);
+    PIDControl resting = plain;
+    PIDBank bank;
+    int mismatches = 0;
+    int rested = 0;
+
+    bank.PIDAdd(1.0f, 1.0f, 5.0f, 0.1f, -10.0f, 10.0f, AUTOMATIC, DIRECT);
+    bank.PIDAdd(1.0f, 1.0f, 5.0f, 0.1f, -10.0f, 10.0f, AUTOMATIC, DIRECT);
+    if(filter > 0.0f)
+    {
+        plain.PIDDerivativeFilterSet(filter);
+        resting.PIDDerivativeFilterSet(filter);
+        bank.PIDDerivativeFilterSet(0, filter);
+        bank.PIDDerivativeFilterSet(1, filter);
+    }
+    resting.PIDDeadbandSet(deadband);
+    bank.PIDDeadbandSet(0, deadband);
+    bank.PIDDeadbandSet(1, deadband);
+
+    plain.PIDSetpointSet(DEADBAND_SETPOINT);
+    resting.PIDSetpointSet(DEADBAND_SETPOINT);
+    bank.PIDSetpointSet(0, DEADBAND_SETPOINT);
+    bank.PIDSetpointSet(1, DEADBAND_SETPOINT);
+
+    for(int tick = 0; tick < DEADBAND_TICKS; tick++)
+    {
+        float input = InputGet(tick);
+
+        plain.PIDInputSet(input);
+        resting.PIDInputSet(input);
+        bank.PIDInputSet(0, input);
+        bank.PIDInputSet(1, input);
+
+        plain.PIDCompute();
+        resting.PIDCompute();
+        bank.PIDCompute(0);
+        bank.ComputeActiveRange(1, 2);
+
+        // The step itself has to kick, and the compute after it to let go
+        if(tick == DEADBAND_WINDUP_TICKS)
+        {
+            PID_TEST_CHECK(plain.PIDOutputGet() == -10.0f);
+        }
+        if(tick == DEADBAND_WINDUP_TICKS + 1)
+        {
+            PID_TEST_CHECK(bank.PIDOutputChangedGet(1));
+#ifndef PID_REAL_TIME
+            PID_TEST_CHECK(resting.PIDOutputChangedGet());
+#endif
+        }
+
+        // kp is 1
+        mismatches += !OutputsClose(resting.PIDOutputGet(), plain.PIDOutputGet(), deadband);
+        mismatches += !OutputsClose(bank.PIDOutputGet(0), plain.PIDOutputGet(), deadband);
+        mismatches += !OutputsClose(bank.PIDOutputGet(1), plain.PIDOutputGet(), deadband);
+        rested += !resting.PIDOutputChangedGet();
+    }
+
+    if(mismatches > 0)
+    {
+        fprintf(stderr, "deadband %g, filter %g: %d outputs differ\n", deadband, filter, 
+                mismatches);
+    }
+    PID_TEST_CHECK(mismatches == 0);
+
+    // Once settled, deadband mode still does its job, except that with 
+    // PID_REAL_TIME PIDCompute ignores it
+#ifndef PID_REAL_TIME
+    PID_TEST_CHECK(rested > 0);
+#else
+    (void)rested;
+#endif
+    PID_TEST_CHECK(plain.PIDOutputGet() == 10.0f);
+}
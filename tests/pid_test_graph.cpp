@@ -0,0 +1,246 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks PIDGraph against the same cascades wired by hand: one
+// outer loop feeding many inner loops, a slower outer loop under RateSet, a
+// third level fed through inputs and two edges into one setpoint. The inner
+// loops have to be shared over the threads, not left on the caller's.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <stddef.h>
+#include <thread>
+#include "pid_bank.h"
+#include "pid_graph.h"
+#include "pid_test.h"
+
+#if defined(__linux__)
+    #include <sched.h>
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Controller 0 is a slow outer loop feeding the setpoints of the first inner 
+// loops. Controller GRAPH_OUTER is a second outer loop feeding the setpoints
+// of the second inner loops, each of which feeds the input of a third level 
+// loop, and also the setpoint of inner loop GRAPH_SHARED.
+//
+#define GRAPH_INNER                 1000
+#define GRAPH_OUTER                 (1 + GRAPH_INNER)
+#define GRAPH_SECOND                200
+#define GRAPH_SECOND_FIRST          (GRAPH_OUTER + 1)
+#define GRAPH_THIRD_FIRST           (GRAPH_SECOND_FIRST + GRAPH_SECOND)
+#define GRAPH_CONTROLLERS           (GRAPH_THIRD_FIRST + GRAPH_SECOND)
+#define GRAPH_SHARED                5
+#define GRAPH_DIVIDER               4
+#define GRAPH_THREADS               8
+#define GRAPH_TICKS                 100
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void BankFill(PIDBank &bank);
+static void InputsSet(PIDBank &bank, int tick);
+static void Copy(PIDBank &bank, size_t from, size_t to, bool setpoint, float gain,
+                 float offset);
+static void HandTick(PIDBank &bank, int tick);
+static void GraphCheck(unsigned threads);
+static void PinCheck();
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    GraphCheck(1);
+    GraphCheck(GRAPH_THREADS);
+    PinCheck();
+
+    return PIDTestResult("pid_test_graph");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+BankFill(PIDBank &bank)
+{
+    for(size_t i = 0; i < GRAPH_CONTROLLERS; i++)
+    {
+        float kp = 0.5f + 0.01f * (float)(i % 13);
+
+        bank.PIDAdd(kp, 0.3f, 0.01f, 0.01f, -50.0f, 50.0f, AUTOMATIC, DIRECT);
+        bank.PIDSetpointSet(i, 1.0f + 0.1f * (float)(i % 7));
+    }
+}
+
+//
+// The inputs that no edge feeds
+//
+static void
+InputsSet(PIDBank &bank, int tick)
+{
+    float *input = bank.InputData();
+
+    for(size_t i = 0; i < GRAPH_THIRD_FIRST; i++)
+    {
+        input[i] = sinf(0.1f * (float)tick + 0.01f * (float)i);
+    }
+}
+
+static void
+Copy(PIDBank &bank, size_t from, size_t to, bool setpoint, float gain, float offset)
+{
+    float *target = setpoint ? bank.SetpointData() : bank.InputData();
+
+    target[to] = gain * bank.OutputData()[from] + offset;
+}
+
+//
+// One tick of the graph, written out. The edges from a controller take 
+// effect when it is computed, and the faster outer loop comes first.
+//
+static void
+HandTick(PIDBank &bank, int tick)
+{
+    bank.ComputeRange(GRAPH_OUTER, GRAPH_OUTER + 1);
+    for(size_t k = 0; k < GRAPH_SECOND; k++)
+    {
+        Copy(bank, GRAPH_OUTER, GRAPH_SECOND_FIRST + k, true, 1.0f, 0.0f);
+    }
+    Copy(bank, GRAPH_OUTER, GRAPH_SHARED, true, 2.0f, 0.0f);
+
+    if((tick - 1) % GRAPH_DIVIDER == 0)
+    {
+        bank.ComputeRange(0, 1);
+        for(size_t k = 0; k < GRAPH_INNER; k++)
+        {
+            Copy(bank, 0, 1 + k, true, 0.5f, 1.0f);
+        }
+    }
+
+    bank.ComputeRange(1, 1 + GRAPH_INNER);
+    bank.ComputeRange(GRAPH_SECOND_FIRST, GRAPH_SECOND_FIRST + GRAPH_SECOND);
+    for(size_t k = 0; k < GRAPH_SECOND; k++)
+    {
+        Copy(bank, GRAPH_SECOND_FIRST + k, GRAPH_THIRD_FIRST + k, false, -1.0f, 0.0f);
+    }
+
+    bank.ComputeRange(GRAPH_THIRD_FIRST, GRAPH_CONTROLLERS);
+}
+
+static void
+GraphCheck(unsigned threads)
+{
+    PIDBank graphBank(GRAPH_CONTROLLERS), handBank(GRAPH_CONTROLLERS);
+    size_t mismatches = 0;
+
+    BankFill(graphBank);
+    BankFill(handBank);
+
+    PIDGraph graph(graphBank);
+
+    for(size_t k = 0; k < GRAPH_INNER; k++)
+    {
+        PID_TEST_CHECK(graph.Connect(0, 1 + k, PID_GRAPH_SETPOINT, 0.5f, 1.0f));
+    }
+    for(size_t k = 0; k < GRAPH_SECOND; k++)
+    {
+        PID_TEST_CHECK(graph.Connect(GRAPH_OUTER, GRAPH_SECOND_FIRST + k));
+        PID_TEST_CHECK(graph.Connect(GRAPH_SECOND_FIRST + k, GRAPH_THIRD_FIRST + k, 
+                                     PID_GRAPH_INPUT, -1.0f, 0.0f));
+    }
+    PID_TEST_CHECK(graph.Connect(GRAPH_OUTER, GRAPH_SHARED, PID_GRAPH_SETPOINT, 2.0f, 0.0f));
+    graph.RateSet(0, GRAPH_DIVIDER);
+
+    PID_TEST_CHECK(graph.Build(threads));
+    PID_TEST_CHECK(graph.LevelCount() == 3);
+    PID_TEST_CHECK(graph.PartCount() == threads);
+
+    for(int tick = 1; tick <= GRAPH_TICKS; tick++)
+    {
+        InputsSet(graphBank, tick);
+        InputsSet(handBank, tick);
+        PID_TEST_CHECK(graph.Tick() == (uint64_t)tick);
+        HandTick(handBank, tick);
+
+        for(size_t i = 0; i < GRAPH_CONTROLLERS; i++)
+        {
+            mismatches += !PIDTestSame(graphBank.PIDOutputGet(i), handBank.PIDOutputGet(i));
+        }
+    }
+
+    PID_TEST_CHECK(mismatches == 0);
+
+    // The last tick is not one of the slow outer loop's, so the shared 
+    // setpoint was last written by the other edge
+    PID_TEST_CHECK(graphBank.PIDSetpointGet(GRAPH_SHARED) == 
+                   2.0f * graphBank.PIDOutputGet(GRAPH_OUTER));
+}
+
+//
+// The thread calling Tick computes part 0, so a pinned graph pins it too. It
+// runs on a thread of its own to leave the test's affinity alone.
+//
+static void
+PinCheck()
+{
+#if defined(__linux__)
+    unsigned cpuCount = std::thread::hardware_concurrency();
+    unsigned firstCpu = 1;
+    cpu_set_t set;
+
+    std::thread caller([&]()
+    {
+        PIDBank bank(0);
+        PIDGraph graph(bank);
+
+        BankFill(bank);
+        PID_TEST_CHECK(graph.Build(GRAPH_THREADS, true, firstCpu));
+        graph.Tick();
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+    });
+    caller.join();
+
+    PID_TEST_CHECK(CPU_COUNT(&set) == 1);
+    PID_TEST_CHECK(CPU_ISSET(cpuCount ? firstCpu % cpuCount : firstCpu, &set));
+#endif
+}
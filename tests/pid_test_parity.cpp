@@ -0,0 +1,313 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks that every SIMD kernel of PIDBank, and the scalar one,
+// computes the same outputs bit for bit as PIDControl objects with the same
+// settings, over every compute entry point, anti-windup strategy and update law,
+// and that PIDControlT does too for the settings it has.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_bank_simd.h"
+#include "pid_controller.h"
+#include "pid_controller_t.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// An odd number of controllers, so that every kernel runs its remainder too
+//
+#define PARITY_CONTROLLERS          203
+#define PARITY_TICKS                600
+
+static uint32_t parityRandom;
+
+//
+// Gains fixed at compile time, for a PIDControlT that folds them to constants
+//
+struct
+ParityStaticConfig : PIDConfigDefault
+{
+    static constexpr bool staticGains = true;
+    static constexpr float kp = 2.0f;
+    static constexpr float ki = 3.0f;
+    static constexpr float kd = 0.02f;
+    static constexpr float sampleTime = 0.01f;
+    static constexpr PIDDirection direction = REVERSE;
+
+    static constexpr bool staticLimits = true;
+    static constexpr float outMin = -1.0f;
+    static constexpr float outMax = 1.0f;
+};
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static float RandomGet();
+static void ParityFill(std::vector<PIDControl> &pids, PIDBank &bank);
+static void ParityCheck(PIDSimdLevel level);
+static void TemplateCheck();
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    for(int level = PID_SIMD_SCALAR; level <= PID_SIMD_NEON; level++)
+    {
+        if(PIDSimdLevelSet((PIDSimdLevel)level))
+        {
+            ParityCheck((PIDSimdLevel)level);
+        }
+    }
+    PIDSimdLevelSet(PIDSimdLevelBest());
+    TemplateCheck();
+
+    return PIDTestResult("pid_test_parity");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// Uniform in [-2, 2), the same sequence on every platform
+//
+static float
+RandomGet()
+{
+    parityRandom = parityRandom * 1664525u + 1013904223u;
+    return (float)(parityRandom >> 8) * (4.0f / 16777216.0f) - 2.0f;
+}
+
+//
+// A mix of directions, modes, anti-windup strategies and laws, some settings
+// made before a controller is added to the bank's weighted count and some 
+// after
+//
+static void
+ParityFill(std::vector<PIDControl> &pids, PIDBank &bank)
+{
+    for(size_t i = 0; i < PARITY_CONTROLLERS; i++)
+    {
+        float kp = 2.0f + 0.01f * (float)i;
+        float kd = (i % 4 == 0) ? 0.0f : 0.02f;
+        PIDMode mode = (i % 11 == 0) ? MANUAL : AUTOMATIC;
+        PIDDirection direction = (i % 5 == 0) ? REVERSE : DIRECT;
+        PIDAntiWindup antiWindup = (PIDAntiWindup)(i % 3);
+
+        pids.emplace_back(kp, 3.0f, kd, 0.01f, -1.0f, 1.0f, mode, direction);
+        bank.PIDAdd(kp, 3.0f, kd, 0.01f, -1.0f, 1.0f, mode, direction);
+
+        pids[i].PIDAntiWindupSet(antiWindup, 1.5f);
+        bank.PIDAntiWindupSet(i, antiWindup, 1.5f);
+
+        if(i % 7 == 1)
+        {
+            pids[i].PIDSetpointWeightsSet(0.6f, 0.3f);
+            bank.PIDSetpointWeightsSet(i, 0.6f, 0.3f);
+        }
+        if(i % 6 == 2)
+        {
+            pids[i].PIDDerivativeFilterSet(8.0f);
+            bank.PIDDerivativeFilterSet(i, 8.0f);
+        }
+        if(i % 9 == 3)
+        {
+            pids[i].PIDDeadbandSet(0.0f);
+            bank.PIDDeadbandSet(i, 0.0f);
+        }
+    }
+}
+
+static void
+ParityCheck(PIDSimdLevel level)
+{
+    std::vector<PIDControl> pids;
+    std::vector<uint32_t> indices;
+    PIDBank bank;
+    int mismatches = 0;
+
+    parityRandom = 11;
+    ParityFill(pids, bank);
+
+    for(uint32_t i = 0; i < PARITY_CONTROLLERS; i += 3)
+    {
+        indices.push_back(i);
+    }
+
+    for(int tick = 0; tick < PARITY_TICKS; tick++)
+    {
+        // Hold the inputs now and then, so that deadband mode rests
+        bool hold = (tick % 10) >= 7;
+
+        for(size_t i = 0; i < PARITY_CONTROLLERS; i++)
+        {
+            float input = hold ? pids[i].PIDInputGet() : 2.0f * RandomGet();
+            float setpoint = hold ? pids[i].PIDSetpointGet() : 2.0f * RandomGet();
+
+            pids[i].PIDInputSet(input);
+            pids[i].PIDSetpointSet(setpoint);
+            bank.PIDInputSet(i, input);
+            bank.PIDSetpointSet(i, setpoint);
+        }
+
+        // Every entry point in turn
+        switch(tick % 4)
+        {
+            case 0:
+                bank.ComputeAll();
+                break;
+            case 1:
+                bank.ComputeActive();
+                break;
+            case 2:
+                for(size_t i = 0; i < PARITY_CONTROLLERS; i++)
+                {
+                    bank.PIDCompute(i);
+                }
+                break;
+            default:
+                bank.ComputeIndices(indices.data(), indices.size());
+                break;
+        }
+
+        for(size_t i = 0; i < PARITY_CONTROLLERS; i++)
+        {
+            if((tick % 4) != 3 || i % 3 == 0)
+            {
+                pids[i].PIDCompute();
+            }
+            mismatches += !PIDTestSame(pids[i].PIDOutputGet(), bank.PIDOutputGet(i));
+        }
+
+        // Settings changed half way through have to rescale the same way
+        if(tick == PARITY_TICKS / 2)
+        {
+            for(size_t i = 0; i < PARITY_CONTROLLERS; i++)
+            {
+                pids[i].PIDSampleTimeSet(0.02f);
+                bank.PIDSampleTimeSet(i, 0.02f);
+                pids[i].PIDTuningsSet(1.5f, 2.0f, 0.05f);
+                bank.PIDTuningsSet(i, 1.5f, 2.0f, 0.05f);
+            }
+        }
+    }
+
+    if(mismatches > 0)
+    {
+        fprintf(stderr, "SIMD level %d: %d outputs differ from PIDControl\n", (int)level, 
+                mismatches);
+    }
+    PID_TEST_CHECK(mismatches == 0);
+}
+
+//
+// PIDControlT with every term, with the derivative left out next to a
+// PIDControl without a derivative gain, and with everything fixed at compile
+// time
+//
+static void
+TemplateCheck()
+{
+    PIDControl reference(2.0f, 3.0f, 0.02f, 0.01f, -1.0f, 1.0f, AUTOMATIC, REVERSE);
+    PIDControl referencePI(2.0f, 3.0f, 0.0f, 0.01f, -1.0f, 1.0f, AUTOMATIC, DIRECT);
+    PIDControlT<PIDDynamicConfig<>> dynamic(2.0f, 3.0f, 0.02f, 0.01f, -1.0f, 1.0f, 
+                                            AUTOMATIC, REVERSE);
+    PIDControlT<PIDDynamicConfig<PID_TERMS_PI>> dynamicPI(2.0f, 3.0f, 0.0f, 0.01f, -1.0f, 
+                                                          1.0f, AUTOMATIC, DIRECT);
+    PIDControlT<ParityStaticConfig> fixed;
+    int mismatches = 0;
+
+    parityRandom = 17;
+
+    for(int tick = 0; tick < PARITY_TICKS; tick++)
+    {
+        float input = 2.0f * RandomGet();
+        float setpoint = RandomGet();
+
+        reference.PIDInputSet(input);
+        reference.PIDSetpointSet(setpoint);
+        referencePI.PIDInputSet(input);
+        referencePI.PIDSetpointSet(setpoint);
+        dynamic.PIDInputSet(input);
+        dynamic.PIDSetpointSet(setpoint);
+        dynamicPI.PIDInputSet(input);
+        dynamicPI.PIDSetpointSet(setpoint);
+        fixed.PIDInputSet(input);
+        fixed.PIDSetpointSet(setpoint);
+
+        reference.PIDCompute();
+        referencePI.PIDCompute();
+        dynamic.PIDCompute();
+        dynamicPI.PIDCompute();
+        fixed.PIDCompute();
+
+        if(tick < PARITY_TICKS / 2)
+        {
+            mismatches += !PIDTestSame(reference.PIDOutputGet(), fixed.PIDOutputGet());
+        }
+        mismatches += !PIDTestSame(reference.PIDOutputGet(), dynamic.PIDOutputGet());
+        mismatches += !PIDTestSame(referencePI.PIDOutputGet(), dynamicPI.PIDOutputGet());
+
+        // The setters have to rescale the same way, and a trip through MANUAL
+        // has to start the integrator from the output
+        if(tick == PARITY_TICKS / 2)
+        {
+            reference.PIDSampleTimeSet(0.02f);
+            dynamic.PIDSampleTimeSet(0.02f);
+            reference.PIDTuningsSet(1.5f, 2.0f, 0.05f);
+            dynamic.PIDTuningsSet(1.5f, 2.0f, 0.05f);
+            reference.PIDOutputLimitsSet(-0.5f, 0.75f);
+            dynamic.PIDOutputLimitsSet(-0.5f, 0.75f);
+            referencePI.PIDModeSet(MANUAL);
+            dynamicPI.PIDModeSet(MANUAL);
+            referencePI.PIDModeSet(AUTOMATIC);
+            dynamicPI.PIDModeSet(AUTOMATIC);
+        }
+    }
+
+    if(mismatches > 0)
+    {
+        fprintf(stderr, "PIDControlT: %d outputs differ from PIDControl\n", mismatches);
+    }
+    PID_TEST_CHECK(mismatches == 0);
+}
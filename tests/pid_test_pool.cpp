@@ -0,0 +1,262 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks the handles of PIDPool and PIDBankPool under adds and
+// removes in random order: every live handle keeps naming the object it was
+// handed out for, handles to removed objects stop resolving even once their slot
+// is reused, and the bank stays dense.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_pool.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define POOL_OPERATIONS             20000
+#define POOL_LIVE_MAX               300
+#define POOL_CHECK_EVERY            250
+
+//
+// Pool object that tells which object it is and counts its destructions
+//
+struct
+Tagged
+{
+    Tagged(uint32_t tag, int *destroyed) : tag(tag), destroyed(destroyed) {}
+    ~Tagged() { (*destroyed)++; }
+
+    uint32_t tag;
+    int *destroyed;
+};
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void ObjectPoolCheck();
+static void BankPoolCheck();
+static void BankPoolStateCheck(PIDBankPool &pool, 
+                               const std::unordered_map<PIDHandle, float> &live,
+                               const std::vector<PIDHandle> &stale);
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    ObjectPoolCheck();
+    BankPoolCheck();
+
+    return PIDTestResult("pid_test_pool");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+ObjectPoolCheck()
+{
+    std::mt19937 random(1);
+    std::vector<std::pair<PIDHandle, Tagged *> > live;
+    std::vector<PIDHandle> stale;
+    int destroyed = 0, created = 0;
+
+    {
+        PIDPool<Tagged> pool;
+        size_t wrong = 0;
+
+        for(int op = 0; op < POOL_OPERATIONS; op++)
+        {
+            if(live.empty() || (live.size() < POOL_LIVE_MAX && random() % 3 != 0))
+            {
+                PIDHandle handle = pool.Create((uint32_t)created, &destroyed);
+
+                created++;
+                live.push_back(std::make_pair(handle, pool.Get(handle)));
+            }
+            else
+            {
+                size_t k = random() % live.size();
+
+                PID_TEST_CHECK(pool.Destroy(live[k].first));
+                stale.push_back(live[k].first);
+                live[k] = live.back();
+                live.pop_back();
+            }
+
+            if(op % POOL_CHECK_EVERY != 0)
+            {
+                continue;
+            }
+
+            // Objects never move, so each handle gives back the first address
+            for(size_t k = 0; k < live.size(); k++)
+            {
+                wrong += pool.Get(live[k].first) != live[k].second;
+            }
+            for(size_t k = 0; k < stale.size(); k++)
+            {
+                wrong += pool.Get(stale[k]) != nullptr;
+            }
+            PID_TEST_CHECK(wrong == 0);
+            PID_TEST_CHECK(pool.Size() == live.size());
+            PID_TEST_CHECK(destroyed == (int)stale.size());
+        }
+
+        // Only live objects are visited, and each once
+        size_t visits = 0;
+        uint64_t tags = 0, liveTags = 0;
+
+        pool.ForEach([&](Tagged &object) { visits++; tags += object.tag; });
+        for(size_t k = 0; k < live.size(); k++)
+        {
+            liveTags += live[k].second->tag;
+        }
+        PID_TEST_CHECK(visits == live.size());
+        PID_TEST_CHECK(tags == liveTags);
+
+        PID_TEST_CHECK(!pool.Destroy(stale.front()));
+        PID_TEST_CHECK(!pool.Destroy(PID_HANDLE_NONE));
+    }
+
+    // The pool destroys what is left in it
+    PID_TEST_CHECK(destroyed == created);
+}
+
+//
+// Each controller is told apart by its setpoint, which is the order in which 
+// it was added
+//
+static void
+BankPoolCheck()
+{
+    std::mt19937 random(2);
+    std::unordered_map<PIDHandle, float> live;
+    std::vector<PIDHandle> handles, stale;
+    PIDBank bank(0);
+    float added = 0.0f;
+
+    // Controllers already in the bank get handles too
+    for(int i = 0; i < 10; i++)
+    {
+        bank.PIDAdd(1.0f, 0.0f, 0.0f, 0.01f, -1.0f, 1.0f, AUTOMATIC, DIRECT);
+        bank.PIDSetpointSet(bank.Size() - 1, added);
+        added += 1.0f;
+    }
+
+    PIDBankPool pool(bank);
+
+    for(size_t i = 0; i < bank.Size(); i++)
+    {
+        live[pool.HandleAt(i)] = bank.PIDSetpointGet(i);
+        handles.push_back(pool.HandleAt(i));
+    }
+    BankPoolStateCheck(pool, live, stale);
+
+    for(int op = 0; op < POOL_OPERATIONS; op++)
+    {
+        if(handles.empty() || (handles.size() < POOL_LIVE_MAX && random() % 3 != 0))
+        {
+            PIDHandle handle = pool.PIDAdd(1.0f, 0.0f, 0.0f, 0.01f, -1.0f, 1.0f, 
+                                           AUTOMATIC, DIRECT);
+
+            pool.View(handle).PIDSetpointSet(added);
+            live[handle] = added;
+            handles.push_back(handle);
+            added += 1.0f;
+        }
+        else
+        {
+            size_t k = random() % handles.size();
+
+            PID_TEST_CHECK(pool.PIDRemove(handles[k]));
+            live.erase(handles[k]);
+            stale.push_back(handles[k]);
+            handles[k] = handles.back();
+            handles.pop_back();
+        }
+
+        if(op % POOL_CHECK_EVERY == 0)
+        {
+            BankPoolStateCheck(pool, live, stale);
+        }
+    }
+    BankPoolStateCheck(pool, live, stale);
+
+    PID_TEST_CHECK(!pool.PIDRemove(stale.front()));
+    PID_TEST_CHECK(pool.Size() == live.size());
+}
+
+static void
+BankPoolStateCheck(PIDBankPool &pool, const std::unordered_map<PIDHandle, float> &live,
+                   const std::vector<PIDHandle> &stale)
+{
+    size_t wrong = 0;
+
+    // Every live handle views the controller it was handed out for
+    for(const std::pair<const PIDHandle, float> &entry : live)
+    {
+        wrong += !pool.Valid(entry.first);
+        wrong += pool.View(entry.first).PIDSetpointGet() != entry.second;
+        wrong += pool.HandleAt(pool.Index(entry.first)) != entry.first;
+    }
+
+    // Removed handles stay invalid, also once their slot is handed out again
+    for(size_t k = 0; k < stale.size(); k++)
+    {
+        wrong += pool.Valid(stale[k]);
+    }
+
+    // The bank holds the live controllers and nothing else, with no gaps
+    for(size_t i = 0; i < pool.Size(); i++)
+    {
+        PIDHandle handle = pool.HandleAt(i);
+
+        wrong += live.count(handle) == 0;
+        wrong += pool.Index(handle) != i;
+    }
+
+    PID_TEST_CHECK(wrong == 0);
+    PID_TEST_CHECK(pool.Size() == live.size());
+}
@@ -0,0 +1,162 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks the dead time of PIDPlantBank: a large bank with dead time
+// builds in time linear in its size, each plant sees its input its own number of
+// samples late, and plants added between steps leave the history of the others
+// alone.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stddef.h>
+#include <vector>
+#include "pid_simulator.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// Plants in the large bank. Built by clearing the history on every add, as it
+// once was, this many take hours.
+//
+#define SIMULATOR_PLANTS            1000000
+#define SIMULATOR_DELAYS            8
+#define SIMULATOR_SAMPLE_TIME       0.001f
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static float DeadTimeGet(size_t delay);
+static void LargeBankCheck();
+static void AddBetweenStepsCheck();
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    LargeBankCheck();
+    AddBetweenStepsCheck();
+
+    return PIDTestResult("pid_test_simulator");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// A dead time that rounds to delay samples
+//
+static float
+DeadTimeGet(size_t delay)
+{
+    return (float)delay * SIMULATOR_SAMPLE_TIME;
+}
+
+//
+// Pure gains, whose output after a step is their delayed input, driven by a
+// unit step. After k steps the plants delayed by under k samples have seen it.
+//
+static void
+LargeBankCheck()
+{
+    PIDPlantBank plants(SIMULATOR_SAMPLE_TIME, SIMULATOR_PLANTS);
+    std::vector<float> control(SIMULATOR_PLANTS, 1.0f);
+    size_t mismatches = 0;
+
+    for(size_t i = 0; i < SIMULATOR_PLANTS; i++)
+    {
+        plants.AddFirstOrder(1.0f, 0.0f, DeadTimeGet(i % SIMULATOR_DELAYS));
+    }
+
+    // The history is a row of inputs per sample of the longest delay
+    PID_TEST_CHECK(plants.MemoryBytes() < SIMULATOR_PLANTS * (SIMULATOR_DELAYS + 16) * 
+                                          sizeof(float));
+
+    for(size_t step = 1; step <= SIMULATOR_DELAYS; step++)
+    {
+        plants.Step(control.data());
+
+        for(size_t i = 0; i < SIMULATOR_PLANTS; i++)
+        {
+            float expected = (i % SIMULATOR_DELAYS < step) ? 1.0f : 0.0f;
+
+            mismatches += (plants.OutputGet(i) != expected);
+        }
+    }
+
+    PID_TEST_CHECK(mismatches == 0);
+}
+
+//
+// A plant added between steps with a longer delay than any before it makes 
+// the history deeper. The plant already there has to carry on as in a bank 
+// that had both from the start, and the new one starts at rest.
+//
+static void
+AddBetweenStepsCheck()
+{
+    PIDPlantBank grown(SIMULATOR_SAMPLE_TIME);
+    PIDPlantBank whole(SIMULATOR_SAMPLE_TIME);
+    float control[2];
+
+    grown.AddFirstOrder(1.0f, 0.0f, DeadTimeGet(3));
+    whole.AddFirstOrder(1.0f, 0.0f, DeadTimeGet(3));
+    whole.AddFirstOrder(1.0f, 0.0f, DeadTimeGet(5));
+
+    for(int step = 0; step < 20; step++)
+    {
+        if(step == 4)
+        {
+            grown.AddFirstOrder(1.0f, 0.0f, DeadTimeGet(5));
+        }
+
+        // The second plant of whole sits at 0 until grown has it too
+        control[0] = (float)(step + 1);
+        control[1] = (step < 4) ? 0.0f : (float)(100 + step);
+        grown.Step(control);
+        whole.Step(control);
+
+        PID_TEST_CHECK(grown.OutputGet(0) == whole.OutputGet(0));
+        PID_TEST_CHECK(grown.OutputGet(0) == ((step >= 3) ? (float)(step - 2) : 0.0f));
+        if(step >= 4)
+        {
+            PID_TEST_CHECK(grown.OutputGet(1) == whole.OutputGet(1));
+        }
+    }
+}
@@ -0,0 +1,157 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks the timed PIDCompute: intervals up to
+// PID_CORE_INTERVAL_MAX sample times scale the integral and derivative terms, a
+// longer gap is a restart in which the integrator takes one nominal step and the
+// derivative is not taken across the gap, and the intervals after it scale
+// again.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <stdint.h>
+#include "pid_controller.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+//
+// 10 ms in microseconds, the sample time of the controllers below
+//
+#define TIMED_SAMPLE_MICROS         10000u
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void IntegralCheck(uint32_t start);
+static void DerivativeCheck();
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    IntegralCheck(0);
+    IntegralCheck(UINT32_MAX - 5 * TIMED_SAMPLE_MICROS);
+    DerivativeCheck();
+
+    return PIDTestResult("pid_test_timed");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// A pure integrator with a constant error of 1 steps by 0.01 per sample time.
+// Started close to the wrap of the clock, the intervals wrap too.
+//
+static void
+IntegralCheck(uint32_t start)
+{
+    PIDControl pid(0.0f, 1.0f, 0.0f, 0.01f, -100.0f, 100.0f, AUTOMATIC, DIRECT);
+    uint32_t now = start;
+    float before;
+
+    pid.PIDSetpointSet(1.0f);
+    for(int tick = 0; tick < 10; tick++)
+    {
+        PID_TEST_CHECK(pid.PIDCompute(now));
+        now += TIMED_SAMPLE_MICROS;
+    }
+    PID_TEST_CHECK(fabsf(pid.PIDOutputGet() - 0.1f) < 1e-4f);
+
+    // Over polling computes nothing
+    PID_TEST_CHECK(!pid.PIDCompute(now - TIMED_SAMPLE_MICROS + TIMED_SAMPLE_MICROS / 4));
+
+    // Three sample times give three steps
+    now += 2 * TIMED_SAMPLE_MICROS;
+    before = pid.PIDOutputGet();
+    PID_TEST_CHECK(pid.PIDCompute(now));
+    PID_TEST_CHECK(fabsf(pid.PIDOutputGet() - before - 0.03f) < 1e-4f);
+
+    // Ten seconds are a restart and give one step, not a thousand
+    now += 1000 * TIMED_SAMPLE_MICROS;
+    before = pid.PIDOutputGet();
+    PID_TEST_CHECK(pid.PIDCompute(now));
+    PID_TEST_CHECK(fabsf(pid.PIDOutputGet() - before - 0.01f) < 1e-4f);
+
+    // The interval after the restart scales again
+    now += 2 * TIMED_SAMPLE_MICROS;
+    before = pid.PIDOutputGet();
+    PID_TEST_CHECK(pid.PIDCompute(now));
+    PID_TEST_CHECK(fabsf(pid.PIDOutputGet() - before - 0.02f) < 1e-4f);
+}
+
+//
+// A pure derivative on a ramp of the input. Within the cap the derivative is
+// the slope over the real interval; across a restart there is none.
+//
+static void
+DerivativeCheck()
+{
+    PIDControl pid(0.0f, 0.0f, 0.01f, 0.01f, -100.0f, 100.0f, AUTOMATIC, DIRECT);
+    uint32_t now = 0;
+
+    for(int tick = 0; tick < 10; tick++)
+    {
+        pid.PIDInputSet(0.1f * (float)tick);
+        PID_TEST_CHECK(pid.PIDCompute(now));
+        now += TIMED_SAMPLE_MICROS;
+    }
+
+    // The input moves 0.1 per sample time, so kd times its rate is -0.1
+    PID_TEST_CHECK(fabsf(pid.PIDOutputGet() + 0.1f) < 1e-4f);
+
+    // The same rate over four sample times
+    now += 3 * TIMED_SAMPLE_MICROS;
+    pid.PIDInputSet(pid.PIDInputGet() + 0.4f);
+    PID_TEST_CHECK(pid.PIDCompute(now));
+    PID_TEST_CHECK(fabsf(pid.PIDOutputGet() + 0.1f) < 1e-4f);
+
+    // The input moved a lot over the gap, but the derivative starts over
+    now += 500 * TIMED_SAMPLE_MICROS;
+    pid.PIDInputSet(50.0f);
+    PID_TEST_CHECK(pid.PIDCompute(now));
+    PID_TEST_CHECK(pid.PIDOutputGet() == 0.0f);
+
+    now += TIMED_SAMPLE_MICROS;
+    pid.PIDInputSet(50.1f);
+    PID_TEST_CHECK(pid.PIDCompute(now));
+    PID_TEST_CHECK(fabsf(pid.PIDOutputGet() + 0.1f) < 1e-3f);
+}
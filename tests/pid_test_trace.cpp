@@ -0,0 +1,258 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks that a columnar trace, raw or delta compressed, reads back
+// bit for bit what was written across chunk boundaries, and that replaying it
+// through PIDControl objects or a PIDBank writes the outputs the controllers
+// give when stepped by hand.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_controller.h"
+#include "pid_trace.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define TRACE_CHANNELS              3
+#define TRACE_CHUNK_SAMPLES         64
+#define TRACE_SAMPLES               250
+
+//
+// A sample of every channel, as written
+//
+struct
+TraceSample
+{
+    int64_t timestamp;
+    float inputs[TRACE_CHANNELS];
+    float setpoints[TRACE_CHANNELS];
+    float outputs[TRACE_CHANNELS];
+};
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static std::vector<TraceSample> SamplesMake();
+static PIDControl ControllerMake(size_t channel);
+static void TraceRoundTrip(const char *path, bool delta);
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : "pid_test_trace.bin";
+
+    TraceRoundTrip(path, false);
+    TraceRoundTrip(path, true);
+    remove(path);
+
+    return PIDTestResult("pid_test_trace");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// Slow signals, which delta compress, with a jittery clock, a negative zero 
+// and a jump thrown in
+//
+static std::vector<TraceSample> 
+SamplesMake()
+{
+    std::vector<TraceSample> samples(TRACE_SAMPLES);
+
+    for(size_t t = 0; t < TRACE_SAMPLES; t++)
+    {
+        samples[t].timestamp = 1000000 + 10000 * (int64_t)t + (int64_t)(t % 7);
+
+        for(size_t c = 0; c < TRACE_CHANNELS; c++)
+        {
+            samples[t].inputs[c] = 0.5f * sinf(0.05f * (float)t + (float)c);
+            samples[t].setpoints[c] = (t < TRACE_SAMPLES / 2) ? 0.25f : -0.5f;
+            samples[t].outputs[c] = 0.0f;
+        }
+    }
+    samples[10].inputs[0] = -0.0f;
+    samples[100].inputs[1] = 1.0e30f;
+
+    return samples;
+}
+
+static PIDControl
+ControllerMake(size_t channel)
+{
+    return PIDControl(1.0f + 0.5f * (float)channel, 2.0f, 0.01f, 0.01f, -1.0f, 1.0f, 
+                      AUTOMATIC, DIRECT);
+}
+
+static void
+TraceRoundTrip(const char *path, bool delta)
+{
+    std::vector<TraceSample> samples = SamplesMake();
+    std::vector<int64_t> timestampScratch(TRACE_CHUNK_SAMPLES);
+    std::vector<float> scratch(TRACE_CHUNK_SAMPLES);
+    std::vector<PIDControl> replayed, stepped;
+    PIDTraceWriter writer;
+    PIDTraceReader reader;
+    PIDBank bank;
+    int mismatches = 0;
+    size_t sample = 0;
+
+    PID_TEST_CHECK(writer.Open(path, TRACE_CHANNELS, TRACE_CHUNK_SAMPLES, delta));
+    for(const TraceSample &s : samples)
+    {
+        PID_TEST_CHECK(writer.Append(s.timestamp, s.inputs, s.setpoints, nullptr));
+    }
+    PID_TEST_CHECK(writer.Close());
+
+    // Everything reads back as written
+    PID_TEST_CHECK(reader.Open(path, true));
+    PID_TEST_CHECK(reader.ChannelsGet() == TRACE_CHANNELS);
+    PID_TEST_CHECK(reader.SamplesGet() == TRACE_SAMPLES);
+    PID_TEST_CHECK(reader.ChunkCountGet() == 
+                   (TRACE_SAMPLES + TRACE_CHUNK_SAMPLES - 1) / TRACE_CHUNK_SAMPLES);
+
+    for(size_t chunk = 0; chunk < reader.ChunkCountGet(); chunk++)
+    {
+        uint32_t count = reader.ChunkSamplesGet(chunk);
+        const int64_t *timestamps = reader.TimestampRead(chunk, timestampScratch.data());
+
+        PID_TEST_CHECK(timestamps != nullptr);
+        for(uint32_t t = 0; t < count && timestamps; t++)
+        {
+            mismatches += timestamps[t] != samples[sample + t].timestamp;
+        }
+
+        for(uint32_t c = 0; c < TRACE_CHANNELS; c++)
+        {
+            const float *inputs = reader.ColumnRead(chunk, PID_TRACE_INPUT, c, scratch.data());
+
+            PID_TEST_CHECK(inputs != nullptr);
+            for(uint32_t t = 0; t < count && inputs; t++)
+            {
+                mismatches += !PIDTestSame(inputs[t], samples[sample + t].inputs[c]);
+            }
+
+            const float *setpoints = reader.ColumnRead(chunk, PID_TRACE_SETPOINT, c, 
+                                                       scratch.data());
+
+            PID_TEST_CHECK(setpoints != nullptr);
+            for(uint32_t t = 0; t < count && setpoints; t++)
+            {
+                mismatches += !PIDTestSame(setpoints[t], samples[sample + t].setpoints[c]);
+            }
+        }
+        sample += count;
+    }
+    PID_TEST_CHECK(sample == TRACE_SAMPLES);
+    PID_TEST_CHECK(mismatches == 0);
+
+    // Replay through objects and compare with stepping the same controllers by
+    // hand
+    for(size_t c = 0; c < TRACE_CHANNELS; c++)
+    {
+        replayed.push_back(ControllerMake(c));
+        stepped.push_back(ControllerMake(c));
+        bank.PIDAdd(1.0f + 0.5f * (float)c, 2.0f, 0.01f, 0.01f, -1.0f, 1.0f, AUTOMATIC, 
+                    DIRECT);
+    }
+    for(TraceSample &s : samples)
+    {
+        for(size_t c = 0; c < TRACE_CHANNELS; c++)
+        {
+            stepped[c].PIDSetpointSet(s.setpoints[c]);
+            stepped[c].PIDInputSet(s.inputs[c]);
+            stepped[c].PIDCompute();
+            s.outputs[c] = stepped[c].PIDOutputGet();
+        }
+    }
+
+    PID_TEST_CHECK(PIDTraceReplay(reader, replayed.data(), false));
+    mismatches = 0;
+    sample = 0;
+    for(size_t chunk = 0; chunk < reader.ChunkCountGet(); chunk++)
+    {
+        uint32_t count = reader.ChunkSamplesGet(chunk);
+
+        for(uint32_t c = 0; c < TRACE_CHANNELS; c++)
+        {
+            const float *outputs = reader.OutputColumn(chunk, c);
+
+            for(uint32_t t = 0; t < count; t++)
+            {
+                mismatches += !PIDTestSame(outputs[t], samples[sample + t].outputs[c]);
+            }
+        }
+        sample += count;
+    }
+    PID_TEST_CHECK(mismatches == 0);
+
+    // And through a bank, whose outputs then end up in the file
+    PID_TEST_CHECK(PIDTraceReplay(reader, bank));
+    PID_TEST_CHECK(reader.Close());
+    PID_TEST_CHECK(reader.Open(path, false));
+
+    mismatches = 0;
+    sample = 0;
+    for(size_t chunk = 0; chunk < reader.ChunkCountGet(); chunk++)
+    {
+        uint32_t count = reader.ChunkSamplesGet(chunk);
+
+        for(uint32_t c = 0; c < TRACE_CHANNELS; c++)
+        {
+            const float *outputs = reader.ColumnRead(chunk, PID_TRACE_OUTPUT, c, 
+                                                     scratch.data());
+
+            PID_TEST_CHECK(outputs != nullptr);
+            for(uint32_t t = 0; t < count && outputs; t++)
+            {
+                mismatches += !PIDTestSame(outputs[t], samples[sample + t].outputs[c]);
+            }
+        }
+        sample += count;
+    }
+    PID_TEST_CHECK(mismatches == 0);
+    PID_TEST_CHECK(reader.Close());
+}
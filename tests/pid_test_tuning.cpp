@@ -0,0 +1,168 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Checks PIDTuningChannel: a set the controller would take only
+// part of is refused whole and leaves the controller as it was, and sets
+// published from another thread are always read whole.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <math.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include "pid_controller.h"
+#include "pid_tuning_channel.h"
+#include "pid_test.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define TUNING_PUBLISHES            20000
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static bool OutputLimitGet(PIDControl &pid, float limit);
+static void RefusedCheck();
+static void ConcurrentCheck();
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main()
+{
+    RefusedCheck();
+    ConcurrentCheck();
+
+    return PIDTestResult("pid_test_tuning");
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+//
+// Tells whether a large error drives the controller's output to limit, which
+// is how its output limits show
+//
+static bool
+OutputLimitGet(PIDControl &pid, float limit)
+{
+    pid.PIDSetpointSet(1.0e6f);
+    pid.PIDInputSet(0.0f);
+    pid.PIDCompute();
+
+    return pid.PIDOutputGet() == limit;
+}
+
+static void
+RefusedCheck()
+{
+    PIDControl pid(1.0f, 0.0f, 0.0f, 0.01f, -10.0f, 10.0f, AUTOMATIC, DIRECT);
+    PIDTuningChannel channel;
+    PIDTuning good = { 2.0f, 0.5f, 0.1f, -5.0f, 5.0f };
+    PIDTuning limits = { 7.0f, 7.0f, 7.0f, 3.0f, 3.0f };
+    PIDTuning gain = { -1.0f, 7.0f, 7.0f, -1.0f, 1.0f };
+    PIDTuning notANumber = { NAN, 7.0f, 7.0f, -1.0f, 1.0f };
+
+    PID_TEST_CHECK(channel.Publish(good) == 1);
+    PID_TEST_CHECK(channel.Poll(pid));
+    PID_TEST_CHECK(pid.PIDKpGet() == 2.0f);
+    PID_TEST_CHECK(OutputLimitGet(pid, 5.0f));
+
+    // Each of these would have been taken in part by the controller
+    PID_TEST_CHECK(channel.Publish(limits) == 0);
+    PID_TEST_CHECK(channel.Publish(gain) == 0);
+    PID_TEST_CHECK(channel.Publish(notANumber) == 0);
+    PID_TEST_CHECK(!channel.Poll(pid));
+    PID_TEST_CHECK(pid.PIDKpGet() == 2.0f);
+    PID_TEST_CHECK(pid.PIDKiGet() == 0.5f);
+    PID_TEST_CHECK(pid.PIDKdGet() == 0.1f);
+    PID_TEST_CHECK(OutputLimitGet(pid, 5.0f));
+
+    // The versions carry on from the last set published
+    good.kp = 3.0f;
+    good.outMax = 6.0f;
+    PID_TEST_CHECK(channel.Publish(good) == 2);
+    PID_TEST_CHECK(channel.Poll(pid));
+    PID_TEST_CHECK(pid.PIDKpGet() == 3.0f);
+    PID_TEST_CHECK(OutputLimitGet(pid, 6.0f));
+}
+
+//
+// Set k has every field made from k, so a set read in part is told apart 
+// from a whole one
+//
+static void
+ConcurrentCheck()
+{
+    PIDTuningChannel channel;
+    std::atomic<bool> done(false);
+    uint32_t torn = 0, last = 0, backwards = 0;
+
+    std::thread publisher([&]()
+    {
+        for(int k = 1; k <= TUNING_PUBLISHES; k++)
+        {
+            PIDTuning tuning = { (float)k, 2.0f * k, 3.0f * k, -(float)k, (float)k };
+
+            channel.Publish(tuning);
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    while(!done.load(std::memory_order_acquire))
+    {
+        PIDTuning tuning;
+        uint32_t version;
+
+        if(!channel.Read(tuning, version))
+        {
+            continue;
+        }
+
+        torn += (tuning.ki != 2.0f * tuning.kp || tuning.kd != 3.0f * tuning.kp ||
+                 tuning.outMin != -tuning.kp || tuning.outMax != tuning.kp ||
+                 tuning.kp != (float)version);
+        backwards += (version < last);
+        last = version;
+    }
+    publisher.join();
+
+    PID_TEST_CHECK(torn == 0);
+    PID_TEST_CHECK(backwards == 0);
+}
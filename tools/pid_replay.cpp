@@ -0,0 +1,386 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Replays recorded plant data through the controllers, far faster
+// than real time. Memory maps a columnar trace (see C++/pid_trace.h), runs every
+// channel through PIDComputeBlock, the timed PIDCompute or a PIDBank and writes
+// the outputs into the trace's output columns in place. Can also build a trace
+// from a CSV file first, and dump a replayed trace back to CSV.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "pid_controller.h"
+#include "pid_bank.h"
+#include "pid_trace.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define REPLAY_DEFAULT_CHUNK_SAMPLES    65536
+
+//
+// The settings every channel's controller is created with
+//
+struct
+ReplaySettings
+{
+    float kp;
+    float ki;
+    float kd;
+    float sampleTime;
+    float outMin;
+    float outMax;
+    PIDDirection direction;
+};
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void Usage(const char *program);
+static bool CsvConvert(const char *csvPath, const char *tracePath, uint32_t chunkSamples,
+                       bool delta);
+static bool CsvDump(PIDTraceReader &trace, const char *csvPath);
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main(int argc, char **argv)
+{
+    const char *tracePath = nullptr;
+    const char *csvIn = nullptr;
+    const char *csvOut = nullptr;
+    uint32_t chunkSamples = REPLAY_DEFAULT_CHUNK_SAMPLES;
+    bool delta = false;
+    bool useBank = false;
+    bool timed = false;
+    ReplaySettings settings = { 1.0f, 0.0f, 0.0f, 0.001f, -1.0f, 1.0f, DIRECT };
+    PIDTraceReader trace;
+    bool ok;
+
+    for(int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if(strcmp(argv[i], "--from-csv") == 0 && hasValue)
+        {
+            csvIn = argv[++i];
+        }
+        else if(strcmp(argv[i], "--to-csv") == 0 && hasValue)
+        {
+            csvOut = argv[++i];
+        }
+        else if(strcmp(argv[i], "--chunk") == 0 && hasValue)
+        {
+            chunkSamples = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if(strcmp(argv[i], "--kp") == 0 && hasValue)
+        {
+            settings.kp = strtof(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--ki") == 0 && hasValue)
+        {
+            settings.ki = strtof(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--kd") == 0 && hasValue)
+        {
+            settings.kd = strtof(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--sample-time") == 0 && hasValue)
+        {
+            settings.sampleTime = strtof(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--min") == 0 && hasValue)
+        {
+            settings.outMin = strtof(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--max") == 0 && hasValue)
+        {
+            settings.outMax = strtof(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--reverse") == 0)
+        {
+            settings.direction = REVERSE;
+        }
+        else if(strcmp(argv[i], "--delta") == 0)
+        {
+            delta = true;
+        }
+        else if(strcmp(argv[i], "--bank") == 0)
+        {
+            useBank = true;
+        }
+        else if(strcmp(argv[i], "--timed") == 0)
+        {
+            timed = true;
+        }
+        else if(argv[i][0] != '-' && !tracePath)
+        {
+            tracePath = argv[i];
+        }
+        else
+        {
+            Usage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+
+    if(!tracePath || chunkSamples == 0 || (useBank && timed))
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    if(csvIn && !CsvConvert(csvIn, tracePath, chunkSamples, delta))
+    {
+        fprintf(stderr, "could not convert %s into %s\n", csvIn, tracePath);
+        return 1;
+    }
+
+    if(!trace.Open(tracePath, true))
+    {
+        fprintf(stderr, "%s is not a trace that can be opened for writing\n", tracePath);
+        return 1;
+    }
+
+    uint32_t channels = trace.ChannelsGet();
+    auto start = std::chrono::steady_clock::now();
+
+    if(useBank)
+    {
+        PIDBank bank;
+
+        for(uint32_t channel = 0; channel < channels; channel++)
+        {
+            bank.PIDAdd(settings.kp, settings.ki, settings.kd, settings.sampleTime,
+                        settings.outMin, settings.outMax, AUTOMATIC, settings.direction);
+        }
+        ok = PIDTraceReplay(trace, bank);
+    }
+    else
+    {
+        std::vector<PIDControl> controllers;
+
+        controllers.reserve(channels);
+        for(uint32_t channel = 0; channel < channels; channel++)
+        {
+            controllers.emplace_back(settings.kp, settings.ki, settings.kd,
+                                     settings.sampleTime, settings.outMin, settings.outMax,
+                                     AUTOMATIC, settings.direction);
+        }
+        ok = PIDTraceReplay(trace, controllers.data(), timed);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                   start).count();
+    uint64_t updates = trace.SamplesGet() * channels;
+
+    if(!ok)
+    {
+        fprintf(stderr, "%s has a column that does not decode\n", tracePath);
+        return 1;
+    }
+
+    printf("replayed %llu samples of %u channels in %zu chunks: %.3f s, %.3e updates/s\n",
+           (unsigned long long)trace.SamplesGet(), channels, trace.ChunkCountGet(), seconds,
+           seconds > 0.0 ? (double)updates / seconds : 0.0);
+
+    if(csvOut && !CsvDump(trace, csvOut))
+    {
+        fprintf(stderr, "could not write %s\n", csvOut);
+        return 1;
+    }
+
+    if(!trace.Close())
+    {
+        fprintf(stderr, "could not write the outputs back to %s\n", tracePath);
+        return 1;
+    }
+
+    return 0;
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+Usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [options] <trace>\n"
+            "  --from-csv <file>   first build <trace> from a CSV of time in seconds\n"
+            "                      followed by an input and a setpoint per channel\n"
+            "  --chunk <n>         samples per chunk when building, default %u\n"
+            "  --delta             delta compress the columns when building\n"
+            "  --bank              replay through a PIDBank instead of PIDComputeBlock\n"
+            "  --timed             replay through the timed PIDCompute with the\n"
+            "                      recorded timestamps\n"
+            "  --kp, --ki, --kd, --sample-time, --min, --max <value>\n"
+            "  --reverse           settings of every channel's controller\n"
+            "  --to-csv <file>     write the replayed trace out as CSV\n",
+            program, REPLAY_DEFAULT_CHUNK_SAMPLES);
+}
+
+//
+// Lines that do not start with a number, such as a header, are skipped. The
+// first data line sets the number of channels.
+//
+static bool
+CsvConvert(const char *csvPath, const char *tracePath, uint32_t chunkSamples, bool delta)
+{
+    FILE *file = fopen(csvPath, "r");
+    PIDTraceWriter writer;
+    std::vector<float> inputs, setpoints, fields;
+    char line[65536];
+    bool ok = file != nullptr;
+
+    while(ok && fgets(line, sizeof(line), file))
+    {
+        char *cursor = line;
+        char *end;
+        double time = strtod(cursor, &end);
+
+        if(end == cursor)
+        {
+            continue;
+        }
+
+        fields.clear();
+        for(cursor = end; *cursor == ','; cursor = end)
+        {
+            fields.push_back(strtof(cursor + 1, &end));
+            if(end == cursor + 1)
+            {
+                break;
+            }
+        }
+
+        if(inputs.empty())
+        {
+            if(fields.empty() || fields.size() % 2 != 0)
+            {
+                ok = false;
+                break;
+            }
+            inputs.resize(fields.size() / 2);
+            setpoints.resize(fields.size() / 2);
+            ok = writer.Open(tracePath, (uint32_t)inputs.size(), chunkSamples, delta);
+        }
+
+        if(fields.size() != 2 * inputs.size())
+        {
+            ok = false;
+            break;
+        }
+
+        for(size_t channel = 0; channel < inputs.size(); channel++)
+        {
+            inputs[channel] = fields[2 * channel];
+            setpoints[channel] = fields[2 * channel + 1];
+        }
+        ok = ok && writer.Append((int64_t)llround(time * 1e6), inputs.data(),
+                                 setpoints.data(), nullptr);
+    }
+
+    if(file)
+    {
+        fclose(file);
+    }
+
+    return writer.Close() && ok;
+}
+
+static bool
+CsvDump(PIDTraceReader &trace, const char *csvPath)
+{
+    FILE *file = fopen(csvPath, "w");
+    uint32_t channels = trace.ChannelsGet();
+    std::vector<int64_t> timeScratch(trace.ChunkSamplesGet());
+    std::vector<float> scratch(2 * (size_t)channels * trace.ChunkSamplesGet());
+    std::vector<const float *> columns(3 * (size_t)channels);
+    bool ok = file != nullptr;
+
+    if(ok)
+    {
+        fprintf(file, "time");
+        for(uint32_t channel = 0; channel < channels; channel++)
+        {
+            fprintf(file, ",input%u,setpoint%u,output%u", channel, channel, channel);
+        }
+        fprintf(file, "\n");
+    }
+
+    for(size_t chunk = 0; ok && chunk < trace.ChunkCountGet(); chunk++)
+    {
+        const int64_t *timestamps = trace.TimestampRead(chunk, timeScratch.data());
+
+        ok = timestamps != nullptr;
+        for(uint32_t channel = 0; ok && channel < channels; channel++)
+        {
+            float *space = &scratch[2 * (size_t)channel * trace.ChunkSamplesGet()];
+
+            columns[3 * channel] = trace.ColumnRead(chunk, PID_TRACE_INPUT, channel, space);
+            columns[3 * channel + 1] = trace.ColumnRead(chunk, PID_TRACE_SETPOINT, channel,
+                                                        space + trace.ChunkSamplesGet());
+            columns[3 * channel + 2] = trace.OutputColumn(chunk, channel);
+            ok = columns[3 * channel] && columns[3 * channel + 1] && columns[3 * channel + 2];
+        }
+
+        for(uint32_t i = 0; ok && i < trace.ChunkSamplesGet(chunk); i++)
+        {
+            fprintf(file, "%.6f", (double)timestamps[i] * 1e-6);
+            for(size_t column = 0; column < columns.size(); column++)
+            {
+                fprintf(file, ",%.9g", (double)columns[column][i]);
+            }
+            fprintf(file, "\n");
+        }
+    }
+
+    if(file)
+    {
+        ok = fclose(file) == 0 && ok;
+    }
+
+    return ok;
+}
@@ -0,0 +1,361 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Closes thousands of loops of PID controllers around simulated
+// plants, first and second order lags with dead time, for millions of loop
+// steps, and prints the control quality next to the throughput and the memory
+// per loop. With --min-rate or --max-iae it fails when the run is slower or
+// worse than that, so that CI can gate on it.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "pid_bank.h"
+#include "pid_controller.h"
+#include "pid_simulator.h"
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define SIMULATE_DEFAULT_LOOPS      10000
+#define SIMULATE_DEFAULT_STEPS      1000
+#define SIMULATE_DEFAULT_SAMPLE     0.001f
+
+typedef enum
+{
+    SIMULATE_FIRST_ORDER,
+    SIMULATE_SECOND_ORDER,
+    SIMULATE_MIXED
+}
+SimulateModel;
+
+//
+// A plant and the gains it is tuned with
+//
+struct
+SimulateLoop
+{
+    bool secondOrder;
+    float gain;
+    float timeConstant;
+    float naturalFrequency;
+    float damping;
+    float deadTime;
+    float kp;
+    float ki;
+    float kd;
+};
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void Usage(const char *program);
+static SimulateLoop LoopMake(size_t index, SimulateModel model, float deadTime);
+static bool ReportJson(const PIDSimulationReport &report, bool objects, const char *path);
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main(int argc, char **argv)
+{
+    size_t loops = SIMULATE_DEFAULT_LOOPS;
+    uint64_t steps = SIMULATE_DEFAULT_STEPS;
+    float sampleTime = SIMULATE_DEFAULT_SAMPLE;
+    float deadTime = 0.005f;
+    SimulateModel model = SIMULATE_MIXED;
+    bool objects = false;
+    const char *jsonPath = nullptr;
+    double minRate = 0.0;
+    double maxIae = 0.0;
+    bool ok;
+
+    for(int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if(strcmp(argv[i], "--loops") == 0 && hasValue)
+        {
+            loops = (size_t)strtoull(argv[++i], nullptr, 10);
+        }
+        else if(strcmp(argv[i], "--steps") == 0 && hasValue)
+        {
+            steps = strtoull(argv[++i], nullptr, 10);
+        }
+        else if(strcmp(argv[i], "--sample-time") == 0 && hasValue)
+        {
+            sampleTime = strtof(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--dead-time") == 0 && hasValue)
+        {
+            deadTime = strtof(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--model") == 0 && hasValue)
+        {
+            i++;
+            if(strcmp(argv[i], "first") == 0)
+            {
+                model = SIMULATE_FIRST_ORDER;
+            }
+            else if(strcmp(argv[i], "second") == 0)
+            {
+                model = SIMULATE_SECOND_ORDER;
+            }
+            else if(strcmp(argv[i], "mixed") == 0)
+            {
+                model = SIMULATE_MIXED;
+            }
+            else
+            {
+                Usage(argv[0]);
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--objects") == 0)
+        {
+            objects = true;
+        }
+        else if(strcmp(argv[i], "--json") == 0 && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else if(strcmp(argv[i], "--min-rate") == 0 && hasValue)
+        {
+            minRate = strtod(argv[++i], nullptr);
+        }
+        else if(strcmp(argv[i], "--max-iae") == 0 && hasValue)
+        {
+            maxIae = strtod(argv[++i], nullptr);
+        }
+        else
+        {
+            Usage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+
+    if(loops == 0 || steps == 0 || !(sampleTime > 0.0f) || deadTime < 0.0f)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    // Every loop steps from rest at 0 to a setpoint of 1
+    PIDPlantBank plants(sampleTime, loops);
+    PIDSimulator simulator(plants);
+    PIDBank bank(objects ? 0 : loops);
+    std::vector<PIDControl> pids;
+
+    if(objects)
+    {
+        pids.reserve(loops);
+    }
+
+    for(size_t i = 0; i < loops; i++)
+    {
+        SimulateLoop loop = LoopMake(i, model, deadTime);
+
+        if(loop.secondOrder)
+        {
+            plants.AddSecondOrder(loop.gain, loop.naturalFrequency, loop.damping, 
+                                  loop.deadTime);
+        }
+        else
+        {
+            plants.AddFirstOrder(loop.gain, loop.timeConstant, loop.deadTime);
+        }
+
+        if(objects)
+        {
+            pids.emplace_back(loop.kp, loop.ki, loop.kd, sampleTime, -10.0f, 10.0f, 
+                              AUTOMATIC, DIRECT);
+            pids.back().PIDSetpointSet(1.0f);
+        }
+        else
+        {
+            bank.PIDAdd(loop.kp, loop.ki, loop.kd, sampleTime, -10.0f, 10.0f, 
+                        AUTOMATIC, DIRECT);
+            bank.PIDSetpointSet(i, 1.0f);
+        }
+    }
+
+    ok = objects ? simulator.Run(pids.data(), pids.size(), steps) : simulator.Run(bank, steps);
+    if(!ok)
+    {
+        fprintf(stderr, "could not run the simulation\n");
+        return 1;
+    }
+
+    PIDSimulationReport report = simulator.ReportGet();
+
+    printf("%zu loops x %llu steps of %g s through %s\n", report.loops, 
+           (unsigned long long)report.steps, (double)sampleTime, 
+           objects ? "PIDControl objects" : "a PIDBank");
+    printf("  %-22s %-14s  %-22s %s\n", "throughput", "", "control quality", "");
+    printf("  %-22s %-14.4g  %-22s %.6g\n", "loop steps/s/core", report.loopStepsPerSecond, 
+           "mean IAE", report.meanIae);
+    printf("  %-22s %-14.3f  %-22s %.6g\n", "ns per loop step", report.nsPerLoopStep, 
+           "max IAE", report.maxIae);
+    printf("  %-22s %-14zu  %-22s %.6g\n", "bytes per loop", report.bytesPerLoop, 
+           "mean ISE", report.meanIse);
+    printf("  %-22s %-14.3f  %-22s %.2f%%\n", "seconds", report.seconds, 
+           "max overshoot", 100.0 * report.maxOvershoot);
+    printf("  %-22s %-14s  %-22s %.4g s, %zu unsettled\n", "", "", "max settling time", 
+           (double)report.maxSettlingTime, report.unsettled);
+    printf("  %-22s %-14s  %-22s %.6g\n", "", "", "mean effort", report.meanEffort);
+
+    if(jsonPath != nullptr && !ReportJson(report, objects, jsonPath))
+    {
+        fprintf(stderr, "could not write %s\n", jsonPath);
+        return 1;
+    }
+
+    if(minRate > 0.0 && report.loopStepsPerSecond < minRate)
+    {
+        fprintf(stderr, "%.4g loop steps/s is below the gate of %.4g\n", 
+                report.loopStepsPerSecond, minRate);
+        return 2;
+    }
+
+    if(maxIae > 0.0 && report.maxIae > maxIae)
+    {
+        fprintf(stderr, "an IAE of %.6g is above the gate of %.6g\n", report.maxIae, maxIae);
+        return 2;
+    }
+
+    return 0;
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+Usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --loops <n>         loops to simulate, default %u\n"
+            "  --steps <n>         sample times to run every loop for, default %u\n"
+            "  --sample-time <s>   default %g\n"
+            "  --model first|second|mixed\n"
+            "                      plant models, default mixed\n"
+            "  --dead-time <s>     longest dead time, spread over the loops,\n"
+            "                      default 0.005\n"
+            "  --objects           control through PIDControl objects instead of a\n"
+            "                      PIDBank\n"
+            "  --json <file>       write the report as JSON, - for stdout\n"
+            "  --min-rate <n>      exit with 2 below n loop steps/s/core\n"
+            "  --max-iae <x>       exit with 2 if any loop's IAE is above x\n",
+            program, SIMULATE_DEFAULT_LOOPS, SIMULATE_DEFAULT_STEPS,
+            (double)SIMULATE_DEFAULT_SAMPLE);
+}
+
+//
+// Plants spread deterministically over a range of gains, lags and dead 
+// times, each tuned by the IMC rules with a closed loop time constant of the
+// plant's own lag plus its dead time, so that every loop settles without
+// overshooting much
+//
+static SimulateLoop
+LoopMake(size_t index, SimulateModel model, float deadTime)
+{
+    SimulateLoop loop;
+    float spread = (float)(index % 97) / 96.0f;
+
+    loop.secondOrder = (model == SIMULATE_SECOND_ORDER) || 
+                       (model == SIMULATE_MIXED && index % 2 == 1);
+    loop.gain = 0.5f + 1.5f * spread;
+    loop.timeConstant = 0.02f + 0.08f * (float)(index % 13) / 12.0f;
+    loop.naturalFrequency = 20.0f + 40.0f * (float)(index % 11) / 10.0f;
+    loop.damping = 0.4f + 0.8f * (float)(index % 7) / 6.0f;
+    loop.deadTime = deadTime * (float)(index % 5) / 4.0f;
+
+    if(loop.secondOrder)
+    {
+        float lambda = 1.0f / loop.naturalFrequency + loop.deadTime;
+        float ti = 2.0f * loop.damping / loop.naturalFrequency;
+        float td = 1.0f / (2.0f * loop.damping * loop.naturalFrequency);
+
+        loop.kp = ti / (loop.gain * 2.0f * lambda);
+        loop.ki = loop.kp / ti;
+        loop.kd = loop.kp * td;
+    }
+    else
+    {
+        float lambda = loop.timeConstant + loop.deadTime;
+
+        loop.kp = loop.timeConstant / (loop.gain * (lambda + loop.deadTime));
+        loop.ki = loop.kp / loop.timeConstant;
+        loop.kd = 0.0f;
+    }
+
+    return loop;
+}
+
+static bool
+ReportJson(const PIDSimulationReport &report, bool objects, const char *path)
+{
+    bool toStdout = (strcmp(path, "-") == 0);
+    FILE *file = toStdout ? stdout : fopen(path, "w");
+
+    if(file == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"controllers\": \"%s\",\n", objects ? "objects" : "bank");
+    fprintf(file, "  \"loops\": %zu,\n", report.loops);
+    fprintf(file, "  \"steps\": %llu,\n", (unsigned long long)report.steps);
+    fprintf(file, "  \"seconds\": %.9f,\n", report.seconds);
+    fprintf(file, "  \"loop_steps_per_second_per_core\": %.1f,\n", report.loopStepsPerSecond);
+    fprintf(file, "  \"ns_per_loop_step\": %.4f,\n", report.nsPerLoopStep);
+    fprintf(file, "  \"bytes_per_loop\": %zu,\n", report.bytesPerLoop);
+    fprintf(file, "  \"mean_iae\": %.9g,\n", report.meanIae);
+    fprintf(file, "  \"max_iae\": %.9g,\n", report.maxIae);
+    fprintf(file, "  \"mean_ise\": %.9g,\n", report.meanIse);
+    fprintf(file, "  \"max_overshoot\": %.9g,\n", (double)report.maxOvershoot);
+    fprintf(file, "  \"max_settling_time\": %.9g,\n", (double)report.maxSettlingTime);
+    fprintf(file, "  \"unsettled\": %zu,\n", report.unsettled);
+    fprintf(file, "  \"mean_effort\": %.9g\n", report.meanEffort);
+    fprintf(file, "}\n");
+
+    return toStdout ? (fflush(file) == 0) : (fclose(file) == 0);
+}
@@ -0,0 +1,517 @@
+//*********************************************************************************
+// Arduino PID Library Version 1.0.1 Modified Version for C++
+// Platform Independent
+//
+// Revision: 1.1
+//
+// Description: Measures the worst case execution time of one controller update.
+// Times every call of PIDComputeConstantTime, or of PIDCompute to compare, with
+// the serialized time stamp counter over a billion calls on inputs chosen to be
+// as hard as possible: saturating steps, sign flips, subnormals and controllers
+// in every mode and anti-windup strategy. Reports the minimum, maximum and tail
+// percentiles from a histogram, so nothing is stored per sample. Built
+// without exceptions, so that nothing it calls can throw.
+//
+// For a detailed explanation of the theory behind this library, go to:
+// http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+//
+// Revisions can be found here:
+// https://github.com/tcleg
+//
+// Modified by: Trent Cleghorn , <trentoncleghorn@gmail.com>
+//
+// Copyright (C) Brett Beauregard , <br3ttb@gmail.com>
+//
+//                                 GPLv3 License
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+// PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//*********************************************************************************
+
+//*********************************************************************************
+// Headers
+//*********************************************************************************
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "pid_controller.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define WCET_CYCLES 1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+    #include <pmmintrin.h>
+#endif
+
+#if defined(__linux__)
+    #include <sched.h>
+    #include <sys/mman.h>
+#endif
+
+//*********************************************************************************
+// Macros and Globals
+//*********************************************************************************
+
+#define WCET_DEFAULT_ITERATIONS     1000000000ull
+
+// Inputs are cycled through from a table of this many, a power of two
+#define WCET_INPUTS                 4096
+
+// Times below this are counted one by one, those above in powers of two
+#define WCET_DIRECT_BUCKETS         4096
+#define WCET_LOG_BUCKETS            64
+
+//
+// The controller under test. Real time code runs without instrumentation
+// whatever PID_INSTRUMENTATION says.
+//
+typedef BasicPIDControl<float, PIDInstrumentationNone> WcetControl;
+
+//
+// One sample of the adversarial input sequence
+//
+struct
+WcetInput
+{
+    float input;
+    float setpoint;
+};
+
+//
+// Times of every timed call, without storing any of them
+//
+struct
+WcetHistogram
+{
+    uint64_t direct[WCET_DIRECT_BUCKETS];
+    uint64_t log[WCET_LOG_BUCKETS];
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+};
+
+static WcetHistogram histogram;
+static WcetInput inputs[WCET_INPUTS];
+
+//*********************************************************************************
+// Prototypes
+//*********************************************************************************
+
+static void Usage(const char *program);
+static void InputsBuild();
+static void ControllersBuild(std::vector<WcetControl> &controllers, size_t count);
+static uint64_t OverheadCalibrate();
+static void HistogramAdd(uint64_t time);
+static uint64_t HistogramPercentile(double fraction);
+
+//*********************************************************************************
+// Private Inline Functions
+//*********************************************************************************
+
+//
+// The clock is serialized on both sides so that the update is neither started
+// before the first read nor still running at the second. The empty asm keeps
+// the compiler from moving the update's loads and stores across either.
+//
+static inline uint64_t
+TimerStart()
+{
+#if defined(WCET_CYCLES)
+    uint64_t time;
+
+    _mm_lfence();
+    time = __rdtsc();
+    _mm_lfence();
+    #if defined(__GNUC__)
+        __asm__ __volatile__("" ::: "memory");
+    #endif
+    return time;
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static inline uint64_t
+TimerStop()
+{
+#if defined(WCET_CYCLES)
+    unsigned processor;
+    uint64_t time;
+
+    #if defined(__GNUC__)
+        __asm__ __volatile__("" ::: "memory");
+    #endif
+    time = __rdtscp(&processor);
+    _mm_lfence();
+    return time;
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+//*********************************************************************************
+// Main
+//*********************************************************************************
+
+int
+main(int argc, char **argv)
+{
+    static const double percentiles[] = { 0.5, 0.99, 0.999, 0.9999, 0.99999 };
+    static const char *const percentileNames[] = { "p50", "p99", "p99.9", "p99.99", 
+                                                   "p99.999" };
+    const size_t controllerCount = 8;
+    std::vector<WcetControl> controllers;
+    uint64_t iterations = WCET_DEFAULT_ITERATIONS;
+    bool constantTime = true;
+    bool realTime = false;
+    bool flushToZero = false;
+    int cpu = -1;
+    uint64_t overhead;
+    float checksum = 0.0f;
+
+    for(int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if(strcmp(argv[i], "--iterations") == 0 && hasValue)
+        {
+            iterations = strtoull(argv[++i], nullptr, 10);
+        }
+        else if(strcmp(argv[i], "--cpu") == 0 && hasValue)
+        {
+            cpu = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--path") == 0 && hasValue)
+        {
+            i++;
+            if(strcmp(argv[i], "rt") != 0 && strcmp(argv[i], "compute") != 0)
+            {
+                Usage(argv[0]);
+                return 1;
+            }
+            constantTime = strcmp(argv[i], "rt") == 0;
+        }
+        else if(strcmp(argv[i], "--fifo") == 0)
+        {
+            realTime = true;
+        }
+        else if(strcmp(argv[i], "--ftz") == 0)
+        {
+            flushToZero = true;
+        }
+        else
+        {
+            Usage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+
+    if(iterations == 0)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+#if defined(__linux__)
+    if(cpu >= 0)
+    {
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if(sched_setaffinity(0, sizeof(set), &set) != 0)
+        {
+            fprintf(stderr, "could not pin to cpu %d\n", cpu);
+            return 1;
+        }
+    }
+
+    if(realTime)
+    {
+        struct sched_param param;
+
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+        if(sched_setscheduler(0, SCHED_FIFO, &param) != 0 || 
+           mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        {
+            fprintf(stderr, "could not switch to SCHED_FIFO and lock memory\n");
+            return 1;
+        }
+    }
+#else
+    if(cpu >= 0 || realTime)
+    {
+        fprintf(stderr, "--cpu and --fifo are only supported on Linux\n");
+        return 1;
+    }
+#endif
+
+    // Subnormals take a slow path in the floating point unit of most x86 
+    // processors, which no choice of instructions avoids
+    if(flushToZero)
+    {
+#if defined(WCET_CYCLES)
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+#else
+        fprintf(stderr, "--ftz is only supported on x86\n");
+        return 1;
+#endif
+    }
+
+    InputsBuild();
+    ControllersBuild(controllers, controllerCount);
+    overhead = OverheadCalibrate();
+
+    memset(&histogram, 0, sizeof(histogram));
+    histogram.min = UINT64_MAX;
+
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        WcetControl &pid = controllers[i % controllerCount];
+        const WcetInput &sample = inputs[(i / controllerCount) % WCET_INPUTS];
+        uint64_t start, stop;
+
+        pid.PIDInputSet(sample.input);
+        pid.PIDSetpointSet(sample.setpoint);
+
+        start = TimerStart();
+        if(constantTime)
+        {
+            pid.PIDComputeConstantTime();
+        }
+        else
+        {
+            pid.PIDCompute();
+        }
+        stop = TimerStop();
+
+        HistogramAdd((stop - start > overhead) ? stop - start - overhead : 0);
+        checksum += pid.PIDOutputGet();
+    }
+
+    printf("%s: %llu calls, %s after subtracting %llu of timer overhead\n", 
+           constantTime ? "PIDComputeConstantTime" : "PIDCompute", 
+           (unsigned long long)histogram.count, 
+#if defined(WCET_CYCLES)
+           "cycles", 
+#else
+           "ns", 
+#endif
+           (unsigned long long)overhead);
+    printf("  min %llu  max %llu  mean %.2f\n", (unsigned long long)histogram.min, 
+           (unsigned long long)histogram.max, 
+           (double)histogram.total / (double)histogram.count);
+    for(size_t p = 0; p < sizeof(percentiles) / sizeof(percentiles[0]); p++)
+    {
+        uint64_t value = HistogramPercentile(percentiles[p]);
+
+        printf("  %-8s %s%llu\n", percentileNames[p], 
+               (value >= WCET_DIRECT_BUCKETS) ? "< " : "", (unsigned long long)value);
+    }
+
+    // Printed so that the updates cannot be optimized away
+    printf("  checksum %g\n", (double)checksum);
+
+    return 0;
+}
+
+//*********************************************************************************
+// Private Functions
+//*********************************************************************************
+
+static void
+Usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --iterations <n>    timed calls, default %llu\n"
+            "  --path rt|compute   time PIDComputeConstantTime, the default, or\n"
+            "                      PIDCompute\n"
+            "  --cpu <n>           pin to cpu <n> first\n"
+            "  --fifo              run under SCHED_FIFO with memory locked, which\n"
+            "                      needs the privileges for it\n"
+            "  --ftz               flush subnormals to zero, as a real time loop\n"
+            "                      on x86 should\n",
+            program, (unsigned long long)WCET_DEFAULT_ITERATIONS);
+}
+
+//
+// A mix meant to reach every path PIDCompute could take: settled values, 
+// full scale steps that saturate the output, sign flips, exact and signed 
+// zeros, and subnormals, which are slow on some processors. A fixed seed 
+// keeps runs comparable.
+//
+static void
+InputsBuild()
+{
+    uint32_t state = 0x9e3779b9u;
+
+    for(size_t i = 0; i < WCET_INPUTS; i++)
+    {
+        float uniform, other;
+
+        state = state * 1664525u + 1013904223u;
+        uniform = (float)(state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+        state = state * 1664525u + 1013904223u;
+        other = (float)(state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+
+        switch(i % 8)
+        {
+            case 0:
+                inputs[i].input = 0.01f * uniform;
+                inputs[i].setpoint = 0.0f;
+                break;
+            case 1:
+                inputs[i].input = 1000.0f * uniform;
+                inputs[i].setpoint = -1000.0f * other;
+                break;
+            case 2:
+                inputs[i].input = -0.0f;
+                inputs[i].setpoint = 0.0f;
+                break;
+            case 3:
+                inputs[i].input = 1e-40f * uniform;
+                inputs[i].setpoint = 1e-41f * other;
+                break;
+            case 4:
+                inputs[i].input = -inputs[i - 3].input;
+                inputs[i].setpoint = -inputs[i - 3].setpoint;
+                break;
+            default:
+                inputs[i].input = 2.0f * uniform;
+                inputs[i].setpoint = 2.0f * other;
+                break;
+        }
+    }
+}
+
+//
+// Every law, anti-windup strategy and direction, and one controller in MANUAL.
+// They are all built before anything is timed.
+//
+static void
+ControllersBuild(std::vector<WcetControl> &controllers, size_t count)
+{
+    static const PIDAntiWindup strategies[] = { CLAMPING, CONDITIONAL_INTEGRATION, 
+                                                BACK_CALCULATION };
+
+    controllers.reserve(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        controllers.emplace_back(2.0f, 5.0f, 0.05f, 0.001f, -1.0f, 1.0f, 
+                                 (i == count - 1) ? MANUAL : AUTOMATIC, 
+                                 (i % 2) ? REVERSE : DIRECT);
+
+        WcetControl &pid = controllers.back();
+
+        pid.PIDAntiWindupSet(strategies[i % 3], 2.0f);
+        if(i % 4 >= 2)
+        {
+            pid.PIDSetpointWeightsSet(0.5f, 0.25f);
+            pid.PIDDerivativeFilterSet(10.0f);
+        }
+    }
+}
+
+//
+// The least time an empty timed region takes, subtracted from every sample
+//
+static uint64_t
+OverheadCalibrate()
+{
+    uint64_t overhead = UINT64_MAX;
+
+    for(int i = 0; i < 100000; i++)
+    {
+        uint64_t start = TimerStart();
+        uint64_t stop = TimerStop();
+
+        if(stop - start < overhead)
+        {
+            overhead = stop - start;
+        }
+    }
+
+    return overhead;
+}
+
+static void
+HistogramAdd(uint64_t time)
+{
+    if(time < WCET_DIRECT_BUCKETS)
+    {
+        histogram.direct[time]++;
+    }
+    else
+    {
+        unsigned bucket = 0;
+
+        for(uint64_t rest = time; rest > 1; rest >>= 1)
+        {
+            bucket++;
+        }
+        histogram.log[bucket]++;
+    }
+
+    histogram.count++;
+    histogram.total += time;
+    histogram.min = (time < histogram.min) ? time : histogram.min;
+    histogram.max = (time > histogram.max) ? time : histogram.max;
+}
+
+//
+// The smallest time at or under which the fraction of the calls ran. Above
+// WCET_DIRECT_BUCKETS only the power of two it is under is known, and that
+// is what is returned.
+//
+static uint64_t
+HistogramPercentile(double fraction)
+{
+    uint64_t rank = (uint64_t)(fraction * (double)histogram.count);
+    uint64_t seen = 0;
+
+    if(rank >= histogram.count)
+    {
+        rank = histogram.count - 1;
+    }
+
+    for(uint64_t time = 0; time < WCET_DIRECT_BUCKETS; time++)
+    {
+        seen += histogram.direct[time];
+        if(seen > rank)
+        {
+            return time;
+        }
+    }
+
+    for(unsigned bucket = 0; bucket < WCET_LOG_BUCKETS; bucket++)
+    {
+        seen += histogram.log[bucket];
+        if(seen > rank)
+        {
+            return (bucket + 1 < 64) ? (1ull << (bucket + 1)) : UINT64_MAX;
+        }
+    }
+
+    return histogram.max;
+}